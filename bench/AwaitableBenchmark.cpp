@@ -0,0 +1,146 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// Measures the consumer interface for C++20 coroutines (AwaitableConsumer) against the callback interface.
+/// Compare with BM_ProtocolHandler_Batched of ConsumerBenchmark.cpp, it replays the same recordings with callbacks.
+///
+/// Benchmarks are parameterized like the ones in ConsumerBenchmark.cpp.
+///
+/// Reported counters:
+/// - items_per_second: packages per second
+/// - bytes_per_second: transport layer bytes per second
+/// - time/package: time per package
+
+#include <boost/asio/detail/config.hpp>
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "boost/asio/co_spawn.hpp"
+#include "boost/asio/detached.hpp"
+#include "boost/asio/io_context.hpp"
+
+#include "streaming_protocol/AwaitableConsumer.hpp"
+#include "streaming_protocol/ProtocolHandler.hpp"
+#include "streaming_protocol/Types.h"
+
+#include "EncodedScenario.hpp"
+#include "MemoryStream.hpp"
+
+namespace daq::streaming_protocol::bench {
+    /// Each packet is fetched with co_await nextPacket()
+    static void BM_AwaitableConsumer_nextPacket(benchmark::State& state)
+    {
+        Scenario scenario(state);
+        EncodedScenario encoded = encode(scenario);
+        LogCallback logCallback = silentLogCallback();
+
+        size_t valueCount = 0;
+        for (auto _ : state) {
+            boost::asio::io_context ioc;
+            AwaitableConsumer consumer(ioc, logCallback);
+            consumer.protocolHandler().setReceiveMode(RECEIVEMODE_BATCHED);
+            consumer.start(std::make_unique < MemoryStream > (ioc, encoded.complete));
+            auto coroutine = [&]() -> boost::asio::awaitable < void >
+            {
+                const AwaitableConsumer::Packet* packet;
+                while ((packet = co_await consumer.nextPacket()) != nullptr) {
+                    benchmark::DoNotOptimize(packet->timeStamp);
+                    benchmark::DoNotOptimize(packet->data.data());
+                    valueCount += packet->valueCount;
+                }
+            };
+            boost::asio::co_spawn(ioc, coroutine(), boost::asio::detached);
+            ioc.run();
+        }
+        benchmark::DoNotOptimize(valueCount);
+        setCounters(state, encoded);
+    }
+
+    /// Values of all signals are fetched with co_await read(). Data packets are not queued.
+    static void BM_AwaitableConsumer_read(benchmark::State& state)
+    {
+        Scenario scenario(state);
+        EncodedScenario encoded = encode(scenario);
+        LogCallback logCallback = silentLogCallback();
+
+        // one coroutine per signal reads this many packages at once
+        static const size_t ReadInterval = 16;
+        // holds more than one read of the memory stream delivers
+        static const size_t SignalReaderCapacity = 64 * 1024;
+        size_t valuesPerSignal = DataPackageCount / scenario.signalCount * scenario.valuesPerPackage;
+        size_t readCount = std::min(ReadInterval * scenario.valuesPerPackage, valuesPerSignal);
+        std::vector < uint8_t > values(readCount * sizeof(double));
+        std::vector < uint64_t > timeStamps(readCount);
+
+        size_t valueCount = 0;
+        for (auto _ : state) {
+            boost::asio::io_context ioc;
+            AwaitableConsumer consumer(ioc, logCallback);
+            consumer.protocolHandler().setReceiveMode(RECEIVEMODE_BATCHED);
+            consumer.setQueueData(false);
+            std::vector < SignalReader* > signalReaders;
+            for (size_t signalIndex = 0; signalIndex < scenario.signalCount; ++signalIndex) {
+                signalReaders.push_back(&consumer.addSignal("data" + std::to_string(signalIndex), SignalReaderCapacity));
+            }
+            consumer.start(std::make_unique < MemoryStream > (ioc, encoded.complete));
+            auto coroutine = [&](SignalReader& signalReader) -> boost::asio::awaitable < void >
+            {
+                size_t count;
+                while ((count = co_await consumer.read(signalReader, values.data(), timeStamps.data(), readCount)) > 0) {
+                    valueCount += count;
+                }
+            };
+            for (SignalReader* signalReader : signalReaders) {
+                boost::asio::co_spawn(ioc, coroutine(*signalReader), boost::asio::detached);
+            }
+            ioc.run();
+            for (SignalReader* signalReader : signalReaders) {
+                if (signalReader->droppedValueCount() > 0) {
+                    state.SkipWithError("values were dropped");
+                    return;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(valueCount);
+        setCounters(state, encoded);
+    }
+
+    static void scenarios(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "sampleType", "values", "signals", "timeRule" });
+        for (int64_t valuesPerPackage : { 1, 64, 1024 }) {
+            for (RuleType timeRule : { RULETYPE_LINEAR, RULETYPE_EXPLICIT }) {
+                benchmark->Args({ SAMPLETYPE_REAL64, valuesPerPackage, 1, timeRule });
+            }
+        }
+        // many signals
+        for (int64_t signalCount : { 16, 256 }) {
+            benchmark->Args({ SAMPLETYPE_REAL64, 64, signalCount, RULETYPE_LINEAR });
+        }
+    }
+
+    BENCHMARK(BM_AwaitableConsumer_nextPacket)->Apply(scenarios);
+    BENCHMARK(BM_AwaitableConsumer_read)->Apply(scenarios);
+}
+
+#endif
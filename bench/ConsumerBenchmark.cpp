@@ -0,0 +1,296 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// Measures the consumer side: Transport layer interpretation in ProtocolHandler and
+/// signal data processing in SignalContainer/SubscribedSignal.
+///
+/// All benchmarks are parameterized by
+/// - sample type of the data signals (SampleType)
+/// - number of values per data package
+/// - number of data signals, each one in its own table with its own time signal
+/// - time rule of the time signals (RuleType, linear or explicit)
+///
+/// Delivery of values in blocks (SignalContainer::enableBlocks()), BasicSignalContainer with a handler bound at compile time
+/// and pulling values from a StreamReader are measured as well.
+///
+/// Reported counters:
+/// - items_per_second: packages per second
+/// - bytes_per_second: transport layer bytes per second
+/// - time/package: time per package
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "boost/asio/io_context.hpp"
+#include "nlohmann/json.hpp"
+
+#include "streaming_protocol/BasicSignalContainer.hpp"
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/MetaInformation.hpp"
+#include "streaming_protocol/ProtocolHandler.hpp"
+#include "streaming_protocol/SignalContainer.hpp"
+#include "streaming_protocol/StreamReader.hpp"
+#include "streaming_protocol/Types.h"
+
+#include "EncodedScenario.hpp"
+#include "MemoryStream.hpp"
+
+namespace daq::streaming_protocol::bench {
+    /// Replays the recording through ProtocolHandler and SignalContainer
+    static void runProtocolHandler(benchmark::State& state, ReceiveMode receiveMode)
+    {
+        Scenario scenario(state);
+        EncodedScenario encoded = encode(scenario);
+        LogCallback logCallback = silentLogCallback();
+
+        size_t valueCount = 0;
+        size_t dataPackageCount = 0;
+        auto dataAsValueCb = [&valueCount, &dataPackageCount](const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t count)
+        {
+            benchmark::DoNotOptimize(timeStamp);
+            benchmark::DoNotOptimize(data);
+            valueCount += count;
+            if (!subscribedSignal.isTimeSignal()) {
+                ++dataPackageCount;
+            }
+        };
+        auto streamMetaCb = [](ProtocolHandler&, const std::string&, const nlohmann::json&) {};
+
+        for (auto _ : state) {
+            dataPackageCount = 0;
+            // The meta information is processed for each replay. Its share is small compared to all the data packages.
+            boost::asio::io_context ioc;
+            SignalContainer signalContainer(logCallback);
+            signalContainer.setDataAsValueCb(dataAsValueCb);
+            auto protocolHandler = std::make_shared < ProtocolHandler > (ioc, signalContainer, streamMetaCb, logCallback);
+            protocolHandler->setReceiveMode(receiveMode);
+            protocolHandler->start(std::make_unique < MemoryStream > (ioc, encoded.complete));
+            ioc.run();
+            // ProtocolHandler only logs rejected packages. Measuring the rejection path is not intended.
+            if (dataPackageCount != DataPackageCount) {
+                state.SkipWithError("data packages were rejected");
+                return;
+            }
+        }
+        benchmark::DoNotOptimize(valueCount);
+        setCounters(state, encoded);
+    }
+
+    static void BM_ProtocolHandler_PerPackage(benchmark::State& state)
+    {
+        runProtocolHandler(state, RECEIVEMODE_PER_PACKAGE);
+    }
+
+    static void BM_ProtocolHandler_Batched(benchmark::State& state)
+    {
+        runProtocolHandler(state, RECEIVEMODE_BATCHED);
+    }
+
+    /// Feeds the payloads to SignalContainer::processMeasuredData directly. No transport layer involved.
+    /// \param blocks Values are delivered in blocks (SignalContainer::enableBlocks()) instead of per package
+    static void runProcessMeasuredData(benchmark::State& state, bool blocks)
+    {
+        Scenario scenario(state);
+        EncodedScenario encoded = encode(scenario);
+        LogCallback logCallback = silentLogCallback();
+
+        size_t valueCount = 0;
+        auto dataAsValueCb = [&valueCount](const SubscribedSignal&, uint64_t timeStamp, const uint8_t* data, size_t count)
+        {
+            benchmark::DoNotOptimize(timeStamp);
+            benchmark::DoNotOptimize(data);
+            valueCount += count;
+        };
+        auto streamMetaCb = [](ProtocolHandler&, const std::string&, const nlohmann::json&) {};
+
+        // the meta information is processed once to get all signals subscribed
+        boost::asio::io_context ioc;
+        SignalContainer signalContainer(logCallback);
+        if (blocks) {
+            auto dataAsBlocksCb = [&valueCount](const SignalBlock* signalBlocks, size_t blockCount)
+            {
+                for (size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex) {
+                    benchmark::DoNotOptimize(signalBlocks[blockIndex].timeStamps);
+                    benchmark::DoNotOptimize(signalBlocks[blockIndex].data);
+                    valueCount += signalBlocks[blockIndex].valueCount;
+                }
+            };
+            signalContainer.enableBlocks(4096, std::chrono::milliseconds(10), dataAsBlocksCb);
+        } else {
+            signalContainer.setDataAsValueCb(dataAsValueCb);
+        }
+        auto protocolHandler = std::make_shared < ProtocolHandler > (ioc, signalContainer, streamMetaCb, logCallback);
+        protocolHandler->start(std::make_unique < MemoryStream > (ioc, encoded.meta));
+        ioc.run();
+
+        for (auto _ : state) {
+            for (const auto& payload : encoded.payloads) {
+                if (signalContainer.processMeasuredData(payload.signalNumber, encoded.payloadData.data() + payload.offset, payload.size) < 0) {
+                    state.SkipWithError("data package was rejected");
+                    return;
+                }
+            }
+        }
+        signalContainer.flushBlocks();
+        benchmark::DoNotOptimize(valueCount);
+        setCounters(state, encoded);
+    }
+
+    static void BM_SignalContainer_processMeasuredData(benchmark::State& state)
+    {
+        runProcessMeasuredData(state, false);
+    }
+
+    static void BM_SignalContainer_Blocks(benchmark::State& state)
+    {
+        runProcessMeasuredData(state, true);
+    }
+
+    /// Same as dataAsValueCb above, bound at compile time
+    struct CountingHandler : public NopSignalHandler
+    {
+        void dataAsValue(const SubscribedSignal&, uint64_t timeStamp, const uint8_t* data, size_t count)
+        {
+            benchmark::DoNotOptimize(timeStamp);
+            benchmark::DoNotOptimize(data);
+            valueCount += count;
+        }
+
+        size_t valueCount = 0;
+    };
+
+    static void BM_BasicSignalContainer_processMeasuredData(benchmark::State& state)
+    {
+        Scenario scenario(state);
+        EncodedScenario encoded = encode(scenario);
+        LogCallback logCallback = silentLogCallback();
+        BasicSignalContainer < CountingHandler > basicSignalContainer(logCallback);
+
+        // The meta information is interpreted by a SignalContainer and handed over
+        auto signalMetaCb = [&](SubscribedSignal& subscribedSignal, const std::string& method, const nlohmann::json& params)
+        {
+            nlohmann::json document;
+            document["method"] = method;
+            document["params"] = params;
+            std::vector < uint8_t > payload = nlohmann::json::to_msgpack(document);
+            std::vector < uint8_t > package(sizeof(METAINFORMATION_MSGPACK));
+            memcpy(package.data(), &METAINFORMATION_MSGPACK, sizeof(METAINFORMATION_MSGPACK));
+            package.insert(package.end(), payload.begin(), payload.end());
+            MetaInformation metaInformation(logCallback);
+            metaInformation.interpret(package.data(), package.size());
+            basicSignalContainer.processMetaInformation(subscribedSignal.signalNumber(), metaInformation);
+        };
+        auto streamMetaCb = [](ProtocolHandler&, const std::string&, const nlohmann::json&) {};
+        boost::asio::io_context ioc;
+        SignalContainer signalContainer(logCallback);
+        signalContainer.setSignalMetaCb(signalMetaCb);
+        auto protocolHandler = std::make_shared < ProtocolHandler > (ioc, signalContainer, streamMetaCb, logCallback);
+        protocolHandler->start(std::make_unique < MemoryStream > (ioc, encoded.meta));
+        ioc.run();
+
+        for (auto _ : state) {
+            for (const auto& payload : encoded.payloads) {
+                if (basicSignalContainer.processMeasuredData(payload.signalNumber, encoded.payloadData.data() + payload.offset, payload.size) < 0) {
+                    state.SkipWithError("data package was rejected");
+                    return;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(basicSignalContainer.handler().valueCount);
+        setCounters(state, encoded);
+    }
+
+    /// Values and time stamps are put into a StreamReader by the SignalContainer and pulled from there in between
+    static void BM_StreamReader(benchmark::State& state)
+    {
+        Scenario scenario(state);
+        EncodedScenario encoded = encode(scenario);
+        LogCallback logCallback = silentLogCallback();
+
+        // the readers are emptied after this many packages
+        static const size_t ReadInterval = 16;
+        StreamReader streamReader(logCallback);
+        std::vector < SignalReader* > signalReaders;
+        for (size_t signalIndex = 0; signalIndex < scenario.signalCount; ++signalIndex) {
+            signalReaders.push_back(&streamReader.addSignal("data" + std::to_string(signalIndex), ReadInterval * scenario.valuesPerPackage));
+        }
+        std::vector < uint8_t > values(ReadInterval * scenario.valuesPerPackage * sizeof(double));
+        std::vector < uint64_t > timeStamps(ReadInterval * scenario.valuesPerPackage);
+
+        auto streamMetaCb = [](ProtocolHandler&, const std::string&, const nlohmann::json&) {};
+        boost::asio::io_context ioc;
+        SignalContainer signalContainer(logCallback);
+        signalContainer.setDataAsTimestampedValuesCb([&streamReader](const SubscribedSignal& subscribedSignal, const uint64_t* pTimeStamps, const uint8_t* data, size_t count)
+        {
+            streamReader.add(subscribedSignal, pTimeStamps, data, count);
+        });
+        auto protocolHandler = std::make_shared < ProtocolHandler > (ioc, signalContainer, streamMetaCb, logCallback);
+        protocolHandler->start(std::make_unique < MemoryStream > (ioc, encoded.meta));
+        ioc.run();
+
+        size_t valueCount = 0;
+        for (auto _ : state) {
+            for (size_t payloadIndex = 0; payloadIndex < encoded.payloads.size(); ++payloadIndex) {
+                const auto& payload = encoded.payloads[payloadIndex];
+                if (signalContainer.processMeasuredData(payload.signalNumber, encoded.payloadData.data() + payload.offset, payload.size) < 0) {
+                    state.SkipWithError("data package was rejected");
+                    return;
+                }
+                if ((payloadIndex % ReadInterval) == ReadInterval - 1) {
+                    for (SignalReader* signalReader : signalReaders) {
+                        valueCount += signalReader->read(values.data(), timeStamps.data(), signalReader->available());
+                    }
+                }
+            }
+        }
+        benchmark::DoNotOptimize(valueCount);
+        for (SignalReader* signalReader : signalReaders) {
+            if (signalReader->droppedValueCount() > 0) {
+                state.SkipWithError("values were dropped");
+                return;
+            }
+        }
+        setCounters(state, encoded);
+    }
+
+    static void scenarios(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "sampleType", "values", "signals", "timeRule" });
+        for (SampleType sampleType : { SAMPLETYPE_S16, SAMPLETYPE_S32, SAMPLETYPE_REAL32, SAMPLETYPE_REAL64 }) {
+            for (int64_t valuesPerPackage : { 1, 64, 1024 }) {
+                for (RuleType timeRule : { RULETYPE_LINEAR, RULETYPE_EXPLICIT }) {
+                    benchmark->Args({ sampleType, valuesPerPackage, 1, timeRule });
+                }
+            }
+        }
+        // many signals
+        for (int64_t signalCount : { 16, 256 }) {
+            for (RuleType timeRule : { RULETYPE_LINEAR, RULETYPE_EXPLICIT }) {
+                benchmark->Args({ SAMPLETYPE_REAL64, 64, signalCount, timeRule });
+            }
+        }
+    }
+
+    BENCHMARK(BM_ProtocolHandler_PerPackage)->Apply(scenarios);
+    BENCHMARK(BM_ProtocolHandler_Batched)->Apply(scenarios);
+    BENCHMARK(BM_SignalContainer_processMeasuredData)->Apply(scenarios);
+    BENCHMARK(BM_SignalContainer_Blocks)->Apply(scenarios);
+    BENCHMARK(BM_BasicSignalContainer_processMeasuredData)->Apply(scenarios);
+    BENCHMARK(BM_StreamReader)->Apply(scenarios);
+}
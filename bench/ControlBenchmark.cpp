@@ -0,0 +1,520 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/// Measures the latency of control requests (subscribe/unsubscribe).
+///
+/// BM_Control_SubscribeToFirstData: Time from subscribing signals until the first data of all of them arrived at the consumer.
+/// Each signal is subscribed with a separate call, calls made in one go are merged into one request.
+/// The producer acknowledges the subscription and sends one data package right away.
+/// Benchmarks are parameterized by
+/// - HTTP version announced by the producer: 10 for a new connection per request as before, 11 for the keep-alive connection
+/// - number of signals subscribed in one go
+///
+/// BM_Control_Requests: Time until control requests issued at once are completed, without merging.
+/// Benchmarks are parameterized by
+/// - 0 for a new connection per request (HttpPost), 1 for requests pipelined over a keep-alive connection (ControlConnection)
+/// - number of requests issued in one go
+///
+/// BM_Control_SubscribeAcknowledged: Time from subscribing signals until their subscription is acknowledged and the request is completed.
+/// Producer (ProducerSession) and consumer are connected by a tcp connection (TcpStream), the producer runs in a thread of its own.
+/// Benchmarks are parameterized by
+/// - 0 for requests sent to the control server (keep-alive connection), 1 for in-band requests sent over the data stream
+/// - number of signals subscribed in one go
+///
+/// BM_Control_SubscribeStorm: Subscribe storm, many clients issue requests at once, each client pipelines 4 requests over its keep-alive connection.
+/// Executing a command takes 200us (e.g. waiting for hardware). The control server runs in a thread of its own.
+/// Benchmarks are parameterized by
+/// - 0 for a synchronous CommandCb blocking the io thread meanwhile, 1 for an AsyncCommandCb completed by a device thread
+/// - number of clients (connections)
+///
+/// Reported counters:
+/// - time/signal, time/request: time per subscribed signal or per request
+/// - p50, p99: median and 99th percentile of the response latency in seconds, measured from the start of the storm
+///
+/// Producer and consumer run in the same thread and communicate over the loopback interface unless stated otherwise.
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "boost/asio/executor_work_guard.hpp"
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/post.hpp"
+#include "boost/asio/steady_timer.hpp"
+#include "nlohmann/json.hpp"
+
+#include "streaming_protocol/ControlServer.hpp"
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/jsonrpc_defines.hpp"
+#include "streaming_protocol/ProducerSession.hpp"
+#include "streaming_protocol/ProtocolHandler.hpp"
+#include "streaming_protocol/SignalContainer.hpp"
+#include "streaming_protocol/StreamWriter.h"
+#include "streaming_protocol/SynchronousSignal.hpp"
+#include "streaming_protocol/Types.h"
+#include "streaming_protocol/Unit.hpp"
+
+#include "../lib/ControlConnection.hpp"
+#include "../lib/HttpPost.hpp"
+
+#include "EncodedScenario.hpp"
+#include "LoopbackStream.hpp"
+#include "TcpStream.hpp"
+
+namespace daq::streaming_protocol::bench {
+    static const uint16_t ControlPort = 7470;
+
+    static void writeInit(StreamWriter& writer, unsigned int httpVersion)
+    {
+        nlohmann::json init;
+        init[daq::jsonrpc::METHOD] = META_METHOD_INIT;
+        init[daq::jsonrpc::PARAMS][META_STREAMID] = "stream";
+        nlohmann::json& jsonRpcHttp = init[daq::jsonrpc::PARAMS]["commandInterfaces"]["jsonrpc-http"];
+        jsonRpcHttp["httpMethod"] = "POST";
+        jsonRpcHttp["httpPath"] = "/";
+        jsonRpcHttp["httpVersion"] = (httpVersion >= 11) ? "1.1" : "1.0";
+        jsonRpcHttp["port"] = std::to_string(ControlPort);
+        writer.writeMetaInformation(0, init);
+    }
+
+    /// Acknowledges the data signal and its time signal, followed by the first data package
+    static void writeSubscribed(StreamWriter& writer, size_t signalIndex)
+    {
+        std::string index = std::to_string(signalIndex);
+
+        nlohmann::json subscribeData;
+        subscribeData[daq::jsonrpc::METHOD] = META_METHOD_SUBSCRIBE;
+        subscribeData[daq::jsonrpc::PARAMS][META_SIGNALID] = "data" + index;
+        writer.writeMetaInformation(dataSignalNumber(signalIndex), subscribeData);
+
+        nlohmann::json subscribeTime;
+        subscribeTime[daq::jsonrpc::METHOD] = META_METHOD_SUBSCRIBE;
+        subscribeTime[daq::jsonrpc::PARAMS][META_SIGNALID] = "time" + index;
+        writer.writeMetaInformation(timeSignalNumber(signalIndex), subscribeTime);
+
+        nlohmann::json dataSignal;
+        dataSignal[daq::jsonrpc::METHOD] = META_METHOD_SIGNAL;
+        dataSignal[daq::jsonrpc::PARAMS][META_TABLEID] = "table" + index;
+        dataSignal[daq::jsonrpc::PARAMS][META_DEFINITION][META_DATATYPE] = DATA_TYPE_REAL64;
+        dataSignal[daq::jsonrpc::PARAMS][META_DEFINITION][META_RULE] = META_RULETYPE_EXPLICIT;
+        writer.writeMetaInformation(dataSignalNumber(signalIndex), dataSignal);
+
+        nlohmann::json timeSignal;
+        timeSignal[daq::jsonrpc::METHOD] = META_METHOD_SIGNAL;
+        timeSignal[daq::jsonrpc::PARAMS][META_TABLEID] = "table" + index;
+        nlohmann::json& definition = timeSignal[daq::jsonrpc::PARAMS][META_DEFINITION];
+        definition[META_DATATYPE] = DATA_TYPE_UINT64;
+        definition[META_UNIT][META_UNIT_ID] = Unit::UNIT_ID_SECONDS;
+        definition[META_UNIT][META_DISPLAY_NAME] = "s";
+        definition[META_UNIT][META_QUANTITY] = META_TIME;
+        definition[META_RULE] = META_RULETYPE_LINEAR;
+        definition[META_RULETYPE_LINEAR][META_DELTA] = 10;
+        writer.writeMetaInformation(timeSignalNumber(signalIndex), timeSignal);
+
+        IndexedValue < uint64_t > startTime;
+        startTime.index = 0;
+        startTime.value = 0;
+        writer.writeSignalData(timeSignalNumber(signalIndex), &startTime, sizeof(startTime));
+        double value = 1.0;
+        writer.writeSignalData(dataSignalNumber(signalIndex), &value, sizeof(value));
+    }
+
+    static void writeUnsubscribed(StreamWriter& writer, size_t signalIndex)
+    {
+        std::string index = std::to_string(signalIndex);
+
+        nlohmann::json unsubscribeData;
+        unsubscribeData[daq::jsonrpc::METHOD] = META_METHOD_UNSUBSCRIBE;
+        unsubscribeData[daq::jsonrpc::PARAMS] = nlohmann::json::object();
+        writer.writeMetaInformation(dataSignalNumber(signalIndex), unsubscribeData);
+
+        nlohmann::json unsubscribeTime;
+        unsubscribeTime[daq::jsonrpc::METHOD] = META_METHOD_UNSUBSCRIBE;
+        unsubscribeTime[daq::jsonrpc::PARAMS] = nlohmann::json::object();
+        writer.writeMetaInformation(timeSignalNumber(signalIndex), unsubscribeTime);
+    }
+
+    static void BM_Control_SubscribeToFirstData(benchmark::State& state)
+    {
+        unsigned int httpVersion = static_cast < unsigned int > (state.range(0));
+        size_t signalCount = static_cast < size_t > (state.range(1));
+        LogCallback logCallback = silentLogCallback();
+        boost::asio::io_context ioc;
+
+        auto stream = std::make_unique < LoopbackStream > (ioc);
+        // the stream is owned by the consumer
+        std::shared_ptr < stream::Stream > writerStream(stream.get(), [](stream::Stream*){});
+        StreamWriter writer(writerStream);
+        writeInit(writer, httpVersion);
+
+        ControlServer::CommandCb commandCb = [&](const std::string&, const std::string& command, const SignalIds& signalIds, std::string&)
+        {
+            for (const std::string& signalId : signalIds) {
+                // "data<index>"
+                size_t signalIndex = std::stoul(signalId.substr(4));
+                if (command == META_METHOD_SUBSCRIBE) {
+                    writeSubscribed(writer, signalIndex);
+                } else {
+                    writeUnsubscribed(writer, signalIndex);
+                }
+            }
+            return 0;
+        };
+        ControlServer server(ioc, ControlPort, commandCb, logCallback);
+        server.start();
+
+        size_t dataCount = 0;
+        size_t unsubscribeCount = 0;
+        bool initialized = false;
+        SignalContainer signalContainer(logCallback);
+        signalContainer.setDataAsValueCb([&](const SubscribedSignal&, uint64_t, const uint8_t*, size_t)
+        {
+            ++dataCount;
+        });
+        signalContainer.setSignalMetaCb([&](const SubscribedSignal&, const std::string& method, const nlohmann::json&)
+        {
+            if (method == META_METHOD_UNSUBSCRIBE) {
+                ++unsubscribeCount;
+            }
+        });
+        auto streamMetaCb = [&](ProtocolHandler&, const std::string& method, const nlohmann::json&)
+        {
+            if (method == META_METHOD_INIT) {
+                initialized = true;
+            }
+        };
+        auto protocolHandler = std::make_shared < ProtocolHandler > (ioc, signalContainer, streamMetaCb, logCallback);
+        protocolHandler->start(std::move(stream));
+        while (!initialized) {
+            ioc.run_one();
+        }
+
+        SignalIds allSignalIds;
+        for (size_t signalIndex = 0; signalIndex < signalCount; ++signalIndex) {
+            allSignalIds.push_back("data" + std::to_string(signalIndex));
+        }
+
+        for (auto _ : state) {
+            dataCount = 0;
+            for (const std::string& signalId : allSignalIds) {
+                protocolHandler->subscribe({ signalId });
+            }
+            while (dataCount < signalCount) {
+                ioc.run_one();
+            }
+
+            state.PauseTiming();
+            unsubscribeCount = 0;
+            protocolHandler->unsubscribe(allSignalIds);
+            while (unsubscribeCount < 2 * signalCount) {
+                ioc.run_one();
+            }
+            state.ResumeTiming();
+        }
+        state.counters["time/signal"] = benchmark::Counter(static_cast < double > (signalCount),
+                                                           benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+
+        protocolHandler->stop();
+        server.stop();
+        ioc.poll();
+    }
+
+    static void BM_Control_Requests(benchmark::State& state)
+    {
+        bool keepAlive = state.range(0) != 0;
+        size_t requestCount = static_cast < size_t > (state.range(1));
+        LogCallback logCallback = silentLogCallback();
+        boost::asio::io_context ioc;
+
+        ControlServer::CommandCb commandCb = [](const std::string&, const std::string&, const SignalIds&, std::string&)
+        {
+            return 0;
+        };
+        ControlServer server(ioc, ControlPort, commandCb, logCallback);
+        server.start();
+
+        nlohmann::json request;
+        request[daq::jsonrpc::JSONRPC] = "2.0";
+        request[daq::jsonrpc::METHOD] = std::string("stream.") + META_METHOD_SUBSCRIBE;
+        request[daq::jsonrpc::PARAMS].push_back("data0");
+        request[daq::jsonrpc::ID] = 1;
+        std::string requestString = request.dump();
+
+        auto connection = std::make_shared < ControlConnection > (ioc, "127.0.0.1", std::to_string(ControlPort), "/", 11, logCallback);
+        size_t completedCount = 0;
+        bool failed = false;
+        auto resultCb = [&](const boost::system::error_code& ec)
+        {
+            failed |= ec.failed();
+            ++completedCount;
+        };
+
+        for (auto _ : state) {
+            completedCount = 0;
+            for (size_t requestIndex = 0; requestIndex < requestCount; ++requestIndex) {
+                if (keepAlive) {
+                    connection->post(requestString, [&resultCb](const boost::system::error_code& ec, const nlohmann::json&)
+                    {
+                        resultCb(ec);
+                    });
+                } else {
+                    auto httpPost = std::make_shared < HttpPost > (ioc, "127.0.0.1", std::to_string(ControlPort), "/", 11, logCallback);
+                    httpPost->run(requestString, resultCb);
+                }
+            }
+            while (completedCount < requestCount) {
+                ioc.run_one();
+            }
+        }
+        if (failed) {
+            state.SkipWithError("control request failed");
+        }
+        state.counters["time/request"] = benchmark::Counter(static_cast < double > (requestCount),
+                                                            benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+
+        connection->close();
+        server.stop();
+        ioc.poll();
+    }
+
+    static void BM_Control_SubscribeAcknowledged(benchmark::State& state)
+    {
+        bool inBand = state.range(0) != 0;
+        size_t signalCount = static_cast < size_t > (state.range(1));
+        LogCallback logCallback = silentLogCallback();
+
+        // the producer
+        boost::asio::io_context producerIoc;
+        nlohmann::json commandInterfaces;
+        nlohmann::json& jsonRpcHttp = commandInterfaces["jsonrpc-http"];
+        jsonRpcHttp["httpMethod"] = "POST";
+        jsonRpcHttp["httpPath"] = "/";
+        jsonRpcHttp["httpVersion"] = "1.1";
+        jsonRpcHttp["port"] = std::to_string(ControlPort);
+        if (inBand) {
+            commandInterfaces[COMMANDINTERFACE_JSONRPC_INBAND] = nlohmann::json::object();
+        }
+        boost::asio::io_context ioc;
+        auto streams = TcpStream::createPair(ioc, producerIoc);
+        StreamWriter writer(streams.second);
+        auto producerSession = std::make_shared < ProducerSession > (streams.second, commandInterfaces, logCallback);
+        ProducerSession::Signals signals;
+        for (size_t signalIndex = 0; signalIndex < signalCount; ++signalIndex) {
+            std::string signalId = "data" + std::to_string(signalIndex);
+            signals[signalId] = std::make_shared < SynchronousSignal < double > > (signalId, "table", writer, logCallback);
+        }
+        producerSession->start([](const boost::system::error_code&) {});
+        ControlServer::CommandCb commandCb = [&](const std::string&, const std::string& command, const SignalIds& signalIds, std::string&)
+        {
+            if (command == META_METHOD_SUBSCRIBE) {
+                producerSession->subscribeSignals(signalIds);
+            } else {
+                producerSession->unsubscribeSignals(signalIds);
+            }
+            return 0;
+        };
+        ControlServer controlServer(producerIoc, ControlPort, commandCb, logCallback);
+        controlServer.start();
+        auto producerWork = boost::asio::make_work_guard(producerIoc);
+        std::thread producerThread([&producerIoc]() {
+            producerIoc.run();
+        });
+
+        // the consumer
+        size_t subscribeCount = 0;
+        size_t unsubscribeCount = 0;
+        size_t completedCount = 0;
+        bool available = false;
+        bool failed = false;
+        SignalContainer signalContainer(logCallback);
+        signalContainer.setSignalMetaCb([&](const SubscribedSignal&, const std::string& method, const nlohmann::json&)
+        {
+            if (method == META_METHOD_SUBSCRIBE) {
+                ++subscribeCount;
+            } else if (method == META_METHOD_UNSUBSCRIBE) {
+                ++unsubscribeCount;
+            }
+        });
+        auto streamMetaCb = [&](ProtocolHandler&, const std::string& method, const nlohmann::json&)
+        {
+            if (method == META_METHOD_AVAILABLE) {
+                available = true;
+            }
+        };
+        auto completionCb = [&](const boost::system::error_code& ec)
+        {
+            failed |= ec.failed();
+            ++completedCount;
+        };
+        auto protocolHandler = std::make_shared < ProtocolHandler > (ioc, signalContainer, streamMetaCb, logCallback);
+        protocolHandler->start(std::move(streams.first));
+        boost::asio::post(producerIoc, [&]() {
+            producerSession->addSignals(signals);
+        });
+        while (!available) {
+            ioc.run_one();
+        }
+
+        SignalIds allSignalIds;
+        for (size_t signalIndex = 0; signalIndex < signalCount; ++signalIndex) {
+            allSignalIds.push_back("data" + std::to_string(signalIndex));
+        }
+
+        for (auto _ : state) {
+            subscribeCount = 0;
+            completedCount = 0;
+            for (const std::string& signalId : allSignalIds) {
+                protocolHandler->subscribe({ signalId }, completionCb);
+            }
+            while ((subscribeCount < signalCount) || (completedCount < signalCount)) {
+                ioc.run_one();
+            }
+
+            state.PauseTiming();
+            unsubscribeCount = 0;
+            completedCount = 0;
+            protocolHandler->unsubscribe(allSignalIds, completionCb);
+            while ((unsubscribeCount < signalCount) || (completedCount < 1)) {
+                ioc.run_one();
+            }
+            state.ResumeTiming();
+        }
+        if (failed) {
+            state.SkipWithError("control request failed");
+        }
+        state.counters["time/signal"] = benchmark::Counter(static_cast < double > (signalCount),
+                                                           benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+
+        protocolHandler->stop();
+        ioc.run();
+        boost::asio::post(producerIoc, [&]() {
+            controlServer.stop();
+            producerSession->stop();
+        });
+        producerWork.reset();
+        producerThread.join();
+    }
+
+    /// Time spent by the device to execute a command, e.g. waiting for hardware
+    static const std::chrono::microseconds CommandDuration = std::chrono::microseconds(200);
+
+    static void BM_Control_SubscribeStorm(benchmark::State& state)
+    {
+        bool async = state.range(0) != 0;
+        size_t connectionCount = static_cast < size_t > (state.range(1));
+        static const size_t RequestsPerConnection = 4;
+        LogCallback logCallback = silentLogCallback();
+
+        // the control server and the device run in threads of their own
+        boost::asio::io_context serverIoc;
+        boost::asio::io_context deviceIoc;
+        auto serverWork = boost::asio::make_work_guard(serverIoc);
+        auto deviceWork = boost::asio::make_work_guard(deviceIoc);
+
+        ControlServer::CommandCb commandCb = [](const std::string&, const std::string&, const SignalIds&, std::string&)
+        {
+            std::this_thread::sleep_for(CommandDuration);
+            return 0;
+        };
+        ControlServer::AsyncCommandCb asyncCommandCb = [&deviceIoc](const std::string&, const std::string&, const SignalIds& signalIds, ControlServer::CompletionCb completionCb)
+        {
+            auto timer = std::make_shared < boost::asio::steady_timer > (deviceIoc, CommandDuration);
+            timer->async_wait([timer, signalIds, completionCb](const boost::system::error_code&)
+            {
+                completionCb(0, signalIds, "");
+            });
+        };
+        std::unique_ptr < ControlServer > server;
+        if (async) {
+            server = std::make_unique < ControlServer > (serverIoc, ControlPort, asyncCommandCb, logCallback);
+        } else {
+            server = std::make_unique < ControlServer > (serverIoc, ControlPort, commandCb, logCallback);
+        }
+        server->start();
+        std::thread serverThread([&serverIoc]() { serverIoc.run(); });
+        std::thread deviceThread([&deviceIoc]() { deviceIoc.run(); });
+
+        nlohmann::json request;
+        request[daq::jsonrpc::JSONRPC] = "2.0";
+        request[daq::jsonrpc::METHOD] = std::string("stream.") + META_METHOD_SUBSCRIBE;
+        request[daq::jsonrpc::PARAMS].push_back("data0");
+        request[daq::jsonrpc::ID] = 1;
+        std::string requestString = request.dump();
+
+        // the clients, the io_context would stop between storms when running out of work
+        boost::asio::io_context ioc;
+        auto work = boost::asio::make_work_guard(ioc);
+        std::vector < std::shared_ptr < ControlConnection > > connections;
+        for (size_t connectionIndex = 0; connectionIndex < connectionCount; ++connectionIndex) {
+            connections.push_back(std::make_shared < ControlConnection > (ioc, "127.0.0.1", std::to_string(ControlPort), "/", 11, logCallback));
+        }
+
+        std::vector < double > latencies;
+        size_t completedCount = 0;
+        bool failed = false;
+        for (auto _ : state) {
+            completedCount = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (auto& connection : connections) {
+                for (size_t requestIndex = 0; requestIndex < RequestsPerConnection; ++requestIndex) {
+                    connection->post(requestString, [&, start](const boost::system::error_code& ec, const nlohmann::json&)
+                    {
+                        failed |= ec.failed();
+                        latencies.push_back(std::chrono::duration < double > (std::chrono::steady_clock::now() - start).count());
+                        ++completedCount;
+                    });
+                }
+            }
+            while (completedCount < connectionCount * RequestsPerConnection) {
+                ioc.run_one();
+            }
+        }
+        if (failed) {
+            state.SkipWithError("control request failed");
+        }
+        if (!latencies.empty()) {
+            std::sort(latencies.begin(), latencies.end());
+            state.counters["p50"] = latencies[latencies.size() / 2];
+            state.counters["p99"] = latencies[latencies.size() * 99 / 100];
+        }
+        state.counters["time/request"] = benchmark::Counter(static_cast < double > (connectionCount * RequestsPerConnection),
+                                                            benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+
+        for (auto& connection : connections) {
+            connection->close();
+        }
+        work.reset();
+        ioc.poll();
+        boost::asio::post(serverIoc, [&]() {
+            server->stop();
+        });
+        serverWork.reset();
+        serverThread.join();
+        deviceWork.reset();
+        deviceThread.join();
+    }
+
+    BENCHMARK(BM_Control_SubscribeToFirstData)->ArgNames({ "httpVersion", "signals" })->ArgsProduct({ { 10, 11 }, { 1, 16 } })->UseRealTime();
+    BENCHMARK(BM_Control_SubscribeAcknowledged)->ArgNames({ "inBand", "signals" })->ArgsProduct({ { 0, 1 }, { 1, 16 } })->UseRealTime();
+    BENCHMARK(BM_Control_Requests)->ArgNames({ "keepAlive", "requests" })->ArgsProduct({ { 0, 1 }, { 1, 16 } })->UseRealTime();
+    BENCHMARK(BM_Control_SubscribeStorm)->ArgNames({ "async", "connections" })->ArgsProduct({ { 0, 1 }, { 8, 32 } })->UseRealTime();
+}
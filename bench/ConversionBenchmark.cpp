@@ -0,0 +1,232 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// Measures the conversion of sample values into double or float (SampleConverter) against the former
+/// conversion loop of SubscribedSignal::interpretValuesAsDouble() that converted one value after the other.
+///
+/// Benchmarks are parameterized by
+/// - sample type (SampleType)
+/// - 1 if each value is preceded by its value index (constant rule), 0 for values only (explicit rule)
+/// - instruction set (SampleConverter::InstructionSet), not for the former loop
+/// - options (SampleConverter::Option), not for the former loop
+///
+/// Reported counters:
+/// - items_per_second: values per second
+///
+/// Generation of time stamps for linear time rules and their conversion into nanoseconds (TimeTicks) are measured as well.
+
+#include <cstring>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "streaming_protocol/SampleConverter.hpp"
+#include "streaming_protocol/TimeTicks.hpp"
+#include "streaming_protocol/Types.h"
+
+namespace daq::streaming_protocol::bench {
+    static const size_t ValueCount = 4096;
+
+    static size_t sampleSize(SampleType sampleType)
+    {
+        switch (sampleType) {
+        case SAMPLETYPE_S16:
+            return sizeof(int16_t);
+        case SAMPLETYPE_S32:
+        case SAMPLETYPE_REAL32:
+            return sizeof(int32_t);
+        default:
+            return sizeof(int64_t);
+        }
+    }
+
+    static std::vector < uint8_t > createData(SampleType sampleType, bool indexed)
+    {
+        size_t valueSize = sampleSize(sampleType);
+        if (indexed) {
+            valueSize += sizeof(uint64_t);
+        }
+        std::vector < uint8_t > data(ValueCount * valueSize);
+        for (size_t byteIndex = 0; byteIndex < data.size(); ++byteIndex) {
+            // small exponents for floating point types
+            data[byteIndex] = static_cast < uint8_t > (byteIndex % 61);
+        }
+        return data;
+    }
+
+    /// The former conversion loop
+    template < typename DataType >
+    static void convertLoop(const uint8_t* pData, size_t count, double* doubleValueBuffer, bool indexed)
+    {
+        DataType value;
+        if (!indexed) {
+            for (size_t i = 0; i < count; ++i) {
+                memcpy(&value, pData, sizeof(value));
+                doubleValueBuffer[i] = static_cast < double > (value);
+                pData += sizeof(DataType);
+            }
+        } else {
+            uint64_t valueIndex;
+            for (size_t i = 0; i < count; ++i) {
+                memcpy(&valueIndex, pData, sizeof(valueIndex));
+                pData += sizeof(valueIndex);
+                memcpy(&value, pData, sizeof(value));
+                doubleValueBuffer[i] = static_cast < double > (value);
+                pData += sizeof(DataType);
+            }
+        }
+    }
+
+    static void BM_Conversion_Loop(benchmark::State& state)
+    {
+        SampleType sampleType = static_cast < SampleType > (state.range(0));
+        bool indexed = state.range(1) != 0;
+        std::vector < uint8_t > data = createData(sampleType, indexed);
+        std::vector < double > results(ValueCount);
+
+        for (auto _ : state) {
+            switch (sampleType) {
+            case SAMPLETYPE_S16:
+                convertLoop < int16_t > (data.data(), ValueCount, results.data(), indexed);
+                break;
+            case SAMPLETYPE_S32:
+                convertLoop < int32_t > (data.data(), ValueCount, results.data(), indexed);
+                break;
+            case SAMPLETYPE_S64:
+                convertLoop < int64_t > (data.data(), ValueCount, results.data(), indexed);
+                break;
+            case SAMPLETYPE_REAL32:
+                convertLoop < float > (data.data(), ValueCount, results.data(), indexed);
+                break;
+            default:
+                convertLoop < double > (data.data(), ValueCount, results.data(), indexed);
+                break;
+            }
+            benchmark::DoNotOptimize(results.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(static_cast < int64_t > (state.iterations() * ValueCount));
+    }
+
+    template < typename Result >
+    static void runSampleConverter(benchmark::State& state)
+    {
+        SampleType sampleType = static_cast < SampleType > (state.range(0));
+        bool indexed = state.range(1) != 0;
+        SampleConverter::InstructionSet instructionSet = static_cast < SampleConverter::InstructionSet > (state.range(2));
+        unsigned int options = static_cast < unsigned int > (state.range(3));
+        if (instructionSet > SampleConverter::supportedInstructionSet()) {
+            state.SkipWithError("instruction set is not supported by this CPU");
+            return;
+        }
+
+        std::vector < uint8_t > data = createData(sampleType, indexed);
+        std::vector < Result > results(ValueCount);
+
+        PostScaling postScaling;
+        postScaling.scale = 0.5;
+        postScaling.offset = -3;
+        Range range;
+        range.low = -1e6;
+        range.high = 1e6;
+
+        SampleConverter converter;
+        converter.setElementTypes({ sampleType });
+        converter.setIndexed(indexed);
+        converter.setPostScaling(postScaling);
+        converter.setRange(range);
+        converter.setInstructionSet(instructionSet);
+
+        for (auto _ : state) {
+            converter.convert(data.data(), ValueCount, results.data(), options);
+            benchmark::DoNotOptimize(results.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(static_cast < int64_t > (state.iterations() * ValueCount));
+    }
+
+    static void BM_SampleConverter_Double(benchmark::State& state)
+    {
+        runSampleConverter < double > (state);
+    }
+
+    static void BM_SampleConverter_Float(benchmark::State& state)
+    {
+        runSampleConverter < float > (state);
+    }
+
+    /// Time stamp of each value as computed by consumers of DataAsValueCb: converted one after the other via double
+    static void BM_TimeStamps_Loop(benchmark::State& state)
+    {
+        uint64_t timeTicksPerSecond = static_cast < uint64_t > (state.range(0));
+        std::vector < uint64_t > nanoseconds(ValueCount);
+        for (auto _ : state) {
+            for (size_t i = 0; i < ValueCount; ++i) {
+                uint64_t timeTicks = 1000000 + i * 3;
+                nanoseconds[i] = static_cast < uint64_t > (static_cast < double > (timeTicks) / static_cast < double > (timeTicksPerSecond) * 1e9);
+            }
+            benchmark::DoNotOptimize(nanoseconds.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(static_cast < int64_t > (state.iterations() * ValueCount));
+    }
+
+    static void BM_TimeTicks(benchmark::State& state)
+    {
+        uint64_t timeTicksPerSecond = static_cast < uint64_t > (state.range(0));
+        std::vector < uint64_t > nanoseconds(ValueCount);
+        for (auto _ : state) {
+            TimeTicks::linear(1000000, 3, ValueCount, nanoseconds.data());
+            TimeTicks::toNanoseconds(nanoseconds.data(), ValueCount, timeTicksPerSecond, nanoseconds.data());
+            benchmark::DoNotOptimize(nanoseconds.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(static_cast < int64_t > (state.iterations() * ValueCount));
+    }
+
+    static const SampleType SampleTypes[] = { SAMPLETYPE_S16, SAMPLETYPE_S32, SAMPLETYPE_S64, SAMPLETYPE_REAL32, SAMPLETYPE_REAL64 };
+
+    static void loopScenarios(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "sampleType", "indexed" });
+        for (SampleType sampleType : SampleTypes) {
+            for (int64_t indexed : { 0, 1 }) {
+                benchmark->Args({ sampleType, indexed });
+            }
+        }
+    }
+
+    static void converterScenarios(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "sampleType", "indexed", "instructionSet", "options" });
+        for (SampleType sampleType : SampleTypes) {
+            for (int64_t indexed : { 0, 1 }) {
+                for (SampleConverter::InstructionSet instructionSet : { SampleConverter::INSTRUCTIONSET_SCALAR, SampleConverter::INSTRUCTIONSET_SSE41, SampleConverter::INSTRUCTIONSET_AVX2 }) {
+                    for (int64_t options : { 0, SampleConverter::OPTION_POSTSCALING | SampleConverter::OPTION_RANGE }) {
+                        benchmark->Args({ sampleType, indexed, instructionSet, options });
+                    }
+                }
+            }
+        }
+    }
+
+    BENCHMARK(BM_Conversion_Loop)->Apply(loopScenarios);
+    BENCHMARK(BM_SampleConverter_Double)->Apply(converterScenarios);
+    BENCHMARK(BM_SampleConverter_Float)->Apply(converterScenarios);
+    // 1GHz, 1MHz and 48kHz
+    BENCHMARK(BM_TimeStamps_Loop)->ArgName("timeTicksPerSecond")->Arg(1000000000)->Arg(1000000)->Arg(48000);
+    BENCHMARK(BM_TimeTicks)->ArgName("timeTicksPerSecond")->Arg(1000000000)->Arg(1000000)->Arg(48000);
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "boost/asio/io_context.hpp"
+#include "nlohmann/json.hpp"
+
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/jsonrpc_defines.hpp"
+#include "streaming_protocol/StreamWriter.h"
+#include "streaming_protocol/Unit.hpp"
+
+#include "EncodedScenario.hpp"
+
+namespace daq::streaming_protocol::bench {
+    LogCallback silentLogCallback()
+    {
+        return [](spdlog::source_loc, spdlog::level::level_enum, const char*) {};
+    }
+
+    Scenario::Scenario(SampleType sampleType, size_t valuesPerPackage, size_t signalCount, RuleType timeRule)
+        : sampleType(sampleType)
+        , valuesPerPackage(valuesPerPackage)
+        , signalCount(signalCount)
+        , timeRule(timeRule)
+    {
+    }
+
+    Scenario::Scenario(const benchmark::State& state)
+        : Scenario(static_cast < SampleType > (state.range(0)),
+                   static_cast < size_t > (state.range(1)),
+                   static_cast < size_t > (state.range(2)),
+                   static_cast < RuleType > (state.range(3)))
+    {
+    }
+
+    static const char* dataTypeName(SampleType sampleType)
+    {
+        switch (sampleType) {
+        case SAMPLETYPE_S16:
+            return DATA_TYPE_INT16;
+        case SAMPLETYPE_S32:
+            return DATA_TYPE_INT32;
+        case SAMPLETYPE_S64:
+            return DATA_TYPE_INT64;
+        case SAMPLETYPE_REAL32:
+            return DATA_TYPE_REAL32;
+        default:
+            return DATA_TYPE_REAL64;
+        }
+    }
+
+    static size_t sampleSize(SampleType sampleType)
+    {
+        switch (sampleType) {
+        case SAMPLETYPE_S16:
+            return sizeof(int16_t);
+        case SAMPLETYPE_S32:
+        case SAMPLETYPE_REAL32:
+            return sizeof(int32_t);
+        default:
+            return sizeof(int64_t);
+        }
+    }
+
+    SignalNumber dataSignalNumber(size_t signalIndex)
+    {
+        return static_cast < SignalNumber > (2 * signalIndex + 1);
+    }
+
+    SignalNumber timeSignalNumber(size_t signalIndex)
+    {
+        return static_cast < SignalNumber > (2 * signalIndex + 2);
+    }
+
+    static void writeSubscribeAndSignalMeta(StreamWriter& writer, const Scenario& scenario)
+    {
+        for (size_t signalIndex = 0; signalIndex < scenario.signalCount; ++signalIndex) {
+            std::string tableId = "table" + std::to_string(signalIndex);
+
+            nlohmann::json subscribeData;
+            subscribeData[daq::jsonrpc::METHOD] = META_METHOD_SUBSCRIBE;
+            subscribeData[daq::jsonrpc::PARAMS][META_SIGNALID] = "data" + std::to_string(signalIndex);
+            writer.writeMetaInformation(dataSignalNumber(signalIndex), subscribeData);
+
+            nlohmann::json subscribeTime;
+            subscribeTime[daq::jsonrpc::METHOD] = META_METHOD_SUBSCRIBE;
+            subscribeTime[daq::jsonrpc::PARAMS][META_SIGNALID] = "time" + std::to_string(signalIndex);
+            writer.writeMetaInformation(timeSignalNumber(signalIndex), subscribeTime);
+
+            nlohmann::json dataSignal;
+            dataSignal[daq::jsonrpc::METHOD] = META_METHOD_SIGNAL;
+            dataSignal[daq::jsonrpc::PARAMS][META_TABLEID] = tableId;
+            dataSignal[daq::jsonrpc::PARAMS][META_DEFINITION][META_DATATYPE] = dataTypeName(scenario.sampleType);
+            dataSignal[daq::jsonrpc::PARAMS][META_DEFINITION][META_RULE] = META_RULETYPE_EXPLICIT;
+            writer.writeMetaInformation(dataSignalNumber(signalIndex), dataSignal);
+
+            nlohmann::json timeSignal;
+            timeSignal[daq::jsonrpc::METHOD] = META_METHOD_SIGNAL;
+            timeSignal[daq::jsonrpc::PARAMS][META_TABLEID] = tableId;
+            nlohmann::json& definition = timeSignal[daq::jsonrpc::PARAMS][META_DEFINITION];
+            definition[META_DATATYPE] = DATA_TYPE_UINT64;
+            // time signals are identified by the quantity of their unit
+            definition[META_UNIT][META_UNIT_ID] = Unit::UNIT_ID_SECONDS;
+            definition[META_UNIT][META_DISPLAY_NAME] = "s";
+            definition[META_UNIT][META_QUANTITY] = META_TIME;
+            if (scenario.timeRule == RULETYPE_LINEAR) {
+                definition[META_RULE] = META_RULETYPE_LINEAR;
+                definition[META_RULETYPE_LINEAR][META_DELTA] = 10;
+            } else {
+                definition[META_RULE] = META_RULETYPE_EXPLICIT;
+            }
+            writer.writeMetaInformation(timeSignalNumber(signalIndex), timeSignal);
+        }
+    }
+
+    EncodedScenario encode(const Scenario& scenario)
+    {
+        boost::asio::io_context ioc;
+        EncodedScenario encoded;
+
+        auto metaStream = std::make_shared < MemoryStream > (ioc);
+        {
+            StreamWriter writer(metaStream);
+            writeSubscribeAndSignalMeta(writer, scenario);
+        }
+        encoded.meta = metaStream->recording();
+
+        auto completeStream = std::make_shared < MemoryStream > (ioc);
+        StreamWriter writer(completeStream);
+        writeSubscribeAndSignalMeta(writer, scenario);
+        size_t metaSize = completeStream->recording()->size();
+
+        auto addPayload = [&](SignalNumber signalNumber, const void* data, size_t size) {
+            writer.writeSignalData(signalNumber, data, size);
+            const uint8_t* pData = reinterpret_cast < const uint8_t* > (data);
+            encoded.payloads.push_back({ signalNumber, encoded.payloadData.size(), size });
+            encoded.payloadData.insert(encoded.payloadData.end(), pData, pData + size);
+            ++encoded.packageCount;
+        };
+
+        std::vector < uint8_t > values(scenario.valuesPerPackage * sampleSize(scenario.sampleType), 0x11);
+        uint64_t valueIndex = 0;
+        for (size_t packageIndex = 0; packageIndex < DataPackageCount; ++packageIndex) {
+            size_t signalIndex = packageIndex % scenario.signalCount;
+            if (scenario.timeRule == RULETYPE_LINEAR) {
+                if (packageIndex < scenario.signalCount) {
+                    IndexedValue < uint64_t > startTime;
+                    startTime.index = 0;
+                    startTime.value = 0;
+                    addPayload(timeSignalNumber(signalIndex), &startTime, sizeof(startTime));
+                }
+            } else {
+                // each data package is preceded by its time stamp
+                uint64_t timeStamp = valueIndex * 10;
+                addPayload(timeSignalNumber(signalIndex), &timeStamp, sizeof(timeStamp));
+            }
+            addPayload(dataSignalNumber(signalIndex), values.data(), values.size());
+            valueIndex += scenario.valuesPerPackage;
+        }
+        encoded.complete = completeStream->recording();
+        encoded.byteCount = encoded.complete->size() - metaSize;
+        return encoded;
+    }
+
+    void setCounters(benchmark::State& state, const EncodedScenario& encoded)
+    {
+        state.SetItemsProcessed(static_cast < int64_t > (state.iterations() * encoded.packageCount));
+        state.SetBytesProcessed(static_cast < int64_t > (state.iterations() * encoded.byteCount));
+        state.counters["time/package"] = benchmark::Counter(static_cast < double > (encoded.packageCount),
+                                                            benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/Types.h"
+
+#include "MemoryStream.hpp"
+
+namespace daq::streaming_protocol::bench {
+    /// Number of data packages in one replay
+    static const size_t DataPackageCount = 10000;
+
+    /// Benchmarks are not to be disturbed by log output
+    LogCallback silentLogCallback();
+
+    /// Describes the signals and packages to be encoded
+    struct Scenario
+    {
+        Scenario(SampleType sampleType, size_t valuesPerPackage, size_t signalCount, RuleType timeRule);
+
+        /// Takes the parameters from the benchmark arguments in this order: sample type, values per package, signal count, time rule
+        explicit Scenario(const benchmark::State& state);
+
+        SampleType sampleType;
+        size_t valuesPerPackage;
+        /// Each data signal is in its own table with its own time signal
+        size_t signalCount;
+        RuleType timeRule;
+    };
+
+    /// Pre-encoded packages of one scenario
+    struct EncodedScenario
+    {
+        /// subscribe acknowledges and signal meta information of all signals
+        std::shared_ptr < const Recording > meta;
+        /// meta information followed by all data packages as delivered by the transport layer
+        std::shared_ptr < const Recording > complete;
+        /// Payloads of the data packages without transport header to be fed to SignalContainer directly
+        struct Payload
+        {
+            SignalNumber signalNumber;
+            size_t offset;
+            size_t size;
+        };
+        std::vector < Payload > payloads;
+        Recording payloadData;
+        /// number of packages (time and data) following the meta information
+        size_t packageCount = 0;
+        /// number of transport layer bytes following the meta information
+        size_t byteCount = 0;
+    };
+
+    SignalNumber dataSignalNumber(size_t signalIndex);
+    SignalNumber timeSignalNumber(size_t signalIndex);
+
+    /// Encodes the meta information of all signals and DataPackageCount data packages distributed over all signals
+    EncodedScenario encode(const Scenario& scenario);
+
+    /// Reports packages/s, bytes/s and time per package
+    void setCounters(benchmark::State& state, const EncodedScenario& encoded);
+}
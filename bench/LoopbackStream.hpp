@@ -0,0 +1,160 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/post.hpp"
+
+#include "stream/Stream.hpp"
+
+namespace daq::streaming_protocol::bench {
+    /// In-memory stream connecting a producer writing to it with a consumer reading from it.
+    /// -Reads wait for data to be written until the stream gets closed.
+    /// -Read completions are posted to the io context like a real network stream does.
+    class LoopbackStream : public stream::Stream
+    {
+    public:
+        explicit LoopbackStream(boost::asio::io_context& ioc, size_t chunkSize = 64 * 1024)
+            : m_ioc(ioc)
+            , m_chunkSize(chunkSize)
+            , m_readPosition(0)
+            , m_bytesToRead(0)
+        {
+        }
+
+        void asyncInit(CompletionCb completionCb) override
+        {
+            completionCb(boost::system::error_code());
+        }
+
+        boost::system::error_code init() override
+        {
+            return boost::system::error_code();
+        }
+
+        std::string endPointUrl() const override
+        {
+            return "loopback";
+        }
+
+        std::string remoteHost() const override
+        {
+            return "127.0.0.1";
+        }
+
+        void asyncReadAtLeast(std::size_t bytesToRead, ReadCompletionCb readAtLeastCb) override
+        {
+            m_bytesToRead = bytesToRead;
+            m_pendingRead = std::move(readAtLeastCb);
+            completeRead();
+        }
+
+        size_t readAtLeast(std::size_t bytesToRead, boost::system::error_code& ec) override
+        {
+            size_t bytesLeft = m_data.size() - m_readPosition;
+            if (bytesLeft < bytesToRead) {
+                ec = boost::asio::error::eof;
+                return 0;
+            }
+            size_t bytesRead = std::min(std::max(bytesToRead, m_chunkSize), bytesLeft);
+            auto buffer = m_buffer.prepare(bytesRead);
+            memcpy(buffer.data(), m_data.data() + m_readPosition, bytesRead);
+            m_buffer.commit(bytesRead);
+            m_readPosition += bytesRead;
+            if (m_readPosition == m_data.size()) {
+                // everything was read, start over
+                m_data.clear();
+                m_readPosition = 0;
+            }
+            return bytesRead;
+        }
+
+        void asyncWrite(const boost::asio::const_buffer& data, WriteCompletionCb writeCompletionCb) override
+        {
+            boost::system::error_code ec;
+            size_t bytesWritten = write(data, ec);
+            writeCompletionCb(ec, bytesWritten);
+        }
+
+        void asyncWrite(const stream::ConstBufferVector& data, WriteCompletionCb writeCompletionCb) override
+        {
+            boost::system::error_code ec;
+            size_t bytesWritten = write(data, ec);
+            writeCompletionCb(ec, bytesWritten);
+        }
+
+        size_t write(const boost::asio::const_buffer& data, boost::system::error_code&) override
+        {
+            const uint8_t* pData = reinterpret_cast < const uint8_t* > (data.data());
+            m_data.insert(m_data.end(), pData, pData + data.size());
+            completeRead();
+            return data.size();
+        }
+
+        size_t write(const stream::ConstBufferVector& data, boost::system::error_code& ec) override
+        {
+            size_t sizeSum = 0;
+            for (const auto& dataIter : data) {
+                sizeSum += write(dataIter, ec);
+            }
+            return sizeSum;
+        }
+
+        void asyncClose(CompletionCb closeCb) override
+        {
+            if (m_pendingRead) {
+                boost::asio::post(m_ioc, [readAtLeastCb = std::move(m_pendingRead)]() {
+                    readAtLeastCb(boost::asio::error::eof, 0);
+                });
+                m_pendingRead = ReadCompletionCb();
+            }
+            closeCb(boost::system::error_code());
+        }
+
+        boost::system::error_code close() override
+        {
+            return boost::system::error_code();
+        }
+
+    private:
+        /// Completes the pending read if enough data was written
+        void completeRead()
+        {
+            if (!m_pendingRead || (m_data.size() - m_readPosition < m_bytesToRead)) {
+                return;
+            }
+            boost::system::error_code ec;
+            size_t bytesRead = readAtLeast(m_bytesToRead, ec);
+            boost::asio::post(m_ioc, [readAtLeastCb = std::move(m_pendingRead), ec, bytesRead]() {
+                readAtLeastCb(ec, bytesRead);
+            });
+            m_pendingRead = ReadCompletionCb();
+        }
+
+        boost::asio::io_context& m_ioc;
+        size_t m_chunkSize;
+        std::vector < uint8_t > m_data;
+        size_t m_readPosition;
+        size_t m_bytesToRead;
+        ReadCompletionCb m_pendingRead;
+    };
+}
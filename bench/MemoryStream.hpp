@@ -0,0 +1,152 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/post.hpp"
+
+#include "stream/Stream.hpp"
+
+namespace daq::streaming_protocol::bench {
+    using Recording = std::vector < uint8_t >;
+
+    /// In-memory stream without any network or file system involved.
+    /// -Everything written is appended to the recording.
+    /// -Reading replays a recording in chunks like a network stream delivers them.
+    ///  Read completions are posted to the io context.
+    class MemoryStream : public stream::Stream
+    {
+    public:
+        /// Stream for recording only
+        explicit MemoryStream(boost::asio::io_context& ioc)
+            : MemoryStream(ioc, std::make_shared < Recording > ())
+        {
+        }
+
+        /// \param replay Recording to be replayed. It is shared and not copied, several streams may replay the same recording.
+        /// \param chunkSize Maximum number of bytes delivered by one read operation
+        MemoryStream(boost::asio::io_context& ioc, std::shared_ptr < const Recording > replay, size_t chunkSize = 64 * 1024)
+            : m_ioc(ioc)
+            , m_replay(replay)
+            , m_chunkSize(chunkSize)
+            , m_readPosition(0)
+        {
+        }
+
+        void asyncInit(CompletionCb completionCb) override
+        {
+            completionCb(boost::system::error_code());
+        }
+
+        boost::system::error_code init() override
+        {
+            return boost::system::error_code();
+        }
+
+        std::string endPointUrl() const override
+        {
+            return "memory";
+        }
+
+        std::string remoteHost() const override
+        {
+            return "localhost";
+        }
+
+        void asyncReadAtLeast(std::size_t bytesToRead, ReadCompletionCb readAtLeastCb) override
+        {
+            boost::system::error_code ec;
+            size_t bytesRead = readAtLeast(bytesToRead, ec);
+            boost::asio::post(m_ioc, [readAtLeastCb = std::move(readAtLeastCb), ec, bytesRead]() {
+                readAtLeastCb(ec, bytesRead);
+            });
+        }
+
+        size_t readAtLeast(std::size_t bytesToRead, boost::system::error_code& ec) override
+        {
+            size_t bytesLeft = m_replay->size() - m_readPosition;
+            if (bytesLeft < bytesToRead) {
+                ec = boost::asio::error::eof;
+                return 0;
+            }
+            size_t bytesRead = std::min(std::max(bytesToRead, m_chunkSize), bytesLeft);
+            auto buffer = m_buffer.prepare(bytesRead);
+            memcpy(buffer.data(), m_replay->data() + m_readPosition, bytesRead);
+            m_buffer.commit(bytesRead);
+            m_readPosition += bytesRead;
+            return bytesRead;
+        }
+
+        void asyncWrite(const boost::asio::const_buffer& data, WriteCompletionCb writeCompletionCb) override
+        {
+            boost::system::error_code ec;
+            size_t bytesWritten = write(data, ec);
+            writeCompletionCb(ec, bytesWritten);
+        }
+
+        void asyncWrite(const stream::ConstBufferVector& data, WriteCompletionCb writeCompletionCb) override
+        {
+            boost::system::error_code ec;
+            size_t bytesWritten = write(data, ec);
+            writeCompletionCb(ec, bytesWritten);
+        }
+
+        size_t write(const boost::asio::const_buffer& data, boost::system::error_code&) override
+        {
+            const uint8_t* pData = reinterpret_cast < const uint8_t* > (data.data());
+            m_recording->insert(m_recording->end(), pData, pData + data.size());
+            return data.size();
+        }
+
+        size_t write(const stream::ConstBufferVector& data, boost::system::error_code& ec) override
+        {
+            size_t sizeSum = 0;
+            for (const auto& dataIter : data) {
+                sizeSum += write(dataIter, ec);
+            }
+            return sizeSum;
+        }
+
+        void asyncClose(CompletionCb closeCb) override
+        {
+            closeCb(boost::system::error_code());
+        }
+
+        boost::system::error_code close() override
+        {
+            return boost::system::error_code();
+        }
+
+        /// \return everything written to the stream so far
+        std::shared_ptr < const Recording > recording() const
+        {
+            return m_recording;
+        }
+
+    private:
+        boost::asio::io_context& m_ioc;
+        std::shared_ptr < Recording > m_recording = std::make_shared < Recording > ();
+        std::shared_ptr < const Recording > m_replay;
+        size_t m_chunkSize;
+        size_t m_readPosition;
+    };
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// Measures resolving signal id patterns (SignalIdPattern) against a registry of 100000 signals.
+///
+/// BM_Pattern_Resolve: Matching signals are visited by SignalIdPattern::forEachMatch(), only the range of the
+/// sorted registry starting with the literal prefix of the pattern is evaluated.
+/// BM_Pattern_Scan: Each signal id of the registry is matched by SignalIdPattern::match().
+/// Benchmarks are parameterized by
+/// - pattern index into Patterns
+///
+/// Reported counters:
+/// - matches: number of signals matched by the pattern
+/// - time/pattern: time for resolving the pattern once
+///
+/// Signal ids look like "device3/ai1234/raw", there are 10 devices with 5000 channels and 2 signals each.
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "streaming_protocol/SignalIdPattern.hpp"
+
+namespace daq::streaming_protocol::bench {
+    static const char* const Patterns[] = {
+        // narrowed to one device
+        "device3/*/raw",
+        // narrowed to a few channels
+        "device3/ai12**",
+        // narrowed to nothing but the 1st letters, all signals are evaluated
+        "device?/ai12/raw",
+        // all signals are evaluated
+        "**/scaled",
+    };
+
+    using Registry = std::map < std::string, std::shared_ptr < int > >;
+
+    static const Registry& registry()
+    {
+        static const Registry signals = []() {
+            Registry result;
+            for (int device = 0; device < 10; ++device) {
+                for (int channel = 0; channel < 5000; ++channel) {
+                    std::string channelId = "device" + std::to_string(device) + "/ai" + std::to_string(channel);
+                    result[channelId + "/raw"] = std::make_shared < int > (channel);
+                    result[channelId + "/scaled"] = std::make_shared < int > (channel);
+                }
+            }
+            return result;
+        }();
+        return signals;
+    }
+
+    static void BM_Pattern_Resolve(benchmark::State& state)
+    {
+        const Registry& signals = registry();
+        SignalIdPattern pattern(Patterns[state.range(0)]);
+        size_t matchCount = 0;
+        for (auto _ : state) {
+            matchCount = 0;
+            pattern.forEachMatch(signals, [&matchCount](const Registry::value_type&) {
+                ++matchCount;
+            });
+            benchmark::DoNotOptimize(matchCount);
+        }
+        state.counters["matches"] = static_cast < double > (matchCount);
+        state.counters["time/pattern"] = benchmark::Counter(static_cast < double > (state.iterations()), benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    }
+
+    static void BM_Pattern_Scan(benchmark::State& state)
+    {
+        const Registry& signals = registry();
+        SignalIdPattern pattern(Patterns[state.range(0)]);
+        size_t matchCount = 0;
+        for (auto _ : state) {
+            matchCount = 0;
+            for (const auto& entry : signals) {
+                if (pattern.match(entry.first)) {
+                    ++matchCount;
+                }
+            }
+            benchmark::DoNotOptimize(matchCount);
+        }
+        state.counters["matches"] = static_cast < double > (matchCount);
+        state.counters["time/pattern"] = benchmark::Counter(static_cast < double > (state.iterations()), benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    }
+
+    BENCHMARK(BM_Pattern_Resolve)->ArgName("pattern")->DenseRange(0, 3);
+    BENCHMARK(BM_Pattern_Scan)->ArgName("pattern")->DenseRange(0, 3);
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/// Measures how the websocket Server scales with the number of concurrent clients on loopback.
+///
+/// Each iteration connects all clients at once, each client waits for the initial meta information of its session.
+/// Afterwards all clients disconnect and the benchmark waits for the server to remove the sessions (not measured).
+/// Clients are driven by ClientThreadCount threads of their own.
+/// Benchmarks are parameterized by
+/// - number of io_context threads owned by the server, 0 for processing all sessions on the accepting io_context
+/// - number of concurrent clients
+///
+/// Reported counters:
+/// - items_per_second: sessions established per second
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "boost/asio/executor_work_guard.hpp"
+#include "boost/asio/io_context.hpp"
+
+#include "stream/WebsocketClientStream.hpp"
+
+#include "streaming_protocol/Server.hpp"
+
+#include "EncodedScenario.hpp"
+
+namespace daq::streaming_protocol::bench {
+    static const uint16_t ServerPort = 7480;
+    static const size_t ClientThreadCount = 4;
+
+    /// \return false on timeout
+    static bool waitForSessionCount(const Server& server, size_t count)
+    {
+        auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (server.sessionCount() != count) {
+            if (std::chrono::steady_clock::now() > timeout) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    static void BM_Server_Connect(benchmark::State& state)
+    {
+        size_t threadCount = static_cast < size_t > (state.range(0));
+        size_t clientCount = static_cast < size_t > (state.range(1));
+        LogCallback logCallback = silentLogCallback();
+
+        boost::asio::io_context acceptorIoc;
+        auto work = boost::asio::make_work_guard(acceptorIoc);
+        Server server(acceptorIoc, ServerPort, threadCount, Server::SESSIONDISTRIBUTION_LEASTLOADED, logCallback);
+        if (server.start() < 0) {
+            state.SkipWithError("server could not be started");
+            return;
+        }
+        std::thread acceptorThread([&acceptorIoc]() { acceptorIoc.run(); });
+
+        std::atomic < size_t > failedClients(0);
+        for (auto _ : state) {
+            std::vector < std::unique_ptr < boost::asio::io_context > > clientIocs;
+            std::vector < std::vector < std::unique_ptr < stream::WebsocketClientStream > > > clients(ClientThreadCount);
+            std::vector < std::thread > clientThreads;
+            for (size_t clientThreadIndex = 0; clientThreadIndex < ClientThreadCount; ++clientThreadIndex) {
+                clientIocs.emplace_back(std::make_unique < boost::asio::io_context > ());
+                for (size_t clientIndex = clientThreadIndex; clientIndex < clientCount; clientIndex += ClientThreadCount) {
+                    clients[clientThreadIndex].emplace_back(std::make_unique < stream::WebsocketClientStream > (*clientIocs.back(), "127.0.0.1", std::to_string(ServerPort), "/"));
+                }
+            }
+
+            for (auto& threadClients : clients) {
+                clientThreads.emplace_back([&threadClients, &failedClients]() {
+                    for (auto& client : threadClients) {
+                        boost::system::error_code ec = client->init();
+                        if (!ec) {
+                            // the initial meta information proves the session to be running
+                            client->readSome(ec);
+                        }
+                        if (ec) {
+                            ++failedClients;
+                        }
+                    }
+                });
+            }
+            for (auto& clientThread : clientThreads) {
+                clientThread.join();
+            }
+            if (failedClients > 0) {
+                state.SkipWithError("client could not connect");
+                break;
+            }
+
+            state.PauseTiming();
+            for (auto& threadClients : clients) {
+                for (auto& client : threadClients) {
+                    client->close();
+                }
+            }
+            if (!waitForSessionCount(server, 0)) {
+                state.SkipWithError("sessions were not removed");
+                state.ResumeTiming();
+                break;
+            }
+            state.ResumeTiming();
+        }
+
+        server.stop();
+        work.reset();
+        acceptorThread.join();
+        state.SetItemsProcessed(static_cast < int64_t > (state.iterations() * clientCount));
+    }
+
+    BENCHMARK(BM_Server_Connect)->ArgNames({"threads", "clients"})
+        ->ArgsProduct({{0, 1, 2, 4}, {1, 10, 100, 500}})->UseRealTime();
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// Measures how the consumer scales with the number of decoding shards (SignalContainer::startShards()).
+///
+/// The data callback does some work per value (conversion to double and summing up) to emulate a consumer that
+/// does more than just counting. Shard count 0 means unsharded processing in the calling thread.
+///
+/// Reported counters:
+/// - items_per_second: packages per second
+/// - bytes_per_second: transport layer bytes per second
+/// - time/package: time per package
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "boost/asio/io_context.hpp"
+#include "nlohmann/json.hpp"
+
+#include "streaming_protocol/ProtocolHandler.hpp"
+#include "streaming_protocol/SignalContainer.hpp"
+#include "streaming_protocol/SubscribedSignal.hpp"
+#include "streaming_protocol/Types.h"
+
+#include "EncodedScenario.hpp"
+#include "MemoryStream.hpp"
+
+namespace daq::streaming_protocol::bench {
+    static const size_t SignalCount = 16;
+    static const size_t ValuesPerPackage = 256;
+
+    static void BM_SignalContainer_Sharded(benchmark::State& state)
+    {
+        unsigned int shardCount = static_cast < unsigned int > (state.range(0));
+        EncodedScenario encoded = encode(Scenario(SAMPLETYPE_REAL64, ValuesPerPackage, SignalCount, RULETYPE_LINEAR));
+        LogCallback logCallback = silentLogCallback();
+
+        std::atomic < size_t > processedDataPackages(0);
+        auto dataAsValueCb = [&processedDataPackages](const SubscribedSignal& subscribedSignal, uint64_t, const uint8_t* data, size_t count)
+        {
+            thread_local std::vector < double > values;
+            values.resize(count);
+            subscribedSignal.interpretValuesAsDouble(data, count, values.data());
+            double sum = 0.0;
+            for (double value : values) {
+                sum += value;
+            }
+            benchmark::DoNotOptimize(sum);
+            processedDataPackages.fetch_add(1, std::memory_order_release);
+        };
+        auto streamMetaCb = [](ProtocolHandler&, const std::string&, const nlohmann::json&) {};
+
+        // the meta information is processed once to get all signals subscribed
+        boost::asio::io_context ioc;
+        SignalContainer signalContainer(logCallback);
+        signalContainer.setDataAsValueCb(dataAsValueCb);
+        if (shardCount > 0) {
+            signalContainer.startShards(shardCount);
+        }
+        auto protocolHandler = std::make_shared < ProtocolHandler > (ioc, signalContainer, streamMetaCb, logCallback);
+        protocolHandler->start(std::make_unique < MemoryStream > (ioc, encoded.meta));
+        ioc.run();
+
+        size_t expectedDataPackages = 0;
+        for (auto _ : state) {
+            for (const auto& payload : encoded.payloads) {
+                if (signalContainer.processMeasuredData(payload.signalNumber, encoded.payloadData.data() + payload.offset, payload.size) < 0) {
+                    state.SkipWithError("data package was rejected");
+                    return;
+                }
+            }
+            // wait for the shards to catch up
+            expectedDataPackages += DataPackageCount;
+            while (processedDataPackages.load(std::memory_order_acquire) < expectedDataPackages) {
+                std::this_thread::yield();
+            }
+        }
+        signalContainer.stopShards();
+        setCounters(state, encoded);
+    }
+
+    BENCHMARK(BM_SignalContainer_Sharded)->ArgName("shards")->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include "boost/asio/connect.hpp"
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/ip/tcp.hpp"
+#include "boost/asio/post.hpp"
+#include "boost/asio/read.hpp"
+#include "boost/asio/write.hpp"
+
+#include "stream/Stream.hpp"
+
+namespace daq::streaming_protocol::bench {
+    /// Stream over a plain tcp connection with Nagle's algorithm disabled.
+    /// Used for measuring latencies in both directions without the websocket layer.
+    /// -Writes are synchronous and counted (see writeCount())
+    /// -Each side is to be used within the io context it was created with
+    class TcpStream : public stream::Stream
+    {
+    public:
+        TcpStream(boost::asio::io_context& ioc, boost::asio::ip::tcp::socket&& socket)
+            : m_ioc(ioc)
+            , m_socket(std::move(socket))
+            , m_writeCount(0)
+        {
+            m_socket.set_option(boost::asio::ip::tcp::no_delay(true));
+        }
+
+        /// Creates both ends of a connection over the loopback interface
+        /// \return The client end created with clientIoc and the server end created with serverIoc
+        static std::pair < std::unique_ptr < TcpStream >, std::shared_ptr < TcpStream > > createPair(boost::asio::io_context& clientIoc, boost::asio::io_context& serverIoc)
+        {
+            using boost::asio::ip::tcp;
+            tcp::acceptor acceptor(serverIoc, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+            tcp::socket clientSocket(clientIoc);
+            clientSocket.connect(acceptor.local_endpoint());
+            tcp::socket serverSocket(serverIoc);
+            acceptor.accept(serverSocket);
+            return { std::make_unique < TcpStream > (clientIoc, std::move(clientSocket)), std::make_shared < TcpStream > (serverIoc, std::move(serverSocket)) };
+        }
+
+        void asyncInit(CompletionCb completionCb) override
+        {
+            completionCb(boost::system::error_code());
+        }
+
+        boost::system::error_code init() override
+        {
+            return boost::system::error_code();
+        }
+
+        std::string endPointUrl() const override
+        {
+            return "tcp";
+        }
+
+        std::string remoteHost() const override
+        {
+            return "127.0.0.1";
+        }
+
+        void asyncReadAtLeast(std::size_t bytesToRead, ReadCompletionCb readAtLeastCb) override
+        {
+            boost::asio::async_read(m_socket, m_buffer, boost::asio::transfer_at_least(bytesToRead), readAtLeastCb);
+        }
+
+        size_t readAtLeast(std::size_t bytesToRead, boost::system::error_code& ec) override
+        {
+            return boost::asio::read(m_socket, m_buffer, boost::asio::transfer_at_least(bytesToRead), ec);
+        }
+
+        void asyncWrite(const boost::asio::const_buffer& data, WriteCompletionCb writeCompletionCb) override
+        {
+            boost::system::error_code ec;
+            size_t bytesWritten = write(data, ec);
+            writeCompletionCb(ec, bytesWritten);
+        }
+
+        void asyncWrite(const stream::ConstBufferVector& data, WriteCompletionCb writeCompletionCb) override
+        {
+            boost::system::error_code ec;
+            size_t bytesWritten = write(data, ec);
+            writeCompletionCb(ec, bytesWritten);
+        }
+
+        size_t write(const boost::asio::const_buffer& data, boost::system::error_code& ec) override
+        {
+            m_writeCount.fetch_add(1, std::memory_order_relaxed);
+            return boost::asio::write(m_socket, data, ec);
+        }
+
+        size_t write(const stream::ConstBufferVector& data, boost::system::error_code& ec) override
+        {
+            m_writeCount.fetch_add(1, std::memory_order_relaxed);
+            return boost::asio::write(m_socket, data, ec);
+        }
+
+        void asyncClose(CompletionCb closeCb) override
+        {
+            boost::system::error_code ec = close();
+            boost::asio::post(m_ioc, [closeCb, ec]() {
+                closeCb(ec);
+            });
+        }
+
+        boost::system::error_code close() override
+        {
+            boost::system::error_code ec;
+            m_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+            m_socket.close(ec);
+            return ec;
+        }
+
+        /// Number of writes to the socket so far
+        size_t writeCount() const
+        {
+            return m_writeCount.load(std::memory_order_relaxed);
+        }
+
+    private:
+        boost::asio::io_context& m_ioc;
+        boost::asio::ip::tcp::socket m_socket;
+        std::atomic < size_t > m_writeCount;
+    };
+}
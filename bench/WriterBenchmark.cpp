@@ -0,0 +1,261 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// Measures writing small signal data packets by the producer: Writing synchronously (StreamWriter) against queued writing (SendQueue).
+/// The packets are written to a tcp connection (TcpStream), the consumer end is drained by a thread of its own.
+/// Queued packets are written in the thread of the io context of the stream.
+///
+/// Benchmarks are parameterized by
+/// - 0 for writing synchronously, 1 for queued writing
+/// - maximum latency of queued packets in microseconds
+/// - payload size of each packet in bytes
+///
+/// Reported counters:
+/// - items_per_second: packets per second, including the time until the queued packets are written
+/// - writes/packet: writes to the socket (syscalls) per packet
+///
+/// Serving one signal to many sessions is measured as well: A signal per session against one signal shared via SignalHub.
+/// Packets are written to streams discarding them, only the producer side is measured. Parameterized by
+/// - 0 for a signal per session, 1 for the signal hub
+/// - number of sessions
+/// - number of values (double) of each packet
+/// items_per_second are packets produced per second, each one written to all sessions.
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "boost/asio/executor_work_guard.hpp"
+#include "boost/asio/io_context.hpp"
+
+#include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/SendQueue.hpp"
+#include "streaming_protocol/SignalHub.hpp"
+#include "streaming_protocol/StreamWriter.h"
+#include "streaming_protocol/SynchronousSignal.hpp"
+
+#include "EncodedScenario.hpp"
+#include "TcpStream.hpp"
+
+namespace daq::streaming_protocol::bench {
+    static const size_t PacketsPerIteration = 1000;
+
+    static void BM_Writer_Packets(benchmark::State& state)
+    {
+        bool queued = state.range(0) != 0;
+        std::chrono::microseconds maxLatency(state.range(1));
+        size_t payloadSize = static_cast < size_t > (state.range(2));
+        LogCallback logCallback = silentLogCallback();
+
+        boost::asio::io_context clientIoc;
+        boost::asio::io_context serverIoc;
+        auto serverWork = boost::asio::make_work_guard(serverIoc);
+        auto streams = TcpStream::createPair(clientIoc, serverIoc);
+        std::shared_ptr < TcpStream > serverStream = streams.second;
+        std::thread serverThread([&serverIoc]() { serverIoc.run(); });
+
+        // the consumer
+        std::thread drainThread([&streams]() {
+            boost::system::error_code ec;
+            while (!ec) {
+                streams.first->readAtLeast(1, ec);
+                streams.first->consume(streams.first->size());
+            }
+        });
+
+        std::shared_ptr < SendQueue > sendQueue;
+        std::unique_ptr < StreamWriter > writer;
+        if (queued) {
+            sendQueue = std::make_shared < SendQueue > (serverIoc, serverStream, maxLatency, SendQueue::DEFAULT_MAX_BATCH_SIZE, SendQueue::DEFAULT_CAPACITY, SendQueue::OVERFLOWPOLICY_DISCONNECT, logCallback);
+            writer = std::make_unique < StreamWriter > (sendQueue);
+        } else {
+            writer = std::make_unique < StreamWriter > (serverStream);
+        }
+
+        std::vector < uint8_t > payload(payloadSize, 0x55);
+        size_t writeCount = serverStream->writeCount();
+        uint64_t queuedBytes = 0;
+        for (auto _ : state) {
+            for (size_t packetIndex = 0; packetIndex < PacketsPerIteration; ++packetIndex) {
+                int result = writer->writeSignalData(1, payload.data(), payload.size());
+                if (result < 0) {
+                    state.SkipWithError("write failed");
+                    break;
+                }
+                queuedBytes += static_cast < uint64_t > (result);
+            }
+            if (queued) {
+                // until written
+                sendQueue->flush();
+                while (sendQueue->metrics().writtenBytes < queuedBytes) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        uint64_t packetCount = state.iterations() * PacketsPerIteration;
+        state.SetItemsProcessed(static_cast < int64_t > (packetCount));
+        state.counters["writes/packet"] = static_cast < double > (serverStream->writeCount() - writeCount) / static_cast < double > (packetCount);
+
+        serverStream->close();
+        drainThread.join();
+        serverWork.reset();
+        serverThread.join();
+    }
+
+    /// Completes all writes right away and discards the data
+    class DiscardingStream : public stream::Stream
+    {
+    public:
+        void asyncInit(CompletionCb completionCb) override
+        {
+            completionCb(boost::system::error_code());
+        }
+
+        boost::system::error_code init() override
+        {
+            return boost::system::error_code();
+        }
+
+        std::string endPointUrl() const override
+        {
+            return "discarding";
+        }
+
+        std::string remoteHost() const override
+        {
+            return "localhost";
+        }
+
+        void asyncReadAtLeast(std::size_t, ReadCompletionCb) override
+        {
+        }
+
+        size_t readAtLeast(std::size_t, boost::system::error_code&) override
+        {
+            return 0;
+        }
+
+        void asyncWrite(const boost::asio::const_buffer& data, WriteCompletionCb writeCompletionCb) override
+        {
+            writeCompletionCb(boost::system::error_code(), data.size());
+        }
+
+        void asyncWrite(const stream::ConstBufferVector& data, WriteCompletionCb writeCompletionCb) override
+        {
+            writeCompletionCb(boost::system::error_code(), boost::asio::buffer_size(data));
+        }
+
+        size_t write(const boost::asio::const_buffer& data, boost::system::error_code&) override
+        {
+            return data.size();
+        }
+
+        size_t write(const stream::ConstBufferVector& data, boost::system::error_code&) override
+        {
+            return boost::asio::buffer_size(data);
+        }
+
+        void asyncClose(CompletionCb closeCb) override
+        {
+            closeCb(boost::system::error_code());
+        }
+
+        boost::system::error_code close() override
+        {
+            return boost::system::error_code();
+        }
+    };
+
+    static void BM_Writer_FanOut(benchmark::State& state)
+    {
+        static const size_t FanOutPacketsPerIteration = 100;
+        bool hub = state.range(0) != 0;
+        size_t sessionCount = static_cast < size_t > (state.range(1));
+        size_t valueCount = static_cast < size_t > (state.range(2));
+        LogCallback logCallback = silentLogCallback();
+
+        boost::asio::io_context serverIoc;
+        auto serverWork = boost::asio::make_work_guard(serverIoc);
+        std::thread serverThread([&serverIoc]() { serverIoc.run(); });
+
+        SignalHub signalHub(logCallback);
+        std::vector < std::shared_ptr < SendQueue > > sendQueues;
+        std::vector < std::unique_ptr < StreamWriter > > writers;
+        std::vector < std::unique_ptr < SynchronousSignal < double > > > signals;
+        if (hub) {
+            signals.push_back(std::make_unique < SynchronousSignal < double > > ("signal", "table", signalHub, logCallback));
+        }
+        for (size_t sessionIndex = 0; sessionIndex < sessionCount; ++sessionIndex) {
+            auto sendQueue = std::make_shared < SendQueue > (serverIoc, std::make_shared < DiscardingStream > (), std::chrono::microseconds(0), SendQueue::DEFAULT_MAX_BATCH_SIZE,
+                                                             SendQueue::DEFAULT_CAPACITY, SendQueue::OVERFLOWPOLICY_DROP, logCallback);
+            sendQueues.push_back(sendQueue);
+            if (hub) {
+                signalHub.addSession(sendQueue);
+                signalHub.subscribe(sendQueue, *signals.front());
+            } else {
+                writers.push_back(std::make_unique < StreamWriter > (sendQueue));
+                signals.push_back(std::make_unique < SynchronousSignal < double > > ("signal", "table", *writers.back(), logCallback));
+                signals.back()->subscribe();
+            }
+        }
+
+        std::vector < double > values(valueCount, 1.5);
+        for (auto _ : state) {
+            for (size_t packetIndex = 0; packetIndex < FanOutPacketsPerIteration; ++packetIndex) {
+                for (auto& signal : signals) {
+                    signal->addData(values);
+                }
+            }
+            // until written
+            for (auto& sendQueue : sendQueues) {
+                while (sendQueue->metrics().bufferedBytes > 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        state.SetItemsProcessed(static_cast < int64_t > (state.iterations() * FanOutPacketsPerIteration));
+
+        serverWork.reset();
+        serverThread.join();
+    }
+
+    static void fanOutScenarios(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "hub", "sessions", "values" });
+        for (int64_t values : { 16, 1024 }) {
+            for (int64_t sessions : { 1, 10, 50 }) {
+                benchmark->Args({ 0, sessions, values });
+                benchmark->Args({ 1, sessions, values });
+            }
+        }
+    }
+
+    static void scenarios(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "queued", "maxLatencyUs", "payload" });
+        for (int64_t payload : { 16, 1024 }) {
+            benchmark->Args({ 0, 0, payload });
+            benchmark->Args({ 1, 0, payload });
+            benchmark->Args({ 1, 1000, payload });
+        }
+    }
+
+    BENCHMARK(BM_Writer_Packets)->Apply(scenarios)->UseRealTime();
+    BENCHMARK(BM_Writer_FanOut)->Apply(fanOutScenarios)->UseRealTime();
+}
@@ -62,6 +62,12 @@ public:
 
     virtual SampleType getSampleType() const override;
 
+    /// Each value follows its own time stamp in the explicit time signal of the table, a value missing does not affect the others.
+    virtual bool isDroppable() const override
+    {
+        return true;
+    }
+
     void createTuples(const DataType* data, uint64_t* timestamps, size_t sampleCount, ValueTuples& tuplesOut)
     {
         if (tuplesOut.size() < sampleCount)
@@ -75,19 +81,24 @@ public:
     }
 
     /// asynchronous values always come with a separate timestamp!
+    /// \return Number of bytes written, -1 on error. Nothing is written if the signal is not subscribed (see isSubscribed()), 0 is returned then.
     int addData(const ValueTuples& tuples)
     {
+        if (!isSubscribed()) {
+            return 0;
+        }
         // in the tabled protocol, we need to send timestamp and value separately
-        int result;
+        int bytesWritten = 0;
         for (const auto tuple : tuples) 
         {
-            result = m_writer.writeSignalData(m_signalNumber, reinterpret_cast<const uint8_t*>(&tuple.value), sizeof(tuple.value));
+            int result = m_writer.writeSignalData(m_signalNumber, reinterpret_cast<const uint8_t*>(&tuple.value), sizeof(tuple.value));
             if (result < 0) {
                 STREAMING_PROTOCOL_LOG_E("{}: Could not write signal data!", m_signalNumber);
                 return result;
             }
+            bytesWritten += result;
         }
-        return 0;
+        return bytesWritten;
     }
 
 private:
@@ -0,0 +1,677 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <boost/asio/detail/config.hpp>
+
+/// The awaitable interface requires C++20 coroutines. It is not available otherwise.
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+#include "nlohmann/json.hpp"
+
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/ProtocolHandler.hpp"
+#include "streaming_protocol/SignalContainer.hpp"
+#include "streaming_protocol/SignalIdPattern.hpp"
+#include "streaming_protocol/StreamReader.hpp"
+#include "streaming_protocol/Types.h"
+
+namespace daq::streaming_protocol {
+    /// \addtogroup consumer
+    /// Consumer for C++20 coroutines: Everything received is awaited with co_await instead of being handed to callbacks.
+    /// Wraps ProtocolHandler and SignalContainer and queues all meta information and data as packets in the order of arrival.
+    /// -All methods are to be called from within the io context. There is no locking.
+    /// -Packets are taken from a pool and reused. Once the pool is large enough, packages are delivered without allocating.
+    /// -Awaiting coroutines are resumed by posting to the io context. This does not allocate either.
+    /// -Values of signals added with addSignal() can be awaited with read() as well.
+    /// \warning Keep this object alive until the session ended and the io context does not run anymore.
+    class AwaitableConsumer
+    {
+    public:
+        enum PacketType {
+            PACKETTYPE_STREAM_META,
+            PACKETTYPE_SIGNAL_META,
+            PACKETTYPE_DATA
+        };
+
+        struct Packet
+        {
+            PacketType type = PACKETTYPE_DATA;
+            /// 0 for stream related meta information
+            SignalNumber signalNumber = 0;
+            /// Empty for stream related meta information
+            std::string signalId;
+
+            /// Meta information only
+            std::string method;
+            nlohmann::json params;
+
+            /// Data only: Values as delivered by DataAsValueCb.
+            /// Values of constant rule signals are preceded by their value index (see IndexedValue).
+            uint64_t timeStamp = 0;
+            size_t valueCount = 0;
+            size_t valueSize = 0;
+            std::vector < uint8_t > data;
+        };
+
+        /// Result of subscribe() and unsubscribe()
+        struct ControlResult
+        {
+            /// false if the request failed or the session ended before
+            bool succeeded = false;
+            /// Signal ids the producer did not subscribe or unsubscribe, i.e. signals it does not know. They are not acknowledged.
+            /// Only known if the producer responds the signals affected (see ControlServer::ResolvingCommandCb), empty otherwise.
+            SignalIds unknownSignalIds;
+        };
+
+        /// \param packetPoolSize Initial number of packets, the pool grows if packets are not fetched fast enough
+        AwaitableConsumer(boost::asio::io_context& ioc, LogCallback logCb, size_t packetPoolSize = 64)
+            : m_ioc(ioc)
+            , m_signalContainer(logCb)
+            , m_streamReader(logCb)
+            , m_packetMask(0)
+            , m_packetHead(0)
+            , m_packetCount(0)
+            , m_hasCurrentPacket(false)
+            , m_resuming(false)
+            , m_queueData(true)
+            , m_readingValues(false)
+            , m_ended(false)
+        {
+            size_t poolSize = 1;
+            while (poolSize < packetPoolSize) {
+                poolSize <<= 1;
+            }
+            for (size_t packetIndex = 0; packetIndex < poolSize; ++packetIndex) {
+                m_packets.emplace_back(std::make_unique < Packet > ());
+            }
+            m_packetMask = poolSize - 1;
+            m_pendingReads.reserve(CompletionMemory::SlotCount);
+
+            m_signalContainer.setSignalMetaCb([this](SubscribedSignal& subscribedSignal, const std::string& method, const nlohmann::json& params)
+            {
+                onSignalMeta(subscribedSignal, method, params);
+            });
+            m_signalContainer.setDataAsValueCb([this](const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t valueCount)
+            {
+                onData(subscribedSignal, timeStamp, data, valueCount);
+            });
+            auto streamMetaCb = [this](ProtocolHandler&, const std::string& method, const nlohmann::json& params)
+            {
+                onStreamMeta(method, params);
+                Packet& packet = pushPacket(PACKETTYPE_STREAM_META, 0);
+                packet.signalId.clear();
+                packet.method = method;
+                packet.params = params;
+                completePacket();
+            };
+            m_protocolHandler = std::make_shared < ProtocolHandler > (ioc, m_signalContainer, streamMetaCb, logCb);
+        }
+
+        AwaitableConsumer(const AwaitableConsumer&) = delete;
+        AwaitableConsumer& operator=(const AwaitableConsumer&) = delete;
+
+        ProtocolHandler& protocolHandler()
+        {
+            return *m_protocolHandler;
+        }
+
+        /// Data packets are queued by default. Turn this off if values are fetched with read() only.
+        void setQueueData(bool queueData)
+        {
+            m_queueData = queueData;
+        }
+
+        /// \warning Add all signals before values arrive
+        /// \param capacity Number of values to be kept
+        /// \return The reader to be passed to read(). It exists as long as this object.
+        SignalReader& addSignal(const std::string& signalId, size_t capacity)
+        {
+            if (!m_readingValues) {
+                m_signalContainer.setDataAsTimestampedValuesCb([this](const SubscribedSignal& subscribedSignal, const uint64_t* timeStamps, const uint8_t* data, size_t valueCount)
+                {
+                    m_streamReader.add(subscribedSignal, timeStamps, data, valueCount);
+                    completeReads();
+                });
+                m_readingValues = true;
+            }
+            return m_streamReader.addSignal(signalId, capacity);
+        }
+
+        /// Starts receiving. Use ProtocolHandler::setReceiveMode() before if required.
+        void start(std::unique_ptr < daq::stream::Stream > stream)
+        {
+            m_protocolHandler->start(std::move(stream), [this](const boost::system::error_code& ec)
+            {
+                m_sessionEc = ec;
+                m_ended = true;
+                completePacket();
+                completeReads();
+                completeControl();
+            });
+        }
+
+        void stop()
+        {
+            m_protocolHandler->stop();
+        }
+
+        /// \return true after the session ended and all packets were fetched
+        bool ended() const
+        {
+            return m_ended && (m_packetCount == 0);
+        }
+
+        /// Session error code, valid after the session ended
+        boost::system::error_code sessionError() const
+        {
+            return m_sessionEc;
+        }
+
+        /// Waits for the next packet. Only one coroutine may wait for packets at a time.
+        /// \return The next packet, valid until the next call. nullptr after the session ended and all packets were fetched.
+        boost::asio::awaitable < const Packet* > nextPacket()
+        {
+            return boost::asio::async_initiate < const boost::asio::use_awaitable_t <>&, void(const Packet*) > ([this](PacketHandler handler)
+            {
+                if (m_hasCurrentPacket) {
+                    // the packet is handed back to the pool
+                    m_packetHead = (m_packetHead + 1) & m_packetMask;
+                    --m_packetCount;
+                    m_hasCurrentPacket = false;
+                }
+                m_packetHandler.emplace(std::move(handler));
+                resumeDirectly();
+            }, boost::asio::use_awaitable);
+        }
+
+        /// Sends the subscribe request and waits for the response. Afterwards, waits until the signals affected are acknowledged by the producer.
+        /// If the producer responds the signals affected, those are awaited. Signal id patterns (see SignalIdPattern) are resolved by the producer then.
+        /// Otherwise, only signals announced as available are awaited.
+        /// Signals unknown to the producer are reported in the result instead of being awaited.
+        boost::asio::awaitable < ControlResult > subscribe(const SignalIds& signalIds)
+        {
+            co_return co_await control(signalIds, true);
+        }
+
+        /// Sends the unsubscribe request and waits for the response and the acknowledges as subscribe() does.
+        boost::asio::awaitable < ControlResult > unsubscribe(const SignalIds& signalIds)
+        {
+            co_return co_await control(signalIds, false);
+        }
+
+        /// Waits until count values of the signal were received and copies them. See SignalReader::read().
+        /// \param signalReader As returned by addSignal(). count is limited to its capacity.
+        /// \return Number of values read, less than count only if the session ended
+        boost::asio::awaitable < size_t > read(SignalReader& signalReader, void* values, uint64_t* timeStamps, size_t count)
+        {
+            // the initiation runs after this method returned, when being awaited
+            SignalReader* pSignalReader = &signalReader;
+            return boost::asio::async_initiate < const boost::asio::use_awaitable_t <>&, void(size_t) > ([this, pSignalReader, values, timeStamps, count](ReadHandler handler)
+            {
+                PendingRead pendingRead{ pSignalReader, values, timeStamps, std::min(count, pSignalReader->capacity()), std::move(handler) };
+                // free entries are reused, the handlers can not be assigned
+                auto iter = std::find_if(m_pendingReads.begin(), m_pendingReads.end(), [](const std::optional < PendingRead >& entry) {
+                    return !entry.has_value();
+                });
+                if (iter == m_pendingReads.end()) {
+                    m_pendingReads.emplace_back(std::move(pendingRead));
+                } else {
+                    iter->emplace(std::move(pendingRead));
+                }
+                resumeDirectly();
+            }, boost::asio::use_awaitable);
+        }
+
+    private:
+        using PacketHandler = boost::asio::async_result < boost::asio::use_awaitable_t <>, void(const Packet*) >::handler_type;
+        using ReadHandler = boost::asio::async_result < boost::asio::use_awaitable_t <>, void(size_t) >::handler_type;
+        using ControlHandler = boost::asio::async_result < boost::asio::use_awaitable_t <>, void() >::handler_type;
+
+        /// Memory for the completions posted to resume coroutines. There are few of them in flight at the same time.
+        class CompletionMemory
+        {
+        public:
+            static const size_t SlotCount = 4;
+
+            void* allocate(size_t size)
+            {
+                for (Slot& slot : m_slots) {
+                    if (!slot.inUse && (size <= sizeof(slot.storage))) {
+                        slot.inUse = true;
+                        return slot.storage;
+                    }
+                }
+                return ::operator new(size);
+            }
+
+            void deallocate(void* pointer)
+            {
+                for (Slot& slot : m_slots) {
+                    if (pointer == slot.storage) {
+                        slot.inUse = false;
+                        return;
+                    }
+                }
+                ::operator delete(pointer);
+            }
+
+        private:
+            struct Slot
+            {
+                alignas(std::max_align_t) unsigned char storage[256];
+                bool inUse = false;
+            };
+            std::array < Slot, SlotCount > m_slots;
+        };
+
+        template < typename T >
+        class CompletionAllocator
+        {
+        public:
+            using value_type = T;
+
+            explicit CompletionAllocator(CompletionMemory& memory)
+                : m_memory(&memory)
+            {
+            }
+
+            template < typename U >
+            CompletionAllocator(const CompletionAllocator < U >& other)
+                : m_memory(other.m_memory)
+            {
+            }
+
+            T* allocate(size_t count)
+            {
+                return static_cast < T* > (m_memory->allocate(count * sizeof(T)));
+            }
+
+            void deallocate(T* pointer, size_t)
+            {
+                m_memory->deallocate(pointer);
+            }
+
+            template < typename U >
+            bool operator==(const CompletionAllocator < U >& other) const
+            {
+                return m_memory == other.m_memory;
+            }
+
+            template < typename U >
+            bool operator!=(const CompletionAllocator < U >& other) const
+            {
+                return m_memory != other.m_memory;
+            }
+
+        private:
+            template < typename > friend class CompletionAllocator;
+            CompletionMemory* m_memory;
+        };
+
+        /// Resumes the awaiting coroutine with the result. Posted with memory of the CompletionMemory.
+        template < typename Handler, typename Result >
+        class Completion
+        {
+        public:
+            using allocator_type = CompletionAllocator < void >;
+
+            Completion(Handler&& handler, Result result, CompletionMemory& memory)
+                : m_handler(std::move(handler))
+                , m_result(result)
+                , m_memory(&memory)
+            {
+            }
+
+            allocator_type get_allocator() const
+            {
+                return allocator_type(*m_memory);
+            }
+
+            void operator()()
+            {
+                m_handler(m_result);
+            }
+
+        private:
+            Handler m_handler;
+            Result m_result;
+            CompletionMemory* m_memory;
+        };
+
+        struct PendingRead
+        {
+            SignalReader* signalReader;
+            void* values;
+            uint64_t* timeStamps;
+            size_t count;
+            ReadHandler handler;
+        };
+
+        /// State of a control request, shared with its completion
+        struct ControlState
+        {
+            bool done = false;
+            boost::system::error_code ec;
+            /// The json rpc result of the response
+            nlohmann::json result;
+        };
+
+        boost::asio::awaitable < ControlResult > control(const SignalIds& signalIds, bool subscribe)
+        {
+            auto state = std::make_shared < ControlState > ();
+            auto resultCb = [this, state](const boost::system::error_code& ec, const nlohmann::json& result)
+            {
+                state->done = true;
+                state->ec = ec;
+                state->result = result;
+                completeControl();
+            };
+            if (subscribe) {
+                m_protocolHandler->subscribe(signalIds, resultCb);
+            } else {
+                m_protocolHandler->unsubscribe(signalIds, resultCb);
+            }
+
+            ControlResult controlResult;
+            SignalIds awaitedSignalIds;
+            bool responded = false;
+            while (true) {
+                if (state->ec || m_ended) {
+                    co_return controlResult;
+                }
+                if (state->done && !responded) {
+                    responded = true;
+                    awaitedSignalIds = affectedSignalIds(signalIds, state->result, controlResult.unknownSignalIds);
+                }
+                if (responded && acknowledged(awaitedSignalIds, subscribe)) {
+                    break;
+                }
+                // resumed by completeControl()
+                co_await boost::asio::async_initiate < const boost::asio::use_awaitable_t <>&, void() > ([this](ControlHandler handler)
+                {
+                    m_controlHandlers.emplace_back(std::move(handler));
+                }, boost::asio::use_awaitable);
+            }
+            controlResult.succeeded = true;
+            co_return controlResult;
+        }
+
+        /// \param result The json rpc result of the response. An array of the signal ids affected if the producer tells them.
+        /// \param unknownSignalIds Filled with the signal ids requested but not affected
+        /// \return The signals to be acknowledged
+        SignalIds affectedSignalIds(const SignalIds& signalIds, const nlohmann::json& result, SignalIds& unknownSignalIds) const
+        {
+            SignalIds affected;
+            if (!result.is_array()) {
+                // The producer does not tell. Signals it does not announce are not awaited, there might be no acknowledge for them.
+                for (const std::string& signalId : signalIds) {
+                    if (SignalIdPattern::isPattern(signalId)) {
+                        continue;
+                    }
+                    std::string literalSignalId = SignalIdPattern::unescape(signalId);
+                    if (m_availableSignalIds.count(literalSignalId) > 0) {
+                        affected.push_back(literalSignalId);
+                    }
+                }
+                return affected;
+            }
+
+            std::unordered_set < std::string > affectedSet;
+            for (const nlohmann::json& signalId : result) {
+                if (signalId.is_string()) {
+                    affected.push_back(signalId);
+                    affectedSet.insert(signalId);
+                }
+            }
+            for (const std::string& signalId : signalIds) {
+                if (!SignalIdPattern::isPattern(signalId) && (affectedSet.count(SignalIdPattern::unescape(signalId)) == 0)) {
+                    unknownSignalIds.push_back(signalId);
+                }
+            }
+            return affected;
+        }
+
+        bool acknowledged(const SignalIds& signalIds, bool subscribed) const
+        {
+            for (const std::string& signalId : signalIds) {
+                if ((m_subscribedSignalIds.count(signalId) > 0) != subscribed) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void onStreamMeta(const std::string& method, const nlohmann::json& params)
+        {
+            if ((method != META_METHOD_AVAILABLE) && (method != META_METHOD_UNAVAILABLE)) {
+                return;
+            }
+            auto signalIdsIter = params.find(META_SIGNALIDS);
+            if ((signalIdsIter == params.end()) || !signalIdsIter->is_array()) {
+                return;
+            }
+            for (const nlohmann::json& signalId : *signalIdsIter) {
+                if (!signalId.is_string()) {
+                    continue;
+                }
+                if (method == META_METHOD_AVAILABLE) {
+                    m_availableSignalIds.insert(signalId.get < std::string > ());
+                } else {
+                    m_availableSignalIds.erase(signalId.get < std::string > ());
+                }
+            }
+        }
+
+        /// \return The next packet to be fetched, nullptr if there is none
+        const Packet* takePacket()
+        {
+            if (m_packetCount == 0) {
+                return nullptr;
+            }
+            m_hasCurrentPacket = true;
+            return m_packets[m_packetHead].get();
+        }
+
+        /// Resumes the coroutine waiting in nextPacket() if there is a packet or the session ended.
+        /// To be called while receiving. The coroutine is resumed later on by the io context.
+        void completePacket()
+        {
+            if (!m_packetHandler || ((m_packetCount == 0) && !m_ended)) {
+                return;
+            }
+            boost::asio::post(m_ioc, Completion < PacketHandler, const Packet* > (std::move(*m_packetHandler), takePacket(), m_completionMemory));
+            m_packetHandler.reset();
+        }
+
+        /// Resumes coroutines waiting in nextPacket() or read() directly as long as there are packets or values for them.
+        /// The coroutines drain the queue without returning to the io context in between. This keeps up with receiving, which processes many packages in one go.
+        /// Resumed coroutines await again from within. Their handlers are picked up by the loop here instead of recursing.
+        void resumeDirectly()
+        {
+            if (m_resuming) {
+                return;
+            }
+            m_resuming = true;
+            while (resumePacket() || resumeRead()) {
+            }
+            m_resuming = false;
+        }
+
+        bool resumePacket()
+        {
+            if (!m_packetHandler || ((m_packetCount == 0) && !m_ended)) {
+                return false;
+            }
+            PacketHandler handler(std::move(*m_packetHandler));
+            m_packetHandler.reset();
+            handler(takePacket());
+            return true;
+        }
+
+        bool resumeRead()
+        {
+            for (std::optional < PendingRead >& entry : m_pendingReads) {
+                if (!entry || ((entry->signalReader->available() < entry->count) && !m_ended)) {
+                    continue;
+                }
+                size_t count = entry->signalReader->read(entry->values, entry->timeStamps, entry->count);
+                ReadHandler handler(std::move(entry->handler));
+                entry.reset();
+                // the entries may change while resumed
+                handler(count);
+                return true;
+            }
+            return false;
+        }
+
+        /// Resumes the coroutines waiting in read() that got enough values
+        void completeReads()
+        {
+            for (std::optional < PendingRead >& entry : m_pendingReads) {
+                if (!entry || ((entry->signalReader->available() < entry->count) && !m_ended)) {
+                    continue;
+                }
+                size_t count = entry->signalReader->read(entry->values, entry->timeStamps, entry->count);
+                boost::asio::post(m_ioc, Completion < ReadHandler, size_t > (std::move(entry->handler), count, m_completionMemory));
+                entry.reset();
+            }
+        }
+
+        /// Resumes all coroutines waiting for control requests. They check for themselves whether they are done.
+        void completeControl()
+        {
+            std::vector < ControlHandler > controlHandlers;
+            controlHandlers.swap(m_controlHandlers);
+            for (ControlHandler& handler : controlHandlers) {
+                boost::asio::post(m_ioc, [handler = std::move(handler)]() mutable
+                {
+                    handler();
+                });
+            }
+        }
+
+        /// \return The packet appended to the queue. Packets keep their allocated memory.
+        Packet& pushPacket(PacketType type, SignalNumber signalNumber)
+        {
+            if (m_packetCount == m_packets.size()) {
+                // Packets are moved as pointers. The packet fetched last stays valid.
+                std::vector < std::unique_ptr < Packet > > packets;
+                packets.reserve(m_packets.size() * 2);
+                for (size_t packetIndex = 0; packetIndex < m_packets.size(); ++packetIndex) {
+                    packets.emplace_back(std::move(m_packets[(m_packetHead + packetIndex) & m_packetMask]));
+                }
+                while (packets.size() < packets.capacity()) {
+                    packets.emplace_back(std::make_unique < Packet > ());
+                }
+                m_packets = std::move(packets);
+                m_packetMask = m_packets.size() - 1;
+                m_packetHead = 0;
+            }
+            Packet& packet = *m_packets[(m_packetHead + m_packetCount) & m_packetMask];
+            ++m_packetCount;
+            packet.type = type;
+            packet.signalNumber = signalNumber;
+            return packet;
+        }
+
+        void onSignalMeta(SubscribedSignal& subscribedSignal, const std::string& method, const nlohmann::json& params)
+        {
+            Packet& packet = pushPacket(PACKETTYPE_SIGNAL_META, subscribedSignal.signalNumber());
+            packet.signalId = subscribedSignal.signalId();
+            packet.method = method;
+            packet.params = params;
+            completePacket();
+
+            if (method == META_METHOD_SUBSCRIBE) {
+                m_subscribedSignalIds.insert(subscribedSignal.signalId());
+                completeControl();
+            } else if (method == META_METHOD_UNSUBSCRIBE) {
+                m_subscribedSignalIds.erase(subscribedSignal.signalId());
+                completeControl();
+            }
+        }
+
+        void onData(const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t valueCount)
+        {
+            if (!m_queueData) {
+                return;
+            }
+            size_t valueSize = subscribedSignal.dataValueSize();
+            if (subscribedSignal.ruleType() == RULETYPE_CONSTANT) {
+                valueSize += sizeof(uint64_t);
+            }
+            Packet& packet = pushPacket(PACKETTYPE_DATA, subscribedSignal.signalNumber());
+            packet.signalId = subscribedSignal.signalId();
+            packet.timeStamp = timeStamp;
+            packet.valueCount = valueCount;
+            packet.valueSize = valueSize;
+            packet.data.assign(data, data + valueCount * valueSize);
+            completePacket();
+        }
+
+        boost::asio::io_context& m_ioc;
+        SignalContainer m_signalContainer;
+        StreamReader m_streamReader;
+        std::shared_ptr < ProtocolHandler > m_protocolHandler;
+
+        /// Ring of packets, the size is a power of two. The packet at the head is the one fetched last.
+        std::vector < std::unique_ptr < Packet > > m_packets;
+        size_t m_packetMask;
+        size_t m_packetHead;
+        /// Including the packet fetched last
+        size_t m_packetCount;
+        bool m_hasCurrentPacket;
+
+        /// Awaiting coroutines
+        CompletionMemory m_completionMemory;
+        std::optional < PacketHandler > m_packetHandler;
+        /// Set while resumeDirectly() resumes coroutines
+        bool m_resuming;
+        /// Empty entries are free
+        std::vector < std::optional < PendingRead > > m_pendingReads;
+        std::vector < ControlHandler > m_controlHandlers;
+
+        bool m_queueData;
+        bool m_readingValues;
+        bool m_ended;
+        boost::system::error_code m_sessionEc;
+        /// Signals acknowledged by the producer
+        std::unordered_set < std::string > m_subscribedSignalIds;
+        /// Signals announced by the producer
+        std::unordered_set < std::string > m_availableSignalIds;
+    };
+}
+
+#endif
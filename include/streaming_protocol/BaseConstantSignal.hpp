@@ -26,6 +26,7 @@ class BaseConstantSignal : public BaseValueSignal {
 public:
     BaseConstantSignal(const std::string& signalId, const std::string& tableId, iWriter& writer, const nlohmann::json& defaultStartValue, LogCallback logCb);
 
+    /// \return Number of bytes written, 0 if nothing was written because the signal is not subscribed (see isSubscribed()), -1 on error
     virtual int addData(const void* values, const uint64_t* indices, size_t valuesCount) = 0;
 
     /// Signal meta information describes the signal. It is written once after signal got subscribed.
@@ -49,6 +49,7 @@ namespace daq::streaming_protocol{
         void setTimeStart(uint64_t timeTicks);
         uint64_t getTimeStart() const;
 
+        /// Conversions are exact, see TimeTicks for batch versions
         static uint64_t timeTicksFromNanoseconds(std::chrono::nanoseconds ns, uint64_t m_timeTicksPerSecond);
         static std::chrono::nanoseconds nanosecondsFromTimeTicks(uint64_t timeTicks, uint64_t m_timeTicksPerSecond);
         static uint64_t timeTicksFromTime(const std::chrono::time_point<std::chrono::system_clock> &time, uint64_t m_timeTicksPerSecond);
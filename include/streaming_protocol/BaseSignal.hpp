@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <mutex>
 
@@ -43,10 +44,30 @@ namespace daq::streaming_protocol{
         SignalNumber getNumber() const;
         virtual bool isDataSignal() const = 0;
 
+        /// The consumer calculates time stamps of synchronous signals by counting values. Dropping packets of them shifts all later time stamps of the table.
+        /// \return true if data packets of this signal may be dropped by a send queue (see SendQueue::setDroppable())
+        virtual bool isDroppable() const
+        {
+            return false;
+        }
+
         /// Acknowledge that signal got subscribed and send signal description according to current signal parameters.
+        /// Each call counts as one subscriber.
         virtual void subscribe();
         virtual void unsubscribe();
 
+        /// Data of signals without subscriber is not written. Checking this is cheap, it may be called for each block of data.
+        /// \return true if at least one session subscribed the signal. Producing data for the signal can be skipped otherwise.
+        bool isSubscribed() const
+        {
+            return m_subscriberCount.load(std::memory_order_relaxed) > 0;
+        }
+
+        size_t subscriberCount() const
+        {
+            return m_subscriberCount.load(std::memory_order_relaxed);
+        }
+
         /// Automatically executed once on subscribe().
         /// \todo when having incremental changes this is not necessary:
         /// To be called upon change of signal description.
@@ -69,6 +90,9 @@ namespace daq::streaming_protocol{
         iWriter& m_writer;
         LogCallback logCallback;
 
+        /// Changed by subscribe() and unsubscribe(), read by the thread producing data
+        std::atomic < size_t > m_subscriberCount;
+
         static SignalNumber s_signalNumberCounter;
         static std::mutex s_signalNumberMtx;
     };
@@ -26,6 +26,8 @@ namespace daq::streaming_protocol{
     public:
         BaseSynchronousSignal(const std::string& signalId, const std::string& tableId, iWriter &writer, LogCallback logCb, std::uint64_t valueIndex);
 
+        /// The value index advances even if the signal is not subscribed
+        /// \return Number of bytes written, 0 if nothing was written because the signal is not subscribed (see isSubscribed()), -1 on error
         virtual int addData(const void* data, size_t sampleCount) = 0;
 
         uint64_t getValueIndex()
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "SubscribedSignal.hpp"
+#include "Table.hpp"
+#include "Types.h"
+#include "streaming_protocol/Logging.hpp"
+
+namespace daq::streaming_protocol {
+    class MetaInformation;
+
+    /// \note The same callback method is called for all meta information related to any signal. The provided parameter subscribedSignal gives information about the actual signal the meta onformation belong to!
+    /// \param subscribedSignal Carries lots of usefull information about the signal the data is coming from. (i.e. signal number and signal id). It also carries signal number and signal id to identify the signal.
+    using SignalMetaCb = std::function<void(SubscribedSignal& subscribedSignal, const std::string& method, const nlohmann::json& params)>;
+
+    /// Handler of a BasicSignalContainer that does nothing.
+    /// Derive from this and hide the methods of interest.
+    struct NopSignalHandler : public NopDataHandler
+    {
+        void signalMeta(SubscribedSignal&, const std::string&, const nlohmann::json&)
+        {
+        }
+
+        /// Hide this as well when hiding signalMeta(). Otherwise the json of the meta information is not built and signalMeta() is not called.
+        bool wantsSignalMeta() const
+        {
+            return false;
+        }
+    };
+
+    /// Keeps all subscribed signals and tables and interpretes the signal related meta information.
+    /// Measured data is processed by BasicSignalContainer.
+    class SignalContainerBase {
+    public:
+        explicit SignalContainerBase(LogCallback logCb);
+        SignalContainerBase(const SignalContainerBase& op) = delete;
+        SignalContainerBase& operator=(const SignalContainerBase& op) = delete;
+
+        /// \return true if there is no subscribed signal
+        bool empty() const
+        {
+            return m_subscribedSignals.empty();
+        }
+
+        /// Removes the signal without unsubscribing it, its state is kept. Used to hand a signal over to another container.
+        /// \return nullptr if the signal number is not subscribed
+        std::shared_ptr < SubscribedSignal > releaseSignal(SignalNumber signalNumber);
+
+        /// Adds a signal released by another container. It joins its table, no meta information callback is called.
+        /// \return -1 if the signal number is already subscribed
+        int adoptSignal(std::shared_ptr < SubscribedSignal > signal);
+
+    protected:
+        ~SignalContainerBase() = default;
+
+        /// Everything needed to process measured data of a signal, resolved in advance.
+        struct Route
+        {
+            /// nullptr if the signal number is not subscribed
+            SubscribedSignal* signal = nullptr;
+            /// data signals only: time signal of the table, empty if not known yet
+            std::shared_ptr < SubscribedSignal > timeSignal;
+            /// data signals only: signal belongs to a table
+            bool hasTable = false;
+            /// time signals only: the table has data signals
+            bool hasDataSignals = false;
+        };
+
+        /// new subscribed signals are added with arrival of subscribe acknowledge
+        /// \param signalMetaCb Called after the meta information was processed. If empty, no json document is built from the meta information.
+        int processMetaInformation(SignalNumber signalNumber, const MetaInformation& metaInformation, const SignalMetaCb& signalMetaCb);
+
+        /// \return nullptr if the signal number is not subscribed
+        const Route* route(SignalNumber signalNumber) const
+        {
+            if (signalNumber < m_routes.size()) {
+                const Route& route = m_routes[signalNumber];
+                return (route.signal == nullptr) ? nullptr : &route;
+            }
+            if ((signalNumber < s_indexedRouteCount) || m_sparseRoutes.empty()) {
+                return nullptr;
+            }
+            const auto routeIter = m_sparseRoutes.find(signalNumber);
+            if (routeIter == m_sparseRoutes.end()) {
+                return nullptr;
+            }
+            return &routeIter->second;
+        }
+
+        LogCallback logCallback;
+
+    private:
+        /// Signal number is the key
+        using Signals = std::unordered_map < SignalNumber, std::shared_ptr < SubscribedSignal > >;
+
+        /// Table id is the key
+        using Tables = std::unordered_map < std::string, Table >;
+
+        /// signal number of the status signal is the key, signal id id of the datat signal is the value
+        using StatusSources = std::unordered_map < SignalNumber, std::string >;
+
+        /// Signal number is the index. Covers all signal numbers up to the highest subscribed one below s_indexedRouteCount.
+        using Routes = std::vector < Route >;
+
+        /// Signal number is the key. Routes of signal numbers from s_indexedRouteCount on.
+        using SparseRoutes = std::unordered_map < SignalNumber, Route >;
+
+        /// Signal numbers from here on are not used as index. A single large signal number does not allocate a huge vector.
+        static constexpr SignalNumber s_indexedRouteCount = 4096;
+
+        /// Resolves the route of a signal. Removes the route if the signal is not subscribed.
+        void updateRoute(SignalNumber signalNumber);
+
+        /// Resolves the routes of the time signal and all data signals of a table.
+        void updateTableRoutes(const std::string& tableId);
+
+        /// Removes a signal from a table. A table without any signal is removed.
+        void leaveTable(SignalNumber signalNumber, const std::string& tableId);
+
+        /// processes measured data and keeps meta information about all subscribed signals
+        Signals m_subscribedSignals;
+        Tables m_tables;
+        StatusSources m_statusSources;
+        /// Used when processing measured data instead of m_subscribedSignals and m_tables
+        Routes m_routes;
+        SparseRoutes m_sparseRoutes;
+    };
+
+    /// \addtogroup consumer
+    /// Signal container with the callbacks known at compile time.
+    /// -It contains all subscribed signals.
+    /// -It interpretes all signal related meta information
+    /// -Meta information and measured data are delivered to the handler. Its methods are called directly and may be inlined.
+    /// Use SignalContainer to register callbacks at runtime instead.
+    /// \tparam Handler Provides the methods of NopSignalHandler
+    template < typename Handler >
+    class BasicSignalContainer : public SignalContainerBase {
+    public:
+        explicit BasicSignalContainer(LogCallback logCb, Handler handler = Handler())
+            : SignalContainerBase(logCb)
+            , m_handler(std::move(handler))
+        {
+        }
+
+        Handler& handler()
+        {
+            return m_handler;
+        }
+
+        const Handler& handler() const
+        {
+            return m_handler;
+        }
+
+        /// new subscribed signals are added with arrival of subscribe acknowledge
+        int processMetaInformation(SignalNumber signalNumber, const MetaInformation& metaInformation)
+        {
+            if (!m_handler.wantsSignalMeta()) {
+                return SignalContainerBase::processMetaInformation(signalNumber, metaInformation, SignalMetaCb());
+            }
+            auto signalMetaCb = [this](SubscribedSignal& subscribedSignal, const std::string& method, const nlohmann::json& params)
+            {
+                m_handler.signalMeta(subscribedSignal, method, params);
+            };
+            return SignalContainerBase::processMetaInformation(signalNumber, metaInformation, signalMetaCb);
+        }
+
+        /// \param data Data to process
+        /// \param len Number of bytes to process
+        /// \return number of bytes processed or -1 if signal is unknown.
+        /// \note We require to be called with complete values only!
+        ssize_t processMeasuredData(SignalNumber signalNumber, const unsigned char* data, size_t len);
+
+    private:
+        Handler m_handler;
+    };
+
+    template < typename Handler >
+    ssize_t BasicSignalContainer < Handler >::processMeasuredData(SignalNumber signalNumber, const unsigned char* data, size_t len)
+    {
+        const Route* route = this->route(signalNumber);
+        if (route == nullptr) {
+            STREAMING_PROTOCOL_LOG_W("Got data for signal '{}', that has not been yet reported as subscribed by server", signalNumber);
+            return -1;
+        }
+
+        SubscribedSignal* signal = route->signal;
+        if(signal->isTimeSignal()) {
+            RuleType ruleType = signal->ruleType();
+            // time is relevant only if there are data signals in the table
+            if (ruleType == RULETYPE_EXPLICIT) {
+                // for explicit time rule, there is no value index
+                if (route->hasDataSignals) {
+                    uint64_t timeStamp;
+                    memcpy(&timeStamp, data, sizeof(timeStamp));
+                    signal->setTime(timeStamp);
+                }
+                signal->processMeasuredData(data, len, nullptr, m_handler);
+            } else {
+                // for implicit time rule:
+                // 1st 64 bit are value index, followed by 64 bit timestamp
+                if (route->hasDataSignals) {
+                    IndexedValue<uint64_t> indexedTimeStamp;
+                    memcpy(&indexedTimeStamp, data, sizeof(indexedTimeStamp));
+                    signal->setTime(indexedTimeStamp.value);
+                    signal->setTimeIndex(indexedTimeStamp.index);
+                }
+            }
+        } else {
+            if (route->hasTable) {
+                if (!route->timeSignal) {
+                    STREAMING_PROTOCOL_LOG_W("The time signal isn't yet known for value signal id '{}', number {}, table '{}'!",
+                                             signal->signalId(),
+                                             signalNumber,
+                                             signal->tableId());
+                    return -1;
+                }
+                return signal->processMeasuredData(data, len, route->timeSignal.get(), m_handler);
+            }
+        }
+        return (ssize_t) len;
+    }
+}
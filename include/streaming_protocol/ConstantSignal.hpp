@@ -46,6 +46,9 @@ public:
 
     int addData(const void* values, const uint64_t* indices, size_t valuesCount) override
     {
+        if (!isSubscribed()) {
+            return 0;
+        }
         size_t entrySize = sizeof(IndexedValue<DataType>);
         size_t dataSize = valuesCount * entrySize;
         uint8_t* signalData = static_cast<uint8_t*>(std::malloc(dataSize));
@@ -20,6 +20,8 @@
 
 #include <boost/asio/io_context.hpp>
 
+#include "nlohmann/json.hpp"
+
 #include "streaming_protocol/Logging.hpp"
 #include "streaming_protocol/Types.h"
 
@@ -32,6 +34,8 @@ class ControlServer
 public:
     /// \addtogroup producer
     /// This class is used by producer to run the control service for subscribing/unsubscribing signals
+    /// Besides single json rpc requests, json rpc 2.0 batches (arrays of requests) are accepted. The requests of a batch are executed in one pass
+    /// and answered with one array of json rpc responses in the same order.
 
     /// Executes subscribe/unsubscribe command
     /// \param streamId A unique ID identifying the stream instance
@@ -46,7 +50,59 @@ public:
         std::string& errorMessage
     ) >;
 
+    /// Executes subscribe/unsubscribe command and tells the signals affected.
+    /// Signal ids might be patterns matching several signals (see SignalIdPattern and ProducerSession::resolveSignalIds()).
+    /// \param resolvedSignalIds Filled with the ids of the signals subscribed/unsubscribed. They are responded to the client as result.
+    using ResolvingCommandCb = std::function < int (
+        const std::string& streamId,
+        const std::string& command,
+        const SignalIds& signalIds,
+        SignalIds& resolvedSignalIds,
+        std::string& errorMessage
+    ) >;
+
+    /// Completes a command started by AsyncCommandCb. To be called exactly once, might be called from any thread.
+    /// \param status negative status code if command failed or '0' if command succeeded
+    /// \param resolvedSignalIds The ids of the signals subscribed/unsubscribed. They are responded to the client as result.
+    /// \param errorMessage Error message to be responded to client if command failed
+    using CompletionCb = std::function < void (
+        int status,
+        const SignalIds& resolvedSignalIds,
+        const std::string& errorMessage
+    ) >;
+
+    /// Starts subscribe/unsubscribe command and returns without waiting for it to finish.
+    /// The HTTP response is sent when completionCb is called. Until then, further requests are accepted, many requests might be outstanding at once.
+    /// Responses to requests sent over the same connection are sent in the order of the requests.
+    /// \note completionCb has to be called before the io_context of the server is destroyed.
+    using AsyncCommandCb = std::function < void (
+        const std::string& streamId,
+        const std::string& command,
+        const SignalIds& signalIds,
+        CompletionCb completionCb
+    ) >;
+
+    /// Used internally: Completes a command with its json rpc result
+    using ExecuteCompletionCb = std::function < void (
+        int status,
+        const nlohmann::json& result,
+        const std::string& errorMessage
+    ) >;
+
+    /// Used internally: Starts the command, completionCb is called with the json rpc result
+    using ExecuteCb = std::function < void (
+        const std::string& streamId,
+        const std::string& command,
+        const SignalIds& signalIds,
+        ExecuteCompletionCb completionCb
+    ) >;
+
+    /// Responds "Succeeded" as result of successful commands
     ControlServer(boost::asio::io_context& ioc, uint16_t port, CommandCb commandCb, LogCallback logCb);
+    /// Responds the resolved signal ids as result of successful commands
+    ControlServer(boost::asio::io_context& ioc, uint16_t port, ResolvingCommandCb commandCb, LogCallback logCb);
+    /// Responds the resolved signal ids as result of successful commands once they completed
+    ControlServer(boost::asio::io_context& ioc, uint16_t port, AsyncCommandCb commandCb, LogCallback logCb);
     ~ControlServer();
 
     /// Starts control HTTP server on port
@@ -60,7 +116,7 @@ private:
     std::shared_ptr<listener> m_listener_v4;
     std::shared_ptr<listener> m_listener_v6;
     uint16_t m_port;
-    CommandCb m_commandCb;
+    ExecuteCb m_executeCb;
     LogCallback logCallback;
 };
 
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/SubscribedSignal.hpp"
+#include "streaming_protocol/Types.h"
+
+namespace daq::streaming_protocol {
+    /// Values of a signal handed over by the DeliveryStage. Only valid during the call.
+    struct DeliveredData
+    {
+        SignalNumber signalNumber = 0;
+        std::string signalId;
+        SampleType sampleType = SAMPLETYPE_UNKNOWN;
+        /// Bytes per value. Values of constant rule signals are preceded by their value index (see IndexedValue).
+        size_t valueSize = 0;
+        size_t valueCount = 0;
+        /// One time stamp per value
+        std::vector < uint64_t > timeStamps;
+        std::vector < uint8_t > data;
+    };
+
+    /// Snapshot of the state of a DeliveryStage
+    struct DeliveryMetrics
+    {
+        /// Packages published but not delivered yet
+        size_t queueDepth;
+        /// Highest queue depth so far
+        size_t maxQueueDepth;
+        uint64_t publishedCount;
+        uint64_t deliveredCount;
+        /// Packages dropped by OVERFLOWPOLICY_DROP_OLDEST or because the stage is closed
+        uint64_t droppedCount;
+        /// Number of times the reader had to wait for a free buffer
+        uint64_t blockedCount;
+        bool closed;
+    };
+
+    /// \addtogroup consumer
+    /// Hands decoded data over from the io context thread to application threads, so that slow callbacks do not stall reading from the socket.
+    /// -publish() is called from the DataAsTimestampedValuesCb of the SignalContainer. It copies values and time stamps into a pooled buffer
+    ///  and puts it into a lock-free ring. There is no allocation once the buffers have grown to their working size.
+    /// -Signals are distributed over lanes by their signal number. Each lane is drained by one thread at a time, hence the order of each signal is preserved.
+    ///  Different lanes may be drained concurrently.
+    /// -Lanes are drained by tasks handed to the executor, or by calling poll() if there is no executor.
+    /// -If all buffers of a lane are in use, the overflow policy decides.
+    class DeliveryStage
+    {
+    public:
+        enum OverflowPolicy {
+            /// The reader waits for a free buffer. The device buffers in the meantime.
+            OVERFLOWPOLICY_BLOCK,
+            /// The oldest package not being delivered yet is dropped
+            OVERFLOWPOLICY_DROP_OLDEST,
+            /// The stage is closed: The closed callback is called and all packages published afterwards are dropped.
+            OVERFLOWPOLICY_CLOSE
+        };
+
+        /// Runs task on an application thread
+        using Executor = std::function<void(std::function<void()> task)>;
+        /// \param data Only valid during the call
+        using DeliveredDataCb = std::function<void(const DeliveredData& data)>;
+        /// Called by the reader when the stage gets closed by OVERFLOWPOLICY_CLOSE. Use it to close the connection.
+        using ClosedCb = std::function<void()>;
+
+        /// \param laneCount At least 1
+        /// \param laneCapacity Number of buffers of each lane, at least 1
+        /// \param executor Empty to have the lanes drained by poll()
+        /// \warning With OVERFLOWPOLICY_BLOCK, the reader waits for the lanes being drained. Do not drain on the io context thread!
+        DeliveryStage(size_t laneCount, size_t laneCapacity, OverflowPolicy overflowPolicy, DeliveredDataCb cb, Executor executor, LogCallback logCb);
+        /// Waits until all tasks handed to the executor are done. The executor has to keep running until then.
+        /// A task handed to the executor delivers all packages of its lane before it is done. Without executor, packages not polled yet are discarded.
+        ~DeliveryStage();
+
+        DeliveryStage(const DeliveryStage&) = delete;
+        DeliveryStage& operator=(const DeliveryStage&) = delete;
+
+        /// \warning set before publishing
+        void setClosedCb(ClosedCb cb);
+
+        /// To be called by the reader only. Signature matches DataAsTimestampedValuesCb.
+        /// \return 0 on success, -1 if the package was dropped because the stage is closed
+        int publish(const SubscribedSignal& subscribedSignal, const uint64_t* timeStamps, const uint8_t* data, size_t valueCount);
+
+        /// Drains all lanes in the calling thread. To be used if there is no executor.
+        /// \return Number of packages delivered
+        size_t poll();
+
+        /// May be called from any thread
+        DeliveryMetrics metrics() const;
+
+        bool closed() const
+        {
+            return m_closed.load(std::memory_order_acquire);
+        }
+
+    private:
+        class Lane;
+
+        /// Hands the draining of the lane to the executor if not done already
+        void schedule(Lane& lane);
+        /// The task handed to the executor
+        void drain(Lane& lane);
+        /// Delivers all packages published in the lane
+        size_t deliver(Lane& lane);
+        /// \return A free buffer of the lane, applies the overflow policy if there is none. nullptr if the package is to be dropped.
+        DeliveredData* freeBuffer(Lane& lane);
+
+        std::vector < std::unique_ptr < Lane > > m_lanes;
+        OverflowPolicy m_overflowPolicy;
+        DeliveredDataCb m_cb;
+        Executor m_executor;
+        ClosedCb m_closedCb;
+        LogCallback logCallback;
+
+        std::atomic < bool > m_closed;
+        /// Tasks handed to the executor and not finished yet
+        std::atomic < size_t > m_activeTasks;
+
+        std::atomic < size_t > m_queueDepth;
+        std::atomic < size_t > m_maxQueueDepth;
+        std::atomic < uint64_t > m_publishedCount;
+        std::atomic < uint64_t > m_deliveredCount;
+        std::atomic < uint64_t > m_droppedCount;
+        std::atomic < uint64_t > m_blockedCount;
+    };
+}
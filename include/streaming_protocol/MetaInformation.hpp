@@ -18,15 +18,23 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "nlohmann/json.hpp"
 #include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/MsgpackView.hpp"
+#include "streaming_protocol/Vocabulary.hpp"
 
 namespace daq::streaming_protocol {
     /// \addtogroup consumer
     /// several types of meta information may be defined.
     /// -Type 2 means any meta data encoded using MessagePack (Used in openDAQ streaming protocol.
     /// Content of the meta information can be retrieved as structured document or in binary form depending on the type.
+    ///
+    /// The MessagePack payload is validated and kept as it is. No json document is built unless params() or jsonContent() is called.
+    /// Use content() and paramsView() to look up single values without building a document.
     class MetaInformation
     {
     public:
@@ -37,8 +45,20 @@ namespace daq::streaming_protocol {
 
         int interpret(const uint8_t* data, size_t size);
         std::string method() const;
+
+        /// \return The method as enum, METHODTYPE_UNKNOWN for methods not listed in MethodType. Determined once by interpret().
+        MethodType methodType() const;
+
+        /// Builds a json document from the parameters. Prefer paramsView() if single values are of interest only.
         nlohmann::json params() const;
 
+        /// \return The parameters without building a json document. Invalid view if there are no parameters.
+        MsgpackView paramsView() const;
+
+        /// \return The complete MessagePack content. Invalid view if the meta information is not of type MessagePack.
+        /// \warning The view refers to data owned by this object. It gets invalid with the next call of interpret().
+        MsgpackView content() const;
+
         /// \return meta data as structured data; empty if data could not be parsed
         /// \code
         /// {
@@ -46,14 +66,26 @@ namespace daq::streaming_protocol {
         ///   ”params”: < value >
         /// }
         /// \endcode
+        /// \note The document is built on first request.
         const nlohmann::json& jsonContent() const;
 
         /// \return the meta information type
         uint32_t type() const;
 
     private:
+        using ContainerRange = std::pair < MsgpackView::const_iterator, MsgpackView::const_iterator >;
+
+        /// \return false if a map within the value, nested ones included, has a key that is no string
+        bool hasStringKeysOnly(const MsgpackView& value);
+
         uint32_t m_metaInformationType;
-        nlohmann::json m_jsonContent;
+        MethodType m_methodType;
+        /// MessagePack encoded content, capacity is kept for the next interpret().
+        std::vector < uint8_t > m_msgpack;
+        mutable nlohmann::json m_jsonContent;
+        mutable bool m_jsonContentBuilt;
+        /// Nested arrays and maps still to be checked by hasStringKeysOnly(), capacity is kept for the next interpret().
+        std::vector < ContainerRange > m_containers;
         LogCallback logCallback;
     };
 }
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+#include "nlohmann/json.hpp"
+
+namespace daq::streaming_protocol {
+    /// \addtogroup consumer
+    /// Read-only view on a MessagePack encoded value. Nothing is copied or decoded in advance.
+    /// -Lookups (find(), iteration, asStringView()) walk the encoded data directly.
+    /// -A json document is built only if explicitly requested by toJson().
+    /// \warning The view does not own the data. The data has to outlive the view.
+    class MsgpackView
+    {
+    public:
+        enum Type {
+            MSGPACKTYPE_INVALID,
+            MSGPACKTYPE_NIL,
+            MSGPACKTYPE_BOOL,
+            MSGPACKTYPE_UNSIGNED,
+            MSGPACKTYPE_SIGNED,
+            MSGPACKTYPE_FLOAT,
+            MSGPACKTYPE_STRING,
+            MSGPACKTYPE_BINARY,
+            MSGPACKTYPE_ARRAY,
+            MSGPACKTYPE_MAP,
+            MSGPACKTYPE_EXTENSION
+        };
+
+        /// Iterates over the elements of an array or the members of a map
+        class const_iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = MsgpackView;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const MsgpackView*;
+            using reference = MsgpackView;
+
+            const_iterator();
+
+            /// \return the array element or the value of the map member
+            MsgpackView operator*() const;
+            /// \return the key of the map member, invalid view for arrays
+            MsgpackView key() const;
+            /// same as operator*
+            MsgpackView value() const;
+
+            const_iterator& operator++();
+            bool operator==(const const_iterator& other) const;
+            bool operator!=(const const_iterator& other) const;
+
+        private:
+            friend class MsgpackView;
+            const_iterator(const uint8_t* position, const uint8_t* end, uint64_t remaining, bool isMap);
+            /// determines the element (and key) at the current position
+            void resolve();
+
+            const uint8_t* m_position;
+            const uint8_t* m_end;
+            uint64_t m_remaining;
+            bool m_isMap;
+            /// nullptr for arrays
+            const uint8_t* m_keyBegin;
+            const uint8_t* m_valueBegin;
+            const uint8_t* m_valueEnd;
+        };
+
+        /// Creates an invalid view
+        MsgpackView();
+
+        /// Validates the complete value at the start of the buffer. The view is invalid if the data does not start with a complete MessagePack value.
+        /// Trailing data after the value is not part of the view (see size()).
+        MsgpackView(const uint8_t* data, size_t size);
+
+        /// Creates a view without validation.
+        /// \warning data has to contain exactly one complete value that was validated before.
+        static MsgpackView unchecked(const uint8_t* data, size_t size);
+
+        bool valid() const;
+        Type type() const;
+
+        /// \return Start of the encoded value
+        const uint8_t* data() const;
+        /// \return Number of bytes of the encoded value
+        size_t size() const;
+
+        /// \return number of elements of an array or members of a map, 0 for all other types
+        uint64_t count() const;
+
+        /// Iteration over array elements or map members. Empty range for all other types.
+        const_iterator begin() const;
+        const_iterator end() const;
+
+        /// \return the value of the map member with the given key, invalid view if there is no such member or this is no map
+        MsgpackView find(std::string_view key) const;
+
+        /// \return the string, empty if this is no string. Points to the encoded data, nothing is copied.
+        std::string_view asStringView() const;
+        /// \return the value of unsigned and non-negative signed integers, 0 otherwise
+        uint64_t asUnsigned() const;
+        /// \return the value of signed and unsigned integers, 0 otherwise
+        int64_t asSigned() const;
+        /// \return the value of floats and integers, 0.0 otherwise
+        double asDouble() const;
+        /// \return the value of a bool, false otherwise
+        bool asBool() const;
+
+        /// Builds a json document from the value. Meant to be used only if a structured document is really required.
+        /// \return the json document, null if the view is invalid
+        nlohmann::json toJson() const;
+
+    private:
+        static MsgpackView range(const uint8_t* begin, const uint8_t* end);
+
+        const uint8_t* m_begin;
+        const uint8_t* m_end;
+    };
+}
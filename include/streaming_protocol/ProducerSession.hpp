@@ -16,13 +16,20 @@
 
 #pragma once
 
+#include <chrono>
 #include <map>
+#include <memory>
+#include <unordered_set>
+
+#include <boost/asio/steady_timer.hpp>
 
 #include "nlohmann/json.hpp"
 
 #include "stream/Stream.hpp"
 
 #include "streaming_protocol/BaseSignal.hpp"
+#include "streaming_protocol/SendQueue.hpp"
+#include "streaming_protocol/SignalHub.hpp"
 #include "streaming_protocol/StreamWriter.h"
 #include "streaming_protocol/Logging.hpp"
 
@@ -39,6 +46,8 @@ namespace daq::streaming_protocol {
         using Signals = std::map < std::string, std::shared_ptr < BaseSignal>>;
         using ErrorCb = std::function < void (const boost::system::error_code&) >;
 
+        static constexpr std::chrono::milliseconds DEFAULT_ALIVE_INTERVAL = std::chrono::milliseconds(1000);
+
         /// \param stream used for writing meta information or data
         /// \param commandInterfaces information telling how to connect to control service may be empty
         /// for subscribing/unsubscribing signals
@@ -49,18 +58,42 @@ namespace daq::streaming_protocol {
         ///     "httpPath": "controlUrlPath",
         ///     "httpVersion": "1.0",
         ///     "port": "http"
-        ///   }
+        ///   },
+        ///   "jsonrpc-inband": {}
         /// }
         /// \endcode
+        /// With "jsonrpc-inband" (COMMANDINTERFACE_JSONRPC_INBAND), json rpc requests received over the stream are executed:
+        /// \code
+        /// { "jsonrpc": "2.0", "method": "subscribe", "params": ["signal id", "signal id pattern"], "id": 1 }
+        /// \endcode
+        /// Methods are "subscribe" and "unsubscribe". The response carries the ids of the signals affected as result.
+        /// It is written after the subscribe/unsubscribe acknowledges of the signals.
         ProducerSession(std::shared_ptr<daq::stream::Stream> stream, const nlohmann::json& commandInterfaces,
                         LogCallback logCb);
+        /// Meta information is written asynchronously via the send queue (see SendQueue).
+        /// Signals of the session are to write with a StreamWriter sharing the queue.
+        /// The capacity and overflow policy of the queue bound the memory held for a slow client.
+        /// Signals added tell the queue whether their data may be dropped (see BaseSignal::isDroppable()).
+        ProducerSession(std::shared_ptr<SendQueue> sendQueue, const nlohmann::json& commandInterfaces,
+                        LogCallback logCb);
         ~ProducerSession() = default;
 
-        /// Starts reading from stream, data received will be consumed and thrown away.
+        /// Starts reading from stream. Data received will be consumed and thrown away unless in-band requests are accepted.
         /// On error stream is being reset and errorCb is called.
         void start(ErrorCb errorCb);
         void stop();
 
+        /// With a send queue, "alive" meta information carrying the fill level of the queue is written periodically once started.
+        /// \param interval 0 disables, default is DEFAULT_ALIVE_INTERVAL
+        /// \note To be called before start()
+        void setAliveInterval(std::chrono::milliseconds interval);
+
+        /// Signals written via the hub are shared with other sessions. Subscribing and unsubscribing is done via the hub.
+        /// The session unsubscribes its signals and leaves the hub when stopped or on error.
+        /// \note Requires a send queue, to be called before subscribing signals
+        /// \return -1 without send queue
+        int setSignalHub(std::shared_ptr<SignalHub> signalHub);
+
         /// Add a reference to signal to the session
         /// If it is a data signal, "Available" meta information is send for this signal id.
         /// subscribeSignals() has to be called afterwards to tell that the signal 
@@ -84,12 +117,19 @@ namespace daq::streaming_protocol {
 
         /// Tell that streaming starts for mentioned signals.
         /// Data is send by calling addData() of the actual signal.
+        /// The session counts once as subscriber of a signal, signals already subscribed by the session are not subscribed again.
+        /// \param signalIds Signal ids or patterns (see SignalIdPattern) matching several signals
         /// \return number of signals succesfully subscribed
         size_t subscribeSignals(const SignalIds& signalIds);
 
         /// Tell that streaming stops for mentioned signals.
+        /// \param signalIds Signal ids or patterns (see SignalIdPattern) matching several signals
         /// \return number of signals succesfully unsubscribed
         size_t unsubscribeSignals(const SignalIds& signalIds);
+
+        /// \param signalIds Signal ids or patterns (see SignalIdPattern) matching several signals
+        /// \return The ids of all signals of this session being mentioned or matched by a pattern
+        SignalIds resolveSignalIds(const SignalIds& signalIds) const;
     private:
         /// Writes stream version (META_METHOD_APIVERSION)
         /// \note This has to happen at the very beginning of the session!
@@ -102,16 +142,44 @@ namespace daq::streaming_protocol {
         void writeAvailableMetaInformation(const SignalIds &signalIds);
         void writeUnavailableMetaInformation(const SignalIds &signalIds);
 
+        /// Calls function for each signal mentioned or matched by a pattern
+        template < typename Function >
+        void forEachSignal(const SignalIds& signalIds, Function function) const;
+
         void doRead();
         void onRead(const boost::system::error_code& ec, std::size_t bytesRead);
 
+        /// Processes all complete packages received and consumes them
+        /// \return -1 on protocol error
+        int processReceived();
+        /// Executes an in-band json rpc request and writes the response
+        /// \param data Meta information payload, meta information type followed by the MessagePack encoded request
+        void executeRequest(const uint8_t* data, size_t size);
+
+        void doAlive();
+        /// Writes META_METHOD_ALIVE with the fill level of the send queue
+        /// \return -1 if the stream failed
+        int writeAliveMetaInformation();
+
+        void leaveSignalHub();
+
         void doClose();
         void onClose(const boost::system::error_code& ec);
 
         std::shared_ptr<daq::stream::Stream> m_stream;
         StreamWriter m_writer;
+        /// nullptr when writing synchronously
+        std::shared_ptr<SendQueue> m_sendQueue;
+        std::chrono::milliseconds m_aliveInterval;
+        /// Only with a send queue, runs with the io context of the queue
+        std::unique_ptr<boost::asio::steady_timer> m_aliveTimer;
+        std::shared_ptr<SignalHub> m_signalHub;
         Signals m_allSignals;
+        /// Signals subscribed by this session, used without signal hub only
+        std::unordered_set < std::string > m_subscribedSignalIds;
         ErrorCb m_errorCb;
+        /// In-band json rpc requests are accepted
+        bool m_inBandControl;
         LogCallback logCallback;
     };
 }
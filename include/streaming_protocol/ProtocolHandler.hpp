@@ -16,9 +16,14 @@
 
 #pragma once
 
+#include <chrono>
+#include <deque>
+#include <map>
 #include <memory>
+#include <vector>
 
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
 
 #include "MetaInformation.hpp"
 #include "stream/Stream.hpp"
@@ -28,6 +33,17 @@
 #include "streaming_protocol/Logging.hpp"
 
 namespace daq::streaming_protocol {
+    class Controller;
+
+    /// How the consumer reads packages from the stream
+    enum ReceiveMode {
+        /// Header, additional length and payload of each package are requested with separate reads.
+        RECEIVEMODE_PER_PACKAGE,
+        /// Reads as much as available into the stream buffer and processes all complete packages in one go.
+        /// Returns to the io context only if the buffer holds an incomplete package.
+        RECEIVEMODE_BATCHED
+    };
+
     /// \addtogroup consumer
     /// \todo Might be renamed to ConsumerSession"
     /// This class represents the streaming protocol consumer
@@ -39,11 +55,24 @@ namespace daq::streaming_protocol {
     {
     public:
         /// callback function for stream related meta information. This also includes notification about signals getting available or becoming unavailable.
+        /// The parameters are decoded into a json document only if a callback is set.
         using StreamMetaCb = std::function<void(ProtocolHandler& prtotocolHandler, const std::string& method, const nlohmann::json& params)>;
         using CompletionCb = std::function<void(const boost::system::error_code& ec)>;
+        /// Completes a control request
+        /// \param result The json rpc result of the response. The ids of the signals affected if the producer tells them, null on error.
+        using ControlResultCb = std::function<void(const boost::system::error_code& ec, const nlohmann::json& result)>;
 
         ProtocolHandler(boost::asio::io_context& ioc, SignalContainer& signalContainer, StreamMetaCb streamMetaCb, LogCallback logCb);
+        ~ProtocolHandler();
+
+        /// \warning set receive mode before calling start()
+        void setReceiveMode(ReceiveMode receiveMode);
+        ReceiveMode receiveMode() const;
+
         /// after initializing the provided stream, the protocol is being received and processed until end of session or error.
+        /// Once the session is running, receiving and processing signal data does not allocate memory.
+        /// In RECEIVEMODE_BATCHED, one read covers all packages that arrived in the meantime.
+        /// In receive mode RECEIVEMODE_PER_PACKAGE:
         ///
         /// ----------------     ---------------     --------------------------     ----------------
         /// |              |     |             |     |                        |     |              |
@@ -57,6 +86,17 @@ namespace daq::streaming_protocol {
         ///                   -----------------------------------<------------------------------------
         ///                                                next package
         ///
+        /// In receive mode RECEIVEMODE_BATCHED:
+        ///
+        /// ----------------     ------------------     ----------------------------
+        /// |              |     |                |     |                          |
+        /// | init stream  |---->| read available |---->| process all complete     |---
+        /// |              |  |  | data           |     | packages in buffer       |  |
+        /// ----------------  |  ------------------     ----------------------------  |
+        ///                   |                                                       |
+        ///                   ---------------------------<-----------------------------
+        ///                                  remaining package incomplete
+        ///
         /// \param stream Data stream to consume data from. It delivers meta information and signal data
         void start(std::unique_ptr < daq::stream::Stream > stream, CompletionCb completionCb=CompletionCb());
 
@@ -65,9 +105,41 @@ namespace daq::streaming_protocol {
 
         void stop();
 
-        void subscribe(const SignalIds& signalIds);
-        void unsubscribe(const SignalIds& signalIds);
+        /// Control requests are sent over one keep-alive connection per session.
+        /// May be called from outside the io context.
+        /// Calls made within the merge window are merged into one request. 0 by default: Calls made before returning to the io context are merged.
+        void setControlMergeWindow(std::chrono::microseconds mergeWindow);
+
+        /// Sends the control request. Each signal is acknowledged by its meta information "subscribe" or "unsubscribe" afterwards.
+        /// If the producer accepts in-band requests (StreamMeta::inBandControl()), requests are sent over the stream instead of a separate control connection.
+        /// The completion callback is called after the acknowledges then.
+        /// May be called from outside the io context, the request is dispatched to the io context.
+        /// \param completionCb Optional, called with the result of the control request
+        void subscribe(const SignalIds& signalIds, CompletionCb completionCb=CompletionCb());
+        void unsubscribe(const SignalIds& signalIds, CompletionCb completionCb=CompletionCb());
+        /// As above, the result of the response is handed over as well. It tells the signals the producer subscribed or unsubscribed.
+        /// Requests merged within the merge window share the response, the result covers all of them then.
+        void subscribe(const SignalIds& signalIds, ControlResultCb resultCb);
+        void unsubscribe(const SignalIds& signalIds, ControlResultCb resultCb);
     private:
+        /// Created with the first control request of the session, used within the io context only
+        /// \throws std::runtime_error
+        Controller& controller();
+        /// Hands the request to the controller, called within the io context
+        /// \param subscribe true to subscribe, false to unsubscribe
+        void doControlRequest(const SignalIds& signalIds, ControlResultCb resultCb, bool subscribe);
+        static ControlResultCb toControlResultCb(CompletionCb completionCb);
+
+        /// Writes an in-band json rpc request to the stream asynchronously, used by the controller if the producer accepts in-band requests.
+        /// The request is completed by its response or with the error if writing failed.
+        /// \param method META_METHOD_SUBSCRIBE or META_METHOD_UNSUBSCRIBE
+        void writeInBandRequest(const char* method, const SignalIds& signalIds, ControlResultCb resultCb);
+        /// Writes the first queued in-band request
+        void doWriteInBand();
+        /// Completes the pending in-band request with the error if writing failed, writes the next queued request
+        void onInBandWritten(const boost::system::error_code& ec);
+        /// Completes the pending in-band request the response belongs to
+        void processInBandResponse(const MsgpackView& response);
 
         /// Initiates the stream to be closed.
         /// \param SessionEc Session error code to be reported with the completion callback after closing
@@ -78,13 +150,43 @@ namespace daq::streaming_protocol {
         void onHeader(const boost::system::error_code& ec);
         void onAdditionalLength(const boost::system::error_code& ec);
         void onPayload(const boost::system::error_code& ec);
+
+        /// Keeps this object alive until the stream got closed or the io context is destroyed
+        void holdSession();
+
+        using ReadStep = void (ProtocolHandler::*)(const boost::system::error_code& ec);
+        /// Executes the read step from within the io context as soon as the stream buffer holds the required number of bytes
+        void doRead(size_t bytesRequired, ReadStep readStep);
+
+        /// Requests more data. Reads at least the number of bytes missing to complete the next package.
+        void doReadBatch(size_t bytesMissing);
+        void onReadBatch(const boost::system::error_code& ec, std::size_t bytesRead);
+        /// Called first by each read completion
+        /// \return false if the session got closed while the read was pending. The session is released then and the read is not to be processed.
+        bool onReadComplete();
+        /// Destroys the closed stream as soon as neither a read nor a write is pending on it
+        void releaseClosedStream();
+
+        /// Processes the payload of the current package. The payload is at the beginning of the stream buffer.
+        /// \return -1 if the session got closed due to an error
+        int processPayload();
         /// The stream is destroyed. Completion callback is called with session error code
         void onClose(const boost::system::error_code& ec);
 
         boost::asio::io_context& m_ioc;
+        /// Never expires. Its wait holds a reference to this object from start until the stream got closed and no read is pending anymore.
+        /// Destroying the io context destroys the wait and releases this object as well.
+        /// Read completion handlers capture a plain this pointer. They fit into std::function and are created without allocating.
+        boost::asio::steady_timer m_sessionTimer;
+        /// Executed when the pending per package read completed
+        ReadStep m_readStep;
+        /// A read on the stream or a posted read step is outstanding
+        bool m_readPending;
         SignalContainer& m_signalContainer;
         StreamMetaCb m_streamMetaCb;
         std::unique_ptr < daq::stream::Stream > m_stream;
+        /// Holds the closed stream until the read and the writes that were pending on close completed
+        std::unique_ptr < daq::stream::Stream > m_closedStream;
         /// Will be set upon start with infomation from m_stream.
         /// We use this to omit possible race condition after reset of m_stream
         std::string m_remoteHost;
@@ -95,8 +197,23 @@ namespace daq::streaming_protocol {
         uint32_t m_length;
         SignalNumber m_signalNumber;
         TransportType m_type;
+        ReceiveMode m_receiveMode;
 
         StreamMeta m_streamMeta;
+        std::unique_ptr < Controller > m_controller;
+        std::chrono::microseconds m_controlMergeWindow;
+        /// Id of the last in-band request
+        uint64_t m_inBandRequestId;
+        /// In-band requests waiting for their response, the request id is the key. Completed with an error when closing.
+        std::map < uint64_t, ControlResultCb > m_pendingInBandRequests;
+        /// An encoded in-band request to be written
+        struct InBandWrite
+        {
+            uint64_t requestId;
+            std::vector < uint8_t > package;
+        };
+        /// Written one after the other, the first one is being written
+        std::deque < InBandWrite > m_inBandWrites;
 
         MetaInformation m_metaInformation;
         daq::streaming_protocol::LogCallback logCallback;
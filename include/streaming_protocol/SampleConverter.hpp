@@ -0,0 +1,112 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "streaming_protocol/Types.h"
+
+namespace daq::streaming_protocol {
+    /// \addtogroup consumer
+    /// Converts values as delivered in data packages into double or float.
+    /// -A value consists of one or more scalar elements: Complex numbers have 2, arrays have their count and structs have one per member.
+    ///  Each element results in one converted value. Results of a value are stored one after the other.
+    /// -Values of constant rule signals are preceded by their value index (IndexedValue). Indices and elements are de-interleaved.
+    /// -Post scaling and clamping to the range are optional and done within the same pass.
+    ///
+    /// Kernels using AVX2 or SSE4.1 are selected at runtime depending on the executing CPU. There is a scalar fallback for everything else.
+    /// All computation is done in double precision. Results are identical for all instruction sets.
+    class SampleConverter
+    {
+    public:
+        enum InstructionSet {
+            INSTRUCTIONSET_SCALAR,
+            INSTRUCTIONSET_SSE41,
+            INSTRUCTIONSET_AVX2
+        };
+
+        enum Option {
+            OPTION_NONE = 0,
+            /// value * scale + offset
+            OPTION_POSTSCALING = 1,
+            /// limit to [low, high], done after post scaling
+            OPTION_RANGE = 2
+        };
+
+        /// \return The best instruction set supported by the executing CPU
+        static InstructionSet supportedInstructionSet();
+
+        /// No elements. Nothing gets converted until setElementTypes() is called
+        SampleConverter();
+
+        /// \param elementTypes Sample type of each element of a value. Only scalar types (SAMPLETYPE_U8 to SAMPLETYPE_REAL64, bit fields) are allowed.
+        /// \return 0 on success, -1 if there is a non-scalar sample type. Previous layout is kept on error.
+        int setElementTypes(const std::vector < SampleType >& elementTypes);
+
+        /// \param indexed true if each value is preceded by its uint64 value index
+        void setIndexed(bool indexed);
+
+        void setPostScaling(const PostScaling& postScaling);
+        void setRange(const Range& range);
+
+        /// Restricts the kernels to the given instruction set. Instruction sets not supported by the CPU are replaced by the best supported one.
+        void setInstructionSet(InstructionSet instructionSet);
+        InstructionSet instructionSet() const;
+
+        /// \return Number of results per value
+        size_t elementCount() const
+        {
+            return m_elements.size();
+        }
+
+        /// \return Size of a value in bytes including the value index of indexed values
+        size_t valueSize() const
+        {
+            return m_valueSize;
+        }
+
+        /// @param count Number of values to process, not the number of bytes!
+        /// @param results Gets count * elementCount() results
+        /// @param options Combination of Option
+        /// @param valueIndices nullptr or room for count value indices. Only filled for indexed values.
+        /// \return Number of results
+        size_t convert(const uint8_t* pData, size_t count, double* results, unsigned int options = OPTION_NONE, uint64_t* valueIndices = nullptr) const;
+        size_t convert(const uint8_t* pData, size_t count, float* results, unsigned int options = OPTION_NONE, uint64_t* valueIndices = nullptr) const;
+
+    private:
+        struct Element
+        {
+            SampleType type;
+            /// position within the value (after the value index)
+            size_t offset;
+        };
+
+        template < typename Result >
+        size_t convertTo(const uint8_t* pData, size_t count, Result* results, unsigned int options, uint64_t* valueIndices) const;
+
+        std::vector < Element > m_elements;
+        /// all elements have the same sample type
+        bool m_uniform;
+        bool m_indexed;
+        size_t m_valueSize;
+        PostScaling m_postScaling;
+        Range m_range;
+        InstructionSet m_instructionSet;
+    };
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "stream/Stream.hpp"
+
+#include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/Types.h"
+
+namespace daq::streaming_protocol {
+    /// Snapshot of the state of a SendQueue
+    struct SendQueueMetrics
+    {
+        /// Bytes queued and not handed to the stream yet
+        size_t queuedBytes;
+        /// Bytes held: queued and being written
+        size_t bufferedBytes;
+        size_t capacity;
+        /// bufferedBytes in percent of the capacity
+        unsigned int fillLevel;
+        uint64_t packetCount;
+        /// Writes issued to the stream, each one covers all packets queued meanwhile
+        uint64_t writeCount;
+        uint64_t writtenBytes;
+        /// Signal data packets dropped by the overflow policy
+        uint64_t droppedCount;
+        uint64_t droppedBytes;
+        /// Set when a write failed or the queue overflowed with OVERFLOWPOLICY_DISCONNECT, packets are discarded afterwards
+        bool failed;
+    };
+
+    /// \addtogroup producer
+    /// Per-session send queue for writing asynchronously.
+    /// -Packets are appended to a buffer. This does not block on the stream, a slow client does not stall the thread producing the data.
+    /// -Packets queued meanwhile are written together with one write (one websocket frame, one syscall).
+    /// -There is one write at a time. Writes are initiated in the io context thread.
+    /// -Flushing follows a size/time policy: Packets are written once maxBatchSize bytes are queued or the oldest one is queued for maxLatency.
+    ///  With a maxLatency of 0, packets are written as soon as the write before completed.
+    /// -Memory is bounded: Bytes queued and being written are accounted against the capacity. Signal data packets not fitting are subject to the overflow policy.
+    ///  Meta information is never dropped, it may exceed the capacity by another capacity. Beyond, the stream is closed whatever the policy.
+    /// -Only signal data of signals set droppable (see setDroppable()) is dropped. The consumer counts values to calculate time stamps of synchronous signals,
+    ///  a packet missing would shift all later time stamps of the table. Time stamps of explicit time signals and data of signals not droppable
+    ///  are treated like meta information with OVERFLOWPOLICY_DROP and OVERFLOWPOLICY_DECIMATE.
+    /// -Pushing never waits for the client, a slow client does not stall other sessions.
+    /// -Packets shared by several sessions (see SignalHub) are queued by reference. Only packets smaller than COPY_THRESHOLD are copied,
+    ///  referencing them would cost more than copying.
+    /// All writers of a stream have to share its queue (see StreamWriter), otherwise writes would overlap.
+    /// \note Create with std::make_shared, pending writes and timers keep the queue alive.
+    class SendQueue : public std::enable_shared_from_this < SendQueue >
+    {
+    public:
+        enum OverflowPolicy {
+            /// The stream is closed, the session ends as on any other failure of the stream
+            OVERFLOWPOLICY_DISCONNECT,
+            /// Signal data packets of droppable signals not fitting are dropped as a whole
+            OVERFLOWPOLICY_DROP,
+            /// Above half of the capacity only every 2nd, above three quarters only every 4th signal data packet of each droppable signal is queued.
+            /// Packets not fitting are dropped.
+            OVERFLOWPOLICY_DECIMATE
+        };
+
+        static constexpr size_t DEFAULT_MAX_BATCH_SIZE = 65536;
+        static constexpr size_t DEFAULT_CAPACITY = 16 * 1024 * 1024;
+        static constexpr size_t COPY_THRESHOLD = 512;
+
+        /// Complete packet including the transport header, immutable once created
+        using Packet = std::shared_ptr < const std::vector < uint8_t > >;
+
+        /// \param ioc The io context the stream is running with
+        /// \param maxLatency Longest time a packet is held back to be written together with later ones
+        /// \param maxBatchSize Queued packets are written once they reach this size, without waiting for maxLatency
+        /// \param capacity Maximum number of bytes held for signal data
+        SendQueue(boost::asio::io_context& ioc, std::shared_ptr < daq::stream::Stream > stream, std::chrono::microseconds maxLatency, size_t maxBatchSize,
+                  size_t capacity, OverflowPolicy overflowPolicy, LogCallback logCb);
+
+        SendQueue(const SendQueue&) = delete;
+        SendQueue& operator=(const SendQueue&) = delete;
+
+        /// Appends one packet composed of several buffers. May be called from any thread.
+        /// \param type Only signal data is subject to the overflow policy
+        /// \return Number of bytes queued, 0 if the packet was dropped, -1 if the stream failed
+        int push(TransportType type, unsigned int signalNumber, const boost::asio::const_buffer* buffers, size_t bufferCount);
+
+        /// Appends a reference to a packet, the packet is kept until written
+        /// \return Number of bytes queued, 0 if the packet was dropped, -1 if the stream failed
+        int push(TransportType type, unsigned int signalNumber, const Packet& packet);
+
+        /// Writes all queued packets without waiting for maxLatency. May be called from any thread.
+        void flush();
+
+        /// Signal data of droppable signals is subject to OVERFLOWPOLICY_DROP and OVERFLOWPOLICY_DECIMATE. Signals are not droppable by default.
+        /// Set this only for signals whose time stamps do not depend on the packets before (see BaseSignal::isDroppable()).
+        /// May be called from any thread.
+        void setDroppable(unsigned int signalNumber, bool droppable);
+
+        /// May be called from any thread
+        SendQueueMetrics metrics() const;
+
+        /// Bytes queued and being written in percent of the capacity
+        unsigned int fillLevel() const;
+
+        /// \return Number of signal data packets of the signal dropped by the overflow policy
+        uint64_t droppedCount(unsigned int signalNumber) const;
+
+        boost::asio::io_context& ioContext()
+        {
+            return m_ioc;
+        }
+
+        std::shared_ptr < daq::stream::Stream > stream() const
+        {
+            return m_stream;
+        }
+
+    private:
+        struct SignalState
+        {
+            /// Signal data packets pushed, used for decimation
+            uint64_t packetIndex = 0;
+            uint64_t droppedCount = 0;
+            bool droppable = false;
+        };
+
+        /// Packets queued one after the other, either copied into the batch buffer or referenced
+        struct Segment
+        {
+            /// Position in the batch buffer, for copied packets only
+            size_t offset;
+            size_t size;
+            /// nullptr for copied packets
+            Packet packet;
+        };
+
+        /// Applies the overflow policy and accounts the packet. To be called with the mutex locked.
+        /// \return 1 if the packet is to be appended, 0 if it was dropped, -1 if the stream failed
+        int enqueue(std::unique_lock < std::mutex >& lock, TransportType type, unsigned int signalNumber, size_t size);
+        void appendCopy(const uint8_t* data, size_t size);
+        /// Unlocks the mutex if writeNext() gets posted
+        void scheduleWrite(std::unique_lock < std::mutex >& lock);
+        /// Hands writeNext() to the io context and unlocks the mutex
+        void postWriteNext(std::unique_lock < std::mutex >& lock);
+        /// To be called in the io context thread with the mutex locked.
+        /// Writes the queued packets if they are due, arms the timer otherwise.
+        void writeNext(std::unique_lock < std::mutex >& lock);
+        void onWritten(const boost::system::error_code& ec, std::size_t bytesWritten);
+        void onTimer();
+        /// Signal numbers from here on are not used as index. A single large signal number does not allocate a huge vector.
+        static constexpr unsigned int s_indexedSignalCount = 4096;
+
+        /// To be called with the mutex locked
+        /// \return The state of the signal, created if there is none
+        SignalState& signalState(unsigned int signalNumber);
+        /// To be called with the mutex locked
+        /// \return nullptr if the signal has no state
+        SignalState* findSignalState(unsigned int signalNumber);
+        const SignalState* findSignalState(unsigned int signalNumber) const;
+        /// Applies OVERFLOWPOLICY_DROP and OVERFLOWPOLICY_DECIMATE to signal data of a droppable signal. To be called with the mutex locked.
+        /// \return true if the signal data packet is to be queued
+        bool admit(SignalState& signal, unsigned int signalNumber, size_t size);
+        /// To be called with the mutex locked. Discards all queued packets and closes the stream.
+        void disconnect(std::unique_lock < std::mutex >& lock);
+        unsigned int fillLevelLocked() const;
+
+        boost::asio::io_context& m_ioc;
+        std::shared_ptr < daq::stream::Stream > m_stream;
+        std::chrono::microseconds m_maxLatency;
+        size_t m_maxBatchSize;
+        size_t m_capacity;
+        OverflowPolicy m_overflowPolicy;
+        LogCallback logCallback;
+
+        /// Only accessed in the io context thread
+        boost::asio::steady_timer m_timer;
+
+        mutable std::mutex m_mutex;
+        /// Copied packets being appended
+        std::vector < uint8_t > m_queued;
+        /// Copied packets being written. Both buffers are swapped, they keep their capacity.
+        std::vector < uint8_t > m_writing;
+        std::vector < Segment > m_queuedSegments;
+        std::vector < Segment > m_writingSegments;
+        daq::stream::ConstBufferVector m_writingBuffers;
+        /// Time the first packet of m_queued was queued
+        std::chrono::steady_clock::time_point m_queuedSince;
+        bool m_writeInProgress;
+        /// Set while the stream is being called, writes completing meanwhile are continued by the caller
+        bool m_initiating;
+        /// writeNext() is posted to the io context
+        bool m_posted;
+        bool m_timerArmed;
+        bool m_flushRequested;
+        bool m_failed;
+        uint64_t m_packetCount;
+        uint64_t m_writeCount;
+        uint64_t m_writtenBytes;
+        uint64_t m_droppedCount;
+        uint64_t m_droppedBytes;
+        /// Signal number is the index. Covers all signal numbers up to the highest one below s_indexedSignalCount having a state.
+        std::vector < SignalState > m_signals;
+        /// Signal number is the key. States of signal numbers from s_indexedSignalCount on.
+        std::unordered_map < unsigned int, SignalState > m_sparseSignals;
+        /// Bytes of copied and referenced packets
+        size_t m_queuedBytes;
+        size_t m_writingBytes;
+    };
+}
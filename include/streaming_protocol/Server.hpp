@@ -17,49 +17,114 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
+#include "boost/asio/executor_work_guard.hpp"
 #include "boost/asio/io_context.hpp"
+#include "boost/asio/ip/tcp.hpp"
 
 #include "stream/Stream.hpp"
-#include "stream/WebsocketServer.hpp"
 
 #include "streaming_protocol/ProducerSession.hpp"
 #include "streaming_protocol/Logging.hpp"
 
 namespace daq::streaming_protocol {
+    /// Accepts websocket clients and runs a ProducerSession for each of them.
+    ///
+    /// By default, the acceptor and all sessions run on the io_context given to the constructor.
+    /// With a thread count > 0, the server owns a pool of io_contexts with one thread each. Accepting happens on the
+    /// io_context given to the constructor. Each client is assigned to one of the pool threads (shard) before it is
+    /// accepted. It is accepted into the io_context of that shard and processed there for its whole life time.
+    /// Each shard keeps its own session registry.
     class Server {
     public:
+        /// How new sessions are assigned to the shards of the pool
+        enum SessionDistribution {
+            /// Shards are chosen one after the other
+            SESSIONDISTRIBUTION_ROUNDROBIN,
+            /// The shard with the fewest sessions at the time accepting the next client starts is chosen
+            SESSIONDISTRIBUTION_LEASTLOADED
+        };
+
         Server(boost::asio::io_context& readerIoContext, uint16_t wsDataPort, LogCallback logCb);
+        /// \param readerIoContext Accepting of new clients happens here. Needs to be run by the caller.
+        /// \param threadCount Number of io_context threads owned by the server. 0 to process all sessions on readerIoContext
+        /// \param distribution How to assign new sessions to the threads
+        Server(boost::asio::io_context& readerIoContext, uint16_t wsDataPort, size_t threadCount, SessionDistribution distribution, LogCallback logCb);
         Server(const Server&) = delete;
         Server& operator= (const Server&) = delete;
         virtual ~Server();
+        /// May be called again after stop(). The threads of the pool are started again then.
+        /// \return 0 on success, -1 if listening on the port failed
         int start();
+        /// Stops accepting and closes all sessions. The threads of the pool are joined on destruction.
         void stop();
 
+        /// \return Number of sessions, including clients still in the websocket handshake
         size_t sessionCount() const;
+
+        /// \return Number of threads owned by the server. 0 if all sessions are processed on the reader io_context
+        size_t threadCount() const;
+        /// \return Number of sessions processed by the given thread of the pool
+        size_t sessionCount(size_t threadIndex) const;
     private:
         /// stream id is the key
         using Sessions = std::map < std::string, std::weak_ptr < ProducerSession > >;
-        
+
+        /// One io_context with the sessions processed on it
+        struct Shard {
+            explicit Shard(boost::asio::io_context& ioc);
+
+            boost::asio::io_context& ioContext;
+            /// only set for shards owned by the server
+            std::unique_ptr < boost::asio::io_context > ownedIoContext;
+            std::unique_ptr < boost::asio::executor_work_guard < boost::asio::io_context::executor_type > > workGuard;
+            std::thread thread;
+
+            Sessions sessions;
+            /// set by stop(), sessions finishing the websocket handshake afterwards are not started
+            bool stopped;
+            mutable std::mutex sessionsMtx;
+            /// number of entries in sessions plus clients in the websocket handshake, readable without locking
+            std::atomic < size_t > sessionCount;
+        };
+
+        /// Starts the thread running the io_context of a shard owned by the server
+        void startThread(Shard& shard);
+
         void startWebsocketAccept();
         
-        void handleWebsocketTcpAccept(const boost::system::error_code& ec, boost::asio::ip::tcp::socket&& streamSocket);
+        /// \param shard Processes the accepted client. The socket was opened on its io_context.
+        void handleWebsocketTcpAccept(Shard& shard, const boost::system::error_code& ec, boost::asio::ip::tcp::socket&& streamSocket);
+
+        /// \return The shard to process the next session
+        Shard& nextShard();
         
-        void createSession(std::shared_ptr<stream::Stream> newStream);
+        void createSession(Shard& shard, std::shared_ptr<stream::Stream> newStream);
         void updateAvailableSignals(const SignalIds& removedSignals, const SignalIds& addedSignals);
 
         /// Executed upon detection of disconnect from client
-        void removeSessionCb(const std::string& sessionId);
+        void removeSessionCb(Shard& shard, const std::string& sessionId);
+
+        void stopThreads();
                 
         boost::asio::io_context& m_readerIoContext;
+        uint16_t m_wsDataPort;
+        SessionDistribution m_distribution;
+
+        boost::asio::ip::tcp::acceptor m_acceptor;
+
+        std::vector < std::unique_ptr < Shard > > m_shards;
+        /// true if the shards are owned by the server, false if there is one shard using the reader io_context
+        bool m_ownsThreads;
+        std::atomic < size_t > m_nextShard;
 
-        stream::WebsocketServer m_server;
-        
-        Sessions m_sessions;
-        std::mutex m_sessionsMtx;
         SignalIds m_availableSignals;
         LogCallback logCallback;
     };
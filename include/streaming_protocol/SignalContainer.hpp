@@ -16,34 +16,49 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
-#include <unordered_map>
 
 #include <nlohmann/json.hpp>
 
+#include "BasicSignalContainer.hpp"
 #include "SubscribedSignal.hpp"
-#include "Table.hpp"
 #include "Types.h"
 #include "streaming_protocol/Logging.hpp"
 
 namespace daq::streaming_protocol {
+    class BlockAccumulator;
     class MetaInformation;
+    class ShardedDecoder;
+
+    /// Values and time stamps of a signal accumulated from several packages
+    struct SignalBlock
+    {
+        const SubscribedSignal* signal;
+        /// One time stamp per value
+        const uint64_t* timeStamps;
+        /// Values as delivered to DataAsValueCb, valueSize bytes each
+        const uint8_t* data;
+        size_t valueSize;
+        size_t valueCount;
+    };
 
-    /// \note The same callback method is called for all meta information related to any signal. The provided parameter subscribedSignal gives information about the actual signal the meta onformation belong to!
-    /// \param subscribedSignal Carries lots of usefull information about the signal the data is coming from. (i.e. signal number and signal id). It also carries signal number and signal id to identify the signal.
-    using SignalMetaCb = std::function<void(SubscribedSignal& subscribedSignal, const std::string& method, const nlohmann::json& params)>;
+    /// \param blocks One block per signal. Blocks are only valid during the call.
+    using DataAsBlocksCb = std::function<void(const SignalBlock* blocks, size_t blockCount)>;
 
     /// \addtogroup consumer
     /// This class is used by stream consumers
     /// -It contains all subscribed signals.
     /// -It interpretes all signal related meta information
     /// -Callback functions may be registered in order to get informed about signal related meta information and measured data.
+    /// This is BasicSignalContainer with callbacks that are set at runtime.
     class SignalContainer {
     public:
         explicit SignalContainer(LogCallback logCb);
+        ~SignalContainer();
         SignalContainer(const SignalContainer& op) = delete;
         SignalContainer& operator=(const SignalContainer& op) = delete;
 
@@ -56,6 +71,43 @@ namespace daq::streaming_protocol {
         /// \warning set callback function before subscribing signals, otherwise you will miss measured values received.
         int setDataAsValueCb(DataAsValueCb cb);
 
+        /// Optional, time stamps of all values are generated only if this is set.
+        /// \warning set callback function before subscribing signals, otherwise you will miss measured values received.
+        int setDataAsTimestampedValuesCb(DataAsTimestampedValuesCb cb);
+
+        /// Enables the block mode: Values and time stamps of each signal are accumulated and delivered in blocks to cb.
+        /// -A block is delivered as soon as it holds blockCapacity values.
+        /// -All pending blocks are delivered together once the oldest pending value waited for maxLatency.
+        ///  The deadline is checked with each package processed and by pollBlocks() only, the container has no timer.
+        ///  If packages may stop arriving, pollBlocks() is required to be called periodically (e.g. from a timer of the io context),
+        ///  otherwise pending values wait for the next package.
+        /// -Pending values of a signal are delivered before meta information of that signal is processed.
+        /// The other callbacks are still called for each package.
+        /// \return -1 if the block mode is already enabled, in sharded mode, or on invalid parameters
+        int enableBlocks(size_t blockCapacity, std::chrono::microseconds maxLatency, DataAsBlocksCb cb);
+
+        /// Delivers all pending blocks if the deadline expired. To be called by the thread processing the measured data.
+        void pollBlocks();
+
+        /// Delivers all pending blocks
+        void flushBlocks();
+
+        /// Enables the sharded mode: Signal related meta information and measured data are processed by shardCount worker threads.
+        /// The calling thread only hands the packages over to the shards using lock-free queues.
+        /// -All signals of a table are processed by the same shard. Order within a table is preserved.
+        /// -Callbacks are executed by the shards. Callbacks for signals of different tables might run concurrently!
+        /// -Processing happens asynchronously. Errors are logged but not reported by processMetaInformation() and processMeasuredData().
+        /// \warning set callback functions before and call this before subscribing signals. Callbacks set later are not used by the shards.
+        /// \param queueCapacity Number of packages each shard can queue. If a queue is full, the calling thread waits.
+        /// \return -1 if signals are already subscribed or sharded mode is already enabled
+        int startShards(unsigned int shardCount, size_t queueCapacity = 4096);
+
+        /// Processes all queued packages and stops the shards. All signals processed by the shards are removed.
+        void stopShards();
+
+        /// \return Number of shards, 0 if sharded mode is not enabled
+        size_t shardCount() const;
+
         /// new subscribed signals are added with arrival of subscribe acknowledge
         int processMetaInformation(SignalNumber signalNumber, const MetaInformation& metaInformation);
 
@@ -66,24 +118,57 @@ namespace daq::streaming_protocol {
         ssize_t processMeasuredData(SignalNumber signalNumber, const unsigned char* data, size_t len);
 
     private:
-        /// Signal number is the key
-        using Signals = std::unordered_map < SignalNumber, std::shared_ptr < SubscribedSignal > >;
-
-        /// Table id is the key
-        using Tables = std::unordered_map < std::string, Table >;
-
-        /// signal number of the status signal is the key, signal id id of the datat signal is the value
-        using StatusSources = std::unordered_map < SignalNumber, std::string >;
-
+        /// moves signals between the containers of its shards
+        friend class ShardedDecoder;
+
+        /// Forwards to the callbacks registered
+        struct CallbackHandler
+        {
+            void signalMeta(SubscribedSignal& subscribedSignal, const std::string& method, const nlohmann::json& params)
+            {
+                signalMetaCb(subscribedSignal, method, params);
+            }
+
+            bool wantsSignalMeta() const
+            {
+                return static_cast < bool > (signalMetaCb);
+            }
+
+            void dataAsRaw(const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t byteCount)
+            {
+                dataAsRawCb(subscribedSignal, timeStamp, data, byteCount);
+            }
+
+            void dataAsValue(const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t valueCount)
+            {
+                dataAsValueCb(subscribedSignal, timeStamp, data, valueCount);
+            }
+
+            bool wantsTimestampedValues() const
+            {
+                return (blockAccumulator != nullptr) || static_cast < bool > (dataAsTimestampedValuesCb);
+            }
+
+            void dataAsTimestampedValues(const SubscribedSignal& subscribedSignal, const uint64_t* timeStamps, const uint8_t* data, size_t valueCount);
+
+            /// empty if not set
+            SignalMetaCb signalMetaCb;
+            DataAsRawCb dataAsRawCb;
+            DataAsValueCb dataAsValueCb;
+            /// empty if not set
+            DataAsTimestampedValuesCb dataAsTimestampedValuesCb;
+            /// Set in block mode only, time stamped values are accumulated here as well
+            BlockAccumulator* blockAccumulator = nullptr;
+        };
 
         /// processes measured data and keeps meta information about all subscribed signals
-        Signals m_subscribedSignals;
-        Tables m_tables;
-        StatusSources m_statusSources;
-
-        SignalMetaCb m_signalMetaCb;
-        DataAsRawCb m_dataAsRawCb;
-        DataAsValueCb m_dataAsValueCb;
+        BasicSignalContainer < CallbackHandler > m_container;
         LogCallback logCallback;
+
+        /// Set in sharded mode only
+        std::unique_ptr < ShardedDecoder > m_shardedDecoder;
+
+        /// Set in block mode only
+        std::unique_ptr < BlockAccumulator > m_blockAccumulator;
     };
 }
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/asio/buffer.hpp>
+
+#include "nlohmann/json.hpp"
+
+#include "streaming_protocol/BaseSignal.hpp"
+#include "streaming_protocol/iWriter.hpp"
+#include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/SendQueue.hpp"
+#include "streaming_protocol/Types.h"
+
+namespace daq::streaming_protocol {
+    /// \addtogroup producer
+    /// Writer for signals served to many sessions at once. There is one signal object for all sessions.
+    /// -Each packet is encoded once into an immutable, reference counted buffer (SendQueue::Packet).
+    /// -The send queue of each session subscribed to the signal gets a reference to that buffer. There is no copy and no encoding per session.
+    /// -Stream related meta information (signal number 0) goes to all sessions added.
+    /// -Subscribing and unsubscribing acknowledges and describes the signal to the session concerned only.
+    /// -Writing takes a snapshot of the sessions to write to. Sessions added or removed and signals subscribed or unsubscribed publish a new snapshot,
+    ///  writing does not wait for them.
+    /// Memory and CPU needed for encoding do not depend on the number of sessions.
+    /// Sessions use the hub via ProducerSession::setSignalHub().
+    /// \warning The time start of domain signals (BaseDomainSignal::setTimeStart()) reaches the sessions subscribed at that time only.
+    class SignalHub : public iWriter
+    {
+    public:
+        explicit SignalHub(LogCallback logCb);
+        SignalHub(const SignalHub&) = delete;
+        SignalHub& operator=(const SignalHub&) = delete;
+
+        std::string id() const override;
+
+        /// May be called from any thread
+        /// \return Size of the packet, 0 if there is no session to write to
+        int writeMetaInformation(unsigned int signalNumber, const nlohmann::json& data) override;
+        /// May be called from any thread
+        /// \return Size of the packet, 0 if no session subscribed the signal
+        int writeSignalData(unsigned int signalNumber, const void* pData, size_t length) override;
+
+        void addSession(std::shared_ptr < SendQueue > sendQueue);
+        /// Removes the session from all signals. The signals are not told, use unsubscribe() to keep their subscriber count (BaseSignal::isSubscribed()).
+        void removeSession(const std::shared_ptr < SendQueue >& sendQueue);
+
+        /// Acknowledges and describes the signal to the session. Data of the signal is written to the session afterwards.
+        /// Does nothing if the session subscribed the signal already.
+        void subscribe(const std::shared_ptr < SendQueue >& sendQueue, BaseSignal& signal);
+        /// Does nothing if the session did not subscribe the signal
+        void unsubscribe(const std::shared_ptr < SendQueue >& sendQueue, BaseSignal& signal);
+
+        /// Subscribes all signals given with one new snapshot of the sessions to write to.
+        /// Signals subscribed already or given more than once are acknowledged once.
+        void subscribe(const std::shared_ptr < SendQueue >& sendQueue, const std::vector < BaseSignal* >& signals);
+        /// Unsubscribes all signals given with one new snapshot of the sessions to write to.
+        void unsubscribe(const std::shared_ptr < SendQueue >& sendQueue, const std::vector < BaseSignal* >& signals);
+
+        bool isSubscribed(const std::shared_ptr < SendQueue >& sendQueue, unsigned int signalNumber) const;
+
+        /// \return Number of sessions the signal is written to
+        size_t subscriberCount(unsigned int signalNumber) const;
+
+        /// \return Number of packets encoded, independent of the number of sessions
+        uint64_t encodedCount() const;
+
+    private:
+        using SendQueues = std::vector < std::shared_ptr < SendQueue > >;
+
+        /// Signal numbers from here on are not used as index. A single large signal number does not allocate a huge vector.
+        static constexpr unsigned int s_indexedSignalCount = 4096;
+
+        /// Sessions to write to. Never changed once published, changes publish a copy (see m_routing).
+        struct Routing
+        {
+            /// \return nullptr if no session subscribed the signal
+            const SendQueues* subscribersOf(unsigned int signalNumber) const;
+            void setSubscribers(unsigned int signalNumber, std::shared_ptr < const SendQueues > sendQueues);
+
+            std::shared_ptr < const SendQueues > sessions;
+            /// Signal number is the index. Covers all signal numbers up to the highest subscribed one below s_indexedSignalCount.
+            std::vector < std::shared_ptr < const SendQueues > > subscribers;
+            /// Signal number is the key. Signal numbers from s_indexedSignalCount on.
+            std::unordered_map < unsigned int, std::shared_ptr < const SendQueues > > sparseSubscribers;
+        };
+
+        /// Creates the complete packet with transport header
+        static SendQueue::Packet createPacket(TransportType type, unsigned int signalNumber, const boost::asio::const_buffer* buffers, size_t bufferCount);
+
+        /// \return The sessions to write to, nullptr if there is none. While subscribing or unsubscribing in this thread, the session concerned only.
+        const SendQueues* receivers(const Routing& routing, unsigned int signalNumber) const;
+        int write(TransportType type, unsigned int signalNumber, const boost::asio::const_buffer* buffers, size_t bufferCount);
+
+        static bool contains(const SendQueues* sendQueues, const std::shared_ptr < SendQueue >& sendQueue);
+        static std::shared_ptr < const SendQueues > added(const SendQueues* sendQueues, const std::shared_ptr < SendQueue >& sendQueue);
+        static std::shared_ptr < const SendQueues > removed(const SendQueues* sendQueues, const std::shared_ptr < SendQueue >& sendQueue);
+
+        std::shared_ptr < const Routing > routing() const;
+        /// To be called with m_mutex locked
+        void publish(std::shared_ptr < const Routing > routing);
+
+        void subscribe(const std::shared_ptr < SendQueue >& sendQueue, BaseSignal* const* signals, size_t signalCount);
+        void unsubscribe(const std::shared_ptr < SendQueue >& sendQueue, BaseSignal* const* signals, size_t signalCount);
+
+        /// Redirects writes of this thread to the session being subscribed or unsubscribed. To be called with m_subscribeMutex locked.
+        void setTarget(const std::shared_ptr < SendQueue >& sendQueue);
+
+        LogCallback logCallback;
+
+        /// Serializes subscribing and unsubscribing
+        std::mutex m_subscribeMutex;
+
+        /// Serializes changes of the routing. Writing signals does not lock it.
+        std::mutex m_mutex;
+        /// Accessed with std::atomic_load() and std::atomic_store() only. Writers keep on using the routing they got.
+        std::shared_ptr < const Routing > m_routing;
+        /// Set and read by the subscribing thread only, other threads see m_targetThread differ from their id
+        std::shared_ptr < const SendQueues > m_target;
+        std::atomic < std::thread::id > m_targetThread;
+        std::atomic < uint64_t > m_encodedCount;
+    };
+}
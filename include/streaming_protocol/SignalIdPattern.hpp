@@ -0,0 +1,100 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace daq::streaming_protocol {
+    /// Glob pattern for signal ids, compiled once and matched against many signal ids without allocating.
+    /// Signal ids are treated as paths with '/' as separator:
+    /// -'*' matches any sequence of characters within one path segment, '/' is not matched
+    /// -'**' matches any sequence of characters including '/'
+    /// -'?' matches a single character except '/'
+    /// -'\' followed by '*', '?' or '\' matches the following character literally
+    /// -Everything else matches literally
+    /// Examples: "ai/*/raw" matches "ai/0/raw" but not "ai/0/1/raw", "ai/**" matches all signal ids starting with "ai/".
+    /// Signal ids containing '*' or '?' themselves are to be escaped (see escape()) to be subscribed exactly: "ai/\*" is the signal id "ai/*".
+    class SignalIdPattern
+    {
+    public:
+        /// \return true if the signal id contains wildcards not being escaped and is to be treated as a pattern
+        static bool isPattern(std::string_view signalId);
+
+        /// \return The signal id with '*', '?' and '\' escaped, it is not treated as a pattern
+        static std::string escape(std::string_view signalId);
+
+        /// \return The signal id with escapes removed, to look up signal ids not being a pattern
+        static std::string unescape(std::string_view signalId);
+
+        explicit SignalIdPattern(std::string_view pattern);
+
+        bool match(std::string_view signalId) const;
+
+        /// All matching signal ids start with this
+        const std::string& literalPrefix() const
+        {
+            return m_literalPrefix;
+        }
+
+        /// Calls function with each entry of a map whose key is a matching signal id.
+        /// Maps are sorted by signal id, only the range of entries starting with the literal prefix is visited.
+        /// \param map std::map or any other sorted map with std::string as key
+        template < typename Map, typename Function >
+        void forEachMatch(const Map& map, Function function) const
+        {
+            for (auto iter = map.lower_bound(m_literalPrefix); iter != map.end(); ++iter) {
+                std::string_view signalId(iter->first);
+                if (signalId.compare(0, m_literalPrefix.size(), m_literalPrefix) != 0) {
+                    // beyond the range
+                    break;
+                }
+                if (m_prefixOnly || matchFrom(0, signalId.substr(m_literalPrefix.size()))) {
+                    function(*iter);
+                }
+            }
+        }
+
+    private:
+        enum TokenType {
+            TOKENTYPE_LITERAL,
+            /// '?'
+            TOKENTYPE_ANY_CHARACTER,
+            /// '*'
+            TOKENTYPE_SEGMENT,
+            /// '**'
+            TOKENTYPE_ANY
+        };
+
+        struct Token
+        {
+            TokenType type;
+            std::string literal;
+        };
+
+        /// \param tokenIndex First token to match
+        /// \param rest Part of the signal id to be matched by the tokens
+        bool matchFrom(size_t tokenIndex, std::string_view rest) const;
+
+        std::string m_literalPrefix;
+        /// Tokens following the literal prefix
+        std::vector < Token > m_tokens;
+        /// The pattern is the literal prefix followed by '**'. Every signal id starting with the prefix matches.
+        bool m_prefixOnly;
+    };
+}
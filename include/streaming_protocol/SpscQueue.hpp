@@ -0,0 +1,117 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace daq::streaming_protocol {
+    /// Bounded lock-free queue for exactly one producing and one consuming thread.
+    ///
+    /// All slots are constructed on creation and get reused. Instead of pushing and popping copies,
+    /// the producer fills the next free slot in place and publishes it, the consumer works on the
+    /// oldest published slot and releases it afterwards. Resources held by a slot (i.e. the capacity of a std::vector)
+    /// are kept, hence there is no allocation once the slots have grown to their working size.
+    template < typename Type >
+    class SpscQueue
+    {
+    public:
+        /// \param capacity Number of slots, rounded up to the next power of two
+        /// \param prototype All slots are initialized with a copy of this
+        explicit SpscQueue(size_t capacity, const Type& prototype = Type())
+            : m_slots(roundUpToPowerOfTwo(capacity), prototype)
+            , m_mask(m_slots.size() - 1)
+            , m_writeIndex(0)
+            , m_readIndex(0)
+        {
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        /// To be called by the producer only
+        /// \return The next free slot to be filled or nullptr if the queue is full
+        Type* producerSlot()
+        {
+            size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+            if (writeIndex - m_readIndex.load(std::memory_order_acquire) == m_slots.size()) {
+                return nullptr;
+            }
+            return &m_slots[writeIndex & m_mask];
+        }
+
+        /// To be called by the producer only
+        /// Makes the slot retrieved by producerSlot() available to the consumer
+        void publish()
+        {
+            m_writeIndex.store(m_writeIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /// To be called by the consumer only
+        /// \return The oldest published slot or nullptr if the queue is empty
+        Type* consumerSlot()
+        {
+            size_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+            if (readIndex == m_writeIndex.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+            return &m_slots[readIndex & m_mask];
+        }
+
+        /// To be called by the consumer only
+        /// Hands the slot retrieved by consumerSlot() back to the producer
+        void release()
+        {
+            m_readIndex.store(m_readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /// \return Number of published slots not yet released. The value is a snapshot when called from a third thread.
+        size_t size() const
+        {
+            return m_writeIndex.load(std::memory_order_acquire) - m_readIndex.load(std::memory_order_acquire);
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        size_t capacity() const
+        {
+            return m_slots.size();
+        }
+
+    private:
+        static size_t roundUpToPowerOfTwo(size_t value)
+        {
+            size_t result = 1;
+            while (result < value) {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        /// Producer and consumer indices are kept on separate cache lines
+        static const size_t CacheLineSize = 64;
+
+        std::vector < Type > m_slots;
+        size_t m_mask;
+        alignas(CacheLineSize) std::atomic < size_t > m_writeIndex;
+        alignas(CacheLineSize) std::atomic < size_t > m_readIndex;
+    };
+}
@@ -51,12 +51,16 @@ namespace daq::streaming_protocol {
         /// 10 for 1.0, 11 for 1.1
         unsigned int httpVersion() const;
 
+        /// The producer accepts subscribe/unsubscribe requests over the data stream (COMMANDINTERFACE_JSONRPC_INBAND)
+        bool inBandControl() const;
+
     private:
         std::string m_apiVersion;
         std::string m_streamId;
         std::string m_httpControlPath;
         std::string m_httpControlPort;
         unsigned int m_httpVersion;
+        bool m_inBandControl;
         LogCallback logCallback;
     };
 }
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/SubscribedSignal.hpp"
+
+namespace daq::streaming_protocol {
+    class StreamReader;
+
+    /// \addtogroup consumer
+    /// Bounded lock-free ring with the values and time stamps of one signal, filled by the StreamReader.
+    /// -There is exactly one producer (the thread calling StreamReader::add()) and one consumer calling the read methods.
+    /// -Values are copied as received. Values of constant rule signals are preceded by their value index (see IndexedValue).
+    /// -If the ring is full, values that do not fit are dropped and counted.
+    class SignalReader
+    {
+    public:
+        /// \param capacity Number of values, rounded up to the next power of two
+        SignalReader(const std::string& signalId, size_t capacity);
+
+        SignalReader(const SignalReader&) = delete;
+        SignalReader& operator=(const SignalReader&) = delete;
+
+        const std::string& signalId() const
+        {
+            return m_signalId;
+        }
+
+        size_t capacity() const
+        {
+            return m_timeStamps.size();
+        }
+
+        /// \return Bytes per value, 0 until the first values arrived
+        size_t valueSize() const
+        {
+            return m_valueSize.load(std::memory_order_acquire);
+        }
+
+        /// \return Number of values that can be read without waiting
+        size_t available() const;
+
+        /// Copies the oldest values and their time stamps. Waits up to timeout until count values are available.
+        /// \param values Room for count values of valueSize() bytes, may be nullptr if not of interest
+        /// \param timeStamps Room for count time stamps, may be nullptr if not of interest
+        /// \return Number of values read, less than count on timeout
+        size_t read(void* values, uint64_t* timeStamps, size_t count, std::chrono::microseconds timeout = std::chrono::microseconds(0));
+
+        /// Copies the oldest values with a time stamp before time, up to maxCount.
+        /// Waits up to timeout until a value with a time stamp at or after time arrives, i.e. until all values before time were received.
+        /// \return Number of values read
+        size_t readUntil(uint64_t time, void* values, uint64_t* timeStamps, size_t maxCount, std::chrono::microseconds timeout = std::chrono::microseconds(0));
+
+        /// \return Number of values dropped because the ring was full or the value size changed
+        uint64_t droppedValueCount() const
+        {
+            return m_droppedValueCount.load(std::memory_order_relaxed);
+        }
+
+    private:
+        friend class StreamReader;
+
+        /// To be called by the producer only
+        /// \return false if the values were dropped because the value size changed
+        bool write(const uint64_t* timeStamps, const uint8_t* data, size_t valueCount, size_t valueSize);
+
+        /// Waits until condition() is true or the timeout expired
+        /// \return the last result of condition()
+        template < typename Condition >
+        bool waitFor(std::chrono::microseconds timeout, Condition condition);
+
+        /// Copies count values starting at the read index and releases them
+        void copyOut(void* values, uint64_t* timeStamps, size_t count);
+
+        std::string m_signalId;
+        std::vector < uint64_t > m_timeStamps;
+        /// Allocated with the first values, when the value size is known
+        std::vector < uint8_t > m_values;
+        size_t m_mask;
+        std::atomic < size_t > m_valueSize;
+        std::atomic < uint64_t > m_droppedValueCount;
+
+        /// Producer and consumer indices are kept on separate cache lines
+        static const size_t CacheLineSize = 64;
+        alignas(CacheLineSize) std::atomic < size_t > m_writeIndex;
+        alignas(CacheLineSize) std::atomic < size_t > m_readIndex;
+
+        /// For blocking reads only
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::atomic < bool > m_waiting;
+    };
+
+    /// \addtogroup consumer
+    /// Pull based access to measured data: Values and time stamps of each signal of interest are kept in a SignalReader to be read by processing loops.
+    /// -Feed it by calling add() from the DataAsTimestampedValuesCb of the SignalContainer.
+    /// -Values of signals without a SignalReader are ignored.
+    class StreamReader
+    {
+    public:
+        explicit StreamReader(LogCallback logCb);
+
+        /// \warning Add all signals before values arrive
+        /// \param capacity Number of values to be kept
+        /// \return The reader of the signal. It exists as long as the StreamReader.
+        SignalReader& addSignal(const std::string& signalId, size_t capacity);
+
+        /// Takes the values of a signal. Signature matches DataAsTimestampedValuesCb.
+        void add(const SubscribedSignal& subscribedSignal, const uint64_t* timeStamps, const uint8_t* data, size_t valueCount);
+
+    private:
+        struct Route
+        {
+            /// The signal the route was resolved for. Signal numbers might get reused by other signals.
+            std::string signalId;
+            /// nullptr if there is no reader for this signal
+            SignalReader* reader = nullptr;
+        };
+
+        /// Signal numbers from here on are not used as index. A single large signal number does not allocate a huge vector.
+        static constexpr SignalNumber s_indexedRouteCount = 4096;
+
+        /// \return The route of the signal number, created if there is none
+        Route& route(SignalNumber signalNumber);
+
+        std::vector < std::unique_ptr < SignalReader > > m_signalReaders;
+        /// Signal number is the index. Covers all signal numbers up to the highest one below s_indexedRouteCount values arrived for.
+        std::vector < Route > m_routes;
+        /// Signal number is the key. Routes of signal numbers from s_indexedRouteCount on.
+        std::unordered_map < SignalNumber, Route > m_sparseRoutes;
+        LogCallback logCallback;
+    };
+}
@@ -25,6 +25,7 @@
 #include "stream/Stream.hpp"
 
 #include "streaming_protocol/iWriter.hpp"
+#include "streaming_protocol/SendQueue.hpp"
 #include "streaming_protocol/Types.h"
 
 namespace daq::streaming_protocol{
@@ -33,6 +34,9 @@ namespace daq::streaming_protocol{
     public:
         /// \param stream An initialized (i.e. connected) stream
         StreamWriter(std::shared_ptr < daq::stream::Stream > stream);
+        /// Packets are appended to the queue and written asynchronously, writing does not block on the stream.
+        /// All writers of the stream have to share the queue.
+        StreamWriter(std::shared_ptr < SendQueue > sendQueue);
         StreamWriter(StreamWriter && ) = delete;
         virtual ~StreamWriter() = default;
         StreamWriter(const StreamWriter&) = delete;
@@ -40,16 +44,21 @@ namespace daq::streaming_protocol{
         virtual std::string id() const override;
 
         /// \param signalNumber 0: for stream related, >0: signal related
+        /// \return Number of bytes written or queued
         int writeMetaInformation(unsigned int signalNumber, const nlohmann::json &data) override;
         /// \param signalNumber Must be > 0 since data is always signal related
         int writeSignalData(unsigned int signalNumber, const void *pData, size_t length) override;
-    private:
-        /// creates the transport header and the additional length field if size > 255
+
+        /// Creates the transport header and the additional length field if size > 255
+        /// Also used by the consumer for sending in-band control requests
         /// \return depending on parameter 'size' the created header has 4 bytes or 8 bytes
         static size_t createTransportHeader(TransportType type, unsigned int signalNumber, uint32_t (&transportHeaderBuffer)[2], size_t size);
+    private:
         int writeMsgPackMetaInformation(unsigned int signalNumber, const std::vector<uint8_t>& data);
 
         std::shared_ptr<daq::stream::Stream> m_stream;
+        /// Empty for writing synchronously
+        std::shared_ptr<SendQueue> m_sendQueue;
 
         std::mutex m_writeMtx;
     };
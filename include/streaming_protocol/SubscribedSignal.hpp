@@ -18,13 +18,19 @@
 
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
+#include "streaming_protocol/MsgpackView.hpp"
+#include "streaming_protocol/SampleConverter.hpp"
+#include "streaming_protocol/TimeTicks.hpp"
 #include "streaming_protocol/Unit.hpp"
 #include "streaming_protocol/Types.h"
+#include "streaming_protocol/Vocabulary.hpp"
 #include "streaming_protocol/Logging.hpp"
 
 #if defined(_MSC_VER)
@@ -46,6 +52,34 @@ class SubscribedSignal;
 using DataAsRawCb = std::function<void(const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t byteCount)>;
 /// \param valueCount Number of values delivered. Not number of bytes!
 using DataAsValueCb = std::function<void(const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t valueCount)>;
+/// Delivers the values together with the absolute time stamp of each value. Consumers do not need to apply the time rule themselves.
+/// \param timeStamps valueCount time stamps in time ticks of the time signal. Only valid during the call.
+/// \param valueCount Number of values delivered. Not number of bytes!
+using DataAsTimestampedValuesCb = std::function<void(const SubscribedSignal& subscribedSignal, const uint64_t* timeStamps, const uint8_t* data, size_t valueCount)>;
+
+/// Handler with the callbacks for measured data known at compile time. Does nothing.
+/// Derive from this and hide the methods of interest. See SubscribedSignal::processMeasuredData() and BasicSignalContainer.
+/// The parameters are the same as the ones of the callbacks above.
+struct NopDataHandler
+{
+    void dataAsRaw(const SubscribedSignal&, uint64_t, const uint8_t*, size_t)
+    {
+    }
+
+    void dataAsValue(const SubscribedSignal&, uint64_t, const uint8_t*, size_t)
+    {
+    }
+
+    /// \return true if time stamps are to be generated for dataAsTimestampedValues()
+    bool wantsTimestampedValues() const
+    {
+        return false;
+    }
+
+    void dataAsTimestampedValues(const SubscribedSignal&, const uint64_t*, const uint8_t*, size_t)
+    {
+    }
+};
 
 /// \addtogroup consumer
 /// Interpretes and stores meta information of a subscribed signal.
@@ -56,13 +90,31 @@ public:
     virtual ~SubscribedSignal() = default;
 
     /// process measured data
+    /// \param cbTimestampedValues Optional, time stamps are generated only if set
+    /// \return number of bytes processed, -1 on error
+    ssize_t processMeasuredData(const unsigned char* pData, size_t size, const std::shared_ptr < SubscribedSignal>& timeSignal, const DataAsRawCb& cbRaw, const DataAsValueCb& cbValues,
+                                const DataAsTimestampedValuesCb& cbTimestampedValues = DataAsTimestampedValuesCb());
+
+    /// process measured data with the callbacks of handler resolved at compile time. Nothing is copied per call.
+    /// \param timeSignal nullptr if there is none
+    /// \param handler See NopDataHandler for the methods required
     /// \return number of bytes processed, -1 on error
-    ssize_t processMeasuredData(const unsigned char* pData, size_t size, std::shared_ptr < SubscribedSignal> timeSignal, DataAsRawCb cbRaw, DataAsValueCb cbValues);
+    template < typename Handler >
+    ssize_t processMeasuredData(const unsigned char* pData, size_t size, const SubscribedSignal* timeSignal, Handler& handler);
 
     /// process signal related meta information.
     /// \return 0 on success, -1 on error
     int processSignalMetaInformation(const std::string& method, const nlohmann::json& params);
 
+    /// process signal related meta information with the method already resolved.
+    /// \return 0 on success, -1 on error
+    int processSignalMetaInformation(MethodType method, const nlohmann::json& params);
+
+    /// process signal related meta information read from the MessagePack encoded parameters.
+    /// The signal id of a subscribe is taken from the view, a json document is built for the signal method only.
+    /// \return 0 on success, -1 on error
+    int processSignalMetaInformation(MethodType method, const MsgpackView& params);
+
     /// \return the unique signal number. Signals have also an unique id which is a string.
     /// For efficiency reasons, the id is delivered only once of a subscribed is acknowledged.
     /// This meta information also carries the signal number. The connection of both is kept in this class.
@@ -73,12 +125,12 @@ public:
 
     /// \return the textual unique identifier of the signal.
     /// It is the first received information after a signal got subscribed.
-    std::string signalId() const
+    const std::string& signalId() const
     {
         return m_signalId;
     }
 
-    std::string tableId() const
+    const std::string& tableId() const
     {
         return m_tableId;
     }
@@ -165,9 +217,11 @@ public:
     }
 
     /// Set the time signal for this signal
-    void setTimeSignal(std::shared_ptr<SubscribedSignal> timeSignal)
+    void setTimeSignal(const std::shared_ptr<SubscribedSignal>& timeSignal)
     {
-        m_timeSignal = timeSignal;
+        if (m_timeSignal != timeSignal) {
+            m_timeSignal = timeSignal;
+        }
     }
 
     uint64_t linearDelta() const
@@ -200,9 +254,17 @@ public:
         return m_bitsInterpretationObject;
     }
 
+    /// Values consisting of more than one element (complex, array, struct) are not converted here. Use sampleConverter() for those.
     /// @param count Number of values to process, not the number of bytes!
+    /// \return Number of converted values, 0 if not supported
     size_t interpretValuesAsDouble(const unsigned char* pData, size_t count, double *doubleValueBuffer) const;
 
+    /// Converts values of all data types into double or float. Post scaling and range of the signal are known to the converter.
+    const SampleConverter& sampleConverter() const
+    {
+        return m_sampleConverter;
+    }
+
     /// \return Post scaling information of the scalar signal member
     PostScaling postScaling() const
     {
@@ -232,30 +294,6 @@ public:
 
 private:
 
-    template < typename DataType >
-    inline void convert(const uint8_t *pData, size_t count, double* doubleValueBuffer) const
-    {
-        DataType value;
-        if (m_ruleType == RULETYPE_EXPLICIT) {
-            // values only
-            for(size_t i=0; i<count; ++i) {
-                memcpy(&value, pData, sizeof (value));
-                doubleValueBuffer[i] = static_cast <double> (value);
-                pData += sizeof(DataType);
-            }
-        } else {
-            // for implicit signals, each value follows after a value index
-            uint64_t valueIndex;
-            for(size_t i=0; i<count; ++i) {
-                memcpy(&valueIndex, pData, sizeof (valueIndex));
-                pData += sizeof (valueIndex);
-                memcpy(&value, pData, sizeof (value));
-                doubleValueBuffer[i] = static_cast <double> (value);
-                pData += sizeof(DataType);
-            }
-        }
-    }
-
     SignalNumber m_signalNumber;
     std::string m_signalId;
     /// The table, the signal belomgs to
@@ -283,9 +321,93 @@ private:
     Unit m_unit;
     Range m_range;
     PostScaling m_postScaling;
+    SampleConverter m_sampleConverter;
+    /// Reused for delivering time stamps to DataAsTimestampedValuesCb
+    std::vector<uint64_t> m_timeStamps;
 
     nlohmann::json m_interpretationObject;
     LogCallback logCallback;
     RelatedSignals m_relatedSignals;
 };
+
+template < typename Handler >
+ssize_t SubscribedSignal::processMeasuredData(const unsigned char* pData, size_t size, const SubscribedSignal* timeSignal, Handler& handler)
+{
+    auto timeSignalRule = RULETYPE_EXPLICIT;
+    if (timeSignal)
+        timeSignalRule = timeSignal->m_ruleType;
+
+    switch (timeSignalRule) {
+    case RULETYPE_LINEAR:
+    {
+        // Signals with a non-explicit rule will have a value index for each value
+        size_t bytesPerValue;
+        m_linearDelta = timeSignal->m_linearDelta;
+
+        if (m_ruleType == RULETYPE_EXPLICIT) {
+            // Since we deliver the time stamp of the first value,
+            // We increment timestamp after execution of the callback methods.
+            // short read is not allowed! We expect complete packages only!
+
+            uint64_t timeStamp = timeSignal->time() + ((m_linearValueIndex - timeSignal->timeIndex()) * m_linearDelta);
+            handler.dataAsRaw(*this, timeStamp, pData, size);
+
+            bytesPerValue = m_dataValueSize;
+            size_t valueCount = size / bytesPerValue;
+            handler.dataAsValue(*this, timeStamp, pData, valueCount);
+            if (handler.wantsTimestampedValues()) {
+                m_timeStamps.resize(valueCount);
+                TimeTicks::linear(timeStamp, m_linearDelta, valueCount, m_timeStamps.data());
+                handler.dataAsTimestampedValues(*this, m_timeStamps.data(), pData, valueCount);
+            }
+            m_linearValueIndex += valueCount;
+        }
+        else if (m_ruleType == RULETYPE_CONSTANT) {
+            // for implicit signals, we get also the value index
+            bytesPerValue = sizeof(uint64_t) + m_dataValueSize;
+
+            handler.dataAsRaw(*this, timeSignal->time(), pData, size);
+            size_t valueCount = size / bytesPerValue;
+            handler.dataAsValue(*this, timeSignal->time(), pData, valueCount);
+            if (handler.wantsTimestampedValues()) {
+                // each value carries its value index
+                m_timeStamps.resize(valueCount);
+                TimeTicks::linear(timeSignal->time(), timeSignal->timeIndex(), m_linearDelta, pData, bytesPerValue, valueCount, m_timeStamps.data());
+                handler.dataAsTimestampedValues(*this, m_timeStamps.data(), pData, valueCount);
+            }
+        }
+        else {
+            STREAMING_PROTOCOL_LOG_E("Linear data signal is not supported");
+        }
+        break;
+    }
+    case RULETYPE_EXPLICIT:
+    {
+        // In openDAQ streaming protocol, time stamp and value are delivered separately as explicit values
+        // in the time signal and the data signal.
+        // The device will deliver the time stamp before the value => Time (m_time) is already set! 
+        if ((size % m_dataValueSize) != 0) {
+            STREAMING_PROTOCOL_LOG_E("Data is not an even multiple of expected data size");
+            return (ssize_t) size;
+        }
+        uint64_t time = timeSignal ? timeSignal->m_time : 0;
+        handler.dataAsRaw(*this, time, pData, size);
+        handler.dataAsValue(*this, time, pData, size / m_dataValueSize);
+        if (handler.wantsTimestampedValues()) {
+            // all values share the time stamp received last
+            m_timeStamps.assign(size / m_dataValueSize, time);
+            handler.dataAsTimestampedValues(*this, m_timeStamps.data(), pData, m_timeStamps.size());
+        }
+        break;
+    }
+    case RULETYPE_CONSTANT:
+        STREAMING_PROTOCOL_LOG_E("Domain signal with constant rule is not supported  ({})", m_signalId);
+        return -1;
+    case RULETYPE_UNKNOWN:
+        STREAMING_PROTOCOL_LOG_E("No rule for signal ", m_signalId);
+        return -1;
+    }
+
+    return (ssize_t) size;
+}
 }
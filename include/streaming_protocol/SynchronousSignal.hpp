@@ -60,6 +60,9 @@ public:
 	virtual int addData(const void* data, size_t sampleCount) override
 	{
 	    m_valueIndex += sampleCount;
+	    if (!isSubscribed()) {
+	        return 0;
+	    }
 	    return m_writer.writeSignalData(m_signalNumber, (uint8_t*)data, sampleCount * sizeof(DataType));
 	}
 
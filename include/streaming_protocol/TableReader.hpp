@@ -0,0 +1,128 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/SubscribedSignal.hpp"
+#include "streaming_protocol/Types.h"
+
+namespace daq::streaming_protocol {
+    /// Rows of a table with values of all data signals aligned by their value index
+    struct TableFrame
+    {
+        /// Value index of the first row
+        uint64_t firstValueIndex;
+        size_t rowCount;
+        /// One time stamp per row
+        const uint64_t* timeStamps;
+        size_t columnCount;
+        /// columns[column][row], one column per data signal in the order given to the TableReader. Missing values are NaN.
+        const double* const* columns;
+        /// rows[row * columnCount + column] if row major frames are enabled, nullptr otherwise
+        const double* rows;
+    };
+
+    /// \param frame Only valid during the call
+    using TableFrameCb = std::function<void(const TableFrame& frame)>;
+
+    /// \addtogroup consumer
+    /// Joins the synchronous data signals of a table (explicit rule, linear time) on their shared value index.
+    /// -Feed it with the values of the data signals by calling add() from the DataAsTimestampedValuesCb of the SignalContainer.
+    ///  Values of signals that are not a column of this reader are ignored.
+    /// -Frames of frameCapacity rows are delivered as soon as all columns have the values.
+    /// -Values of signals running ahead are buffered. If a column buffers more than maxBufferedRows, rows are delivered anyway.
+    ///  Missing values of signals lagging behind are NaN then. Their values arriving later are dropped.
+    /// -Values are converted into double. Only scalar data types are supported.
+    class TableReader
+    {
+    public:
+        /// \param signalIds Signal id of the data signal of each column
+        /// \param maxBufferedRows Is raised to frameCapacity if smaller
+        TableReader(const std::vector < std::string >& signalIds, size_t frameCapacity, size_t maxBufferedRows, TableFrameCb cb, LogCallback logCb);
+
+        /// Additionally deliver row major frames (TableFrame::rows)
+        void setRowMajor(bool rowMajor);
+
+        /// Takes the values of a data signal. Signature matches DataAsTimestampedValuesCb.
+        void add(const SubscribedSignal& subscribedSignal, const uint64_t* timeStamps, const uint8_t* data, size_t valueCount);
+
+        /// Delivers all buffered rows. Missing values are NaN.
+        void flush();
+
+        size_t columnCount() const
+        {
+            return m_columns.size();
+        }
+
+        /// \return Number of values dropped because they arrived after their row was delivered
+        uint64_t droppedValueCount() const
+        {
+            return m_droppedValueCount;
+        }
+
+        /// Transposes column major into row major layout: rows[row * columnCount + column] = columns[column][row]
+        static void interleave(const double* const* columns, size_t columnCount, size_t rowCount, double* rows);
+
+    private:
+        struct Column
+        {
+            std::string signalId;
+            /// Values from the first row not delivered yet on. NaN for values not received.
+            std::vector < double > values;
+        };
+
+        /// \return -1 if the signal is no column
+        int columnIndex(const SubscribedSignal& subscribedSignal);
+        /// \return Column index + 1 of the signal number, 0 if not resolved yet
+        size_t& signalColumn(SignalNumber signalNumber);
+        /// Delivers rowCount rows. Columns with less rows are padded with NaN.
+        void deliver(size_t rowCount);
+
+        std::vector < Column > m_columns;
+        size_t m_frameCapacity;
+        size_t m_maxBufferedRows;
+        TableFrameCb m_cb;
+        bool m_rowMajor;
+
+        /// false until the first values arrive
+        bool m_started;
+        /// Value index of the first row not delivered yet
+        uint64_t m_firstValueIndex;
+        /// Time stamp and value index of the latest values received. Time stamps of rows are derived from this.
+        uint64_t m_referenceTime;
+        uint64_t m_referenceValueIndex;
+        uint64_t m_timeDelta;
+        uint64_t m_droppedValueCount;
+
+        /// Signal number is the index, column index + 1, 0 if not resolved yet. Covers signal numbers below 4096.
+        std::vector < size_t > m_signalColumns;
+        /// Signal number is the key. Columns of signal numbers from 4096 on.
+        std::unordered_map < SignalNumber, size_t > m_sparseSignalColumns;
+        std::vector < double > m_conversionBuffer;
+        std::vector < uint64_t > m_timeStamps;
+        std::vector < const double* > m_columnPointers;
+        std::vector < double > m_rows;
+        LogCallback logCallback;
+    };
+}
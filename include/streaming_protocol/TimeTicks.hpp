@@ -0,0 +1,57 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace daq::streaming_protocol {
+    /// Conversion of time ticks into nanoseconds and std::chrono::system_clock and generation of time stamps for linear time rules.
+    /// -All conversions are done in integer arithmetic and are exact: Results are rounded towards zero, there is no detour via double.
+    /// -Batch versions convert whole arrays and are considerably faster than converting one value after the other.
+    /// -Time stamps are counted from the unix epoch. Times before the unix epoch are not supported.
+    /// -A timeTicksPerSecond of 0 (unknown time base) results in 0.
+    class TimeTicks
+    {
+    public:
+        static constexpr uint64_t NANOSECONDS_PER_SECOND = 1000000000;
+
+        /// \return value * multiplier / divisor without intermediate overflow. Results beyond 64 bit are truncated.
+        static uint64_t mulDiv(uint64_t value, uint64_t multiplier, uint64_t divisor);
+
+        static uint64_t toNanoseconds(uint64_t timeTicks, uint64_t timeTicksPerSecond);
+        static uint64_t fromNanoseconds(uint64_t nanoseconds, uint64_t timeTicksPerSecond);
+
+        /// \note Resolution is the one of std::chrono::system_clock
+        static std::chrono::system_clock::time_point toSystemClock(uint64_t timeTicks, uint64_t timeTicksPerSecond);
+        static uint64_t fromSystemClock(const std::chrono::system_clock::time_point& time, uint64_t timeTicksPerSecond);
+
+        /// Batch version of toNanoseconds(). Input and output may be the same array.
+        static void toNanoseconds(const uint64_t* timeTicks, size_t count, uint64_t timeTicksPerSecond, uint64_t* nanoseconds);
+
+        /// Batch version of toSystemClock()
+        static void toSystemClock(const uint64_t* timeTicks, size_t count, uint64_t timeTicksPerSecond, std::chrono::system_clock::time_point* times);
+
+        /// Time stamps of values of a linear time rule: timeStamps[i] = start + i * delta
+        static void linear(uint64_t start, uint64_t delta, size_t count, uint64_t* timeStamps);
+
+        /// Time stamps of values of a linear time rule identified by their value index: timeStamps[i] = start + (index[i] - startIndex) * delta
+        /// \param indexedValues The value index of each value as uint64, indices are stride bytes apart (i.e. IndexedValue)
+        static void linear(uint64_t start, uint64_t startIndex, uint64_t delta, const uint8_t* indexedValues, size_t stride, size_t count, uint64_t* timeStamps);
+    };
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/Types.h"
+
+namespace daq::streaming_protocol {
+    /// Known values of the meta information "method"
+    enum MethodType {
+        METHODTYPE_UNKNOWN,
+
+        // stream related
+        METHODTYPE_APIVERSION,
+        METHODTYPE_INIT,
+        METHODTYPE_AVAILABLE,
+        METHODTYPE_UNAVAILABLE,
+        METHODTYPE_ALIVE,
+
+        // signal related
+        METHODTYPE_SUBSCRIBE,
+        METHODTYPE_UNSUBSCRIBE,
+        METHODTYPE_SIGNAL
+    };
+
+    /// Known values of "dataType" in a signal definition
+    enum DataType {
+        DATATYPE_UNKNOWN,
+        DATATYPE_INT8,
+        DATATYPE_UINT8,
+        DATATYPE_INT16,
+        DATATYPE_UINT16,
+        DATATYPE_INT32,
+        DATATYPE_UINT32,
+        DATATYPE_INT64,
+        DATATYPE_UINT64,
+        DATATYPE_REAL32,
+        DATATYPE_REAL64,
+        DATATYPE_COMPLEX32,
+        DATATYPE_COMPLEX64,
+        DATATYPE_ARRAY,
+        DATATYPE_DYNAMIC_ARRAY,
+        DATATYPE_STRUCT,
+        DATATYPE_BITFIELD
+    };
+
+    /// Maps a fixed set of names to enum values.
+    /// The hash function is seeded so that there is no collision between the names. The seed is searched at compile time,
+    /// a lookup takes one hash calculation and one string comparison.
+    template < typename Enum, size_t Count >
+    class PerfectHash
+    {
+    public:
+        struct Entry
+        {
+            std::string_view name;
+            Enum value;
+        };
+
+        /// \throw std::logic_error if there is no collision free seed. Fails to compile if evaluated at compile time.
+        constexpr PerfectHash(const std::array < Entry, Count >& entries, Enum unknown)
+            : m_entries(entries)
+            , m_unknown(unknown)
+        {
+            for (uint32_t seed = 0; seed < MaxSeed; ++seed) {
+                if (tryFill(seed)) {
+                    m_seed = seed;
+                    return;
+                }
+            }
+            throw std::logic_error("no collision free seed found");
+        }
+
+        /// \return The value belonging to the name or the unknown value given on construction
+        constexpr Enum find(std::string_view name) const
+        {
+            uint8_t entryIndex = m_slots[hash(name, m_seed) & (TableSize - 1)];
+            if ((entryIndex != EmptySlot) && (m_entries[entryIndex].name == name)) {
+                return m_entries[entryIndex].value;
+            }
+            return m_unknown;
+        }
+
+    private:
+        static constexpr size_t roundUpToPowerOfTwo(size_t value)
+        {
+            size_t result = 1;
+            while (result < value) {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        /// FNV-1a with seed
+        static constexpr uint32_t hash(std::string_view name, uint32_t seed)
+        {
+            uint32_t value = 2166136261u ^ seed;
+            for (char character : name) {
+                value ^= static_cast < uint8_t > (character);
+                value *= 16777619u;
+            }
+            // the table index is taken from the lower bits, mix in the upper bits.
+            return value ^ (value >> 15);
+        }
+
+        constexpr bool tryFill(uint32_t seed)
+        {
+            for (auto& slot : m_slots) {
+                slot = EmptySlot;
+            }
+            for (size_t entryIndex = 0; entryIndex < Count; ++entryIndex) {
+                uint8_t& slot = m_slots[hash(m_entries[entryIndex].name, seed) & (TableSize - 1)];
+                if (slot != EmptySlot) {
+                    return false;
+                }
+                slot = static_cast < uint8_t > (entryIndex);
+            }
+            return true;
+        }
+
+        static_assert(Count < 255, "too many entries");
+        /// Some space helps finding a seed quickly
+        static constexpr size_t TableSize = roundUpToPowerOfTwo(2 * Count);
+        static constexpr uint8_t EmptySlot = 0xff;
+        static constexpr uint32_t MaxSeed = 100000;
+
+        std::array < Entry, Count > m_entries;
+        Enum m_unknown;
+        uint32_t m_seed = 0;
+        std::array < uint8_t, TableSize > m_slots = {};
+    };
+
+    static constexpr PerfectHash < MethodType, 8 > s_methodTypes({ {
+        { META_METHOD_APIVERSION, METHODTYPE_APIVERSION },
+        { META_METHOD_INIT, METHODTYPE_INIT },
+        { META_METHOD_AVAILABLE, METHODTYPE_AVAILABLE },
+        { META_METHOD_UNAVAILABLE, METHODTYPE_UNAVAILABLE },
+        { META_METHOD_ALIVE, METHODTYPE_ALIVE },
+        { META_METHOD_SUBSCRIBE, METHODTYPE_SUBSCRIBE },
+        { META_METHOD_UNSUBSCRIBE, METHODTYPE_UNSUBSCRIBE },
+        { META_METHOD_SIGNAL, METHODTYPE_SIGNAL }
+    } }, METHODTYPE_UNKNOWN);
+
+    static constexpr PerfectHash < DataType, 16 > s_dataTypes({ {
+        { DATA_TYPE_INT8, DATATYPE_INT8 },
+        { DATA_TYPE_UINT8, DATATYPE_UINT8 },
+        { DATA_TYPE_INT16, DATATYPE_INT16 },
+        { DATA_TYPE_UINT16, DATATYPE_UINT16 },
+        { DATA_TYPE_INT32, DATATYPE_INT32 },
+        { DATA_TYPE_UINT32, DATATYPE_UINT32 },
+        { DATA_TYPE_INT64, DATATYPE_INT64 },
+        { DATA_TYPE_UINT64, DATATYPE_UINT64 },
+        { DATA_TYPE_REAL32, DATATYPE_REAL32 },
+        { DATA_TYPE_REAL64, DATATYPE_REAL64 },
+        { DATA_TYPE_COMPLEX32, DATATYPE_COMPLEX32 },
+        { DATA_TYPE_COMPLEX64, DATATYPE_COMPLEX64 },
+        { DATA_TYPE_ARRAY, DATATYPE_ARRAY },
+        { DATA_TYPE_DYNAMIC_ARRAY, DATATYPE_DYNAMIC_ARRAY },
+        { DATA_TYPE_STRUCT, DATATYPE_STRUCT },
+        { DATA_TYPE_BITFIELD, DATATYPE_BITFIELD }
+    } }, DATATYPE_UNKNOWN);
+
+    static constexpr PerfectHash < RuleType, 3 > s_ruleTypes({ {
+        { META_RULETYPE_EXPLICIT, RULETYPE_EXPLICIT },
+        { META_RULETYPE_LINEAR, RULETYPE_LINEAR },
+        { META_RULETYPE_CONSTANT, RULETYPE_CONSTANT }
+    } }, RULETYPE_UNKNOWN);
+
+    /// \return METHODTYPE_UNKNOWN if the method is not known
+    constexpr MethodType methodTypeFromName(std::string_view name)
+    {
+        return s_methodTypes.find(name);
+    }
+
+    /// \return DATATYPE_UNKNOWN if the data type is not known
+    constexpr DataType dataTypeFromName(std::string_view name)
+    {
+        return s_dataTypes.find(name);
+    }
+
+    /// \return RULETYPE_UNKNOWN if the rule is not known
+    constexpr RuleType ruleTypeFromName(std::string_view name)
+    {
+        return s_ruleTypes.find(name);
+    }
+}
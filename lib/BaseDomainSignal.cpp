@@ -3,6 +3,7 @@
 
 #include "nlohmann/json.hpp"
 #include "streaming_protocol/BaseDomainSignal.hpp"
+#include "streaming_protocol/TimeTicks.hpp"
 
 #include "streaming_protocol/Types.h"
 
@@ -46,29 +47,18 @@ uint64_t BaseDomainSignal::getTimeTicksPerSecond() const
 
 uint64_t BaseDomainSignal::timeTicksFromNanoseconds(std::chrono::nanoseconds ns, uint64_t m_timeTicksPerSecond)
 {
-    double nsAsUint64 = std::chrono::duration < double >(ns).count();
-    return static_cast<uint64_t>(m_timeTicksPerSecond * nsAsUint64);
+    return TimeTicks::fromNanoseconds(static_cast<uint64_t>(ns.count()), m_timeTicksPerSecond);
 }
 
 std::chrono::nanoseconds BaseDomainSignal::nanosecondsFromTimeTicks(uint64_t timeTicks, uint64_t m_timeTicksPerSecond)
 {
-    uint64_t seconds = timeTicks / m_timeTicksPerSecond;
-    uint64_t subTicks = timeTicks % m_timeTicksPerSecond;
-    subTicks *= 1000000000;
-    subTicks /= m_timeTicksPerSecond;
-    std::chrono::nanoseconds ns(seconds*1000000000);
-    std::chrono::nanoseconds subSecondsNs(subTicks);
-    ns += subSecondsNs;
-    return ns;
+    return std::chrono::nanoseconds(TimeTicks::toNanoseconds(timeTicks, m_timeTicksPerSecond));
 }
 
 uint64_t BaseDomainSignal::timeTicksFromTime(const std::chrono::time_point<std::chrono::system_clock> &time, uint64_t m_timeTicksPerSecond)
 {
     // currently we use the unix epoch as fixed epoch!
-    auto duration = std::chrono::duration<double>(time.time_since_epoch());
-    double timeSinceUnixEpochDouble = duration.count();
-    uint64_t timeTicks = static_cast<uint64_t>(timeSinceUnixEpochDouble * m_timeTicksPerSecond);
-    return timeTicks;
+    return TimeTicks::fromSystemClock(time, m_timeTicksPerSecond);
 }
 
 std::chrono::time_point<std::chrono::system_clock> BaseDomainSignal::timeFromTimeTicks(uint64_t timeTicks, uint64_t m_timeTicksPerSecond)
@@ -102,6 +92,9 @@ void BaseDomainSignal::setTimeStart(uint64_t timeTicks)
 {
     // Start time is send separately since it is generated with the first measured value
     m_startInTicks = timeTicks;
+    if (!isSubscribed()) {
+        return;
+    }
     /// @warning here we rely on a data type uint64_t for the valueindex followed by the value itself. This is some implicit knowledge the client has to have.
     /// The size of a complete value it equals to sizeof(uint64_t) +
     IndexedValue <uint64_t> startValue;
@@ -18,11 +18,13 @@ BaseSignal::BaseSignal(const std::string& signalId, const std::string& tableId,
     , m_tableId(tableId)
     , m_writer(writer)
     , logCallback(logCb)
+    , m_subscriberCount(0)
 {
 }
 
 void BaseSignal::subscribe()
 {
+    m_subscriberCount.fetch_add(1, std::memory_order_relaxed);
     nlohmann::json subscribe;
     subscribe[METHOD] = META_METHOD_SUBSCRIBE;
     subscribe[PARAMS][META_SIGNALID] = m_signalId;
@@ -32,6 +34,9 @@ void BaseSignal::subscribe()
 
 void BaseSignal::unsubscribe()
 {
+    size_t subscriberCount = m_subscriberCount.load(std::memory_order_relaxed);
+    while ((subscriberCount > 0) && !m_subscriberCount.compare_exchange_weak(subscriberCount, subscriberCount - 1, std::memory_order_relaxed)) {
+    }
     nlohmann::json unsubscribe;
     unsubscribe[METHOD] = META_METHOD_UNSUBSCRIBE;
     m_writer.writeMetaInformation(m_signalNumber, unsubscribe);
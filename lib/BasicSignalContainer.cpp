@@ -0,0 +1,216 @@
+#include <nlohmann/json.hpp>
+
+#include "streaming_protocol/BasicSignalContainer.hpp"
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/MetaInformation.hpp"
+#include "streaming_protocol/SubscribedSignal.hpp"
+
+namespace daq::streaming_protocol {
+SignalContainerBase::SignalContainerBase(LogCallback logCb)
+    : logCallback(logCb)
+    , m_subscribedSignals()
+{
+}
+
+int SignalContainerBase::processMetaInformation(SignalNumber signalNumber, const MetaInformation &metaInformation, const SignalMetaCb& signalMetaCb)
+{
+    Signals::const_iterator signalIter;
+    MethodType methodType = metaInformation.methodType();
+    const MsgpackView paramsView = metaInformation.paramsView();
+
+    if (methodType == METHODTYPE_UNSUBSCRIBE) {
+        signalIter = m_subscribedSignals.find(signalNumber);
+        if (signalIter == m_subscribedSignals.end()) {
+            STREAMING_PROTOCOL_LOG_E("Got unsubscribe meta information for signal '{}' that was not subscribed before", signalNumber);
+            return -1;
+        }
+        leaveTable(signalNumber, signalIter->second->tableId());
+    } else if (methodType == METHODTYPE_SUBSCRIBE) {
+        // A new signal!
+        const MsgpackView signalIdNode = paramsView.find(META_SIGNALID);
+        if (!signalIdNode.valid()) {
+            STREAMING_PROTOCOL_LOG_E("Invalid subscribe ack: No signal id!");
+            return -1;
+        }
+        auto subscribedSignal = std::make_unique < SubscribedSignal > (signalNumber, logCallback);
+        //STREAMING_PROTOCOL_LOG_I(":\n\tGot subscribed! (signal number: {})", signalNumber);
+        std::pair < Signals::iterator, bool > result = m_subscribedSignals.emplace(signalNumber, std::move(subscribedSignal));
+        if (result.second==false) {
+            STREAMING_PROTOCOL_LOG_E("Got duplicate subscribe ack for signal number {} with signal id {}!", signalNumber, signalIdNode.toJson().dump());
+            return -1;
+        }
+        signalIter = result.first;
+    } else {
+        signalIter = m_subscribedSignals.find(signalNumber);
+        if (signalIter == m_subscribedSignals.end()) {
+            STREAMING_PROTOCOL_LOG_E("Got meta information '{}' of signal {}, that was not subscribed before. Aborting!", metaInformation.method(), signalNumber);
+            return -1;
+        }
+    }
+    SubscribedSignal& signal = *signalIter->second;
+    // only the routes of the signal and of the signals sharing its tables need to be resolved again
+    const bool routesChanged = (methodType == METHODTYPE_SUBSCRIBE) || (methodType == METHODTYPE_SIGNAL) || (methodType == METHODTYPE_UNSUBSCRIBE);
+    const std::string previousTableId = signal.tableId();
+    // the json document is built only if there is somebody to pass it to
+    nlohmann::json params;
+    int result;
+    if (signalMetaCb) {
+        params = metaInformation.params();
+        result = signal.processSignalMetaInformation(methodType, params);
+    } else {
+        result = signal.processSignalMetaInformation(methodType, paramsView);
+    }
+    if (result != 0) {
+        if (routesChanged) {
+            updateRoute(signalNumber);
+            updateTableRoutes(previousTableId);
+            updateTableRoutes(signal.tableId());
+        }
+        return result;
+    }
+
+    // This has to happen after meta information was processed!
+    if (methodType == METHODTYPE_SIGNAL) {
+        const std::string& tableId = signal.tableId();
+        if (tableId != previousTableId) {
+            // the signal moved to another table
+            leaveTable(signalNumber, previousTableId);
+        }
+        // Perhaps we need to add this to the table members. If it already exists, nothing is changed.
+        if (signal.isTimeSignal()) {
+            m_tables[tableId].timeSignalNumber = signalNumber;
+        } else {
+            m_tables[tableId].dataSignalNumbers.insert(signalNumber);
+        }
+    }
+
+    if (signalMetaCb) {
+        signalMetaCb(signal, metaInformation.method(), params);
+    }
+
+    const std::string tableId = signal.tableId();
+    if (methodType == METHODTYPE_UNSUBSCRIBE) {
+        m_subscribedSignals.erase(signalIter);
+    }
+    if (routesChanged) {
+        updateRoute(signalNumber);
+        updateTableRoutes(tableId);
+        if (tableId != previousTableId) {
+            updateTableRoutes(previousTableId);
+        }
+    }
+    return 0;
+}
+
+std::shared_ptr < SubscribedSignal > SignalContainerBase::releaseSignal(SignalNumber signalNumber)
+{
+    auto signalIter = m_subscribedSignals.find(signalNumber);
+    if (signalIter == m_subscribedSignals.end()) {
+        return nullptr;
+    }
+    std::shared_ptr < SubscribedSignal > signal = std::move(signalIter->second);
+    m_subscribedSignals.erase(signalIter);
+    const std::string tableId = signal->tableId();
+    leaveTable(signalNumber, tableId);
+    updateRoute(signalNumber);
+    updateTableRoutes(tableId);
+    // the time signal belongs to this container, the new one resolves it again
+    signal->setTimeSignal(nullptr);
+    return signal;
+}
+
+int SignalContainerBase::adoptSignal(std::shared_ptr < SubscribedSignal > signal)
+{
+    const SignalNumber signalNumber = signal->signalNumber();
+    if (!m_subscribedSignals.emplace(signalNumber, signal).second) {
+        STREAMING_PROTOCOL_LOG_E("Can not adopt signal number {} with signal id {}, it is subscribed already!", signalNumber, signal->signalId());
+        return -1;
+    }
+    const std::string& tableId = signal->tableId();
+    if (signal->isTimeSignal()) {
+        m_tables[tableId].timeSignalNumber = signalNumber;
+    } else {
+        m_tables[tableId].dataSignalNumbers.insert(signalNumber);
+    }
+    updateRoute(signalNumber);
+    updateTableRoutes(tableId);
+    return 0;
+}
+
+void SignalContainerBase::updateRoute(SignalNumber signalNumber)
+{
+    const auto signalIter = m_subscribedSignals.find(signalNumber);
+    if (signalIter == m_subscribedSignals.end()) {
+        if (signalNumber < m_routes.size()) {
+            m_routes[signalNumber] = Route();
+        } else {
+            m_sparseRoutes.erase(signalNumber);
+        }
+        return;
+    }
+
+    Route* route;
+    if (signalNumber < s_indexedRouteCount) {
+        if (signalNumber >= m_routes.size()) {
+            m_routes.resize(signalNumber + 1);
+        }
+        route = &m_routes[signalNumber];
+    } else {
+        route = &m_sparseRoutes[signalNumber];
+    }
+    *route = Route();
+
+    const std::shared_ptr < SubscribedSignal >& signal = signalIter->second;
+    route->signal = signal.get();
+
+    const auto tableIter = m_tables.find(signal->tableId());
+    if (tableIter == m_tables.end()) {
+        return;
+    }
+    const Table& table = tableIter->second;
+    if (signal->isTimeSignal()) {
+        route->hasDataSignals = !table.dataSignalNumbers.empty();
+    } else {
+        route->hasTable = true;
+        if (table.timeSignalNumber != 0) {
+            auto timeSignalIter = m_subscribedSignals.find(table.timeSignalNumber);
+            if (timeSignalIter != m_subscribedSignals.end()) {
+                route->timeSignal = timeSignalIter->second;
+            }
+        }
+        signal->setTimeSignal(route->timeSignal);
+    }
+}
+
+void SignalContainerBase::updateTableRoutes(const std::string& tableId)
+{
+    const auto tableIter = m_tables.find(tableId);
+    if (tableIter == m_tables.end()) {
+        return;
+    }
+    const Table& table = tableIter->second;
+    if (table.timeSignalNumber != 0) {
+        updateRoute(table.timeSignalNumber);
+    }
+    for (SignalNumber dataSignalNumber : table.dataSignalNumbers) {
+        updateRoute(dataSignalNumber);
+    }
+}
+
+void SignalContainerBase::leaveTable(SignalNumber signalNumber, const std::string& tableId)
+{
+    auto tableIter = m_tables.find(tableId);
+    if (tableIter == m_tables.end()) {
+        return;
+    }
+    Table& table = tableIter->second;
+    if (table.timeSignalNumber == signalNumber) {
+        table.timeSignalNumber = 0;
+    }
+    table.dataSignalNumbers.erase(signalNumber);
+    if ((table.timeSignalNumber == 0) && (table.dataSignalNumbers.empty())) {
+        // table is empty!
+        m_tables.erase(tableIter);
+    }
+}
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cstring>
+
+#include "BlockAccumulator.hpp"
+
+namespace daq::streaming_protocol {
+    BlockAccumulator::BlockAccumulator(size_t blockCapacity, std::chrono::microseconds maxLatency, DataAsBlocksCb cb)
+        : m_blockCapacity(blockCapacity)
+        , m_maxLatency(maxLatency)
+        , m_cb(cb)
+    {
+    }
+
+    BlockAccumulator::Block& BlockAccumulator::block(SignalNumber signalNumber)
+    {
+        std::unique_ptr < Block >* block;
+        if (signalNumber < s_indexedBlockCount) {
+            if (signalNumber >= m_blocks.size()) {
+                m_blocks.resize(signalNumber + 1);
+            }
+            block = &m_blocks[signalNumber];
+        } else {
+            block = &m_sparseBlocks[signalNumber];
+        }
+        if (!*block) {
+            *block = std::make_unique < Block > ();
+        }
+        return **block;
+    }
+
+    BlockAccumulator::Block* BlockAccumulator::findBlock(SignalNumber signalNumber)
+    {
+        if (signalNumber < m_blocks.size()) {
+            return m_blocks[signalNumber].get();
+        }
+        if ((signalNumber < s_indexedBlockCount) || m_sparseBlocks.empty()) {
+            return nullptr;
+        }
+        const auto blockIter = m_sparseBlocks.find(signalNumber);
+        if (blockIter == m_sparseBlocks.end()) {
+            return nullptr;
+        }
+        return blockIter->second.get();
+    }
+
+    void BlockAccumulator::add(const SubscribedSignal& signal, const uint64_t* timeStamps, const uint8_t* data, size_t valueCount, size_t valueSize)
+    {
+        Block& block = this->block(signal.signalNumber());
+        if ((block.valueCount > 0) && ((block.signal != &signal) || (block.valueSize != valueSize))) {
+            // values of different layout do not fit into the same block
+            deliver(block);
+        }
+        block.signal = &signal;
+        if (block.valueSize != valueSize) {
+            block.valueSize = valueSize;
+            block.data.resize(m_blockCapacity * valueSize);
+        }
+        if (block.timeStamps.empty()) {
+            block.timeStamps.resize(m_blockCapacity);
+        }
+
+        while (valueCount > 0) {
+            if (block.valueCount == 0) {
+                if (m_pendingBlocks.empty()) {
+                    m_deadline = std::chrono::steady_clock::now() + m_maxLatency;
+                }
+                block.pendingIndex = m_pendingBlocks.size();
+                m_pendingBlocks.push_back(&block);
+            }
+            size_t count = std::min(valueCount, m_blockCapacity - block.valueCount);
+            memcpy(block.timeStamps.data() + block.valueCount, timeStamps, count * sizeof(uint64_t));
+            memcpy(block.data.data() + block.valueCount * valueSize, data, count * valueSize);
+            block.valueCount += count;
+            timeStamps += count;
+            data += count * valueSize;
+            valueCount -= count;
+            if (block.valueCount == m_blockCapacity) {
+                deliver(block);
+            }
+        }
+    }
+
+    void BlockAccumulator::poll()
+    {
+        if (!m_pendingBlocks.empty() && (std::chrono::steady_clock::now() >= m_deadline)) {
+            flush();
+        }
+    }
+
+    void BlockAccumulator::flush()
+    {
+        if (m_pendingBlocks.empty()) {
+            return;
+        }
+        m_signalBlocks.clear();
+        for (const Block* block : m_pendingBlocks) {
+            m_signalBlocks.push_back({ block->signal, block->timeStamps.data(), block->data.data(), block->valueSize, block->valueCount });
+        }
+        m_cb(m_signalBlocks.data(), m_signalBlocks.size());
+        for (Block* block : m_pendingBlocks) {
+            block->valueCount = 0;
+        }
+        m_pendingBlocks.clear();
+    }
+
+    void BlockAccumulator::flush(SignalNumber signalNumber)
+    {
+        Block* block = findBlock(signalNumber);
+        if (block && (block->valueCount > 0)) {
+            deliver(*block);
+        }
+    }
+
+    void BlockAccumulator::deliver(Block& block)
+    {
+        SignalBlock signalBlock = { block.signal, block.timeStamps.data(), block.data.data(), block.valueSize, block.valueCount };
+        m_cb(&signalBlock, 1);
+        block.valueCount = 0;
+        // the last pending block takes the place of the delivered one
+        Block* lastBlock = m_pendingBlocks.back();
+        lastBlock->pendingIndex = block.pendingIndex;
+        m_pendingBlocks[block.pendingIndex] = lastBlock;
+        m_pendingBlocks.pop_back();
+    }
+}
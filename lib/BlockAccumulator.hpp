@@ -0,0 +1,91 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "streaming_protocol/SignalContainer.hpp"
+#include "streaming_protocol/SubscribedSignal.hpp"
+#include "streaming_protocol/Types.h"
+
+namespace daq::streaming_protocol {
+    /// Accumulates values and time stamps of each signal in columnar blocks of fixed capacity (see SignalContainer::enableBlocks()).
+    /// -The memory of a block is allocated when the signal delivers its first values and reused afterwards.
+    /// -Not thread safe. Used by the thread processing the measured data.
+    class BlockAccumulator
+    {
+    public:
+        BlockAccumulator(size_t blockCapacity, std::chrono::microseconds maxLatency, DataAsBlocksCb cb);
+
+        BlockAccumulator(const BlockAccumulator&) = delete;
+        BlockAccumulator& operator=(const BlockAccumulator&) = delete;
+
+        /// Appends values, full blocks are delivered immediately
+        /// \param valueSize Size of each value in bytes
+        void add(const SubscribedSignal& signal, const uint64_t* timeStamps, const uint8_t* data, size_t valueCount, size_t valueSize);
+
+        /// Delivers all pending blocks if the deadline expired. There is no timer, the deadline is checked only when this is called.
+        void poll();
+
+        /// Delivers all pending blocks together, in the order they got pending
+        void flush();
+
+        /// Delivers the pending block of a signal
+        void flush(SignalNumber signalNumber);
+
+    private:
+        struct Block
+        {
+            const SubscribedSignal* signal = nullptr;
+            std::vector < uint64_t > timeStamps;
+            std::vector < uint8_t > data;
+            size_t valueSize = 0;
+            size_t valueCount = 0;
+            /// Position in m_pendingBlocks while holding values
+            size_t pendingIndex = 0;
+        };
+
+        /// Signal numbers from here on are not used as index. A single large signal number does not allocate a huge vector.
+        static constexpr SignalNumber s_indexedBlockCount = 4096;
+
+        /// \return The block of the signal number, created if there is none
+        Block& block(SignalNumber signalNumber);
+        /// \return nullptr if there is no block for the signal number
+        Block* findBlock(SignalNumber signalNumber);
+        void deliver(Block& block);
+
+        size_t m_blockCapacity;
+        std::chrono::steady_clock::duration m_maxLatency;
+        DataAsBlocksCb m_cb;
+        /// Signal number is the index. Covers all signal numbers up to the highest one below s_indexedBlockCount values arrived for.
+        /// Blocks do not move, they are referenced by m_pendingBlocks.
+        std::vector < std::unique_ptr < Block > > m_blocks;
+        /// Signal number is the key. Blocks of signal numbers from s_indexedBlockCount on.
+        std::unordered_map < SignalNumber, std::unique_ptr < Block > > m_sparseBlocks;
+        /// Blocks holding values. Flushing visits these only, not all blocks.
+        std::vector < Block* > m_pendingBlocks;
+        /// Pending blocks are to be delivered latest at this point in time
+        std::chrono::steady_clock::time_point m_deadline;
+        /// Reused when delivering several blocks at once
+        std::vector < SignalBlock > m_signalBlocks;
+    };
+}
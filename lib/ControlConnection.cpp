@@ -0,0 +1,253 @@
+#include <chrono>
+#include <stdexcept>
+
+#include <boost/beast/version.hpp>
+
+#include "streaming_protocol/jsonrpc_defines.hpp"
+
+#include "ControlConnection.hpp"
+
+#include "stream/utils/boost_compatibility_utils.hpp"
+
+namespace daq::streaming_protocol {
+    namespace http = boost::beast::http;
+    using tcp = boost::asio::ip::tcp;
+
+    static const std::chrono::seconds timeout(30);
+
+    ControlConnection::ControlConnection(boost::asio::io_context& ioc, const std::string& host, const std::string& port, const std::string& target, unsigned int protocolVersion,
+                                         LogCallback logCb)
+        : m_host(host)
+        , m_port(port)
+        , m_target(target)
+        , m_protocolVersion(protocolVersion)
+        , m_resolver(ioc)
+        , m_stream(ioc)
+        , m_state(STATE_CLOSED)
+        , m_writtenCount(0)
+        , m_writing(false)
+        , m_reading(false)
+        , m_responseCount(0)
+        , m_connectCount(0)
+        , m_generation(0)
+        , logCallback(logCb)
+    {
+        if(m_host.empty()) {
+            m_host = "localhost";
+        }
+
+        if(m_port.empty()) {
+            throw std::runtime_error("port not provided");
+        }
+
+        if(m_target.empty()) {
+            throw std::runtime_error("target not provided");
+        }
+    }
+
+    void ControlConnection::post(const std::string& request, ResultCb resultCb)
+    {
+        STREAMING_PROTOCOL_LOG_D("{} target: {} request: {}", __FUNCTION__, m_target, request);
+        PendingRequest pendingRequest;
+        pendingRequest.request.version(m_protocolVersion);
+        pendingRequest.request.method(http::verb::post);
+        pendingRequest.request.target(m_target);
+        pendingRequest.request.set(http::field::host, m_host);
+        pendingRequest.request.set(http::field::content_type, "application/json; charset=utf-8");
+        pendingRequest.request.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+        pendingRequest.request.keep_alive(m_protocolVersion >= 11);
+        pendingRequest.request.body() = request;
+        pendingRequest.request.prepare_payload();
+        pendingRequest.resultCb = resultCb;
+        m_pendingRequests.emplace_back(std::move(pendingRequest));
+
+        if (m_state == STATE_CLOSED) {
+            connect();
+        } else {
+            doWrite();
+        }
+    }
+
+    void ControlConnection::close()
+    {
+        closeSocket();
+        completeAll(boost::asio::error::operation_aborted);
+    }
+
+    size_t ControlConnection::connectCount() const
+    {
+        return m_connectCount;
+    }
+
+    void ControlConnection::connect()
+    {
+        m_state = STATE_CONNECTING;
+        m_resolver.async_resolve(m_host, m_port, [self = shared_from_this(), generation = m_generation](const boost::system::error_code& ec, const tcp::resolver::results_type& results)
+        {
+            if (generation == self->m_generation) {
+                self->onResolve(ec, results);
+            }
+        });
+    }
+
+    void ControlConnection::onResolve(const boost::system::error_code& ec, const tcp::resolver::results_type& results)
+    {
+        if (ec) {
+            fail(ec, "resolve");
+            return;
+        }
+        m_stream.expires_after(timeout);
+        m_stream.async_connect(results, [self = shared_from_this(), generation = m_generation](const boost::system::error_code& ec, const tcp::endpoint&)
+        {
+            if (generation == self->m_generation) {
+                self->onConnect(ec);
+            }
+        });
+    }
+
+    void ControlConnection::onConnect(const boost::system::error_code& ec)
+    {
+        if (ec) {
+            fail(ec, "connect");
+            return;
+        }
+        m_state = STATE_CONNECTED;
+        ++m_connectCount;
+        // Pipelined requests are small, they are not to be delayed until the ones before are acknowledged
+        boost::system::error_code optionEc;
+        m_stream.socket().set_option(tcp::no_delay(true), optionEc);
+        doWrite();
+    }
+
+    void ControlConnection::doWrite()
+    {
+        if ((m_state != STATE_CONNECTED) || m_writing || (m_writtenCount == m_pendingRequests.size())) {
+            return;
+        }
+        // Without keep-alive, the producer closes the connection after the first response
+        if ((m_writtenCount > 0) && !m_pendingRequests.front().request.keep_alive()) {
+            return;
+        }
+        m_writing = true;
+        m_stream.expires_after(timeout);
+        // Requests stay at their place in the queue until their response arrived
+        auto self = shared_from_this();
+        auto writeCallback = [self, generation = m_generation](const boost::system::error_code& ec, std::size_t)
+        {
+            if (generation == self->m_generation) {
+                self->onWrite(ec);
+            }
+        };
+        daq::stream::boost_compatibility_utils::async_write(m_stream, m_pendingRequests[m_writtenCount].request, writeCallback);
+    }
+
+    void ControlConnection::onWrite(const boost::system::error_code& ec)
+    {
+        m_writing = false;
+        if (ec) {
+            fail(ec, "write");
+            return;
+        }
+        ++m_writtenCount;
+        if (!m_reading) {
+            doRead();
+        }
+        // pipelined, there is no need to wait for the response
+        doWrite();
+    }
+
+    void ControlConnection::doRead()
+    {
+        m_reading = true;
+        m_response = {};
+        m_stream.expires_after(timeout);
+        http::async_read(m_stream, m_buffer, m_response, [self = shared_from_this(), generation = m_generation](const boost::system::error_code& ec, std::size_t)
+        {
+            if (generation == self->m_generation) {
+                self->onRead(ec);
+            }
+        });
+    }
+
+    void ControlConnection::onRead(const boost::system::error_code& ec)
+    {
+        m_reading = false;
+        if (ec) {
+            fail(ec, "read");
+            return;
+        }
+        ++m_responseCount;
+
+        if (m_response.result() != http::status::ok) {
+            STREAMING_PROTOCOL_LOG_E("Request failed with code {} : {}", m_response.result_int(), m_response.body());
+        } else {
+            STREAMING_PROTOCOL_LOG_D("Request succeeded, response: {}", m_response.body());
+        }
+
+        // Responses to successful requests are json rpc responses. Producers not telling the signals affected respond plain text.
+        nlohmann::json result;
+        if (m_response.result() == http::status::ok) {
+            nlohmann::json response = nlohmann::json::parse(m_response.body(), nullptr, false);
+            if (response.is_object() && response.contains(daq::jsonrpc::RESULT)) {
+                result = response[daq::jsonrpc::RESULT];
+            }
+        }
+
+        ResultCb resultCb = std::move(m_pendingRequests.front().resultCb);
+        m_pendingRequests.pop_front();
+        --m_writtenCount;
+
+        if (!m_response.keep_alive()) {
+            // Requests written after this one are not answered. They are written again on a new connection.
+            closeSocket();
+            if (!m_pendingRequests.empty()) {
+                connect();
+            }
+        } else if (m_writtenCount > 0) {
+            doRead();
+        }
+        doWrite();
+
+        // last, the callback might post further requests
+        resultCb(boost::system::error_code(), result);
+    }
+
+    void ControlConnection::closeSocket()
+    {
+        ++m_generation;
+        m_resolver.cancel();
+        boost::system::error_code ec;
+        m_stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+        m_stream.close();
+        m_buffer.consume(m_buffer.size());
+        m_state = STATE_CLOSED;
+        m_writtenCount = 0;
+        m_writing = false;
+        m_reading = false;
+        m_responseCount = 0;
+    }
+
+    void ControlConnection::fail(const boost::system::error_code& ec, const char* what)
+    {
+        // The producer might have closed the connection while it was idle
+        bool reused = (m_responseCount > 0);
+        closeSocket();
+        if (reused) {
+            STREAMING_PROTOCOL_LOG_D("{}: {}, reconnecting", what, ec.message());
+            connect();
+            return;
+        }
+        STREAMING_PROTOCOL_LOG_E("{}: {}", what, ec.message());
+        completeAll(ec);
+    }
+
+    void ControlConnection::completeAll(const boost::system::error_code& ec)
+    {
+        // Callbacks might post further requests
+        std::deque < PendingRequest > pendingRequests;
+        pendingRequests.swap(m_pendingRequests);
+        for (PendingRequest& pendingRequest : pendingRequests) {
+            pendingRequest.resultCb(ec, nlohmann::json());
+        }
+    }
+}
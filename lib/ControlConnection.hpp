@@ -0,0 +1,115 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <nlohmann/json.hpp>
+
+#include "streaming_protocol/Logging.hpp"
+
+namespace daq::streaming_protocol {
+    /// Keep-alive HTTP connection to the control port of a producer. Replaces a connection per request (HttpPost).
+    /// -Connects with the first request and keeps the connection for all further requests.
+    /// -Requests are pipelined: They are written without waiting for the responses to the requests before. Responses arrive in order.
+    /// -Reconnects with the next request if the producer closed the connection. HTTP 1.0 connections are closed by the producer after each response.
+    /// -A request failing on a connection that was idle before is sent once more on a new connection. The producer might have closed the connection in the meantime.
+    /// All methods are to be called from within the io context.
+    class ControlConnection : public std::enable_shared_from_this < ControlConnection >
+    {
+    public:
+        /// \param result The json rpc result of the response, null if the response does not carry one or on error
+        using ResultCb = std::function < void(const boost::system::error_code& ec, const nlohmann::json& result) >;
+
+        /// \throw std::runtime_error on error
+        /// \param host If empty, we assume localhost
+        /// \param protocolVersion 10 for 1.0, 11 for 1.1
+        ControlConnection(boost::asio::io_context& ioc, const std::string& host, const std::string& port, const std::string& target, unsigned int protocolVersion,
+                          LogCallback logCb);
+        ControlConnection(const ControlConnection&) = delete;
+        ControlConnection& operator=(const ControlConnection&) = delete;
+
+        /// Sends the request as soon as the connection is established
+        /// \param resultCb Called with the response or an error. Requests are completed in order.
+        void post(const std::string& request, ResultCb resultCb);
+
+        /// Closes the connection. Requests not completed yet are completed with boost::asio::error::operation_aborted.
+        void close();
+
+        /// Number of connections established so far
+        size_t connectCount() const;
+
+    private:
+        using Request = boost::beast::http::request < boost::beast::http::string_body >;
+        using Response = boost::beast::http::response < boost::beast::http::string_body >;
+
+        enum State {
+            STATE_CLOSED,
+            STATE_CONNECTING,
+            STATE_CONNECTED
+        };
+
+        struct PendingRequest
+        {
+            Request request;
+            ResultCb resultCb;
+        };
+
+        void connect();
+        void onResolve(const boost::system::error_code& ec, const boost::asio::ip::tcp::resolver::results_type& results);
+        void onConnect(const boost::system::error_code& ec);
+        /// Writes the next request if there is one not written yet
+        void doWrite();
+        void onWrite(const boost::system::error_code& ec);
+        void doRead();
+        void onRead(const boost::system::error_code& ec);
+        /// Closes the socket, the requests not completed yet stay queued
+        void closeSocket();
+        /// Retries on a new connection or completes all requests with the error
+        void fail(const boost::system::error_code& ec, const char* what);
+        void completeAll(const boost::system::error_code& ec);
+
+        std::string m_host;
+        std::string m_port;
+        std::string m_target;
+        unsigned int m_protocolVersion;
+        boost::asio::ip::tcp::resolver m_resolver;
+        boost::beast::tcp_stream m_stream;
+        boost::beast::flat_buffer m_buffer;
+        Response m_response;
+        State m_state;
+        /// Requests not completed yet in the order of sending. The first m_writtenCount of them were written.
+        std::deque < PendingRequest > m_pendingRequests;
+        size_t m_writtenCount;
+        bool m_writing;
+        bool m_reading;
+        /// Responses received on the current connection
+        size_t m_responseCount;
+        size_t m_connectCount;
+        /// Incremented whenever the socket gets closed. Completions belonging to a former connection are ignored.
+        size_t m_generation;
+        LogCallback logCallback;
+    };
+}
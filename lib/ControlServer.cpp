@@ -18,10 +18,13 @@
 #include <boost/beast/http.hpp>
 #include <boost/beast/http/string_body.hpp>
 #include <boost/beast/version.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/asio/ip/v6_only.hpp>
 #include <boost/config.hpp>
 #include <algorithm>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
@@ -47,95 +50,197 @@ using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
 BEGIN_NAMESPACE_STREAMING_PROTOCOL
 
 
-/// This function produces an HTTP response for the given
-/// request. The type of the response object depends on the
-/// contents of the request, so the interface requires the
-/// caller to pass a generic lambda for receiving the response.
-template<class Body, class Allocator, class Send>
-void handle_request(http::request<Body, http::basic_fields<Allocator>>&& req,
-    Send&& send, ControlServer::CommandCb commandCb, LogCallback logCallback)
-{
-    // Returns a bad request response
-    auto const bad_request =
-    [&req, &logCallback](beast::string_view why)
-    {
-        std::string whyAsString(why);
-        http::response<http::string_body> res{http::status::bad_request, req.version()};
-        res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-        res.set(http::field::content_type, "text/html");
-        res.keep_alive(req.keep_alive());
-        res.body() = whyAsString;
-        res.prepare_payload();
-        STREAMING_PROTOCOL_LOG_E("Bad request: {}", whyAsString);
-        return res;
-    };
+/// Completes one json rpc request
+/// \param code 0 on success, the json rpc error code otherwise
+/// \param result The json rpc result on success
+/// \param errorMessage The reason if the request failed
+using RequestCompletionCb = std::function < void(int code, const nlohmann::json& result, const std::string& errorMessage) >;
 
-    // Make sure we can handle the method
-    if( req.method() != http::verb::post) {
-        return send(bad_request("Unknown HTTP-method"));
+/// Executes one json rpc request. Its parameters are an array of signal ids.
+/// Invalid requests are completed right away, valid ones when the command completed.
+static void execute_request(const nlohmann::json& request, ControlServer::ExecuteCb& executeCb, RequestCompletionCb completionCb, LogCallback& logCallback)
+{
+    if (!request.is_object()) {
+        return completionCb(daq::jsonrpc::invalidRequest, nullptr, "json rpc request is not an object");
     }
 
-    /* This is where the magic happens */
-    std::string body = req.body();
-
-
-    auto request = nlohmann::json::parse(body.c_str(), body.c_str() + body.size());
-
-
-    const auto& id = request[daq::jsonrpc::ID];
-    if (id.is_null()) {
-        return send(bad_request("json rpc request without id"));
+    auto id = request.find(daq::jsonrpc::ID);
+    if ((id == request.end()) || id->is_null()) {
+        return completionCb(daq::jsonrpc::invalidRequest, nullptr, "json rpc request without id");
     }
-    const auto& method = request[daq::jsonrpc::METHOD];
-    if (method.is_null()) {
-        return send(bad_request("json rpc request without method"));
+    auto method = request.find(daq::jsonrpc::METHOD);
+    if ((method == request.end()) || !method->is_string()) {
+        return completionCb(daq::jsonrpc::invalidRequest, nullptr, "json rpc request without method");
     }
 
-    std::string methodString = method;
+    std::string methodString = *method;
     static const char delimiter = '.';
     auto pos = methodString.find(delimiter);
     if (pos==std::string::npos) {
-        std::string message("json rpc request with invalid method '" + methodString + "'. Expecting <stream id>.<command>");
-        return send(bad_request(message));
+        return completionCb(daq::jsonrpc::methodNotFound, nullptr, "json rpc request with invalid method '" + methodString + "'. Expecting <stream id>.<command>");
     }
-    std::string streamId = methodString.substr(0, methodString.find(delimiter));
+    std::string streamId = methodString.substr(0, pos);
     std::string command = methodString.substr(pos + sizeof(delimiter));
 
-    const auto& params = request[daq::jsonrpc::PARAMS];
-    if (params.is_null()) {
-        return send(bad_request("json rpc request without parameters"));
+    auto params = request.find(daq::jsonrpc::PARAMS);
+    if ((params == request.end()) || params->is_null()) {
+        return completionCb(daq::jsonrpc::invalidParams, nullptr, "json rpc request without parameters");
     }
-    
-    std::string s_response;
 
     STREAMING_PROTOCOL_LOG_I("Got request '{}' from '{}'", command, streamId);
     // params holds an array of signal ids
     SignalIds signalIds;
-    if (!params.is_array()) {
-        return send(bad_request("Expecting an array of signal ids as parameters"));
+    if (!params->is_array()) {
+        return completionCb(daq::jsonrpc::invalidParams, nullptr, "Expecting an array of signal ids as parameters");
     }
 
-    for (const auto &iter :params) {
+    for (const auto &iter : *params) {
+        if (!iter.is_string()) {
+            return completionCb(daq::jsonrpc::invalidParams, nullptr, "Expecting an array of signal ids as parameters");
+        }
         signalIds.push_back(iter);
     }
 
-    int result = commandCb(streamId, command, signalIds, s_response);
-    if (result < 0)
+    executeCb(streamId, command, signalIds, [completionCb](int status, const nlohmann::json& result, const std::string& errorMessage)
+    {
+        if (status < 0) {
+            completionCb(daq::jsonrpc::internalError, nullptr, "json rpc execution failed: " + errorMessage);
+        } else {
+            completionCb(0, result, std::string());
+        }
+    });
+}
+
+/// Executes all requests of a json rpc batch in one pass
+/// \param completionCb Called with the array of responses, one for each request in the same order, once all requests completed
+static void execute_batch(const nlohmann::json& batch, ControlServer::ExecuteCb& executeCb, std::function < void(const nlohmann::json& responses) > completionCb, LogCallback& logCallback)
+{
+    // Completions are called in the strand of the session one after the other, no locking required
+    struct Responses
     {
-        std::string message("json rpc execution failed: " + s_response);
-        return send(bad_request(message));
+        nlohmann::json responses = nlohmann::json::array();
+        size_t pendingCount = 0;
+    };
+    auto responses = std::make_shared < Responses >();
+    for (const auto& request : batch) {
+        nlohmann::json response;
+        response[daq::jsonrpc::JSONRPC] = "2.0";
+        if (request.is_object() && request.contains(daq::jsonrpc::ID)) {
+            response[daq::jsonrpc::ID] = request[daq::jsonrpc::ID];
+        } else {
+            response[daq::jsonrpc::ID] = nullptr;
+        }
+        responses->responses.push_back(response);
     }
+    // set before the first request is executed, requests might complete right away
+    responses->pendingCount = batch.size();
 
-    std::string res_body = "Succeeded";
+    for (size_t index = 0; index < batch.size(); ++index) {
+        execute_request(batch[index], executeCb, [responses, index, completionCb, logCallback](int code, const nlohmann::json& result, const std::string& errorMessage)
+        {
+            nlohmann::json& response = responses->responses[index];
+            if (code == 0) {
+                response[daq::jsonrpc::RESULT] = result;
+            } else {
+                STREAMING_PROTOCOL_LOG_E("Bad request in batch: {}", errorMessage);
+                response[daq::jsonrpc::ERR][daq::jsonrpc::CODE] = code;
+                response[daq::jsonrpc::ERR][daq::jsonrpc::MESSAGE] = errorMessage;
+            }
+            if (--responses->pendingCount == 0) {
+                completionCb(responses->responses);
+            }
+        }, logCallback);
+    }
+}
+
+/// Returns a bad request response
+static http::response<http::string_body> bad_request(beast::string_view why, unsigned int version, bool keepAlive, LogCallback& logCallback)
+{
+    std::string whyAsString(why);
+    http::response<http::string_body> res{http::status::bad_request, version};
+    res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+    res.set(http::field::content_type, "text/html");
+    res.keep_alive(keepAlive);
+    res.body() = whyAsString;
+    res.prepare_payload();
+    STREAMING_PROTOCOL_LOG_E("Bad request: {}", whyAsString);
+    return res;
+}
+
+/// Returns a response carrying the json rpc response(s)
+static http::response<http::string_body> json_response(std::string&& body, unsigned int version, bool keepAlive)
+{
     http::response<http::string_body> res {
         std::piecewise_construct,
-        std::make_tuple(std::move(res_body)),
-        std::make_tuple(http::status::ok, req.version())
+        std::make_tuple(std::move(body)),
+        std::make_tuple(http::status::ok, version)
     };
     res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
     res.set(http::field::content_type, "application/json");
-    res.keep_alive(req.keep_alive());
-    return send(std::move(res));
+    res.keep_alive(keepAlive);
+    // Without content length, the connection would have to be closed to mark the end of the response
+    res.prepare_payload();
+    return res;
+}
+
+/// This function produces an HTTP response for the given
+/// request. The response is handed to send once the request completed,
+/// send has to be copyable.
+/// A single json rpc request is answered with status bad request if it fails.
+/// A json rpc batch (array of requests) is answered with the array of json rpc responses.
+template<class Body, class Allocator, class Send>
+void handle_request(http::request<Body, http::basic_fields<Allocator>>&& req,
+    Send send, ControlServer::ExecuteCb& executeCb, LogCallback logCallback)
+{
+    unsigned int version = req.version();
+    bool keepAlive = req.keep_alive();
+
+    // Make sure we can handle the method
+    if( req.method() != http::verb::post) {
+        return send(bad_request("Unknown HTTP-method", version, keepAlive, logCallback));
+    }
+
+    /* This is where the magic happens */
+    std::string body = req.body();
+
+
+    auto request = nlohmann::json::parse(body.c_str(), body.c_str() + body.size(), nullptr, false);
+    if (request.is_discarded()) {
+        return send(bad_request("invalid json", version, keepAlive, logCallback));
+    }
+
+    if (request.is_array()) {
+        if (request.empty()) {
+            return send(bad_request("empty json rpc batch", version, keepAlive, logCallback));
+        }
+        execute_batch(request, executeCb, [send, version, keepAlive](const nlohmann::json& responses)
+        {
+            send(json_response(responses.dump(), version, keepAlive));
+        }, logCallback);
+        return;
+    }
+
+    nlohmann::json id;
+    if (request.is_object() && request.contains(daq::jsonrpc::ID)) {
+        id = request[daq::jsonrpc::ID];
+    }
+    execute_request(request, executeCb, [send, version, keepAlive, id, logCallback](int code, const nlohmann::json& result, const std::string& errorMessage) mutable
+    {
+        if (code != 0) {
+            return send(bad_request(errorMessage, version, keepAlive, logCallback));
+        }
+        std::string res_body;
+        if (result.is_string()) {
+            res_body = result;
+        } else {
+            nlohmann::json response;
+            response[daq::jsonrpc::JSONRPC] = "2.0";
+            response[daq::jsonrpc::RESULT] = result;
+            response[daq::jsonrpc::ID] = id;
+            res_body = response.dump();
+        }
+        send(json_response(std::move(res_body), version, keepAlive));
+    }, logCallback);
 }
 
 static void log_error(beast::error_code ec, char const* what, LogCallback logCallback)
@@ -144,64 +249,71 @@ static void log_error(beast::error_code ec, char const* what, LogCallback logCal
 }
 
 /// Handles an HTTP server connection
+/// Requests are read ahead while earlier ones are being executed, responses are sent in the order of the requests.
+/// All handlers and completions run in the strand of the connection.
 class session : public std::enable_shared_from_this<session>
 {
-    // This is the C++11 equivalent of a generic lambda.
-    // The function object is used to send an HTTP message.
-    struct send_lambda
-    {
-        session& m_self;
-
-        explicit send_lambda(session& self)
-            : m_self(self)
-        {
-        }
-
-        template<bool isRequest, class Body, class Fields>
-        void
-        operator()(http::message<isRequest, Body, Fields>&& msg) const
-        {
-            // The lifetime of the message has to extend
-            // for the duration of the async operation so
-            // we use a shared_ptr to manage it.
-            auto sp = std::make_shared<http::message<isRequest, Body, Fields>>(std::move(msg));
-
-            // Store a type-erased version of the shared
-            // pointer in the class to keep it alive.
-            m_self.m_res = sp;
-
-            // Write the response
-            http::async_write(
-                m_self.m_stream,
-                *sp,
-                beast::bind_front_handler(
-                    &session::on_write,
-                    m_self.shared_from_this(),
-                    sp->need_eof()));
-        }
-    };
+    /// Reading is paused while this many responses are pending
+    static const size_t MaxPendingResponses = 16;
+    /// For reading a request while no response is pending and for writing a response
+    static constexpr std::chrono::seconds Timeout = std::chrono::seconds(30);
 
     beast::tcp_stream m_stream;
     beast::flat_buffer m_buffer;
     http::request<http::string_body> m_req;
-    std::shared_ptr<void> m_res;
-    send_lambda m_lambda;
-    ControlServer::CommandCb m_commandCb;
+    /// Responses in the order of the requests read, empty until the request completed
+    std::deque < std::shared_ptr < http::response < http::string_body > > > m_responses;
+    /// Sequence number of the first response in m_responses
+    uint64_t m_firstSequence;
+    bool m_reading;
+    /// Set if the pending read was started while responses were outstanding. It has no expiry.
+    bool m_readWithoutExpiry;
+    bool m_writing;
+    /// Takes over the expiry of a read without expiry once all responses are written
+    net::steady_timer m_idleTimer;
+    /// Set when no more requests are to be read
+    bool m_readClosed;
+    ControlServer::ExecuteCb m_executeCb;
+    /// Executes the command and hands the completion to the strand of the session
+    ControlServer::ExecuteCb m_strandExecuteCb;
     LogCallback logCallback;
 
 public:
-    session(tcp::socket&& socket, ControlServer::CommandCb commandCb, LogCallback logCb)
+    session(tcp::socket&& socket, ControlServer::ExecuteCb executeCb, LogCallback logCb)
         : m_stream(std::move(socket))
-        , m_lambda(*this)
-        , m_commandCb(commandCb)
+        , m_firstSequence(0)
+        , m_reading(false)
+        , m_readWithoutExpiry(false)
+        , m_writing(false)
+        , m_idleTimer(m_stream.get_executor())
+        , m_readClosed(false)
+        , m_executeCb(executeCb)
         , logCallback(logCb)
     {
+        // Only called from within handle_request(), the session is alive
+        m_strandExecuteCb = [this](const std::string& streamId, const std::string& command, const SignalIds& signalIds, ControlServer::ExecuteCompletionCb completionCb)
+        {
+            auto self = shared_from_this();
+            m_executeCb(streamId, command, signalIds, [self, completionCb](int status, const nlohmann::json& result, const std::string& errorMessage)
+            {
+                // Might be called from any thread. Runs right away when called from within the strand.
+                net::dispatch(self->m_stream.get_executor(), [completionCb, status, result, errorMessage]()
+                {
+                    completionCb(status, result, errorMessage);
+                });
+            });
+        };
     }
 
     // Start the asynchronous operation
     void run()
     {
-        do_read();
+        // We need to be executing within a strand to perform async operations
+        // on the I/O objects in this session.
+        net::dispatch(m_stream.get_executor(),
+            beast::bind_front_handler(
+                &session::do_read,
+                shared_from_this()));
     }
 
     void do_read()
@@ -210,10 +322,17 @@ public:
         // otherwise the operation behavior is undefined.
         m_req = {};
 
-        // Set the timeout.
-        m_stream.expires_after(std::chrono::seconds(30));
+        // Set the timeout. Not while responses are outstanding, a command completing late must not end the session.
+        // The expiry of a pending read can not be changed later.
+        m_readWithoutExpiry = !m_responses.empty();
+        if (m_readWithoutExpiry) {
+            m_stream.expires_never();
+        } else {
+            m_stream.expires_after(Timeout);
+        }
 
         // Read a request
+        m_reading = true;
         http::async_read(m_stream, m_buffer, m_req,
             beast::bind_front_handler(
                 &session::on_read,
@@ -223,10 +342,16 @@ public:
     void on_read(beast::error_code ec, std::size_t bytes_transferred)
     {
         boost::ignore_unused(bytes_transferred);
+        m_reading = false;
+        m_idleTimer.cancel();
 
         // This means they closed the connection
         if(ec == http::error::end_of_stream) {
-            do_close();
+            // Pending responses are sent before
+            m_readClosed = true;
+            if (m_responses.empty()) {
+                do_close();
+            }
             return;
         }
 
@@ -235,13 +360,60 @@ public:
             return;
         }
 
+        // The connection is closed after the response
+        if (!m_req.keep_alive()) {
+            m_readClosed = true;
+        }
+
         // Handle request and send the response
-        handle_request(std::move(m_req), m_lambda, m_commandCb, logCallback);
+        uint64_t sequence = m_firstSequence + m_responses.size();
+        m_responses.emplace_back();
+        auto self = shared_from_this();
+        handle_request(std::move(m_req), [self, sequence](http::response<http::string_body>&& res)
+        {
+            self->respond(sequence, std::move(res));
+        }, m_strandExecuteCb, logCallback);
+
+        // Read ahead
+        if (!m_readClosed && (m_responses.size() < MaxPendingResponses)) {
+            do_read();
+        }
+    }
+
+    void respond(uint64_t sequence, http::response<http::string_body>&& res)
+    {
+        // The lifetime of the message has to extend
+        // for the duration of the async operation so
+        // we use a shared_ptr to manage it.
+        m_responses[sequence - m_firstSequence] = std::make_shared < http::response < http::string_body > >(std::move(res));
+        do_write();
+    }
+
+    /// Writes the first response if it is complete
+    void do_write()
+    {
+        if (m_writing || m_responses.empty() || !m_responses.front()) {
+            return;
+        }
+
+        // Applies to the write only while a read is pending
+        m_stream.expires_after(Timeout);
+
+        // Write the response
+        m_writing = true;
+        http::async_write(
+            m_stream,
+            *m_responses.front(),
+            beast::bind_front_handler(
+                &session::on_write,
+                shared_from_this(),
+                m_responses.front()->need_eof()));
     }
 
     void on_write( bool close, beast::error_code ec, std::size_t bytes_transferred)
     {
         boost::ignore_unused(bytes_transferred);
+        m_writing = false;
 
         if(ec) {
             log_error(ec, "write", logCallback);
@@ -256,10 +428,38 @@ public:
         }
 
         // We're done with the response so delete it
-        m_res = nullptr;
+        m_responses.pop_front();
+        ++m_firstSequence;
+
+        if (m_responses.empty() && m_readClosed) {
+            do_close();
+            return;
+        }
+        do_write();
 
         // Read another request
-        do_read();
+        if (!m_reading && !m_readClosed && (m_responses.size() < MaxPendingResponses)) {
+            do_read();
+        }
+
+        if (m_responses.empty() && m_reading && m_readWithoutExpiry) {
+            wait_idle();
+        }
+    }
+
+    /// Closes the session if the pending read does not complete in time, as its expiry would do
+    void wait_idle()
+    {
+        m_idleTimer.expires_after(Timeout);
+        m_idleTimer.async_wait(
+            [self = shared_from_this()](beast::error_code ec)
+            {
+                // A request read in the meantime does not cancel a completed wait
+                if (ec || !self->m_reading || !self->m_readWithoutExpiry || !self->m_responses.empty()) {
+                    return;
+                }
+                self->m_stream.close();
+            });
     }
 
     void do_close()
@@ -279,14 +479,14 @@ class listener : public std::enable_shared_from_this<listener>
 {
     net::io_context& m_ioc;
     tcp::acceptor m_acceptor;
-    ControlServer::CommandCb m_commandCb;
+    ControlServer::ExecuteCb m_executeCb;
     LogCallback logCallback;
 
 public:
-    listener(net::io_context& ioc, const tcp::endpoint& endpoint, ControlServer::CommandCb commandCb, LogCallback logCb)
+    listener(net::io_context& ioc, const tcp::endpoint& endpoint, ControlServer::ExecuteCb executeCb, LogCallback logCb)
         : m_ioc(ioc)
         , m_acceptor(ioc)
-        , m_commandCb(commandCb)
+        , m_executeCb(executeCb)
         , logCallback(logCb)
     {
         beast::error_code ec;
@@ -344,7 +544,7 @@ private:
     {
         // The new connection gets its own strand
         m_acceptor.async_accept(
-            m_ioc,
+            net::make_strand(m_ioc),
             beast::bind_front_handler(
                 &listener::on_accept,
                 shared_from_this()));
@@ -354,9 +554,16 @@ private:
     {
         if(ec) {
             log_error(ec, "accept", logCallback);
+            if(!m_acceptor.is_open()) {
+                // stopped
+                return;
+            }
         } else {
+            // Responses to pipelined requests are not to be delayed until the ones before are acknowledged
+            beast::error_code optionEc;
+            socket.set_option(tcp::no_delay(true), optionEc);
             // Create the session and run it
-            std::make_shared<session>(std::move(socket), m_commandCb, logCallback)->run();
+            std::make_shared<session>(std::move(socket), m_executeCb, logCallback)->run();
         }
 
         // Accept another connection
@@ -369,10 +576,42 @@ private:
 ControlServer::ControlServer(boost::asio::io_context& ioc, uint16_t port, CommandCb commandCb, LogCallback logCb)
     : m_ioc(ioc)
     , m_port(port)
-    , m_commandCb(commandCb)
     , logCallback(logCb)
 {
+    m_executeCb = [commandCb](const std::string& streamId, const std::string& command, const SignalIds& signalIds, ExecuteCompletionCb completionCb)
+    {
+        std::string errorMessage;
+        int status = commandCb(streamId, command, signalIds, errorMessage);
+        completionCb(status, "Succeeded", errorMessage);
+    };
+}
 
+ControlServer::ControlServer(boost::asio::io_context& ioc, uint16_t port, ResolvingCommandCb commandCb, LogCallback logCb)
+    : m_ioc(ioc)
+    , m_port(port)
+    , logCallback(logCb)
+{
+    m_executeCb = [commandCb](const std::string& streamId, const std::string& command, const SignalIds& signalIds, ExecuteCompletionCb completionCb)
+    {
+        SignalIds resolvedSignalIds;
+        std::string errorMessage;
+        int status = commandCb(streamId, command, signalIds, resolvedSignalIds, errorMessage);
+        completionCb(status, resolvedSignalIds, errorMessage);
+    };
+}
+
+ControlServer::ControlServer(boost::asio::io_context& ioc, uint16_t port, AsyncCommandCb commandCb, LogCallback logCb)
+    : m_ioc(ioc)
+    , m_port(port)
+    , logCallback(logCb)
+{
+    m_executeCb = [commandCb](const std::string& streamId, const std::string& command, const SignalIds& signalIds, ExecuteCompletionCb completionCb)
+    {
+        commandCb(streamId, command, signalIds, [completionCb](int status, const SignalIds& resolvedSignalIds, const std::string& errorMessage)
+        {
+            completionCb(status, resolvedSignalIds, errorMessage);
+        });
+    };
 }
 
 ControlServer::~ControlServer()
@@ -384,7 +623,7 @@ void ControlServer::start()
 {
     try {
         // listen to any interface using ipv4
-        m_listener_v4 = std::make_shared<listener>(m_ioc, tcp::endpoint{net::ip::tcp::v4(), m_port}, m_commandCb, logCallback);
+        m_listener_v4 = std::make_shared<listener>(m_ioc, tcp::endpoint{net::ip::tcp::v4(), m_port}, m_executeCb, logCallback);
         m_listener_v4->run();
     }
     catch (const std::exception& e) {
@@ -393,7 +632,7 @@ void ControlServer::start()
 
     try {
         // listen to any interface using ipv6
-        m_listener_v6 = std::make_shared<listener>(m_ioc, tcp::endpoint{net::ip::tcp::v6(), m_port}, m_commandCb, logCallback);
+        m_listener_v6 = std::make_shared<listener>(m_ioc, tcp::endpoint{net::ip::tcp::v6(), m_port}, m_executeCb, logCallback);
         m_listener_v6->run();
     }
     catch (const std::exception& e) {
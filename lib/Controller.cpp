@@ -1,4 +1,8 @@
-﻿#include <sstream>
+﻿#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include <boost/asio/dispatch.hpp>
 
 #include <nlohmann/json.hpp>
 
@@ -10,32 +14,156 @@
 namespace daq::streaming_protocol {
     unsigned int Controller::s_id = 0;
 
+    Controller::State::State(boost::asio::io_context& ioc, daq::streaming_protocol::LogCallback logCb)
+        : m_ioc(ioc)
+        , m_mergeWindow(0)
+        , m_mergeTimer(ioc)
+        , m_flushScheduled(false)
+        , m_closed(false)
+        , m_requestCount(0)
+        , logCallback(logCb)
+    {
+    }
+
     Controller::Controller(boost::asio::io_context& ioc, const std::string& streamId, const std::string& address, const std::string& port, const std::string& target, unsigned int httpVersion,
                            daq::streaming_protocol::LogCallback logCb)
-        : m_ioc(ioc)
-        , m_streamId(streamId)
-        , m_address(address)
-        , m_port(port)
-        , m_target(target)
-        , m_httpVersion(httpVersion)
+        : m_state(std::make_shared < State > (ioc, logCb))
         , logCallback(logCb)
     {
-        if(m_streamId.empty()) {
+        if(streamId.empty()) {
             throw std::runtime_error("No stream id provided");
         }
+        m_state->m_streamId = streamId;
+        m_state->m_connection = std::make_shared < ControlConnection > (ioc, address, port, target, httpVersion, logCb);
     }
 
-    void Controller::execute(const nlohmann::json &request, HttpPost::ResultCb resultCb)
+    Controller::Controller(boost::asio::io_context& ioc, SendCb sendCb, daq::streaming_protocol::LogCallback logCb)
+        : m_state(std::make_shared < State > (ioc, logCb))
+        , logCallback(logCb)
+    {
+        m_state->m_sendCb = sendCb;
+    }
+
+    Controller::~Controller()
     {
-        std::string requestString = request.dump();
-        auto m_httpPost = std::make_shared < HttpPost> (m_ioc, m_address, m_port, m_target, m_httpVersion, logCallback);
-        m_httpPost->run(requestString, resultCb);
+        // handlers still queued do not send anything anymore
+        m_state->close();
+    }
+
+    void Controller::setMergeWindow(std::chrono::microseconds mergeWindow)
+    {
+        m_state->m_mergeWindow = mergeWindow;
+    }
+
+    void Controller::enqueue(const SignalIds& signalIds, const char* method, ResultCb resultCb)
+    {
+        // Calls might be made from outside the io context. The handler keeps the state alive.
+        std::shared_ptr < State > state = m_state;
+        boost::asio::dispatch(state->m_ioc, [state, signalIds, method, resultCb]()
+        {
+            state->enqueue(signalIds, method, resultCb, state);
+        });
+    }
+
+    void Controller::State::enqueue(const SignalIds& signalIds, const char* method, ResultCb resultCb, const std::shared_ptr < State >& self)
+    {
+        if (m_closed) {
+            resultCb(boost::asio::error::operation_aborted, nlohmann::json());
+            return;
+        }
+
+        if (m_pendingCalls.empty() || (strcmp(m_pendingCalls.back().method, method) != 0)) {
+            m_pendingCalls.push_back(PendingCall{ method, SignalIds(), std::unordered_set < std::string >(), std::vector < ResultCb >() });
+        }
+        PendingCall& pendingCall = m_pendingCalls.back();
+        for (const std::string& signalId : signalIds) {
+            if (pendingCall.signalIdSet.insert(signalId).second) {
+                pendingCall.signalIds.push_back(signalId);
+            }
+        }
+        pendingCall.resultCbs.push_back(resultCb);
+
+        if (m_flushScheduled) {
+            return;
+        }
+        m_flushScheduled = true;
+        m_mergeTimer.expires_after(m_mergeWindow);
+        // A completion already queued is not stopped by canceling the timer, it finds the state closed then.
+        m_mergeTimer.async_wait([self](const boost::system::error_code& ec)
+        {
+            if ((ec == boost::asio::error::operation_aborted) || (self->m_closed)) {
+                return;
+            }
+            self->flush();
+        });
+    }
+
+    void Controller::State::flush()
+    {
+        m_flushScheduled = false;
+        std::vector < PendingCall > pendingCalls;
+        pendingCalls.swap(m_pendingCalls);
+        for (PendingCall& pendingCall : pendingCalls) {
+            ++m_requestCount;
+            ResultCb resultCb = [resultCbs = std::move(pendingCall.resultCbs)](const boost::system::error_code& ec, const nlohmann::json& result)
+            {
+                for (const ResultCb& resultCb : resultCbs) {
+                    resultCb(ec, result);
+                }
+            };
+            if (m_sendCb) {
+                m_sendCb(pendingCall.method, pendingCall.signalIds, resultCb);
+                continue;
+            }
+            nlohmann::json request = createRequest(pendingCall.signalIds, pendingCall.method);
+            m_connection->post(request.dump(), resultCb);
+        }
+    }
+
+    void Controller::State::close()
+    {
+        if (m_closed) {
+            return;
+        }
+        m_closed = true;
+        m_mergeTimer.cancel();
+        m_flushScheduled = false;
+        // the send callback might refer to the owner of the controller
+        m_sendCb = SendCb();
+        std::vector < PendingCall > pendingCalls;
+        pendingCalls.swap(m_pendingCalls);
+        if (m_connection) {
+            m_connection->close();
+        }
+        for (PendingCall& pendingCall : pendingCalls) {
+            for (const ResultCb& resultCb : pendingCall.resultCbs) {
+                resultCb(boost::asio::error::operation_aborted, nlohmann::json());
+            }
+        }
+    }
+
+    void Controller::close()
+    {
+        m_state->close();
+    }
+
+    size_t Controller::requestCount() const
+    {
+        return m_state->m_requestCount;
+    }
+
+    size_t Controller::connectCount() const
+    {
+        if (!m_state->m_connection) {
+            return 0;
+        }
+        return m_state->m_connection->connectCount();
     }
 
     void Controller::asyncSubscribe(const SignalIds& signalIds, ResultCb resultCb)
     {
         if(signalIds.empty()) {
-            resultCb(boost::system::error_code());
+            resultCb(boost::system::error_code(), nlohmann::json::array());
             return;
         }
 
@@ -44,14 +172,13 @@ namespace daq::streaming_protocol {
             STREAMING_PROTOCOL_LOG_I("{}", iter);
         }
 
-        nlohmann::json request = createRequest(signalIds, META_METHOD_SUBSCRIBE);
-        execute(request, resultCb);
+        enqueue(signalIds, META_METHOD_SUBSCRIBE, resultCb);
     }
 
     void Controller::asyncUnsubscribe(const SignalIds& signalIds, ResultCb resultCb)
     {
         if(signalIds.empty()) {
-            resultCb(boost::system::error_code());
+            resultCb(boost::system::error_code(), nlohmann::json::array());
             return;
         }
 
@@ -61,11 +188,10 @@ namespace daq::streaming_protocol {
         }
         STREAMING_PROTOCOL_LOG_I("====================================================");
 
-        nlohmann::json request = createRequest(signalIds, META_METHOD_UNSUBSCRIBE);
-        execute(request, resultCb);
+        enqueue(signalIds, META_METHOD_UNSUBSCRIBE, resultCb);
     }
 
-    nlohmann::json Controller::createRequest(const SignalIds& signalIds, const char* method)
+    nlohmann::json Controller::State::createRequest(const SignalIds& signalIds, const char* method)
     {
         nlohmann::json request;
         request[daq::jsonrpc::JSONRPC] = "2.0";
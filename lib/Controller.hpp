@@ -16,13 +16,18 @@
 
 #pragma once
 
+#include <chrono>
+#include <memory>
 #include <string>
 #include <stdexcept>
+#include <unordered_set>
+#include <vector>
 
+#include <boost/asio/steady_timer.hpp>
 #include <nlohmann/json.hpp>
 
 #include "streaming_protocol/Types.h"
-#include "HttpPost.hpp"
+#include "ControlConnection.hpp"
 #include "streaming_protocol/Logging.hpp"
 
 namespace Json {
@@ -31,36 +36,95 @@ namespace Json {
 
 namespace daq::streaming_protocol {
     /// Used to send commands (subscribe/unsubscribe) to the streaming control http port.
+    /// -All requests are sent over one keep-alive connection (ControlConnection) or handed to a send callback (i.e. in-band over the data stream).
+    /// -Calls made within the merge window are merged into one request per method. Calls to different methods keep their order.
     class Controller
     {
     public:
-        using ResultCb = std::function <void (const boost::system::error_code& ec) >;
+        /// \param result The json rpc result of the response, the ids of the signals affected if the producer tells them. Null on error.
+        using ResultCb = std::function <void (const boost::system::error_code& ec, const nlohmann::json& result) >;
+        /// Sends one request, called from within the io context
+        /// \param method META_METHOD_SUBSCRIBE or META_METHOD_UNSUBSCRIBE
+        using SendCb = std::function < void (const char* method, const SignalIds& signalIds, ResultCb resultCb) >;
         /// \param httpVersion 10 for http version 1.0, 11 for http version 1.1...
         /// \throws std::runtime_error
         Controller(boost::asio::io_context& ioc, const std::string& streamId, const std::string& address, const std::string& port, const std::string &target, unsigned int httpVersion,
                    daq::streaming_protocol::LogCallback logCb);
+        /// Requests are handed to sendCb instead of being sent to the control port
+        Controller(boost::asio::io_context& ioc, SendCb sendCb, daq::streaming_protocol::LogCallback logCb);
+        /// Calls not completed yet are completed with boost::asio::error::operation_aborted.
+        /// To be destroyed within the io context or while it is not running.
+        ~Controller();
         Controller(const Controller&) = delete;
         Controller& operator= (const Controller&) = delete;
 
+        /// Calls are collected for this time before being sent. 0 by default: Calls made before returning to the io context are merged.
+        void setMergeWindow(std::chrono::microseconds mergeWindow);
+
         /// \param signalIds several signals might be subscribed with one request to the control port.
+        /// \param resultCb Called with the result of the request. The request might have been merged with others, the result covers all of them then.
         /// \throws std::exception
         void asyncSubscribe(const SignalIds& signalIds, ResultCb resultCb);
 
         /// \param signalIds several signals might be unsubscribed with one request to the control port.
+        /// \param resultCb Called with the result of the request. The request might have been merged with others, the result covers all of them then.
         /// \throws std::exception
         void asyncUnsubscribe(const SignalIds& signalIds, ResultCb resultCb);
 
+        /// Closes the connection. Calls not completed yet are completed with boost::asio::error::operation_aborted.
+        /// To be called from within the io context.
+        void close();
+
+        /// Number of requests sent so far. Merged calls are sent with one request.
+        size_t requestCount() const;
+
+        /// Number of connections established so far
+        size_t connectCount() const;
+
     private:
-        nlohmann::json createRequest(const SignalIds& signalIds, const char* method);
-        /// \throws std::exception
-        void execute(const nlohmann::json &request, HttpPost::ResultCb resultCb);
-
-        boost::asio::io_context& m_ioc;
-        std::string m_streamId;
-        std::string m_address;
-        std::string m_port;
-        std::string m_target;
-        unsigned int m_httpVersion;
+        /// Calls to the same method collected within the merge window
+        struct PendingCall
+        {
+            const char* method;
+            SignalIds signalIds;
+            /// To merge each signal id only once
+            std::unordered_set < std::string > signalIdSet;
+            std::vector < ResultCb > resultCbs;
+        };
+
+        /// Everything touched by the handlers queued to the io context.
+        /// The handlers hold it until they were executed. They might be executed after the Controller is gone.
+        struct State
+        {
+            State(boost::asio::io_context& ioc, daq::streaming_protocol::LogCallback logCb);
+
+            /// Collects the call to be sent when the merge window elapsed, to be called from within the io context
+            void enqueue(const SignalIds& signalIds, const char* method, ResultCb resultCb, const std::shared_ptr < State >& self);
+            /// Sends the calls collected
+            void flush();
+            /// Completes all calls collected with boost::asio::error::operation_aborted
+            void close();
+            nlohmann::json createRequest(const SignalIds& signalIds, const char* method);
+
+            boost::asio::io_context& m_ioc;
+            std::string m_streamId;
+            std::chrono::microseconds m_mergeWindow;
+            boost::asio::steady_timer m_mergeTimer;
+            bool m_flushScheduled;
+            /// Calls arriving after closing are completed with boost::asio::error::operation_aborted right away
+            bool m_closed;
+            std::vector < PendingCall > m_pendingCalls;
+            /// Not created if requests are handed to m_sendCb
+            std::shared_ptr < ControlConnection > m_connection;
+            SendCb m_sendCb;
+            size_t m_requestCount;
+            daq::streaming_protocol::LogCallback logCallback;
+        };
+
+        /// Dispatches the call to the io context
+        void enqueue(const SignalIds& signalIds, const char* method, ResultCb resultCb);
+
+        std::shared_ptr < State > m_state;
         daq::streaming_protocol::LogCallback logCallback;
 
         static unsigned int s_id;
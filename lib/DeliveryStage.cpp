@@ -0,0 +1,310 @@
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "streaming_protocol/DeliveryStage.hpp"
+#include "streaming_protocol/SpscQueue.hpp"
+
+namespace daq::streaming_protocol {
+    /// Buffers and the ring of published buffers of a lane.
+    /// -The reader takes free buffers, fills them and pushes them into the ring.
+    /// -The draining thread pops buffers from the ring and hands them back to the reader after delivery.
+    /// -For dropping the oldest package, the reader pops from the ring as well. Hence popping is done by compare and swap.
+    /// There are as many ring slots as buffers, the ring can not overflow.
+    class DeliveryStage::Lane
+    {
+    public:
+        explicit Lane(size_t capacity)
+            : m_buffers(capacity)
+            , m_ring(roundUpToPowerOfTwo(capacity))
+            , m_mask(m_ring.size() - 1)
+            , m_writeIndex(0)
+            , m_readIndex(0)
+            , m_freeBuffers(capacity)
+            , m_readerWaiting(false)
+            , m_scheduled(false)
+        {
+            for (DeliveredData& buffer : m_buffers) {
+                giveBack(&buffer);
+            }
+        }
+
+        /// To be called by the reader only
+        /// \return nullptr if all buffers are in use
+        DeliveredData* takeFree()
+        {
+            DeliveredData** slot = m_freeBuffers.consumerSlot();
+            if (slot == nullptr) {
+                return nullptr;
+            }
+            DeliveredData* buffer = *slot;
+            m_freeBuffers.release();
+            return buffer;
+        }
+
+        /// To be called by the reader only
+        /// \return A free buffer, waits until the draining thread hands one back
+        DeliveredData* waitFree()
+        {
+            DeliveredData* buffer;
+            std::unique_lock < std::mutex > lock(m_mutex);
+            m_readerWaiting.store(true, std::memory_order_relaxed);
+            // pairs with the fence in giveBack(): Either we see the buffer handed back or the draining thread sees the reader waiting.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_freeCondition.wait(lock, [this, &buffer]() {
+                buffer = takeFree();
+                return buffer != nullptr;
+            });
+            m_readerWaiting.store(false, std::memory_order_relaxed);
+            return buffer;
+        }
+
+        /// To be called by the draining thread only
+        void giveBack(DeliveredData* buffer)
+        {
+            // there are as many slots as buffers
+            *m_freeBuffers.producerSlot() = buffer;
+            m_freeBuffers.publish();
+            // pairs with the fence in waitFree()
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_readerWaiting.load(std::memory_order_relaxed)) {
+                std::lock_guard < std::mutex > lock(m_mutex);
+                m_freeCondition.notify_one();
+            }
+        }
+
+        /// To be called by the reader only
+        void push(DeliveredData* buffer)
+        {
+            size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+            m_ring[writeIndex & m_mask].store(buffer, std::memory_order_relaxed);
+            // sequentially consistent, pairs with DeliveryStage::drain()
+            m_writeIndex.store(writeIndex + 1, std::memory_order_seq_cst);
+        }
+
+        /// \return The oldest published buffer or nullptr if there is none
+        DeliveredData* pop()
+        {
+            size_t readIndex = m_readIndex.load(std::memory_order_acquire);
+            while (readIndex != m_writeIndex.load(std::memory_order_acquire)) {
+                DeliveredData* buffer = m_ring[readIndex & m_mask].load(std::memory_order_relaxed);
+                if (m_readIndex.compare_exchange_weak(readIndex, readIndex + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    return buffer;
+                }
+            }
+            return nullptr;
+        }
+
+        bool empty() const
+        {
+            return m_readIndex.load(std::memory_order_acquire) == m_writeIndex.load(std::memory_order_seq_cst);
+        }
+
+        /// Set while the lane is being drained or the draining is handed to the executor
+        std::atomic < bool >& scheduled()
+        {
+            return m_scheduled;
+        }
+
+    private:
+        static size_t roundUpToPowerOfTwo(size_t value)
+        {
+            size_t result = 1;
+            while (result < value) {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        static const size_t CacheLineSize = 64;
+
+        std::vector < DeliveredData > m_buffers;
+        std::vector < std::atomic < DeliveredData* > > m_ring;
+        size_t m_mask;
+        alignas(CacheLineSize) std::atomic < size_t > m_writeIndex;
+        alignas(CacheLineSize) std::atomic < size_t > m_readIndex;
+        SpscQueue < DeliveredData* > m_freeBuffers;
+        /// the reader waits here for a free buffer (OVERFLOWPOLICY_BLOCK)
+        std::mutex m_mutex;
+        std::condition_variable m_freeCondition;
+        std::atomic < bool > m_readerWaiting;
+        alignas(CacheLineSize) std::atomic < bool > m_scheduled;
+    };
+
+    DeliveryStage::DeliveryStage(size_t laneCount, size_t laneCapacity, OverflowPolicy overflowPolicy, DeliveredDataCb cb, Executor executor, LogCallback logCb)
+        : m_overflowPolicy(overflowPolicy)
+        , m_cb(cb)
+        , m_executor(executor)
+        , logCallback(logCb)
+        , m_closed(false)
+        , m_activeTasks(0)
+        , m_queueDepth(0)
+        , m_maxQueueDepth(0)
+        , m_publishedCount(0)
+        , m_deliveredCount(0)
+        , m_droppedCount(0)
+        , m_blockedCount(0)
+    {
+        if (laneCount == 0) {
+            laneCount = 1;
+        }
+        if (laneCapacity == 0) {
+            laneCapacity = 1;
+        }
+        for (size_t laneIndex = 0; laneIndex < laneCount; ++laneIndex) {
+            m_lanes.emplace_back(std::make_unique < Lane > (laneCapacity));
+        }
+    }
+
+    DeliveryStage::~DeliveryStage()
+    {
+        m_closed.store(true, std::memory_order_release);
+        while (m_activeTasks.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    void DeliveryStage::setClosedCb(ClosedCb cb)
+    {
+        m_closedCb = cb;
+    }
+
+    DeliveredData* DeliveryStage::freeBuffer(Lane& lane)
+    {
+        DeliveredData* buffer = lane.takeFree();
+        if (buffer) {
+            return buffer;
+        }
+
+        switch (m_overflowPolicy) {
+        case OVERFLOWPOLICY_DROP_OLDEST:
+            buffer = lane.pop();
+            if (buffer) {
+                m_queueDepth.fetch_sub(1, std::memory_order_relaxed);
+                m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return buffer;
+            }
+            // all buffers are being delivered right now
+            break;
+        case OVERFLOWPOLICY_CLOSE:
+            STREAMING_PROTOCOL_LOG_E("Delivery stage overflow, closing!");
+            m_closed.store(true, std::memory_order_release);
+            if (m_closedCb) {
+                m_closedCb();
+            }
+            return nullptr;
+        case OVERFLOWPOLICY_BLOCK:
+            break;
+        }
+
+        // Throttle the reader until a buffer is handed back
+        m_blockedCount.fetch_add(1, std::memory_order_relaxed);
+        return lane.waitFree();
+    }
+
+    int DeliveryStage::publish(const SubscribedSignal& subscribedSignal, const uint64_t* timeStamps, const uint8_t* data, size_t valueCount)
+    {
+        if (m_closed.load(std::memory_order_relaxed)) {
+            m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return -1;
+        }
+
+        Lane& lane = *m_lanes[subscribedSignal.signalNumber() % m_lanes.size()];
+        DeliveredData* buffer = freeBuffer(lane);
+        if (buffer == nullptr) {
+            m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return -1;
+        }
+
+        // values of constant rule signals are delivered with their value index
+        size_t valueSize = subscribedSignal.dataValueSize();
+        if (subscribedSignal.ruleType() == RULETYPE_CONSTANT) {
+            valueSize += sizeof(uint64_t);
+        }
+        buffer->signalNumber = subscribedSignal.signalNumber();
+        buffer->signalId = subscribedSignal.signalId();
+        buffer->sampleType = subscribedSignal.dataValueType();
+        buffer->valueSize = valueSize;
+        buffer->valueCount = valueCount;
+        buffer->timeStamps.assign(timeStamps, timeStamps + valueCount);
+        buffer->data.assign(data, data + valueCount * valueSize);
+
+        // counted before pushing, the package might be delivered immediately
+        size_t queueDepth = m_queueDepth.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (queueDepth > m_maxQueueDepth.load(std::memory_order_relaxed)) {
+            m_maxQueueDepth.store(queueDepth, std::memory_order_relaxed);
+        }
+        m_publishedCount.fetch_add(1, std::memory_order_relaxed);
+        lane.push(buffer);
+        schedule(lane);
+        return 0;
+    }
+
+    void DeliveryStage::schedule(Lane& lane)
+    {
+        if (!m_executor) {
+            return;
+        }
+        if (!lane.scheduled().exchange(true, std::memory_order_seq_cst)) {
+            m_activeTasks.fetch_add(1, std::memory_order_relaxed);
+            m_executor([this, &lane]() {
+                drain(lane);
+            });
+        }
+    }
+
+    void DeliveryStage::drain(Lane& lane)
+    {
+        while (true) {
+            deliver(lane);
+            lane.scheduled().store(false, std::memory_order_seq_cst);
+            // Packages published after the last pop and before clearing the flag were not scheduled by the reader
+            if (lane.empty() || lane.scheduled().exchange(true, std::memory_order_seq_cst)) {
+                break;
+            }
+        }
+        // this is the last access, the stage may be destroyed afterwards
+        m_activeTasks.fetch_sub(1, std::memory_order_release);
+    }
+
+    size_t DeliveryStage::deliver(Lane& lane)
+    {
+        size_t count = 0;
+        DeliveredData* buffer;
+        while ((buffer = lane.pop()) != nullptr) {
+            m_queueDepth.fetch_sub(1, std::memory_order_relaxed);
+            m_cb(*buffer);
+            lane.giveBack(buffer);
+            m_deliveredCount.fetch_add(1, std::memory_order_relaxed);
+            ++count;
+        }
+        return count;
+    }
+
+    size_t DeliveryStage::poll()
+    {
+        size_t count = 0;
+        for (auto& lane : m_lanes) {
+            // another thread is polling this lane already
+            if (lane->scheduled().exchange(true, std::memory_order_acquire)) {
+                continue;
+            }
+            count += deliver(*lane);
+            lane->scheduled().store(false, std::memory_order_release);
+        }
+        return count;
+    }
+
+    DeliveryMetrics DeliveryStage::metrics() const
+    {
+        DeliveryMetrics metrics;
+        metrics.queueDepth = m_queueDepth.load(std::memory_order_relaxed);
+        metrics.maxQueueDepth = m_maxQueueDepth.load(std::memory_order_relaxed);
+        metrics.publishedCount = m_publishedCount.load(std::memory_order_relaxed);
+        metrics.deliveredCount = m_deliveredCount.load(std::memory_order_relaxed);
+        metrics.droppedCount = m_droppedCount.load(std::memory_order_relaxed);
+        metrics.blockedCount = m_blockedCount.load(std::memory_order_relaxed);
+        metrics.closed = m_closed.load(std::memory_order_relaxed);
+        return metrics;
+    }
+}
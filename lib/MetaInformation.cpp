@@ -10,7 +10,10 @@
 namespace daq::streaming_protocol {
     MetaInformation::MetaInformation(LogCallback logCb)
         : m_metaInformationType(0)
+        , m_methodType(METHODTYPE_UNKNOWN)
+        , m_msgpack()
         , m_jsonContent()
+        , m_jsonContentBuilt(true)
         , logCallback(logCb)
     {
     }
@@ -18,16 +21,30 @@ namespace daq::streaming_protocol {
     int MetaInformation::interpret(const uint8_t* data, size_t size)
     {
         memcpy(&m_metaInformationType, data, sizeof(m_metaInformationType));
+        m_msgpack.clear();
+        m_methodType = METHODTYPE_UNKNOWN;
+        m_jsonContent = nlohmann::json();
+        m_jsonContentBuilt = true;
         switch (m_metaInformationType) {
         // we do support messagepack only!
         case METAINFORMATION_MSGPACK:
             {
-                try {
-                    m_jsonContent = nlohmann::json::from_msgpack(data+sizeof(m_metaInformationType), data+size);
-                } catch (const nlohmann::json::parse_error& e) {
-                    STREAMING_PROTOCOL_LOG_E("parsing meta information failed : {}", e.what());
+                m_msgpack.assign(data+sizeof(m_metaInformationType), data+size);
+                // the payload has to be one complete value, just like it is required when parsing into a json document
+                MsgpackView content(m_msgpack.data(), m_msgpack.size());
+                if ((!content.valid()) || (content.size() != m_msgpack.size())) {
+                    STREAMING_PROTOCOL_LOG_E("parsing meta information failed : invalid MessagePack");
+                    m_msgpack.clear();
                     return -1;
                 }
+                // same as when parsing into a json document, keys have to be strings
+                if (!hasStringKeysOnly(content)) {
+                    STREAMING_PROTOCOL_LOG_E("parsing meta information failed : map key is no string");
+                    m_msgpack.clear();
+                    return -1;
+                }
+                m_jsonContentBuilt = false;
+                m_methodType = methodTypeFromName(content.find(METHOD).asStringView());
             }
             break;
         default:
@@ -37,26 +54,71 @@ namespace daq::streaming_protocol {
         return 0;
     }
 
-    std::string MetaInformation::method() const
+    bool MetaInformation::hasStringKeysOnly(const MsgpackView& value)
     {
-        const nlohmann::json::const_iterator& methodNode = m_jsonContent.find(METHOD);
-        if (methodNode == m_jsonContent.end()) {
-            return "";
+        // nested arrays and maps are walked without recursion
+        m_containers.clear();
+        m_containers.emplace_back(value.begin(), value.end());
+        while (!m_containers.empty()) {
+            ContainerRange& range = m_containers.back();
+            if (range.first == range.second) {
+                m_containers.pop_back();
+                continue;
+            }
+            MsgpackView key = range.first.key();
+            MsgpackView element = *range.first;
+            ++range.first;
+            if (key.valid() && (key.type() != MsgpackView::MSGPACKTYPE_STRING)) {
+                return false;
+            }
+            MsgpackView::Type elementType = element.type();
+            if ((elementType == MsgpackView::MSGPACKTYPE_ARRAY) || (elementType == MsgpackView::MSGPACKTYPE_MAP)) {
+                m_containers.emplace_back(element.begin(), element.end());
+            }
         }
-        return *methodNode;
+        return true;
+    }
+
+    std::string MetaInformation::method() const
+    {
+        MsgpackView methodNode = content().find(METHOD);
+        return std::string(methodNode.asStringView());
+    }
+
+    MethodType MetaInformation::methodType() const
+    {
+        return m_methodType;
     }
 
     nlohmann::json MetaInformation::params() const
     {
-        const nlohmann::json::const_iterator& paramsNode = m_jsonContent.find(PARAMS);
-        if (paramsNode == m_jsonContent.end()) {
+        MsgpackView paramsNode = paramsView();
+        if (!paramsNode.valid()) {
             return {};
         }
-        return *paramsNode;
+        return paramsNode.toJson();
+    }
+
+    MsgpackView MetaInformation::paramsView() const
+    {
+        return content().find(PARAMS);
+    }
+
+    MsgpackView MetaInformation::content() const
+    {
+        if (m_msgpack.empty()) {
+            return MsgpackView();
+        }
+        // validated by interpret()
+        return MsgpackView::unchecked(m_msgpack.data(), m_msgpack.size());
     }
 
     const nlohmann::json &MetaInformation::jsonContent() const
     {
+        if (!m_jsonContentBuilt) {
+            m_jsonContent = content().toJson();
+            m_jsonContentBuilt = true;
+        }
         return m_jsonContent;
     }
 
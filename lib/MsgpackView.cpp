@@ -0,0 +1,441 @@
+#include <cstring>
+
+#include "streaming_protocol/MsgpackView.hpp"
+
+namespace daq::streaming_protocol {
+    /// The MessagePack format is described in https://github.com/msgpack/msgpack/blob/master/spec.md
+    struct Header
+    {
+        MsgpackView::Type type;
+        /// type byte and length fields
+        size_t headerSize;
+        /// bytes following the header (value of scalars, characters of strings...)
+        uint64_t payloadSize;
+        /// elements of arrays or members of maps
+        uint64_t count;
+    };
+
+    /// all multi-byte numbers are big endian
+    static uint64_t readBigEndian(const uint8_t* position, size_t byteCount)
+    {
+        uint64_t value = 0;
+        for (size_t byteIndex = 0; byteIndex < byteCount; ++byteIndex) {
+            value = (value << 8) | position[byteIndex];
+        }
+        return value;
+    }
+
+    /// \return -1 if there is no complete header or the type is invalid
+    static int parseHeader(const uint8_t* position, const uint8_t* end, Header& header)
+    {
+        if (position >= end) {
+            return -1;
+        }
+        uint8_t typeByte = *position;
+        header.headerSize = 1;
+        header.payloadSize = 0;
+        header.count = 0;
+        // number of bytes of the length field following the type byte
+        size_t lengthSize = 0;
+        // for extensions, the extension type byte follows the length
+        size_t extraSize = 0;
+
+        if (typeByte <= 0x7f) {
+            header.type = MsgpackView::MSGPACKTYPE_UNSIGNED;
+        } else if (typeByte <= 0x8f) {
+            header.type = MsgpackView::MSGPACKTYPE_MAP;
+            header.count = typeByte & 0x0f;
+        } else if (typeByte <= 0x9f) {
+            header.type = MsgpackView::MSGPACKTYPE_ARRAY;
+            header.count = typeByte & 0x0f;
+        } else if (typeByte <= 0xbf) {
+            header.type = MsgpackView::MSGPACKTYPE_STRING;
+            header.payloadSize = typeByte & 0x1f;
+        } else if (typeByte >= 0xe0) {
+            header.type = MsgpackView::MSGPACKTYPE_SIGNED;
+        } else {
+            switch (typeByte) {
+            case 0xc0:
+                header.type = MsgpackView::MSGPACKTYPE_NIL;
+                break;
+            case 0xc2:
+            case 0xc3:
+                header.type = MsgpackView::MSGPACKTYPE_BOOL;
+                break;
+            case 0xc4:
+            case 0xc5:
+            case 0xc6:
+                header.type = MsgpackView::MSGPACKTYPE_BINARY;
+                lengthSize = size_t(1) << (typeByte - 0xc4);
+                break;
+            case 0xc7:
+            case 0xc8:
+            case 0xc9:
+                header.type = MsgpackView::MSGPACKTYPE_EXTENSION;
+                lengthSize = size_t(1) << (typeByte - 0xc7);
+                extraSize = 1;
+                break;
+            case 0xca:
+                header.type = MsgpackView::MSGPACKTYPE_FLOAT;
+                header.payloadSize = sizeof(float);
+                break;
+            case 0xcb:
+                header.type = MsgpackView::MSGPACKTYPE_FLOAT;
+                header.payloadSize = sizeof(double);
+                break;
+            case 0xcc:
+            case 0xcd:
+            case 0xce:
+            case 0xcf:
+                header.type = MsgpackView::MSGPACKTYPE_UNSIGNED;
+                header.payloadSize = uint64_t(1) << (typeByte - 0xcc);
+                break;
+            case 0xd0:
+            case 0xd1:
+            case 0xd2:
+            case 0xd3:
+                header.type = MsgpackView::MSGPACKTYPE_SIGNED;
+                header.payloadSize = uint64_t(1) << (typeByte - 0xd0);
+                break;
+            case 0xd4:
+            case 0xd5:
+            case 0xd6:
+            case 0xd7:
+            case 0xd8:
+                // fixext: extension type byte followed by 1, 2, 4, 8 or 16 bytes
+                header.type = MsgpackView::MSGPACKTYPE_EXTENSION;
+                header.payloadSize = 1 + (uint64_t(1) << (typeByte - 0xd4));
+                break;
+            case 0xd9:
+            case 0xda:
+            case 0xdb:
+                header.type = MsgpackView::MSGPACKTYPE_STRING;
+                lengthSize = size_t(1) << (typeByte - 0xd9);
+                break;
+            case 0xdc:
+            case 0xdd:
+                header.type = MsgpackView::MSGPACKTYPE_ARRAY;
+                lengthSize = size_t(2) << (typeByte - 0xdc);
+                break;
+            case 0xde:
+            case 0xdf:
+                header.type = MsgpackView::MSGPACKTYPE_MAP;
+                lengthSize = size_t(2) << (typeByte - 0xde);
+                break;
+            default:
+                // 0xc1 is never used
+                return -1;
+            }
+        }
+
+        if (lengthSize > 0) {
+            if (static_cast < size_t > (end - position) < 1 + lengthSize) {
+                return -1;
+            }
+            uint64_t length = readBigEndian(position + 1, lengthSize);
+            header.headerSize += lengthSize;
+            if ((header.type == MsgpackView::MSGPACKTYPE_ARRAY) || (header.type == MsgpackView::MSGPACKTYPE_MAP)) {
+                header.count = length;
+            } else {
+                header.payloadSize = length + extraSize;
+            }
+        }
+        return 0;
+    }
+
+    /// \return Position after the complete value starting at position, nullptr if the value is incomplete or invalid
+    static const uint8_t* skipValue(const uint8_t* position, const uint8_t* end)
+    {
+        // arrays and maps are walked without recursion by counting the values still to be skipped
+        uint64_t remaining = 1;
+        while (remaining > 0) {
+            Header header;
+            if (parseHeader(position, end, header) < 0) {
+                return nullptr;
+            }
+            position += header.headerSize;
+            if (static_cast < uint64_t > (end - position) < header.payloadSize) {
+                return nullptr;
+            }
+            position += header.payloadSize;
+            --remaining;
+            if (header.type == MsgpackView::MSGPACKTYPE_ARRAY) {
+                remaining += header.count;
+            } else if (header.type == MsgpackView::MSGPACKTYPE_MAP) {
+                remaining += 2 * header.count;
+            }
+            // each value takes at least one byte. This also limits the counters.
+            if (remaining > static_cast < uint64_t > (end - position)) {
+                return nullptr;
+            }
+        }
+        return position;
+    }
+
+    MsgpackView::const_iterator::const_iterator()
+        : m_position(nullptr)
+        , m_end(nullptr)
+        , m_remaining(0)
+        , m_isMap(false)
+        , m_keyBegin(nullptr)
+        , m_valueBegin(nullptr)
+        , m_valueEnd(nullptr)
+    {
+    }
+
+    MsgpackView::const_iterator::const_iterator(const uint8_t* position, const uint8_t* end, uint64_t remaining, bool isMap)
+        : m_position(position)
+        , m_end(end)
+        , m_remaining(remaining)
+        , m_isMap(isMap)
+        , m_keyBegin(nullptr)
+        , m_valueBegin(nullptr)
+        , m_valueEnd(nullptr)
+    {
+        resolve();
+    }
+
+    void MsgpackView::const_iterator::resolve()
+    {
+        if (m_remaining == 0) {
+            return;
+        }
+        // the complete value was validated before, skipping can not fail.
+        if (m_isMap) {
+            m_keyBegin = m_position;
+            m_valueBegin = skipValue(m_position, m_end);
+        } else {
+            m_valueBegin = m_position;
+        }
+        m_valueEnd = skipValue(m_valueBegin, m_end);
+    }
+
+    MsgpackView MsgpackView::const_iterator::operator*() const
+    {
+        return range(m_valueBegin, m_valueEnd);
+    }
+
+    MsgpackView MsgpackView::const_iterator::key() const
+    {
+        if (m_keyBegin == nullptr) {
+            return MsgpackView();
+        }
+        return range(m_keyBegin, m_valueBegin);
+    }
+
+    MsgpackView MsgpackView::const_iterator::value() const
+    {
+        return **this;
+    }
+
+    MsgpackView::const_iterator& MsgpackView::const_iterator::operator++()
+    {
+        m_position = m_valueEnd;
+        --m_remaining;
+        resolve();
+        return *this;
+    }
+
+    bool MsgpackView::const_iterator::operator==(const const_iterator& other) const
+    {
+        return (m_position == other.m_position) && (m_remaining == other.m_remaining);
+    }
+
+    bool MsgpackView::const_iterator::operator!=(const const_iterator& other) const
+    {
+        return !(*this == other);
+    }
+
+    MsgpackView::MsgpackView()
+        : m_begin(nullptr)
+        , m_end(nullptr)
+    {
+    }
+
+    MsgpackView::MsgpackView(const uint8_t* data, size_t size)
+        : m_begin(nullptr)
+        , m_end(nullptr)
+    {
+        const uint8_t* end = skipValue(data, data + size);
+        if (end != nullptr) {
+            m_begin = data;
+            m_end = end;
+        }
+    }
+
+    MsgpackView MsgpackView::range(const uint8_t* begin, const uint8_t* end)
+    {
+        MsgpackView view;
+        view.m_begin = begin;
+        view.m_end = end;
+        return view;
+    }
+
+    MsgpackView MsgpackView::unchecked(const uint8_t* data, size_t size)
+    {
+        return range(data, data + size);
+    }
+
+    bool MsgpackView::valid() const
+    {
+        return m_begin != nullptr;
+    }
+
+    MsgpackView::Type MsgpackView::type() const
+    {
+        Header header;
+        if (parseHeader(m_begin, m_end, header) < 0) {
+            return MSGPACKTYPE_INVALID;
+        }
+        return header.type;
+    }
+
+    const uint8_t* MsgpackView::data() const
+    {
+        return m_begin;
+    }
+
+    size_t MsgpackView::size() const
+    {
+        return static_cast < size_t > (m_end - m_begin);
+    }
+
+    uint64_t MsgpackView::count() const
+    {
+        Header header;
+        if (parseHeader(m_begin, m_end, header) < 0) {
+            return 0;
+        }
+        return header.count;
+    }
+
+    MsgpackView::const_iterator MsgpackView::begin() const
+    {
+        Header header;
+        if (parseHeader(m_begin, m_end, header) < 0) {
+            return const_iterator();
+        }
+        if ((header.type != MSGPACKTYPE_ARRAY) && (header.type != MSGPACKTYPE_MAP)) {
+            return end();
+        }
+        return const_iterator(m_begin + header.headerSize, m_end, header.count, header.type == MSGPACKTYPE_MAP);
+    }
+
+    MsgpackView::const_iterator MsgpackView::end() const
+    {
+        if (!valid()) {
+            return const_iterator();
+        }
+        return const_iterator(m_end, m_end, 0, type() == MSGPACKTYPE_MAP);
+    }
+
+    MsgpackView MsgpackView::find(std::string_view key) const
+    {
+        if (type() != MSGPACKTYPE_MAP) {
+            return MsgpackView();
+        }
+        for (const_iterator iter = begin(); iter != end(); ++iter) {
+            if (iter.key().type() == MSGPACKTYPE_STRING && iter.key().asStringView() == key) {
+                return *iter;
+            }
+        }
+        return MsgpackView();
+    }
+
+    std::string_view MsgpackView::asStringView() const
+    {
+        Header header;
+        if ((parseHeader(m_begin, m_end, header) < 0) || (header.type != MSGPACKTYPE_STRING)) {
+            return std::string_view();
+        }
+        return std::string_view(reinterpret_cast < const char* > (m_begin + header.headerSize), header.payloadSize);
+    }
+
+    uint64_t MsgpackView::asUnsigned() const
+    {
+        Header header;
+        if (parseHeader(m_begin, m_end, header) < 0) {
+            return 0;
+        }
+        if (header.type == MSGPACKTYPE_UNSIGNED) {
+            if (header.payloadSize == 0) {
+                // positive fixint
+                return *m_begin;
+            }
+            return readBigEndian(m_begin + header.headerSize, header.payloadSize);
+        } else if (header.type == MSGPACKTYPE_SIGNED) {
+            int64_t value = asSigned();
+            if (value >= 0) {
+                return static_cast < uint64_t > (value);
+            }
+        }
+        return 0;
+    }
+
+    int64_t MsgpackView::asSigned() const
+    {
+        Header header;
+        if (parseHeader(m_begin, m_end, header) < 0) {
+            return 0;
+        }
+        if (header.type == MSGPACKTYPE_SIGNED) {
+            if (header.payloadSize == 0) {
+                // negative fixint
+                return static_cast < int8_t > (*m_begin);
+            }
+            uint64_t value = readBigEndian(m_begin + header.headerSize, header.payloadSize);
+            // sign extension
+            size_t unusedBits = 64 - 8 * header.payloadSize;
+            return static_cast < int64_t > (value << unusedBits) >> unusedBits;
+        } else if (header.type == MSGPACKTYPE_UNSIGNED) {
+            return static_cast < int64_t > (asUnsigned());
+        }
+        return 0;
+    }
+
+    double MsgpackView::asDouble() const
+    {
+        Header header;
+        if (parseHeader(m_begin, m_end, header) < 0) {
+            return 0.0;
+        }
+        switch (header.type) {
+        case MSGPACKTYPE_FLOAT:
+            if (header.payloadSize == sizeof(float)) {
+                uint32_t bits = static_cast < uint32_t > (readBigEndian(m_begin + header.headerSize, sizeof(bits)));
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                return value;
+            } else {
+                uint64_t bits = readBigEndian(m_begin + header.headerSize, sizeof(bits));
+                double value;
+                memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+        case MSGPACKTYPE_UNSIGNED:
+            return static_cast < double > (asUnsigned());
+        case MSGPACKTYPE_SIGNED:
+            return static_cast < double > (asSigned());
+        default:
+            return 0.0;
+        }
+    }
+
+    bool MsgpackView::asBool() const
+    {
+        return valid() && (*m_begin == 0xc3);
+    }
+
+    nlohmann::json MsgpackView::toJson() const
+    {
+        if (!valid()) {
+            return nlohmann::json();
+        }
+        try {
+            return nlohmann::json::from_msgpack(m_begin, m_end);
+        } catch (const nlohmann::json::exception&) {
+            // i.e. map keys that are no strings
+            return nlohmann::json();
+        }
+    }
+}
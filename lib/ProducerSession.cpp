@@ -1,6 +1,11 @@
+#include <cstring>
+
+#include <boost/asio/post.hpp>
+
 #include "streaming_protocol/Defines.h"
 #include "streaming_protocol/jsonrpc_defines.hpp"
 #include "streaming_protocol/ProducerSession.hpp"
+#include "streaming_protocol/SignalIdPattern.hpp"
 #include "streaming_protocol/Types.h"
 
 namespace daq::streaming_protocol {
@@ -8,6 +13,21 @@ namespace daq::streaming_protocol {
                                      LogCallback logCb)
         : m_stream(stream)
         , m_writer(stream)
+        , m_aliveInterval(DEFAULT_ALIVE_INTERVAL)
+        , m_inBandControl(commandInterfaces.is_object() && commandInterfaces.contains(COMMANDINTERFACE_JSONRPC_INBAND))
+        , logCallback(logCb)
+    {
+        writeInitialMetaInformation(commandInterfaces);
+    }
+
+    ProducerSession::ProducerSession(std::shared_ptr<SendQueue> sendQueue, const nlohmann::json& commandInterfaces,
+                                     LogCallback logCb)
+        : m_stream(sendQueue->stream())
+        , m_writer(sendQueue)
+        , m_sendQueue(sendQueue)
+        , m_aliveInterval(DEFAULT_ALIVE_INTERVAL)
+        , m_aliveTimer(std::make_unique<boost::asio::steady_timer>(sendQueue->ioContext()))
+        , m_inBandControl(commandInterfaces.is_object() && commandInterfaces.contains(COMMANDINTERFACE_JSONRPC_INBAND))
         , logCallback(logCb)
     {
         writeInitialMetaInformation(commandInterfaces);
@@ -17,17 +37,86 @@ namespace daq::streaming_protocol {
     {
         m_errorCb = errorCb;
         doRead();
+        if (m_aliveTimer && (m_aliveInterval.count() > 0)) {
+            doAlive();
+        }
     }
 
     void ProducerSession::stop()
     {
+        leaveSignalHub();
+        if (m_aliveTimer) {
+            // the timer is used in the io context thread only
+            boost::asio::post(m_sendQueue->ioContext(), [self = shared_from_this()]() {
+                self->m_aliveTimer->cancel();
+            });
+        }
         doClose();
     }
 
+    void ProducerSession::setAliveInterval(std::chrono::milliseconds interval)
+    {
+        m_aliveInterval = interval;
+    }
+
+    int ProducerSession::setSignalHub(std::shared_ptr<SignalHub> signalHub)
+    {
+        if (!m_sendQueue) {
+            STREAMING_PROTOCOL_LOG_E("A signal hub requires a send queue!");
+            return -1;
+        }
+        m_signalHub = signalHub;
+        m_signalHub->addSession(m_sendQueue);
+        return 0;
+    }
+
+    void ProducerSession::leaveSignalHub()
+    {
+        if (!m_signalHub) {
+            return;
+        }
+        // signals without any session left are not produced anymore
+        std::vector < BaseSignal* > signals;
+        signals.reserve(m_allSignals.size());
+        for (const auto& signal : m_allSignals) {
+            signals.push_back(signal.second.get());
+        }
+        m_signalHub->unsubscribe(m_sendQueue, signals);
+        m_signalHub->removeSession(m_sendQueue);
+    }
+
+    void ProducerSession::doAlive()
+    {
+        m_aliveTimer->expires_after(m_aliveInterval);
+        std::weak_ptr<ProducerSession> weakSelf = shared_from_this();
+        m_aliveTimer->async_wait([weakSelf](const boost::system::error_code& ec) {
+            auto self = weakSelf.lock();
+            if (ec || !self) {
+                return;
+            }
+            if (self->writeAliveMetaInformation() < 0) {
+                // the session is over
+                return;
+            }
+            self->doAlive();
+        });
+    }
+
+    int ProducerSession::writeAliveMetaInformation()
+    {
+        nlohmann::json alive;
+        alive[daq::jsonrpc::METHOD] = META_METHOD_ALIVE;
+        alive[daq::jsonrpc::PARAMS][META_FILLLEVEL] = m_sendQueue->fillLevel();
+        return m_writer.writeMetaInformation(0, alive);
+    }
+
     void ProducerSession::addSignal(std::shared_ptr<BaseSignal> signal)
     {
         const std::string& signalId = signal->getId();
         m_allSignals[signalId] = signal;
+        if (m_sendQueue) {
+            m_sendQueue->setDroppable(signal->getNumber(), signal->isDroppable());
+        }
         if (signal->isDataSignal()) {
             SignalIds signalIds;
             signalIds.push_back(signalId);
@@ -35,16 +124,40 @@ namespace daq::streaming_protocol {
         }
     }
 
+    template < typename Function >
+    void ProducerSession::forEachSignal(const SignalIds& signalIds, Function function) const
+    {
+        for (const std::string& signalId : signalIds) {
+            if (SignalIdPattern::isPattern(signalId)) {
+                SignalIdPattern pattern(signalId);
+                pattern.forEachMatch(m_allSignals, [&function](const Signals::value_type& entry) {
+                    function(entry.first, *entry.second);
+                });
+                continue;
+            }
+            auto signalIter = m_allSignals.find(SignalIdPattern::unescape(signalId));
+            if (signalIter != m_allSignals.end()) {
+                function(signalIter->first, *signalIter->second);
+            }
+        }
+    }
+
     size_t ProducerSession::subscribeSignals(const SignalIds &signalIds)
     {
         size_t count = 0;
-        for (auto &signalIditer : signalIds) {
-            const std::string& signalId = signalIditer;
-            auto signalIter = m_allSignals.find(signalId);
-            if (signalIter != m_allSignals.end()) {
-                signalIter->second->subscribe();
-                ++count;
+        // the hub publishes one new snapshot for all signals of the request
+        std::vector < BaseSignal* > hubSignals;
+        forEachSignal(signalIds, [this, &count, &hubSignals](const std::string& signalId, BaseSignal& signal) {
+            if (m_signalHub) {
+                hubSignals.push_back(&signal);
+            } else if (m_subscribedSignalIds.insert(signalId).second) {
+                // the session counts once as subscriber of the signal
+                signal.subscribe();
             }
+            ++count;
+        });
+        if (!hubSignals.empty()) {
+            m_signalHub->subscribe(m_sendQueue, hubSignals);
         }
         return count;
     }
@@ -52,17 +165,30 @@ namespace daq::streaming_protocol {
     size_t ProducerSession::unsubscribeSignals(const SignalIds &signalIds)
     {
         size_t count = 0;
-        for (auto &signalIditer : signalIds) {
-            const std::string& signalId = signalIditer;
-            auto signalIter = m_allSignals.find(signalId);
-            if (signalIter != m_allSignals.end()) {
-                signalIter->second->unsubscribe();
-                ++count;
+        std::vector < BaseSignal* > hubSignals;
+        forEachSignal(signalIds, [this, &count, &hubSignals](const std::string& signalId, BaseSignal& signal) {
+            if (m_signalHub) {
+                hubSignals.push_back(&signal);
+            } else if (m_subscribedSignalIds.erase(signalId) > 0) {
+                signal.unsubscribe();
             }
+            ++count;
+        });
+        if (!hubSignals.empty()) {
+            m_signalHub->unsubscribe(m_sendQueue, hubSignals);
         }
         return count;
     }
 
+    SignalIds ProducerSession::resolveSignalIds(const SignalIds& signalIds) const
+    {
+        SignalIds resolvedSignalIds;
+        forEachSignal(signalIds, [&resolvedSignalIds](const std::string& signalId, BaseSignal&) {
+            resolvedSignalIds.push_back(signalId);
+        });
+        return resolvedSignalIds;
+    }
+
     void ProducerSession::writeInitialMetaInformation(const nlohmann::json& commandInterfaces)
     {
         nlohmann::json apiVersionMeta;
@@ -112,14 +238,126 @@ namespace daq::streaming_protocol {
             // Stop on error.
             // Also on disconnect by the client (boost::asio::error::eof)
             // or stop by producer (boost::asio::error::operation_aborted)!
+            leaveSignalHub();
             m_errorCb(ec);
             return;
         }
-        // we are not interested in the data and through it away!
-        m_stream->consume(bytesRead);
+        if (!m_inBandControl) {
+            // we are not interested in the data and through it away!
+            m_stream->consume(bytesRead);
+        } else if (processReceived() < 0) {
+            leaveSignalHub();
+            m_errorCb(boost::system::errc::make_error_code(boost::system::errc::protocol_error));
+            return;
+        }
         doRead();
     }
 
+    int ProducerSession::processReceived()
+    {
+        // control requests are small, anything bigger is not accepted
+        static const size_t MaxRequestSize = 65536;
+        while (true) {
+            size_t bytesAvailable = m_stream->size();
+            uint32_t header;
+            if (bytesAvailable < sizeof(header)) {
+                return 0;
+            }
+            const uint8_t* pData = m_stream->data();
+            memcpy(&header, pData, sizeof(header));
+            unsigned int signalNumber = header & SIGNAL_NUMBER_MASK;
+            TransportType type = static_cast < TransportType > ((header & TYPE_MASK) >> TYPE_SHIFT);
+            uint32_t length = (header & SIZE_MASK) >> SIZE_SHIFT;
+            size_t headerSize = sizeof(header);
+            if (length == 0) {
+                // length is to be found in additional length field
+                if (bytesAvailable < headerSize + sizeof(length)) {
+                    return 0;
+                }
+                memcpy(&length, pData + headerSize, sizeof(length));
+                headerSize += sizeof(length);
+            }
+            if (length > MaxRequestSize) {
+                STREAMING_PROTOCOL_LOG_E("Received package of {} bytes exceeds the maximum of {} bytes!", length, MaxRequestSize);
+                return -1;
+            }
+            if (bytesAvailable < headerSize + length) {
+                // wait for the remainder of the package
+                return 0;
+            }
+            if ((type == TYPE_METAINFORMATION) && (signalNumber == 0)) {
+                executeRequest(pData + headerSize, length);
+            } else {
+                STREAMING_PROTOCOL_LOG_W("Ignoring received package of type {} for signal {}", type, signalNumber);
+            }
+            m_stream->consume(headerSize + length);
+        }
+    }
+
+    void ProducerSession::executeRequest(const uint8_t* data, size_t size)
+    {
+        uint32_t metaInformationType = 0;
+        if (size >= sizeof(metaInformationType)) {
+            memcpy(&metaInformationType, data, sizeof(metaInformationType));
+        }
+        if (metaInformationType != METAINFORMATION_MSGPACK) {
+            STREAMING_PROTOCOL_LOG_W("Ignoring meta information of unsupported type");
+            return;
+        }
+        nlohmann::json request = nlohmann::json::from_msgpack(data + sizeof(metaInformationType), data + size, true, false);
+
+        nlohmann::json response;
+        response[daq::jsonrpc::JSONRPC] = "2.0";
+        int errorCode = 0;
+        std::string errorMessage;
+        if (request.is_discarded() || !request.is_object() || !request.contains(daq::jsonrpc::METHOD) || !request[daq::jsonrpc::METHOD].is_string()) {
+            errorCode = daq::jsonrpc::invalidRequest;
+            errorMessage = "invalid json rpc request";
+        } else {
+            auto params = request.find(daq::jsonrpc::PARAMS);
+            SignalIds signalIds;
+            if ((params != request.end()) && params->is_array()) {
+                for (const auto& param : *params) {
+                    if (!param.is_string()) {
+                        signalIds.clear();
+                        break;
+                    }
+                    signalIds.push_back(param);
+                }
+            }
+            const std::string& method = request[daq::jsonrpc::METHOD].get_ref < const std::string& > ();
+            if (signalIds.empty()) {
+                errorCode = daq::jsonrpc::invalidParams;
+                errorMessage = "params must be a non empty array of signal ids";
+            } else if (method == META_METHOD_SUBSCRIBE) {
+                // same as subscribing out of band, a signal shared by a signal hub is subscribed via the hub
+                response[daq::jsonrpc::RESULT] = resolveSignalIds(signalIds);
+                subscribeSignals(signalIds);
+            } else if (method == META_METHOD_UNSUBSCRIBE) {
+                response[daq::jsonrpc::RESULT] = resolveSignalIds(signalIds);
+                unsubscribeSignals(signalIds);
+            } else {
+                errorCode = daq::jsonrpc::methodNotFound;
+                errorMessage = "unknown method '" + method + "'";
+            }
+        }
+
+        if (errorCode != 0) {
+            STREAMING_PROTOCOL_LOG_E("In-band request failed: {}", errorMessage);
+            response[daq::jsonrpc::ERR][daq::jsonrpc::CODE] = errorCode;
+            response[daq::jsonrpc::ERR][daq::jsonrpc::MESSAGE] = errorMessage;
+        }
+        // notifications are not answered
+        if (request.is_object() && request.contains(daq::jsonrpc::ID)) {
+            response[daq::jsonrpc::ID] = request[daq::jsonrpc::ID];
+            m_writer.writeMetaInformation(0, response);
+        } else if (errorCode != 0) {
+            // without id, the client can not relate the error to its request
+            response[daq::jsonrpc::ID] = nullptr;
+            m_writer.writeMetaInformation(0, response);
+        }
+    }
+
     void ProducerSession::doClose()
     {
         m_stream->asyncClose(std::bind(&ProducerSession::onClose, shared_from_this(), std::placeholders::_1));
@@ -137,6 +375,9 @@ namespace daq::streaming_protocol {
         m_allSignals.insert(signals.begin(), signals.end());
         SignalIds signalIds;
         for (const auto& signal : signals) {
+            if (m_sendQueue) {
+                m_sendQueue->setDroppable(signal.second->getNumber(), signal.second->isDroppable());
+            }
             if(signal.second->isDataSignal()) {
                 signalIds.push_back(signal.first);
             }
@@ -165,6 +406,7 @@ namespace daq::streaming_protocol {
                 if (signalIter->second->isDataSignal()) {
                     dataSignalIds.push_back(signalIdsIter);
                 }
+                m_subscribedSignalIds.erase(signalIdsIter);
                 count += m_allSignals.erase(signalIdsIter);
             }
         }
@@ -1,29 +1,54 @@
+#include <cstring>
 #include <iostream>
 
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+
 #include "Controller.hpp"
 
 
 #include "streaming_protocol/Defines.h"
+#include "streaming_protocol/jsonrpc_defines.hpp"
 #include "streaming_protocol/ProtocolHandler.hpp"
+#include "streaming_protocol/StreamWriter.h"
 
 
 namespace daq::streaming_protocol {
 
     ProtocolHandler::ProtocolHandler(boost::asio::io_context& ioc, SignalContainer& signalContainer, StreamMetaCb streamMetaCb, LogCallback logCb)
         : m_ioc(ioc)
+        , m_sessionTimer(ioc)
+        , m_readStep(nullptr)
+        , m_readPending(false)
         , m_signalContainer(signalContainer)
         , m_streamMetaCb(streamMetaCb)
+        , m_receiveMode(RECEIVEMODE_PER_PACKAGE)
         , m_streamMeta(logCb)
+        , m_controlMergeWindow(0)
+        , m_inBandRequestId(0)
         , m_metaInformation(logCb)
         , logCallback(logCb)
     {
     }
     
+    ProtocolHandler::~ProtocolHandler() = default;
+
+    void ProtocolHandler::setReceiveMode(ReceiveMode receiveMode)
+    {
+        m_receiveMode = receiveMode;
+    }
+
+    ReceiveMode ProtocolHandler::receiveMode() const
+    {
+        return m_receiveMode;
+    }
+
     void ProtocolHandler::start(std::unique_ptr<daq::stream::Stream> stream, CompletionCb completionCb)
     {
         m_remoteHost = stream->remoteHost();
         m_stream = std::move(stream);
         m_completionCb = completionCb;
+        holdSession();
         m_stream->asyncInit(std::bind(&ProtocolHandler::onInitComplete, shared_from_this(), std::placeholders::_1));
     }
 
@@ -31,6 +56,7 @@ namespace daq::streaming_protocol {
     {
         m_completionCb = completionCb;
         m_stream = std::move(stream);
+        holdSession();
         boost::system::error_code ec = m_stream->init();
         onInitComplete(ec);
     }
@@ -44,40 +70,194 @@ namespace daq::streaming_protocol {
         m_ioc.dispatch(doClose);
     }
 
-    void ProtocolHandler::subscribe(const SignalIds& signalIds)
+    void ProtocolHandler::setControlMergeWindow(std::chrono::microseconds mergeWindow)
     {
-        if (m_stream)
-        {
-            try {
-                Controller controller(m_ioc, m_streamMeta.streamId(), m_remoteHost, m_streamMeta.httpControlPort(), m_streamMeta.httpControlPath(), m_streamMeta.httpVersion(), logCallback);
-                controller.asyncSubscribe(signalIds, [this](const boost::system::error_code& ec) {
-                    if (ec) {
-                        STREAMING_PROTOCOL_LOG_E("Control request failed: {}", ec.message());
-                    }
-                });
-            }  catch (const std::runtime_error& e) {
-                STREAMING_PROTOCOL_LOG_E("{} {}: Won't subscribe!", m_stream->endPointUrl(), e.what());
+        // the controller is used within the io context only
+        boost::asio::dispatch(m_ioc, [self = shared_from_this(), mergeWindow]() {
+            self->m_controlMergeWindow = mergeWindow;
+            if (self->m_controller) {
+                self->m_controller->setMergeWindow(mergeWindow);
             }
+        });
+    }
+
+    Controller& ProtocolHandler::controller()
+    {
+        if (!m_controller) {
+            if (m_streamMeta.inBandControl()) {
+                m_controller = std::make_unique < Controller > (m_ioc, [this](const char* method, const SignalIds& signalIds, Controller::ResultCb resultCb) {
+                    writeInBandRequest(method, signalIds, resultCb);
+                }, logCallback);
+            } else {
+                m_controller = std::make_unique < Controller > (m_ioc, m_streamMeta.streamId(), m_remoteHost, m_streamMeta.httpControlPort(), m_streamMeta.httpControlPath(), m_streamMeta.httpVersion(), logCallback);
+            }
+            m_controller->setMergeWindow(m_controlMergeWindow);
         }
+        return *m_controller;
     }
-    
-    void ProtocolHandler::unsubscribe(const SignalIds& signalIds)
-    {
-        if (m_stream)
-        {
-            try {
-                Controller controller(m_ioc, m_streamMeta.streamId(), m_remoteHost, m_streamMeta.httpControlPort(), m_streamMeta.httpControlPath(), m_streamMeta.httpVersion(), logCallback);
-                controller.asyncUnsubscribe(signalIds, [this](const boost::system::error_code& ec) {
-                    if (ec) {
-                        STREAMING_PROTOCOL_LOG_E("Control request failed: {}", ec.message());
-                    }
-                });
-            } catch(const std::runtime_error& e) {
-                STREAMING_PROTOCOL_LOG_E("{} {}: Won't unsubscribe!", m_stream->endPointUrl(), e.what());
+
+    void ProtocolHandler::subscribe(const SignalIds& signalIds, CompletionCb completionCb)
+    {
+        subscribe(signalIds, toControlResultCb(completionCb));
+    }
+
+    void ProtocolHandler::unsubscribe(const SignalIds& signalIds, CompletionCb completionCb)
+    {
+        unsubscribe(signalIds, toControlResultCb(completionCb));
+    }
+
+    void ProtocolHandler::subscribe(const SignalIds& signalIds, ControlResultCb resultCb)
+    {
+        // Calls might be made from outside the io context. The controller is created and used within the io context only.
+        boost::asio::dispatch(m_ioc, [self = shared_from_this(), signalIds, resultCb]() {
+            self->doControlRequest(signalIds, resultCb, true);
+        });
+    }
+
+    void ProtocolHandler::unsubscribe(const SignalIds& signalIds, ControlResultCb resultCb)
+    {
+        boost::asio::dispatch(m_ioc, [self = shared_from_this(), signalIds, resultCb]() {
+            self->doControlRequest(signalIds, resultCb, false);
+        });
+    }
+
+    ProtocolHandler::ControlResultCb ProtocolHandler::toControlResultCb(CompletionCb completionCb)
+    {
+        if (!completionCb) {
+            return ControlResultCb();
+        }
+        return [completionCb](const boost::system::error_code& ec, const nlohmann::json&) {
+            completionCb(ec);
+        };
+    }
+
+    void ProtocolHandler::doControlRequest(const SignalIds& signalIds, ControlResultCb resultCb, bool subscribe)
+    {
+        if (!m_stream) {
+            if (resultCb) {
+                resultCb(boost::asio::error::not_connected, nlohmann::json());
             }
+            return;
+        }
+
+        // the controller might complete the call while this object is being destroyed
+        auto controllerResultCb = [logCallback = logCallback, resultCb](const boost::system::error_code& ec, const nlohmann::json& result) {
+            if (ec) {
+                STREAMING_PROTOCOL_LOG_E("Control request failed: {}", ec.message());
+            }
+            if (resultCb) {
+                resultCb(ec, result);
+            }
+        };
+        try {
+            if (subscribe) {
+                controller().asyncSubscribe(signalIds, controllerResultCb);
+            } else {
+                controller().asyncUnsubscribe(signalIds, controllerResultCb);
+            }
+        }  catch (const std::runtime_error& e) {
+            STREAMING_PROTOCOL_LOG_E("{} {}: Won't {}!", m_stream->endPointUrl(), e.what(), subscribe ? "subscribe" : "unsubscribe");
+            if (resultCb) {
+                resultCb(boost::asio::error::invalid_argument, nlohmann::json());
+            }
+        }
+    }
+
+    void ProtocolHandler::writeInBandRequest(const char* method, const SignalIds& signalIds, ControlResultCb resultCb)
+    {
+        if (!m_stream) {
+            resultCb(boost::asio::error::not_connected, nlohmann::json());
+            return;
+        }
+        uint64_t requestId = ++m_inBandRequestId;
+        // registered before writing, the response might arrive before the write completed
+        m_pendingInBandRequests[requestId] = resultCb;
+
+        nlohmann::json request;
+        request[daq::jsonrpc::JSONRPC] = "2.0";
+        request[daq::jsonrpc::METHOD] = method;
+        request[daq::jsonrpc::PARAMS] = signalIds;
+        request[daq::jsonrpc::ID] = requestId;
+        std::vector < uint8_t > msgpack = nlohmann::json::to_msgpack(request);
+
+        uint32_t transportHeaderBuffer[2];
+        const uint32_t metaType = METAINFORMATION_MSGPACK;
+        size_t headerSize = StreamWriter::createTransportHeader(TYPE_METAINFORMATION, 0, transportHeaderBuffer, msgpack.size() + sizeof(metaType));
+        InBandWrite inBandWrite;
+        inBandWrite.requestId = requestId;
+        inBandWrite.package.reserve(headerSize + sizeof(metaType) + msgpack.size());
+        const uint8_t* pHeader = reinterpret_cast < const uint8_t* > (transportHeaderBuffer);
+        inBandWrite.package.insert(inBandWrite.package.end(), pHeader, pHeader + headerSize);
+        const uint8_t* pMetaType = reinterpret_cast < const uint8_t* > (&metaType);
+        inBandWrite.package.insert(inBandWrite.package.end(), pMetaType, pMetaType + sizeof(metaType));
+        inBandWrite.package.insert(inBandWrite.package.end(), msgpack.begin(), msgpack.end());
+        m_inBandWrites.push_back(std::move(inBandWrite));
+        if (m_inBandWrites.size() == 1) {
+            // otherwise written after the write in progress completed
+            doWriteInBand();
         }
     }
 
+    void ProtocolHandler::doWriteInBand()
+    {
+        const std::vector < uint8_t >& package = m_inBandWrites.front().package;
+        m_stream->asyncWrite(boost::asio::const_buffer(package.data(), package.size()), [self = shared_from_this()](const boost::system::error_code& ec, std::size_t) {
+            self->onInBandWritten(ec);
+        });
+    }
+
+    void ProtocolHandler::onInBandWritten(const boost::system::error_code& ec)
+    {
+        uint64_t requestId = m_inBandWrites.front().requestId;
+        m_inBandWrites.pop_front();
+        if (!m_stream) {
+            // The session got closed, the pending in-band requests were completed on close.
+            m_inBandWrites.clear();
+            releaseClosedStream();
+            return;
+        }
+
+        ControlResultCb resultCb;
+        if (ec) {
+            STREAMING_PROTOCOL_LOG_E("Writing in-band request failed: {}", ec.message());
+            auto iter = m_pendingInBandRequests.find(requestId);
+            if (iter != m_pendingInBandRequests.end()) {
+                resultCb = std::move(iter->second);
+                m_pendingInBandRequests.erase(iter);
+            }
+        }
+        // before completing, the completion callback might write the next request
+        if (!m_inBandWrites.empty()) {
+            doWriteInBand();
+        }
+        if (resultCb) {
+            resultCb(ec, nlohmann::json());
+        }
+    }
+
+    void ProtocolHandler::processInBandResponse(const MsgpackView& response)
+    {
+        auto iter = m_pendingInBandRequests.find(response.find(daq::jsonrpc::ID).asUnsigned());
+        MsgpackView error = response.find(daq::jsonrpc::ERR);
+        boost::system::error_code ec;
+        if (error.valid()) {
+            STREAMING_PROTOCOL_LOG_E("In-band request failed: {}", error.find(daq::jsonrpc::MESSAGE).asStringView());
+            ec = boost::asio::error::invalid_argument;
+        }
+        if (iter == m_pendingInBandRequests.end()) {
+            // i.e. the error response to an invalid request without id
+            return;
+        }
+        nlohmann::json result;
+        MsgpackView resultView = response.find(daq::jsonrpc::RESULT);
+        if (resultView.valid()) {
+            result = resultView.toJson();
+        }
+        ControlResultCb resultCb = std::move(iter->second);
+        m_pendingInBandRequests.erase(iter);
+        resultCb(ec, result);
+    }
+
     void daq::streaming_protocol::ProtocolHandler::closeSession(const boost::system::error_code &SessionEc, char const* what)
     {
         m_sessionEc = SessionEc;
@@ -95,7 +275,11 @@ namespace daq::streaming_protocol {
             closeSession(ec, "stream initialization failed!");
             return;
         }
-        m_stream->asyncRead(std::bind(&ProtocolHandler::onHeader, shared_from_this(), std::placeholders::_1), sizeof(m_header));
+        if (m_receiveMode == RECEIVEMODE_BATCHED) {
+            doReadBatch(sizeof(m_header));
+            return;
+        }
+        doRead(sizeof(m_header), &ProtocolHandler::onHeader);
     }
     
     void ProtocolHandler::onHeader(const boost::system::error_code& ec)
@@ -111,10 +295,10 @@ namespace daq::streaming_protocol {
         
         if (m_length == 0) {
             // length is to be found in additional length field
-            m_stream->asyncRead(std::bind(&ProtocolHandler::onAdditionalLength, shared_from_this(), std::placeholders::_1), sizeof(m_length));
+            doRead(sizeof(m_length), &ProtocolHandler::onAdditionalLength);
         } else {
             // read payload
-            m_stream->asyncRead(std::bind(&ProtocolHandler::onPayload, shared_from_this(), std::placeholders::_1), m_length);
+            doRead(m_length, &ProtocolHandler::onPayload);
         }
     }
     
@@ -127,7 +311,7 @@ namespace daq::streaming_protocol {
         m_stream->copyDataAndConsume(&m_length, sizeof(m_length));
         
         // read payload
-        m_stream->asyncRead(std::bind(&ProtocolHandler::onPayload, shared_from_this(), std::placeholders::_1), m_length);
+        doRead(m_length, &ProtocolHandler::onPayload);
     }
     
     void ProtocolHandler::onPayload(const boost::system::error_code& ec)
@@ -137,6 +321,120 @@ namespace daq::streaming_protocol {
             return;
         }
         
+        if (processPayload() < 0) {
+            return;
+        }
+        // Payload is processed.
+        m_stream->consume(m_length);
+        
+        /// Now from the beginning: Next header...
+        doRead(sizeof(m_header), &ProtocolHandler::onHeader);
+    }
+
+    void ProtocolHandler::holdSession()
+    {
+        // never expires, the wait is canceled when the stream got closed
+        m_sessionTimer.expires_at(boost::asio::steady_timer::time_point::max());
+        m_sessionTimer.async_wait([self = shared_from_this()](const boost::system::error_code&) {
+        });
+    }
+
+    void ProtocolHandler::doRead(size_t bytesRequired, ReadStep readStep)
+    {
+        m_readStep = readStep;
+        size_t bytesAvailable = m_stream->size();
+        if (bytesAvailable >= bytesRequired) {
+            // go back to the io context after each step anyway
+            m_readPending = true;
+            boost::asio::post(m_ioc, [this]() {
+                if (onReadComplete()) {
+                    (this->*m_readStep)(boost::system::error_code());
+                }
+            });
+            return;
+        }
+        m_readPending = true;
+        m_stream->asyncReadAtLeast(bytesRequired - bytesAvailable, [this](const boost::system::error_code& ec, std::size_t) {
+            if (onReadComplete()) {
+                (this->*m_readStep)(ec);
+            }
+        });
+    }
+
+    void ProtocolHandler::doReadBatch(size_t bytesMissing)
+    {
+        m_readPending = true;
+        m_stream->asyncReadAtLeast(bytesMissing, [this](const boost::system::error_code& ec, std::size_t bytesRead) {
+            if (onReadComplete()) {
+                onReadBatch(ec, bytesRead);
+            }
+        });
+    }
+
+    bool ProtocolHandler::onReadComplete()
+    {
+        m_readPending = false;
+        if (m_stream) {
+            return true;
+        }
+        // The session got closed while the read was pending. The stream and this object were kept for this completion.
+        releaseClosedStream();
+        m_sessionTimer.cancel();
+        return false;
+    }
+
+    void ProtocolHandler::releaseClosedStream()
+    {
+        if (!m_readPending && m_inBandWrites.empty()) {
+            m_closedStream.reset();
+        }
+    }
+
+    void ProtocolHandler::onReadBatch(const boost::system::error_code& ec, std::size_t)
+    {
+        if(ec) {
+            closeSession(ec, "failed reading protocol data!");
+            return;
+        }
+
+        // process all complete packages in the buffer before going back to the io context
+        while (true) {
+            size_t bytesAvailable = m_stream->size();
+            if (bytesAvailable < sizeof(m_header)) {
+                doReadBatch(sizeof(m_header) - bytesAvailable);
+                return;
+            }
+            const uint8_t* pData = m_stream->data();
+            memcpy(&m_header, pData, sizeof(m_header));
+            m_signalNumber = m_header & SIGNAL_NUMBER_MASK;
+            m_type = static_cast < TransportType > ((m_header & TYPE_MASK) >> TYPE_SHIFT);
+            m_length = (m_header & SIZE_MASK) >> SIZE_SHIFT;
+            size_t headerSize = sizeof(m_header);
+            if (m_length == 0) {
+                // length is to be found in additional length field
+                if (bytesAvailable < sizeof(m_header) + sizeof(m_length)) {
+                    doReadBatch(sizeof(m_header) + sizeof(m_length) - bytesAvailable);
+                    return;
+                }
+                memcpy(&m_length, pData + sizeof(m_header), sizeof(m_length));
+                headerSize += sizeof(m_length);
+            }
+            if (bytesAvailable < headerSize + m_length) {
+                // wait for the remainder of the package
+                doReadBatch(headerSize + m_length - bytesAvailable);
+                return;
+            }
+            m_stream->consume(headerSize);
+            if (processPayload() < 0) {
+                return;
+            }
+            // Payload is processed.
+            m_stream->consume(m_length);
+        }
+    }
+
+    int ProtocolHandler::processPayload()
+    {
         switch(m_type) {
         case TYPE_SIGNALDATA:
             if (m_signalContainer.processMeasuredData(m_signalNumber, m_stream->data(), m_length) < 0) {
@@ -148,27 +446,37 @@ namespace daq::streaming_protocol {
             if (m_metaInformation.interpret(m_stream->data(), m_length)) {
                 boost::system::error_code localEc = boost::system::errc::make_error_code(boost::system::errc::protocol_error);
                 closeSession(localEc, "failed to interpret meta information!");
-                return;
+                return -1;
             }
             if (m_signalNumber == 0) {
+                if ((m_metaInformation.methodType() == METHODTYPE_UNKNOWN) && (m_metaInformation.type() == METAINFORMATION_MSGPACK)) {
+                    // responses to in-band requests carry an id and no method
+                    MsgpackView content = m_metaInformation.content();
+                    if (content.find(daq::jsonrpc::ID).valid() && !content.find(daq::jsonrpc::METHOD).valid()) {
+                        processInBandResponse(content);
+                        break;
+                    }
+                }
                 if (m_streamMeta.processMetaInformation(m_metaInformation, m_stream->endPointUrl()) < 0) {
                     boost::system::error_code localEc = boost::system::errc::make_error_code(boost::system::errc::protocol_error);
                     closeSession(localEc, "failed to interpret stream related meta information!");
-                    return;
+                    return -1;
                 }
                 if (m_metaInformation.type()!=METAINFORMATION_MSGPACK) {
                     boost::system::error_code localEc = boost::system::errc::make_error_code(boost::system::errc::protocol_error);
                     closeSession(localEc, "unsupported meta information type");
-                    return;
+                    return -1;
+                }
+                if (m_streamMetaCb) {
+                    m_streamMetaCb(*this, m_metaInformation.method(), m_metaInformation.params());
                 }
-                m_streamMetaCb(*this, m_metaInformation.method(), m_metaInformation.params());
             } else {
                 if (m_signalContainer.processMetaInformation(m_signalNumber, m_metaInformation)<0 ) {
                     boost::system::error_code localEc = boost::system::errc::make_error_code(boost::system::errc::protocol_error);
                     std::string message;
                     message = "failed to interpret meta information for signal " + std::to_string(m_signalNumber) + "!";
                     closeSession(localEc, message.c_str());
-                    return;
+                    return -1;
                 }
             }
             break;
@@ -180,19 +488,34 @@ namespace daq::streaming_protocol {
                         ", signal number: " + std::to_string(m_signalNumber) +
                         ", length: " + std::to_string(m_length);
                 closeSession(localEc, message.c_str());
-                return;
+                return -1;
             }
         }
-        // Payload is processed.
-        m_stream->consume(m_length);
-        
-        /// Now from the beginning: Next header...
-        m_stream->asyncRead(std::bind(&ProtocolHandler::onHeader, shared_from_this(), std::placeholders::_1), sizeof(m_header));
+        return 0;
     }
 
     void daq::streaming_protocol::ProtocolHandler::onClose(const boost::system::error_code &ec)
     {
-        m_stream.reset();
+        if (m_readPending || !m_inBandWrites.empty()) {
+            // pending operations still use the stream, it is destroyed when they completed
+            m_closedStream = std::move(m_stream);
+        } else {
+            m_stream.reset();
+        }
+        // the control connection belongs to the session
+        std::unique_ptr < Controller > controller = std::move(m_controller);
+        if (controller) {
+            controller->close();
+        }
+        std::map < uint64_t, ControlResultCb > pendingInBandRequests;
+        pendingInBandRequests.swap(m_pendingInBandRequests);
+        for (auto& pendingInBandRequest : pendingInBandRequests) {
+            pendingInBandRequest.second(boost::asio::error::operation_aborted, nlohmann::json());
+        }
+        if (!m_readPending) {
+            // Releases the session. Otherwise the completion of the pending read does.
+            m_sessionTimer.cancel();
+        }
         if (ec) {
             STREAMING_PROTOCOL_LOG_E("Error on close: {}", ec.message());
         }
@@ -0,0 +1,690 @@
+#include <cstring>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define SAMPLECONVERTER_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SAMPLECONVERTER_X86) && (defined(__GNUC__) || defined(__clang__))
+/// Allows using intrinsics of the given instruction set within a function without compiling the whole library for it
+#define SAMPLECONVERTER_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SAMPLECONVERTER_TARGET(isa)
+#endif
+
+#include "streaming_protocol/SampleConverter.hpp"
+
+namespace daq::streaming_protocol {
+    /// Post scaling and range as applied by all kernels
+    struct Transform
+    {
+        bool scaled;
+        double scale;
+        double offset;
+        bool clamped;
+        double low;
+        double high;
+    };
+
+    template < typename Result >
+    using ScalarKernel = void (*)(const uint8_t* source, size_t stride, size_t count, Result* results, size_t resultStride, const Transform& transform);
+
+    /// Vector kernels store the results one after the other. Indexed values have their value index right in front.
+    template < typename Result >
+    using VectorKernel = void (*)(const uint8_t* source, size_t stride, size_t count, Result* results, const Transform& transform);
+
+    /// \return 0 for sample types that are no scalars
+    static size_t elementSize(SampleType sampleType)
+    {
+        switch (sampleType) {
+        case SAMPLETYPE_U8:
+        case SAMPLETYPE_S8:
+            return sizeof(uint8_t);
+        case SAMPLETYPE_U16:
+        case SAMPLETYPE_S16:
+            return sizeof(uint16_t);
+        case SAMPLETYPE_U32:
+        case SAMPLETYPE_S32:
+        case SAMPLETYPE_BITFIELD32:
+            return sizeof(uint32_t);
+        case SAMPLETYPE_U64:
+        case SAMPLETYPE_S64:
+        case SAMPLETYPE_BITFIELD64:
+            return sizeof(uint64_t);
+        case SAMPLETYPE_REAL32:
+            return sizeof(float);
+        case SAMPLETYPE_REAL64:
+            return sizeof(double);
+        default:
+            return 0;
+        }
+    }
+
+    static inline double applyTransform(double value, const Transform& transform)
+    {
+        if (transform.scaled) {
+            value = value * transform.scale + transform.offset;
+        }
+        if (transform.clamped) {
+            // Same comparisons as done by the max/min vector instructions. NaN results in the lower limit.
+            value = (value > transform.low) ? value : transform.low;
+            value = (value < transform.high) ? value : transform.high;
+        }
+        return value;
+    }
+
+    template < typename Source, typename Result >
+    static void convertScalar(const uint8_t* source, size_t stride, size_t count, Result* results, size_t resultStride, const Transform& transform)
+    {
+        Source value;
+        if ((stride == sizeof(Source)) && (resultStride == 1) && !transform.scaled && !transform.clamped) {
+            // simple loop the compiler is able to vectorize for the baseline instruction set
+            for (size_t index = 0; index < count; ++index) {
+                memcpy(&value, source + index * sizeof(Source), sizeof(value));
+                results[index] = static_cast < Result > (static_cast < double > (value));
+            }
+            return;
+        }
+
+        for (size_t index = 0; index < count; ++index) {
+            memcpy(&value, source, sizeof(value));
+            *results = static_cast < Result > (applyTransform(static_cast < double > (value), transform));
+            source += stride;
+            results += resultStride;
+        }
+    }
+
+    template < typename Result >
+    static ScalarKernel < Result > scalarKernel(SampleType sampleType)
+    {
+        switch (sampleType) {
+        case SAMPLETYPE_U8:
+            return convertScalar < uint8_t, Result >;
+        case SAMPLETYPE_S8:
+            return convertScalar < int8_t, Result >;
+        case SAMPLETYPE_U16:
+            return convertScalar < uint16_t, Result >;
+        case SAMPLETYPE_S16:
+            return convertScalar < int16_t, Result >;
+        case SAMPLETYPE_U32:
+        case SAMPLETYPE_BITFIELD32:
+            return convertScalar < uint32_t, Result >;
+        case SAMPLETYPE_S32:
+            return convertScalar < int32_t, Result >;
+        case SAMPLETYPE_U64:
+        case SAMPLETYPE_BITFIELD64:
+            return convertScalar < uint64_t, Result >;
+        case SAMPLETYPE_S64:
+            return convertScalar < int64_t, Result >;
+        case SAMPLETYPE_REAL32:
+            return convertScalar < float, Result >;
+        default:
+            return convertScalar < double, Result >;
+        }
+    }
+
+#ifdef SAMPLECONVERTER_X86
+    /// There is no instruction converting 64 bit integers before AVX-512.
+    /// The upper and lower part are put into the mantissa of two doubles which are added. There is one rounding only.
+    SAMPLECONVERTER_TARGET("sse4.1") static inline __m128d uint64ToDouble(__m128i values)
+    {
+        __m128i high = _mm_or_si128(_mm_srli_epi64(values, 32), _mm_castpd_si128(_mm_set1_pd(0x1p84)));
+        __m128i low = _mm_blend_epi16(values, _mm_castpd_si128(_mm_set1_pd(0x1p52)), 0xcc);
+        __m128d result = _mm_sub_pd(_mm_castsi128_pd(high), _mm_set1_pd(0x1p84 + 0x1p52));
+        return _mm_add_pd(result, _mm_castsi128_pd(low));
+    }
+
+    SAMPLECONVERTER_TARGET("sse4.1") static inline __m128d int64ToDouble(__m128i values)
+    {
+        __m128i high = _mm_blend_epi16(_mm_srai_epi32(values, 16), _mm_setzero_si128(), 0x33);
+        high = _mm_add_epi64(high, _mm_castpd_si128(_mm_set1_pd(0x1.8p68)));
+        __m128i low = _mm_blend_epi16(values, _mm_castpd_si128(_mm_set1_pd(0x1p52)), 0x88);
+        __m128d result = _mm_sub_pd(_mm_castsi128_pd(high), _mm_set1_pd(0x1.8p68 + 0x1p52));
+        return _mm_add_pd(result, _mm_castsi128_pd(low));
+    }
+
+    /// A value of up to 32 bit as 32 bit lane. Integers are sign or zero extended, float keeps its bit pattern.
+    template < typename Source >
+    static inline int lane(const uint8_t* source)
+    {
+        if constexpr (sizeof(Source) == sizeof(int32_t)) {
+            int32_t bits;
+            memcpy(&bits, source, sizeof(bits));
+            return bits;
+        } else {
+            Source value;
+            memcpy(&value, source, sizeof(value));
+            return value;
+        }
+    }
+
+    /// \param values 2 values. 64 bit lanes for 64 bit types, 32 bit lanes for all others.
+    template < typename Source >
+    SAMPLECONVERTER_TARGET("sse4.1") static inline __m128d toDoubleSse41(__m128i values)
+    {
+        if constexpr (std::is_same_v < Source, int64_t >) {
+            return int64ToDouble(values);
+        } else if constexpr (std::is_same_v < Source, uint64_t >) {
+            return uint64ToDouble(values);
+        } else if constexpr (std::is_same_v < Source, double >) {
+            return _mm_castsi128_pd(values);
+        } else if constexpr (std::is_same_v < Source, float >) {
+            return _mm_cvtps_pd(_mm_castsi128_ps(values));
+        } else if constexpr (std::is_same_v < Source, uint32_t >) {
+            __m128i shifted = _mm_xor_si128(values, _mm_set1_epi32(INT32_MIN));
+            return _mm_add_pd(_mm_cvtepi32_pd(shifted), _mm_set1_pd(0x1p31));
+        } else {
+            return _mm_cvtepi32_pd(values);
+        }
+    }
+
+    /// Loads 2 consecutive values
+    template < typename Source >
+    SAMPLECONVERTER_TARGET("sse4.1") static inline __m128d loadSse41(const uint8_t* source)
+    {
+        if constexpr (sizeof(Source) == sizeof(uint8_t)) {
+            __m128i values = _mm_cvtsi32_si128(lane < uint16_t > (source));
+            if constexpr (std::is_signed_v < Source >) {
+                return toDoubleSse41 < Source > (_mm_cvtepi8_epi32(values));
+            } else {
+                return toDoubleSse41 < Source > (_mm_cvtepu8_epi32(values));
+            }
+        } else if constexpr (sizeof(Source) == sizeof(uint16_t)) {
+            __m128i values = _mm_cvtsi32_si128(lane < uint32_t > (source));
+            if constexpr (std::is_signed_v < Source >) {
+                return toDoubleSse41 < Source > (_mm_cvtepi16_epi32(values));
+            } else {
+                return toDoubleSse41 < Source > (_mm_cvtepu16_epi32(values));
+            }
+        } else if constexpr (sizeof(Source) == sizeof(uint32_t)) {
+            return toDoubleSse41 < Source > (_mm_loadl_epi64(reinterpret_cast < const __m128i* > (source)));
+        } else {
+            return toDoubleSse41 < Source > (_mm_loadu_si128(reinterpret_cast < const __m128i* > (source)));
+        }
+    }
+
+    /// Loads 2 values, each one preceded by its value index. Value indices are dropped.
+    template < typename Source >
+    SAMPLECONVERTER_TARGET("sse4.1") static inline __m128d loadIndexedSse41(const uint8_t* source)
+    {
+        constexpr size_t stride = sizeof(uint64_t) + sizeof(Source);
+        if constexpr (sizeof(Source) == sizeof(uint64_t)) {
+            // value index and value are in the lower and upper half of a 128 bit register
+            __m128i first = _mm_loadu_si128(reinterpret_cast < const __m128i* > (source - sizeof(uint64_t)));
+            __m128i second = _mm_loadu_si128(reinterpret_cast < const __m128i* > (source + stride - sizeof(uint64_t)));
+            return toDoubleSse41 < Source > (_mm_unpackhi_epi64(first, second));
+        } else {
+            return toDoubleSse41 < Source > (_mm_setr_epi32(lane < Source > (source), lane < Source > (source + stride), 0, 0));
+        }
+    }
+
+    SAMPLECONVERTER_TARGET("sse4.1") static inline void storeSse41(double* results, __m128d values)
+    {
+        _mm_storeu_pd(results, values);
+    }
+
+    SAMPLECONVERTER_TARGET("sse4.1") static inline void storeSse41(float* results, __m128d values)
+    {
+        _mm_storel_epi64(reinterpret_cast < __m128i* > (results), _mm_castps_si128(_mm_cvtpd_ps(values)));
+    }
+
+    template < bool Transformed >
+    SAMPLECONVERTER_TARGET("sse4.1") static inline __m128d transformSse41(__m128d values, const Transform& transform, __m128d scale, __m128d offset, __m128d low, __m128d high)
+    {
+        if constexpr (Transformed) {
+            if (transform.scaled) {
+                values = _mm_add_pd(_mm_mul_pd(values, scale), offset);
+            }
+            if (transform.clamped) {
+                values = _mm_min_pd(_mm_max_pd(values, low), high);
+            }
+        }
+        return values;
+    }
+
+    /// \return Number of values processed. The remainder is left to the scalar kernel.
+    template < typename Source, typename Result, bool Transformed >
+    SAMPLECONVERTER_TARGET("sse4.1") static size_t convertSse41Loop(const uint8_t* source, size_t stride, size_t count, Result* results, const Transform& transform)
+    {
+        const __m128d scale = _mm_set1_pd(transform.scale);
+        const __m128d offset = _mm_set1_pd(transform.offset);
+        const __m128d low = _mm_set1_pd(transform.low);
+        const __m128d high = _mm_set1_pd(transform.high);
+        const bool indexed = (stride == sizeof(uint64_t) + sizeof(Source));
+        if ((stride != sizeof(Source)) && !indexed) {
+            return 0;
+        }
+
+        size_t index = 0;
+        if (indexed) {
+            for (; index + 2 <= count; index += 2) {
+                __m128d values = loadIndexedSse41 < Source > (source + index * stride);
+                storeSse41(results + index, transformSse41 < Transformed > (values, transform, scale, offset, low, high));
+            }
+        } else {
+            for (; index + 2 <= count; index += 2) {
+                __m128d values = loadSse41 < Source > (source + index * stride);
+                storeSse41(results + index, transformSse41 < Transformed > (values, transform, scale, offset, low, high));
+            }
+        }
+        return index;
+    }
+
+    template < typename Source, typename Result >
+    SAMPLECONVERTER_TARGET("sse4.1") static void convertSse41(const uint8_t* source, size_t stride, size_t count, Result* results, const Transform& transform)
+    {
+        size_t index;
+        if (transform.scaled || transform.clamped) {
+            index = convertSse41Loop < Source, Result, true > (source, stride, count, results, transform);
+        } else {
+            index = convertSse41Loop < Source, Result, false > (source, stride, count, results, transform);
+        }
+        convertScalar < Source, Result > (source + index * stride, stride, count - index, results + index, 1, transform);
+    }
+
+    SAMPLECONVERTER_TARGET("avx2") static inline __m256d uint64ToDouble(__m256i values)
+    {
+        __m256i high = _mm256_or_si256(_mm256_srli_epi64(values, 32), _mm256_castpd_si256(_mm256_set1_pd(0x1p84)));
+        __m256i low = _mm256_blend_epi16(values, _mm256_castpd_si256(_mm256_set1_pd(0x1p52)), 0xcc);
+        __m256d result = _mm256_sub_pd(_mm256_castsi256_pd(high), _mm256_set1_pd(0x1p84 + 0x1p52));
+        return _mm256_add_pd(result, _mm256_castsi256_pd(low));
+    }
+
+    SAMPLECONVERTER_TARGET("avx2") static inline __m256d int64ToDouble(__m256i values)
+    {
+        __m256i high = _mm256_blend_epi16(_mm256_srai_epi32(values, 16), _mm256_setzero_si256(), 0x33);
+        high = _mm256_add_epi64(high, _mm256_castpd_si256(_mm256_set1_pd(0x1.8p68)));
+        __m256i low = _mm256_blend_epi16(values, _mm256_castpd_si256(_mm256_set1_pd(0x1p52)), 0x88);
+        __m256d result = _mm256_sub_pd(_mm256_castsi256_pd(high), _mm256_set1_pd(0x1.8p68 + 0x1p52));
+        return _mm256_add_pd(result, _mm256_castsi256_pd(low));
+    }
+
+    /// \param values 4 values of up to 32 bit as 32 bit lanes
+    template < typename Source >
+    SAMPLECONVERTER_TARGET("avx2") static inline __m256d toDoubleAvx2(__m128i values)
+    {
+        if constexpr (std::is_same_v < Source, float >) {
+            return _mm256_cvtps_pd(_mm_castsi128_ps(values));
+        } else if constexpr (std::is_same_v < Source, uint32_t >) {
+            __m128i shifted = _mm_xor_si128(values, _mm_set1_epi32(INT32_MIN));
+            return _mm256_add_pd(_mm256_cvtepi32_pd(shifted), _mm256_set1_pd(0x1p31));
+        } else {
+            return _mm256_cvtepi32_pd(values);
+        }
+    }
+
+    /// \param values 4 values of 64 bit
+    template < typename Source >
+    SAMPLECONVERTER_TARGET("avx2") static inline __m256d toDoubleAvx2(__m256i values)
+    {
+        if constexpr (std::is_same_v < Source, int64_t >) {
+            return int64ToDouble(values);
+        } else if constexpr (std::is_same_v < Source, uint64_t >) {
+            return uint64ToDouble(values);
+        } else {
+            return _mm256_castsi256_pd(values);
+        }
+    }
+
+    /// Loads 4 consecutive values
+    template < typename Source >
+    SAMPLECONVERTER_TARGET("avx2") static inline __m256d loadAvx2(const uint8_t* source)
+    {
+        if constexpr (sizeof(Source) == sizeof(uint8_t)) {
+            __m128i values = _mm_cvtsi32_si128(lane < uint32_t > (source));
+            if constexpr (std::is_signed_v < Source >) {
+                return toDoubleAvx2 < Source > (_mm_cvtepi8_epi32(values));
+            } else {
+                return toDoubleAvx2 < Source > (_mm_cvtepu8_epi32(values));
+            }
+        } else if constexpr (sizeof(Source) == sizeof(uint16_t)) {
+            __m128i values = _mm_loadl_epi64(reinterpret_cast < const __m128i* > (source));
+            if constexpr (std::is_signed_v < Source >) {
+                return toDoubleAvx2 < Source > (_mm_cvtepi16_epi32(values));
+            } else {
+                return toDoubleAvx2 < Source > (_mm_cvtepu16_epi32(values));
+            }
+        } else if constexpr (sizeof(Source) == sizeof(uint32_t)) {
+            return toDoubleAvx2 < Source > (_mm_loadu_si128(reinterpret_cast < const __m128i* > (source)));
+        } else {
+            return toDoubleAvx2 < Source > (_mm256_loadu_si256(reinterpret_cast < const __m256i* > (source)));
+        }
+    }
+
+    /// Loads 4 values, each one preceded by its value index. Value indices are dropped.
+    /// \note Gather instructions are avoided. They are slow on many CPUs.
+    template < typename Source >
+    SAMPLECONVERTER_TARGET("avx2") static inline __m256d loadIndexedAvx2(const uint8_t* source)
+    {
+        constexpr size_t stride = sizeof(uint64_t) + sizeof(Source);
+        if constexpr (sizeof(Source) == sizeof(uint64_t)) {
+            // {index0, value0, index1, value1}, {index2, value2, index3, value3}
+            __m256i first = _mm256_loadu_si256(reinterpret_cast < const __m256i* > (source - sizeof(uint64_t)));
+            __m256i second = _mm256_loadu_si256(reinterpret_cast < const __m256i* > (source + 2 * stride - sizeof(uint64_t)));
+            // unpacking works within 128 bit lanes: {value0, value2, value1, value3}
+            __m256i values = _mm256_unpackhi_epi64(first, second);
+            return toDoubleAvx2 < Source > (_mm256_permute4x64_epi64(values, _MM_SHUFFLE(3, 1, 2, 0)));
+        } else {
+            __m128i values = _mm_setr_epi32(lane < Source > (source), lane < Source > (source + stride), lane < Source > (source + 2 * stride), lane < Source > (source + 3 * stride));
+            return toDoubleAvx2 < Source > (values);
+        }
+    }
+
+    SAMPLECONVERTER_TARGET("avx2") static inline void storeAvx2(double* results, __m256d values)
+    {
+        _mm256_storeu_pd(results, values);
+    }
+
+    SAMPLECONVERTER_TARGET("avx2") static inline void storeAvx2(float* results, __m256d values)
+    {
+        _mm_storeu_ps(results, _mm256_cvtpd_ps(values));
+    }
+
+    template < bool Transformed >
+    SAMPLECONVERTER_TARGET("avx2") static inline __m256d transformAvx2(__m256d values, const Transform& transform, __m256d scale, __m256d offset, __m256d low, __m256d high)
+    {
+        if constexpr (Transformed) {
+            if (transform.scaled) {
+                values = _mm256_add_pd(_mm256_mul_pd(values, scale), offset);
+            }
+            if (transform.clamped) {
+                values = _mm256_min_pd(_mm256_max_pd(values, low), high);
+            }
+        }
+        return values;
+    }
+
+    /// \return Number of values processed. The remainder is left to the scalar kernel.
+    template < typename Source, typename Result, bool Transformed >
+    SAMPLECONVERTER_TARGET("avx2") static size_t convertAvx2Loop(const uint8_t* source, size_t stride, size_t count, Result* results, const Transform& transform)
+    {
+        const __m256d scale = _mm256_set1_pd(transform.scale);
+        const __m256d offset = _mm256_set1_pd(transform.offset);
+        const __m256d low = _mm256_set1_pd(transform.low);
+        const __m256d high = _mm256_set1_pd(transform.high);
+        const bool indexed = (stride == sizeof(uint64_t) + sizeof(Source));
+        if ((stride != sizeof(Source)) && !indexed) {
+            return 0;
+        }
+
+        size_t index = 0;
+        if (indexed) {
+            for (; index + 4 <= count; index += 4) {
+                __m256d values = loadIndexedAvx2 < Source > (source + index * stride);
+                storeAvx2(results + index, transformAvx2 < Transformed > (values, transform, scale, offset, low, high));
+            }
+        } else {
+            for (; index + 4 <= count; index += 4) {
+                __m256d values = loadAvx2 < Source > (source + index * stride);
+                storeAvx2(results + index, transformAvx2 < Transformed > (values, transform, scale, offset, low, high));
+            }
+        }
+        return index;
+    }
+
+    template < typename Source, typename Result >
+    SAMPLECONVERTER_TARGET("avx2") static void convertAvx2(const uint8_t* source, size_t stride, size_t count, Result* results, const Transform& transform)
+    {
+        size_t index;
+        if (transform.scaled || transform.clamped) {
+            index = convertAvx2Loop < Source, Result, true > (source, stride, count, results, transform);
+        } else {
+            index = convertAvx2Loop < Source, Result, false > (source, stride, count, results, transform);
+        }
+        convertScalar < Source, Result > (source + index * stride, stride, count - index, results + index, 1, transform);
+    }
+
+    template < typename Result >
+    static VectorKernel < Result > sse41Kernel(SampleType sampleType)
+    {
+        switch (sampleType) {
+        case SAMPLETYPE_U8:
+            return convertSse41 < uint8_t, Result >;
+        case SAMPLETYPE_S8:
+            return convertSse41 < int8_t, Result >;
+        case SAMPLETYPE_U16:
+            return convertSse41 < uint16_t, Result >;
+        case SAMPLETYPE_S16:
+            return convertSse41 < int16_t, Result >;
+        case SAMPLETYPE_U32:
+        case SAMPLETYPE_BITFIELD32:
+            return convertSse41 < uint32_t, Result >;
+        case SAMPLETYPE_S32:
+            return convertSse41 < int32_t, Result >;
+        case SAMPLETYPE_U64:
+        case SAMPLETYPE_BITFIELD64:
+            return convertSse41 < uint64_t, Result >;
+        case SAMPLETYPE_S64:
+            return convertSse41 < int64_t, Result >;
+        case SAMPLETYPE_REAL32:
+            return convertSse41 < float, Result >;
+        default:
+            return convertSse41 < double, Result >;
+        }
+    }
+
+    template < typename Result >
+    static VectorKernel < Result > avx2Kernel(SampleType sampleType)
+    {
+        switch (sampleType) {
+        case SAMPLETYPE_U8:
+            return convertAvx2 < uint8_t, Result >;
+        case SAMPLETYPE_S8:
+            return convertAvx2 < int8_t, Result >;
+        case SAMPLETYPE_U16:
+            return convertAvx2 < uint16_t, Result >;
+        case SAMPLETYPE_S16:
+            return convertAvx2 < int16_t, Result >;
+        case SAMPLETYPE_U32:
+        case SAMPLETYPE_BITFIELD32:
+            return convertAvx2 < uint32_t, Result >;
+        case SAMPLETYPE_S32:
+            return convertAvx2 < int32_t, Result >;
+        case SAMPLETYPE_U64:
+        case SAMPLETYPE_BITFIELD64:
+            return convertAvx2 < uint64_t, Result >;
+        case SAMPLETYPE_S64:
+            return convertAvx2 < int64_t, Result >;
+        case SAMPLETYPE_REAL32:
+            return convertAvx2 < float, Result >;
+        default:
+            return convertAvx2 < double, Result >;
+        }
+    }
+#endif
+
+    /// Results of consecutive elements are stored one after the other if resultStride is 1. Vector kernels are used then.
+    template < typename Result >
+    static void convertElements(SampleConverter::InstructionSet instructionSet, SampleType sampleType, const uint8_t* source, size_t stride, size_t count, Result* results, size_t resultStride, const Transform& transform)
+    {
+#ifdef SAMPLECONVERTER_X86
+        if (resultStride == 1) {
+            switch (instructionSet) {
+            case SampleConverter::INSTRUCTIONSET_AVX2:
+                avx2Kernel < Result > (sampleType)(source, stride, count, results, transform);
+                return;
+            case SampleConverter::INSTRUCTIONSET_SSE41:
+                sse41Kernel < Result > (sampleType)(source, stride, count, results, transform);
+                return;
+            default:
+                break;
+            }
+        }
+#endif
+        scalarKernel < Result > (sampleType)(source, stride, count, results, resultStride, transform);
+    }
+
+    static SampleConverter::InstructionSet detectInstructionSet()
+    {
+#if defined(SAMPLECONVERTER_X86) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+        __cpuid(info, 1);
+        bool sse41 = (info[2] & (1 << 19)) != 0;
+        // AVX registers need to be saved by the operating system
+        bool avxUsable = ((info[2] & (1 << 27)) != 0) && ((info[2] & (1 << 28)) != 0) && ((_xgetbv(0) & 0x6) == 0x6);
+        bool avx2 = false;
+        if ((maxLeaf >= 7) && avxUsable) {
+            __cpuidex(info, 7, 0);
+            avx2 = (info[1] & (1 << 5)) != 0;
+        }
+#elif defined(SAMPLECONVERTER_X86)
+        __builtin_cpu_init();
+        bool sse41 = __builtin_cpu_supports("sse4.1");
+        bool avx2 = __builtin_cpu_supports("avx2");
+#else
+        bool sse41 = false;
+        bool avx2 = false;
+#endif
+        if (avx2) {
+            return SampleConverter::INSTRUCTIONSET_AVX2;
+        } else if (sse41) {
+            return SampleConverter::INSTRUCTIONSET_SSE41;
+        }
+        return SampleConverter::INSTRUCTIONSET_SCALAR;
+    }
+
+    SampleConverter::InstructionSet SampleConverter::supportedInstructionSet()
+    {
+        static const InstructionSet instructionSet = detectInstructionSet();
+        return instructionSet;
+    }
+
+    SampleConverter::SampleConverter()
+        : m_uniform(true)
+        , m_indexed(false)
+        , m_valueSize(0)
+        , m_instructionSet(supportedInstructionSet())
+    {
+    }
+
+    int SampleConverter::setElementTypes(const std::vector < SampleType >& elementTypes)
+    {
+        std::vector < Element > elements;
+        size_t offset = 0;
+        for (SampleType elementType : elementTypes) {
+            size_t size = elementSize(elementType);
+            if (size == 0) {
+                return -1;
+            }
+            // bit fields are converted like the unsigned integer they consist of
+            if (elementType == SAMPLETYPE_BITFIELD32) {
+                elementType = SAMPLETYPE_U32;
+            } else if (elementType == SAMPLETYPE_BITFIELD64) {
+                elementType = SAMPLETYPE_U64;
+            }
+            elements.push_back({ elementType, offset });
+            offset += size;
+        }
+
+        m_elements = std::move(elements);
+        m_uniform = true;
+        for (const Element& element : m_elements) {
+            if (element.type != m_elements.front().type) {
+                m_uniform = false;
+            }
+        }
+        m_valueSize = offset;
+        if (m_indexed) {
+            m_valueSize += sizeof(uint64_t);
+        }
+        return 0;
+    }
+
+    void SampleConverter::setIndexed(bool indexed)
+    {
+        if (indexed != m_indexed) {
+            if (indexed) {
+                m_valueSize += sizeof(uint64_t);
+            } else {
+                m_valueSize -= sizeof(uint64_t);
+            }
+            m_indexed = indexed;
+        }
+    }
+
+    void SampleConverter::setPostScaling(const PostScaling& postScaling)
+    {
+        m_postScaling = postScaling;
+    }
+
+    void SampleConverter::setRange(const Range& range)
+    {
+        m_range = range;
+    }
+
+    void SampleConverter::setInstructionSet(InstructionSet instructionSet)
+    {
+        if (instructionSet > supportedInstructionSet()) {
+            instructionSet = supportedInstructionSet();
+        }
+        m_instructionSet = instructionSet;
+    }
+
+    SampleConverter::InstructionSet SampleConverter::instructionSet() const
+    {
+        return m_instructionSet;
+    }
+
+    size_t SampleConverter::convert(const uint8_t* pData, size_t count, double* results, unsigned int options, uint64_t* valueIndices) const
+    {
+        return convertTo(pData, count, results, options, valueIndices);
+    }
+
+    size_t SampleConverter::convert(const uint8_t* pData, size_t count, float* results, unsigned int options, uint64_t* valueIndices) const
+    {
+        return convertTo(pData, count, results, options, valueIndices);
+    }
+
+    template < typename Result >
+    size_t SampleConverter::convertTo(const uint8_t* pData, size_t count, Result* results, unsigned int options, uint64_t* valueIndices) const
+    {
+        if (m_elements.empty()) {
+            return 0;
+        }
+
+        Transform transform;
+        transform.scaled = ((options & OPTION_POSTSCALING) != 0) && !m_postScaling.isOneToOne();
+        transform.scale = m_postScaling.scale;
+        transform.offset = m_postScaling.offset;
+        transform.clamped = ((options & OPTION_RANGE) != 0) && !m_range.isUnlimited();
+        transform.low = m_range.low;
+        transform.high = m_range.high;
+
+        const uint8_t* values = pData;
+        if (m_indexed) {
+            if (valueIndices) {
+                for (size_t valueIndex = 0; valueIndex < count; ++valueIndex) {
+                    memcpy(&valueIndices[valueIndex], pData + valueIndex * m_valueSize, sizeof(uint64_t));
+                }
+            }
+            values += sizeof(uint64_t);
+        }
+
+        size_t elementCount = m_elements.size();
+        SampleType firstType = m_elements.front().type;
+        if (m_uniform && !m_indexed) {
+            // one consecutive sequence of elements
+            size_t resultCount = count * elementCount;
+            constexpr SampleType resultType = std::is_same_v < Result, float > ? SAMPLETYPE_REAL32 : SAMPLETYPE_REAL64;
+            if ((firstType == resultType) && !transform.scaled && !transform.clamped) {
+                memcpy(results, values, resultCount * sizeof(Result));
+            } else {
+                convertElements(m_instructionSet, firstType, values, elementSize(firstType), resultCount, results, 1, transform);
+            }
+        } else if (elementCount == 1) {
+            convertElements(m_instructionSet, firstType, values, m_valueSize, count, results, 1, transform);
+        } else {
+            for (size_t elementIndex = 0; elementIndex < elementCount; ++elementIndex) {
+                const Element& element = m_elements[elementIndex];
+                convertElements(m_instructionSet, element.type, values + element.offset, m_valueSize, count, results + elementIndex, elementCount, transform);
+            }
+        }
+        return count * elementCount;
+    }
+}
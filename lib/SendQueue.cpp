@@ -0,0 +1,340 @@
+#include <boost/asio/post.hpp>
+
+#include "streaming_protocol/SendQueue.hpp"
+
+namespace daq::streaming_protocol {
+    SendQueue::SendQueue(boost::asio::io_context& ioc, std::shared_ptr < daq::stream::Stream > stream, std::chrono::microseconds maxLatency, size_t maxBatchSize,
+                         size_t capacity, OverflowPolicy overflowPolicy, LogCallback logCb)
+        : m_ioc(ioc)
+        , m_stream(stream)
+        , m_maxLatency(maxLatency)
+        , m_maxBatchSize(maxBatchSize)
+        , m_capacity(capacity)
+        , m_overflowPolicy(overflowPolicy)
+        , logCallback(logCb)
+        , m_timer(ioc)
+        , m_writeInProgress(false)
+        , m_initiating(false)
+        , m_posted(false)
+        , m_timerArmed(false)
+        , m_flushRequested(false)
+        , m_failed(false)
+        , m_packetCount(0)
+        , m_writeCount(0)
+        , m_writtenBytes(0)
+        , m_droppedCount(0)
+        , m_droppedBytes(0)
+        , m_queuedBytes(0)
+        , m_writingBytes(0)
+    {
+    }
+
+    int SendQueue::push(TransportType type, unsigned int signalNumber, const boost::asio::const_buffer* buffers, size_t bufferCount)
+    {
+        size_t size = 0;
+        for (size_t bufferIndex = 0; bufferIndex < bufferCount; ++bufferIndex) {
+            size += buffers[bufferIndex].size();
+        }
+
+        std::unique_lock < std::mutex > lock(m_mutex);
+        int result = enqueue(lock, type, signalNumber, size);
+        if (result <= 0) {
+            return result;
+        }
+        for (size_t bufferIndex = 0; bufferIndex < bufferCount; ++bufferIndex) {
+            appendCopy(static_cast < const uint8_t* > (buffers[bufferIndex].data()), buffers[bufferIndex].size());
+        }
+        scheduleWrite(lock);
+        return static_cast < int > (size);
+    }
+
+    int SendQueue::push(TransportType type, unsigned int signalNumber, const Packet& packet)
+    {
+        size_t size = packet->size();
+        std::unique_lock < std::mutex > lock(m_mutex);
+        int result = enqueue(lock, type, signalNumber, size);
+        if (result <= 0) {
+            return result;
+        }
+        if (size < COPY_THRESHOLD) {
+            appendCopy(packet->data(), size);
+        } else {
+            Segment segment;
+            segment.offset = 0;
+            segment.size = size;
+            segment.packet = packet;
+            m_queuedSegments.push_back(std::move(segment));
+            m_queuedBytes += size;
+        }
+        scheduleWrite(lock);
+        return static_cast < int > (size);
+    }
+
+    int SendQueue::enqueue(std::unique_lock < std::mutex >& lock, TransportType type, unsigned int signalNumber, size_t size)
+    {
+        if (m_failed) {
+            return -1;
+        }
+        size_t bufferedBytes = m_queuedBytes + m_writingBytes;
+        SignalState* signal = (type == TYPE_SIGNALDATA) ? findSignalState(signalNumber) : nullptr;
+        if ((type == TYPE_SIGNALDATA) && (m_overflowPolicy == OVERFLOWPOLICY_DISCONNECT)) {
+            if (bufferedBytes + size > m_capacity) {
+                STREAMING_PROTOCOL_LOG_E("Send queue overflow, {} bytes buffered, disconnecting slow client!", bufferedBytes);
+                disconnect(lock);
+                return -1;
+            }
+        } else if (signal && signal->droppable) {
+            if (!admit(*signal, signalNumber, size)) {
+                return 0;
+            }
+        } else if (bufferedBytes + size > 2 * m_capacity) {
+            // neither meta information nor data of signals not droppable is dropped
+            STREAMING_PROTOCOL_LOG_E("Send queue overflow by packets not to be dropped, disconnecting!");
+            disconnect(lock);
+            return -1;
+        }
+        if (m_queuedSegments.empty()) {
+            m_queuedSince = std::chrono::steady_clock::now();
+        }
+        ++m_packetCount;
+        return 1;
+    }
+
+    void SendQueue::appendCopy(const uint8_t* data, size_t size)
+    {
+        // adjoining copies form one segment
+        if (m_queuedSegments.empty() || m_queuedSegments.back().packet) {
+            Segment segment;
+            segment.offset = m_queued.size();
+            segment.size = 0;
+            m_queuedSegments.push_back(std::move(segment));
+        }
+        m_queued.insert(m_queued.end(), data, data + size);
+        m_queuedSegments.back().size += size;
+        m_queuedBytes += size;
+    }
+
+    void SendQueue::scheduleWrite(std::unique_lock < std::mutex >& lock)
+    {
+        // A write in progress or a pending timer picks the packet up
+        if (m_writeInProgress || m_posted) {
+            return;
+        }
+        bool due = (m_maxLatency.count() == 0) || (m_queuedBytes >= m_maxBatchSize);
+        if (!due && m_timerArmed) {
+            return;
+        }
+        postWriteNext(lock);
+    }
+
+    SendQueue::SignalState& SendQueue::signalState(unsigned int signalNumber)
+    {
+        if (signalNumber >= s_indexedSignalCount) {
+            return m_sparseSignals[signalNumber];
+        }
+        if (signalNumber >= m_signals.size()) {
+            m_signals.resize(signalNumber + 1);
+        }
+        return m_signals[signalNumber];
+    }
+
+    SendQueue::SignalState* SendQueue::findSignalState(unsigned int signalNumber)
+    {
+        return const_cast < SignalState* > (static_cast < const SendQueue* > (this)->findSignalState(signalNumber));
+    }
+
+    const SendQueue::SignalState* SendQueue::findSignalState(unsigned int signalNumber) const
+    {
+        if (signalNumber < m_signals.size()) {
+            return &m_signals[signalNumber];
+        }
+        if ((signalNumber < s_indexedSignalCount) || m_sparseSignals.empty()) {
+            return nullptr;
+        }
+        const auto signalIter = m_sparseSignals.find(signalNumber);
+        if (signalIter == m_sparseSignals.end()) {
+            return nullptr;
+        }
+        return &signalIter->second;
+    }
+
+    void SendQueue::setDroppable(unsigned int signalNumber, bool droppable)
+    {
+        std::lock_guard < std::mutex > lock(m_mutex);
+        signalState(signalNumber).droppable = droppable;
+    }
+
+    bool SendQueue::admit(SignalState& signal, unsigned int signalNumber, size_t size)
+    {
+        uint64_t packetIndex = signal.packetIndex++;
+        bool keep = m_queuedBytes + m_writingBytes + size <= m_capacity;
+        if (keep && (m_overflowPolicy == OVERFLOWPOLICY_DECIMATE)) {
+            unsigned int fillLevel = fillLevelLocked();
+            if (fillLevel >= 75) {
+                keep = (packetIndex % 4) == 0;
+            } else if (fillLevel >= 50) {
+                keep = (packetIndex % 2) == 0;
+            }
+        }
+        if (!keep) {
+            if (signal.droppedCount == 0) {
+                STREAMING_PROTOCOL_LOG_W("Send queue at {}% fill level, dropping packets of signal {}", fillLevelLocked(), signalNumber);
+            }
+            ++signal.droppedCount;
+            ++m_droppedCount;
+            m_droppedBytes += size;
+        }
+        return keep;
+    }
+
+    void SendQueue::disconnect(std::unique_lock < std::mutex >& lock)
+    {
+        m_failed = true;
+        m_queued.clear();
+        m_queuedSegments.clear();
+        m_queuedBytes = 0;
+        lock.unlock();
+        // The session ends as on any other failure of the stream
+        boost::asio::post(m_ioc, [self = shared_from_this()]() {
+            self->m_stream->asyncClose([](const boost::system::error_code&) {});
+        });
+    }
+
+    void SendQueue::flush()
+    {
+        std::unique_lock < std::mutex > lock(m_mutex);
+        if (m_queuedSegments.empty()) {
+            return;
+        }
+        m_flushRequested = true;
+        if (m_writeInProgress || m_posted) {
+            return;
+        }
+        postWriteNext(lock);
+    }
+
+    void SendQueue::postWriteNext(std::unique_lock < std::mutex >& lock)
+    {
+        m_posted = true;
+        lock.unlock();
+        boost::asio::post(m_ioc, [self = shared_from_this()]() {
+            std::unique_lock < std::mutex > lock(self->m_mutex);
+            self->m_posted = false;
+            self->writeNext(lock);
+        });
+    }
+
+    void SendQueue::writeNext(std::unique_lock < std::mutex >& lock)
+    {
+        // Loops as long as the stream completes writes right away
+        while (!m_writeInProgress && !m_queuedSegments.empty() && !m_failed) {
+            bool due = m_flushRequested || (m_maxLatency.count() == 0) || (m_queuedBytes >= m_maxBatchSize) ||
+                       (std::chrono::steady_clock::now() >= m_queuedSince + m_maxLatency);
+            if (!due) {
+                if (!m_timerArmed) {
+                    m_timerArmed = true;
+                    m_timer.expires_at(m_queuedSince + m_maxLatency);
+                    m_timer.async_wait([self = shared_from_this()](const boost::system::error_code&) {
+                        self->onTimer();
+                    });
+                }
+                return;
+            }
+
+            m_flushRequested = false;
+            m_writing.swap(m_queued);
+            m_queued.clear();
+            m_writingSegments.swap(m_queuedSegments);
+            m_queuedSegments.clear();
+            m_writingBytes = m_queuedBytes;
+            m_queuedBytes = 0;
+            m_writingBuffers.clear();
+            for (const Segment& segment : m_writingSegments) {
+                if (segment.packet) {
+                    m_writingBuffers.emplace_back(segment.packet->data(), segment.size);
+                } else {
+                    m_writingBuffers.emplace_back(m_writing.data() + segment.offset, segment.size);
+                }
+            }
+            m_writeInProgress = true;
+            m_initiating = true;
+            ++m_writeCount;
+            lock.unlock();
+            m_stream->asyncWrite(m_writingBuffers, [self = shared_from_this()](const boost::system::error_code& ec, std::size_t bytesWritten) {
+                self->onWritten(ec, bytesWritten);
+            });
+            lock.lock();
+            m_initiating = false;
+        }
+    }
+
+    void SendQueue::onWritten(const boost::system::error_code& ec, std::size_t bytesWritten)
+    {
+        std::unique_lock < std::mutex > lock(m_mutex);
+        m_writeInProgress = false;
+        m_writing.clear();
+        // releases the references to shared packets
+        m_writingSegments.clear();
+        m_writingBytes = 0;
+        if (ec) {
+            // no need to tell again after disconnecting on overflow
+            if (!m_failed) {
+                STREAMING_PROTOCOL_LOG_E("Writing to stream failed: {}, discarding queued packets", ec.message());
+            }
+            m_failed = true;
+            m_queued.clear();
+            m_queuedSegments.clear();
+            m_queuedBytes = 0;
+            return;
+        }
+        m_writtenBytes += bytesWritten;
+        if (!m_initiating) {
+            writeNext(lock);
+        }
+    }
+
+    void SendQueue::onTimer()
+    {
+        std::unique_lock < std::mutex > lock(m_mutex);
+        m_timerArmed = false;
+        writeNext(lock);
+    }
+
+    unsigned int SendQueue::fillLevelLocked() const
+    {
+        if (m_capacity == 0) {
+            return 100;
+        }
+        return static_cast < unsigned int > ((m_queuedBytes + m_writingBytes) * 100 / m_capacity);
+    }
+
+    unsigned int SendQueue::fillLevel() const
+    {
+        std::lock_guard < std::mutex > lock(m_mutex);
+        return fillLevelLocked();
+    }
+
+    uint64_t SendQueue::droppedCount(unsigned int signalNumber) const
+    {
+        std::lock_guard < std::mutex > lock(m_mutex);
+        const SignalState* signal = findSignalState(signalNumber);
+        return signal ? signal->droppedCount : 0;
+    }
+
+    SendQueueMetrics SendQueue::metrics() const
+    {
+        std::lock_guard < std::mutex > lock(m_mutex);
+        SendQueueMetrics metrics;
+        metrics.queuedBytes = m_queuedBytes;
+        metrics.bufferedBytes = m_queuedBytes + m_writingBytes;
+        metrics.capacity = m_capacity;
+        metrics.fillLevel = fillLevelLocked();
+        metrics.packetCount = m_packetCount;
+        metrics.writeCount = m_writeCount;
+        metrics.writtenBytes = m_writtenBytes;
+        metrics.droppedCount = m_droppedCount;
+        metrics.droppedBytes = m_droppedBytes;
+        metrics.failed = m_failed;
+        return metrics;
+    }
+}
@@ -16,63 +16,276 @@
 
 #include <fstream>
 #include <functional>
+#include <limits>
 
+#include "boost/asio/post.hpp"
 
 #include "stream/Stream.hpp"
+#include "stream/WebsocketServer.hpp"
 
 #include "streaming_protocol/ProducerSession.hpp"
 #include "streaming_protocol/Server.hpp"
 
 namespace daq::streaming_protocol {
+
+    Server::Shard::Shard(boost::asio::io_context& ioc)
+        : ioContext(ioc)
+        , stopped(false)
+        , sessionCount(0)
+    {
+    }
     
     Server::Server(boost::asio::io_context& readerIoContext, uint16_t wsDataPort, LogCallback logCb)
+        : Server(readerIoContext, wsDataPort, 0, SESSIONDISTRIBUTION_ROUNDROBIN, logCb)
+    {
+    }
+
+    Server::Server(boost::asio::io_context& readerIoContext, uint16_t wsDataPort, size_t threadCount, SessionDistribution distribution, LogCallback logCb)
         : m_readerIoContext(readerIoContext)
-        , m_server(m_readerIoContext, std::bind(&Server::createSession, this, std::placeholders::_1), wsDataPort)
+        , m_wsDataPort(wsDataPort)
+        , m_distribution(distribution)
+        , m_acceptor(m_readerIoContext)
+        , m_ownsThreads(threadCount > 0)
+        , m_nextShard(0)
         , logCallback(logCb)
     {
+        if (threadCount == 0) {
+            m_shards.emplace_back(std::make_unique < Shard > (m_readerIoContext));
+            return;
+        }
+
+        for (size_t threadIndex = 0; threadIndex < threadCount; ++threadIndex) {
+            auto ioc = std::make_unique < boost::asio::io_context > (1);
+            auto shard = std::make_unique < Shard > (*ioc);
+            shard->ownedIoContext = std::move(ioc);
+            // keeps the thread running while there are no sessions
+            shard->workGuard = std::make_unique < boost::asio::executor_work_guard < boost::asio::io_context::executor_type > > (shard->ioContext.get_executor());
+            startThread(*shard);
+            m_shards.emplace_back(std::move(shard));
+        }
     }
     
     Server::~Server()
     {
+        boost::system::error_code ec;
+        m_acceptor.close(ec);
+        stopThreads();
     }    
     
+    void Server::startThread(Shard& shard)
+    {
+        boost::asio::io_context& shardIoContext = shard.ioContext;
+        shard.thread = std::thread([&shardIoContext]() {
+            shardIoContext.run();
+        });
+    }
+
     int Server::start()
     {
-        STREAMING_PROTOCOL_LOG_I("Starting");
-        m_server.start();
+        STREAMING_PROTOCOL_LOG_I("Starting with {} thread(s)", m_ownsThreads ? m_shards.size() : 0);
+        for (auto& shard : m_shards) {
+            std::lock_guard < std::mutex > lock(shard->sessionsMtx);
+            shard->stopped = false;
+        }
+        if (m_ownsThreads) {
+            for (auto& shard : m_shards) {
+                if (shard->workGuard) {
+                    continue;
+                }
+                // restarted after stop(). A thread still closing sessions keeps running from now on.
+                shard->workGuard = std::make_unique < boost::asio::executor_work_guard < boost::asio::io_context::executor_type > > (shard->ioContext.get_executor());
+                if (shard->ioContext.stopped()) {
+                    // the thread ran out of work and ends
+                    shard->thread.join();
+                    shard->ioContext.restart();
+                    startThread(*shard);
+                }
+            }
+        }
+        boost::system::error_code ec;
+        boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v4(), m_wsDataPort);
+        m_acceptor.open(endpoint.protocol(), ec);
+        if (ec) {
+            STREAMING_PROTOCOL_LOG_E("Could not open acceptor: {}", ec.message());
+            return -1;
+        }
+        m_acceptor.set_option(boost::asio::socket_base::reuse_address(true), ec);
+        m_acceptor.bind(endpoint, ec);
+        if (ec) {
+            STREAMING_PROTOCOL_LOG_E("Could not bind to port {}: {}", m_wsDataPort, ec.message());
+            m_acceptor.close(ec);
+            return -1;
+        }
+        m_acceptor.listen(boost::asio::socket_base::max_listen_connections, ec);
+        if (ec) {
+            STREAMING_PROTOCOL_LOG_E("Could not listen on port {}: {}", m_wsDataPort, ec.message());
+            m_acceptor.close(ec);
+            return -1;
+        }
+        startWebsocketAccept();
         return 0;
     }
     
     void Server::stop()
     {
         STREAMING_PROTOCOL_LOG_I("Stopping");
-        m_server.stop();
-        {
-            std::lock_guard < std::mutex > lock(m_sessionsMtx);
-            for (auto& iter: m_sessions) {
+        boost::system::error_code ec;
+        m_acceptor.close(ec);
+        for (auto& shard : m_shards) {
+            Sessions sessions;
+            {
+                std::lock_guard < std::mutex > lock(shard->sessionsMtx);
+                sessions.swap(shard->sessions);
+                shard->stopped = true;
+                // sessions still in the websocket handshake stay counted until it ends
+                shard->sessionCount -= sessions.size();
+            }
+            for (auto& iter: sessions) {
                 // check whether the weak pointer is still valid. Own it for some time to stop the session and release again
                 if (auto session = iter.second.lock()) {
-                    session->stop();
+                    if (m_ownsThreads) {
+                        // the session is processed by the thread of the shard only
+                        boost::asio::post(shard->ioContext, [session]() {
+                            session->stop();
+                        });
+                    } else {
+                        session->stop();
+                    }
                 }
             }
-            m_sessions.clear();
+            // let the thread finish after all sessions are closed
+            shard->workGuard.reset();
+        }
+    }
+
+    void Server::stopThreads()
+    {
+        if (!m_ownsThreads) {
+            return;
+        }
+        for (auto& shard : m_shards) {
+            shard->workGuard.reset();
+            shard->ioContext.stop();
+        }
+        for (auto& shard : m_shards) {
+            if (!shard->thread.joinable()) {
+                continue;
+            }
+            if (shard->thread.get_id() == std::this_thread::get_id()) {
+                // destructed from within a callback of the pool. The thread ends after returning from it.
+                shard->thread.detach();
+            } else {
+                shard->thread.join();
+            }
         }
     }
 
     size_t Server::sessionCount() const
     {
-        return m_sessions.size();
+        size_t count = 0;
+        for (const auto& shard : m_shards) {
+            count += shard->sessionCount;
+        }
+        return count;
+    }
+
+    size_t Server::threadCount() const
+    {
+        if (!m_ownsThreads) {
+            return 0;
+        }
+        return m_shards.size();
+    }
+
+    size_t Server::sessionCount(size_t threadIndex) const
+    {
+        if (threadIndex >= m_shards.size()) {
+            return 0;
+        }
+        return m_shards[threadIndex]->sessionCount;
+    }
+
+    void Server::startWebsocketAccept()
+    {
+        Shard& shard = nextShard();
+        // the client is accepted straight into the io_context of the shard processing it. Handing over the native
+        // handle of a socket accepted elsewhere is not supported on all platforms.
+        using ShardSocket = boost::asio::ip::tcp::socket::rebind_executor < boost::asio::io_context::executor_type >::other;
+        m_acceptor.async_accept(shard.ioContext, [this, &shard](const boost::system::error_code& ec, ShardSocket streamSocket) {
+            handleWebsocketTcpAccept(shard, ec, boost::asio::ip::tcp::socket(std::move(streamSocket)));
+        });
+    }
+
+    void Server::handleWebsocketTcpAccept(Shard& shard, const boost::system::error_code& ec, boost::asio::ip::tcp::socket&& streamSocket)
+    {
+        if (ec) {
+            if (ec != boost::asio::error::operation_aborted) {
+                STREAMING_PROTOCOL_LOG_E("Accept failed: {}", ec.message());
+            }
+            return;
+        }
+
+        // counted right away, the shard for the next client is chosen with this one loaded
+        ++shard.sessionCount;
+
+        // continue accepting while the new client is being set up
+        startWebsocketAccept();
+
+        auto newStream = std::make_shared < stream::WebsocketServerStream > (shard.ioContext, std::move(streamSocket));
+        boost::asio::post(shard.ioContext, [this, &shard, newStream]() {
+            newStream->asyncInit([this, &shard, newStream](const boost::system::error_code& error) {
+                if (error) {
+                    STREAMING_PROTOCOL_LOG_W("Websocket handshake failed: {}", error.message());
+                    --shard.sessionCount;
+                    return;
+                }
+                createSession(shard, newStream);
+            });
+        });
+    }
+
+    Server::Shard& Server::nextShard()
+    {
+        if (m_shards.size() == 1) {
+            return *m_shards.front();
+        }
+
+        if (m_distribution == SESSIONDISTRIBUTION_LEASTLOADED) {
+            size_t leastLoadedIndex = 0;
+            size_t leastSessionCount = std::numeric_limits < size_t >::max();
+            // start with the shard after the one chosen last, to spread equally loaded shards
+            size_t startIndex = m_nextShard++;
+            for (size_t offset = 0; offset < m_shards.size(); ++offset) {
+                size_t index = (startIndex + offset) % m_shards.size();
+                size_t count = m_shards[index]->sessionCount;
+                if (count < leastSessionCount) {
+                    leastSessionCount = count;
+                    leastLoadedIndex = index;
+                }
+            }
+            return *m_shards[leastLoadedIndex];
+        }
+
+        return *m_shards[m_nextShard++ % m_shards.size()];
     }
     
-    void Server::createSession(std::shared_ptr<stream::Stream> newStream)
+    void Server::createSession(Shard& shard, std::shared_ptr<stream::Stream> newStream)
     {
         std::string sessionId = newStream->endPointUrl();
         nlohmann::json commandInterfaces; // empty for now. Will be filled when ControlServer is is place.
         auto newSession = std::make_shared<ProducerSession>(newStream, commandInterfaces, logCallback);
 
         {
-            std::lock_guard < std::mutex > lock(m_sessionsMtx);
-            m_sessions[sessionId] = newSession;
+            std::lock_guard < std::mutex > lock(shard.sessionsMtx);
+            if (shard.stopped) {
+                // the server got stopped during the websocket handshake. The client is disconnected.
+                --shard.sessionCount;
+                return;
+            }
+            // the session was counted when the shard was chosen
+            if (!shard.sessions.insert_or_assign(sessionId, newSession).second) {
+                --shard.sessionCount;
+            }
         }
 
         // send meta information with all available signal ids
@@ -81,7 +294,7 @@ namespace daq::streaming_protocol {
         }
 
         // Set callback to be executed upon disconnect of consumer (client)
-        newSession->start(std::bind(&Server::removeSessionCb, this, sessionId));
+        newSession->start(std::bind(&Server::removeSessionCb, this, std::ref(shard), sessionId));
     }
     
     void Server::updateAvailableSignals(const SignalIds& removedSignals, const SignalIds& addedSignals)
@@ -91,27 +304,32 @@ namespace daq::streaming_protocol {
             return;
         }
         
-        std::lock_guard < std::mutex > lock(m_sessionsMtx);
-        for (auto& iter: m_sessions) {
-            // send meta information informing about available/unavailable signals
-            
-            // check whether the weak pointer is still valid. Own it for some time to do the work and release again
-            if (auto sharedPointer = iter.second.lock()) {
-                if (!addedSignals.empty()) {
-                    //sharedPointer->addSignals(addedSignals);
-                }
+        for (auto& shard : m_shards) {
+            std::lock_guard < std::mutex > lock(shard->sessionsMtx);
+            for (auto iter = shard->sessions.begin(); iter != shard->sessions.end(); ) {
+                // send meta information informing about available/unavailable signals
                 
-                if (!removedSignals.empty()) {
-                    sharedPointer->removeSignals(removedSignals);
+                // check whether the weak pointer is still valid. Own it for some time to do the work and release again
+                if (auto sharedPointer = iter->second.lock()) {
+                    if (!addedSignals.empty()) {
+                        //sharedPointer->addSignals(addedSignals);
+                    }
+                    
+                    if (!removedSignals.empty()) {
+                        sharedPointer->removeSignals(removedSignals);
+                    }
+                    ++iter;
+                } else {
+                    iter = shard->sessions.erase(iter);
+                    --shard->sessionCount;
                 }
-            } else {
-                m_sessions.erase(iter.first);
             }
         }
     }
 
-    void Server::removeSessionCb(const std::string &sessionId)
+    void Server::removeSessionCb(Shard& shard, const std::string &sessionId)
     {
-        m_sessions.erase(sessionId);
+        std::lock_guard < std::mutex > lock(shard.sessionsMtx);
+        shard.sessionCount -= shard.sessions.erase(sessionId);
     }
 }
@@ -0,0 +1,337 @@
+#include <cstring>
+#include <functional>
+
+#include "streaming_protocol/Defines.h"
+
+#include "ShardedDecoder.hpp"
+
+namespace daq::streaming_protocol {
+    /// The producer yields that often before it blocks on a full queue
+    static const unsigned int ProducerSpinCount = 64;
+
+    void ShardedDecoder::Fence::pass(std::shared_ptr < SubscribedSignal > signal)
+    {
+        {
+            std::lock_guard < std::mutex > lock(m_mutex);
+            m_signal = std::move(signal);
+            m_passed = true;
+        }
+        m_condition.notify_one();
+    }
+
+    std::shared_ptr < SubscribedSignal > ShardedDecoder::Fence::wait()
+    {
+        std::unique_lock < std::mutex > lock(m_mutex);
+        m_condition.wait(lock, [this]() {
+            return m_passed;
+        });
+        return std::move(m_signal);
+    }
+
+    ShardedDecoder::Package::Package(LogCallback logCb)
+        : type(TYPE_SIGNALDATA)
+        , signalNumber(0)
+        , metaInformation(logCb)
+    {
+    }
+
+    ShardedDecoder::Shard::Shard(size_t queueCapacity, const SignalMetaCb& signalMetaCb, const DataAsRawCb& dataAsRawCb, const DataAsValueCb& dataAsValueCb,
+                                 const DataAsTimestampedValuesCb& dataAsTimestampedValuesCb, LogCallback logCb)
+        : m_signalContainer(logCb)
+        , m_queue(queueCapacity, Package(logCb))
+        , m_sleeping(false)
+        , m_producerWaiting(false)
+        , m_stop(false)
+    {
+        if (signalMetaCb) {
+            // without a callback, the shard does not build json documents from the meta information at all
+            m_signalContainer.setSignalMetaCb(signalMetaCb);
+        }
+        m_signalContainer.setDataAsRawCb(dataAsRawCb);
+        m_signalContainer.setDataAsValueCb(dataAsValueCb);
+        if (dataAsTimestampedValuesCb) {
+            m_signalContainer.setDataAsTimestampedValuesCb(dataAsTimestampedValuesCb);
+        }
+        m_thread = std::thread(&Shard::run, this);
+    }
+
+    ShardedDecoder::Shard::~Shard()
+    {
+        {
+            std::lock_guard < std::mutex > lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_one();
+        m_thread.join();
+    }
+
+    ShardedDecoder::Package& ShardedDecoder::Shard::producerSlot()
+    {
+        Package* package = m_queue.producerSlot();
+        for (unsigned int spin = 0; (package == nullptr) && (spin < ProducerSpinCount); ++spin) {
+            // queue is full, the shard is busy. It usually frees a slot soon.
+            std::this_thread::yield();
+            package = m_queue.producerSlot();
+        }
+        if (package == nullptr) {
+            // Throttle the producer without burning a core
+            std::unique_lock < std::mutex > lock(m_mutex);
+            m_producerWaiting.store(true, std::memory_order_relaxed);
+            // pairs with the fence in run(): Either we see the released slot or the shard sees the producer waiting.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_slotCondition.wait(lock, [this, &package]() {
+                package = m_queue.producerSlot();
+                return package != nullptr;
+            });
+            m_producerWaiting.store(false, std::memory_order_relaxed);
+        }
+        return *package;
+    }
+
+    void ShardedDecoder::Shard::publish()
+    {
+        m_queue.publish();
+        // pairs with the fence in run(): Either we see the shard sleeping or the shard sees the published package.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard < std::mutex > lock(m_mutex);
+            m_condition.notify_one();
+        }
+    }
+
+    void ShardedDecoder::Shard::run()
+    {
+        while (true) {
+            Package* package = m_queue.consumerSlot();
+            if (package == nullptr) {
+                std::unique_lock < std::mutex > lock(m_mutex);
+                m_sleeping.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                m_condition.wait(lock, [this]() {
+                    return !m_queue.empty() || m_stop;
+                });
+                m_sleeping.store(false, std::memory_order_relaxed);
+                if (m_queue.empty()) {
+                    // stop requested and everything processed
+                    return;
+                }
+                continue;
+            }
+
+            if (package->type == TYPE_SIGNALDATA) {
+                m_signalContainer.processMeasuredData(package->signalNumber, package->data.data(), package->data.size());
+            } else if (package->passedFence) {
+                // the signal moves to another shard with all its state
+                package->passedFence->pass(m_signalContainer.m_container.releaseSignal(package->signalNumber));
+                package->passedFence.reset();
+            } else if (package->awaitedFence) {
+                // the old shard has to be done with the signal
+                std::shared_ptr < SubscribedSignal > signal = package->awaitedFence->wait();
+                package->awaitedFence.reset();
+                if (signal) {
+                    m_signalContainer.m_container.adoptSignal(std::move(signal));
+                }
+            } else {
+                m_signalContainer.processMetaInformation(package->signalNumber, package->metaInformation);
+            }
+            m_queue.release();
+            // pairs with the fence in producerSlot(): Either we see the producer waiting or the producer sees the released slot.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_producerWaiting.load(std::memory_order_relaxed)) {
+                std::lock_guard < std::mutex > lock(m_mutex);
+                m_slotCondition.notify_one();
+            }
+        }
+    }
+
+    ShardedDecoder::ShardedDecoder(unsigned int shardCount, size_t queueCapacity,
+                                   const SignalMetaCb& signalMetaCb, const DataAsRawCb& dataAsRawCb, const DataAsValueCb& dataAsValueCb,
+                                   const DataAsTimestampedValuesCb& dataAsTimestampedValuesCb, LogCallback logCb)
+        : m_shardSignalCounts(shardCount, 0)
+        , logCallback(logCb)
+    {
+        for (unsigned int shardIndex = 0; shardIndex < shardCount; ++shardIndex) {
+            m_shards.emplace_back(std::make_unique < Shard > (queueCapacity, signalMetaCb, dataAsRawCb, dataAsValueCb, dataAsTimestampedValuesCb, logCb));
+        }
+    }
+
+    ShardedDecoder::~ShardedDecoder() = default;
+
+    size_t ShardedDecoder::shardCount() const
+    {
+        return m_shards.size();
+    }
+
+    /// A signal without table id belongs to the table with an empty id (same as in SubscribedSignal)
+    static std::string tableIdOf(const MetaInformation& metaInformation)
+    {
+        MsgpackView tableIdNode = metaInformation.paramsView().find(META_TABLEID);
+        if (tableIdNode.type() == MsgpackView::MSGPACKTYPE_STRING) {
+            return std::string(tableIdNode.asStringView());
+        } else if (tableIdNode.valid()) {
+            return tableIdNode.toJson().dump();
+        }
+        return std::string();
+    }
+
+    int ShardedDecoder::processMetaInformation(SignalNumber signalNumber, const MetaInformation& metaInformation)
+    {
+        MethodType methodType = metaInformation.methodType();
+        Shard* shard = assignedShard(signalNumber);
+
+        if (methodType == METHODTYPE_SIGNAL) {
+            std::string tableId = tableIdOf(metaInformation);
+            if (shard == nullptr) {
+                // first signal meta information decides about the table and the shard.
+                m_signals.emplace(signalNumber, SignalAssignment{ tableId });
+                shard = m_shards[joinTable(tableId)].get();
+                setAssignedShard(signalNumber, shard);
+                flushPending(*shard, signalNumber);
+            } else {
+                SignalAssignment& signalAssignment = m_signals.at(signalNumber);
+                if (signalAssignment.tableId != tableId) {
+                    moveSignal(signalNumber, signalAssignment, tableId);
+                    shard = assignedShard(signalNumber);
+                }
+            }
+        } else if (methodType == METHODTYPE_UNSUBSCRIBE) {
+            if (shard == nullptr) {
+                auto pendingIter = m_pendingMetaInformation.find(signalNumber);
+                if (pendingIter == m_pendingMetaInformation.end()) {
+                    STREAMING_PROTOCOL_LOG_E("Got unsubscribe meta information for signal '{}' that was not subscribed before", signalNumber);
+                    return -1;
+                }
+                // signal never got assigned to a table
+                m_pendingMetaInformation.erase(pendingIter);
+                return 0;
+            }
+            forward(*shard, signalNumber, metaInformation);
+            setAssignedShard(signalNumber, nullptr);
+            auto signalIter = m_signals.find(signalNumber);
+            leaveTable(signalIter->second.tableId);
+            m_signals.erase(signalIter);
+            return 0;
+        }
+
+        if (shard == nullptr) {
+            // wait for the signal meta information to find the shard
+            m_pendingMetaInformation[signalNumber].push_back(metaInformation);
+            return 0;
+        }
+        forward(*shard, signalNumber, metaInformation);
+        return 0;
+    }
+
+    ssize_t ShardedDecoder::processMeasuredData(SignalNumber signalNumber, const unsigned char* data, size_t len)
+    {
+        Shard* shard = assignedShard(signalNumber);
+        if (shard == nullptr) {
+            STREAMING_PROTOCOL_LOG_W("Got data for signal '{}', that has not been yet reported as subscribed by server", signalNumber);
+            return -1;
+        }
+        Package& package = shard->producerSlot();
+        package.type = TYPE_SIGNALDATA;
+        package.signalNumber = signalNumber;
+        // capacity of the slot is kept, no allocation once the slot has grown
+        package.data.assign(data, data + len);
+        shard->publish();
+        return static_cast < ssize_t > (len);
+    }
+
+    ShardedDecoder::Shard* ShardedDecoder::assignedShard(SignalNumber signalNumber) const
+    {
+        if (signalNumber >= m_signalShards.size()) {
+            return nullptr;
+        }
+        return m_signalShards[signalNumber];
+    }
+
+    void ShardedDecoder::setAssignedShard(SignalNumber signalNumber, Shard* shard)
+    {
+        if (signalNumber >= m_signalShards.size()) {
+            m_signalShards.resize(signalNumber + 1, nullptr);
+        }
+        m_signalShards[signalNumber] = shard;
+    }
+
+    void ShardedDecoder::forward(Shard& shard, SignalNumber signalNumber, const MetaInformation& metaInformation)
+    {
+        Package& package = shard.producerSlot();
+        package.type = TYPE_METAINFORMATION;
+        package.signalNumber = signalNumber;
+        package.metaInformation = metaInformation;
+        shard.publish();
+    }
+
+    void ShardedDecoder::forwardFence(Shard& shard, SignalNumber signalNumber, std::shared_ptr < Fence > passedFence, std::shared_ptr < Fence > awaitedFence)
+    {
+        Package& package = shard.producerSlot();
+        package.type = TYPE_METAINFORMATION;
+        package.signalNumber = signalNumber;
+        package.passedFence = std::move(passedFence);
+        package.awaitedFence = std::move(awaitedFence);
+        shard.publish();
+    }
+
+    void ShardedDecoder::flushPending(Shard& shard, SignalNumber signalNumber)
+    {
+        auto pendingIter = m_pendingMetaInformation.find(signalNumber);
+        if (pendingIter == m_pendingMetaInformation.end()) {
+            return;
+        }
+        for (const auto& metaInformation : pendingIter->second) {
+            forward(shard, signalNumber, metaInformation);
+        }
+        m_pendingMetaInformation.erase(pendingIter);
+    }
+
+    size_t ShardedDecoder::joinTable(const std::string& tableId)
+    {
+        auto tableIter = m_tables.find(tableId);
+        if (tableIter == m_tables.end()) {
+            size_t leastLoadedIndex = 0;
+            for (size_t shardIndex = 1; shardIndex < m_shardSignalCounts.size(); ++shardIndex) {
+                if (m_shardSignalCounts[shardIndex] < m_shardSignalCounts[leastLoadedIndex]) {
+                    leastLoadedIndex = shardIndex;
+                }
+            }
+            tableIter = m_tables.emplace(tableId, TableAssignment{ leastLoadedIndex, 0 }).first;
+        }
+        ++tableIter->second.signalCount;
+        ++m_shardSignalCounts[tableIter->second.shardIndex];
+        return tableIter->second.shardIndex;
+    }
+
+    void ShardedDecoder::leaveTable(const std::string& tableId)
+    {
+        auto tableIter = m_tables.find(tableId);
+        if (tableIter == m_tables.end()) {
+            return;
+        }
+        --m_shardSignalCounts[tableIter->second.shardIndex];
+        if (--tableIter->second.signalCount == 0) {
+            m_tables.erase(tableIter);
+        }
+    }
+
+    void ShardedDecoder::moveSignal(SignalNumber signalNumber, SignalAssignment& signalAssignment, const std::string& tableId)
+    {
+        size_t oldShardIndex = m_tables.at(signalAssignment.tableId).shardIndex;
+        leaveTable(signalAssignment.tableId);
+        size_t newShardIndex = joinTable(tableId);
+        signalAssignment.tableId = tableId;
+        if (newShardIndex == oldShardIndex) {
+            return;
+        }
+
+        Shard& oldShard = *m_shards[oldShardIndex];
+        Shard& newShard = *m_shards[newShardIndex];
+        // All packages of the signal are processed by the old shard before the new shard processes any.
+        // The old shard hands the signal over with its definition, interpretation and value index.
+        // Packages for the new shard queue up behind the fence meanwhile.
+        auto fence = std::make_shared < Fence > ();
+        forwardFence(oldShard, signalNumber, fence, nullptr);
+        forwardFence(newShard, signalNumber, nullptr, fence);
+        setAssignedShard(signalNumber, &newShard);
+    }
+}
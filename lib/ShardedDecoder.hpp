@@ -0,0 +1,171 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "streaming_protocol/MetaInformation.hpp"
+#include "streaming_protocol/SignalContainer.hpp"
+#include "streaming_protocol/SpscQueue.hpp"
+#include "streaming_protocol/SubscribedSignal.hpp"
+#include "streaming_protocol/Types.h"
+#include "streaming_protocol/Logging.hpp"
+
+namespace daq::streaming_protocol {
+    /// Distributes the processing of signal related meta information and measured data to several worker threads (shards).
+    /// -The calling thread (the io context thread of the ProtocolHandler) only copies the package to the queue of a shard.
+    /// -All signals of a table are processed by the same shard. Their order is preserved.
+    /// -Each shard has its own SignalContainer holding the SubscribedSignal objects of its tables. The callbacks are executed by the shards.
+    /// -A signal is assigned to a shard when its first signal meta information arrives. Its subscribe acknowledge is kept until then.
+    /// -A new table is assigned to the shard processing the fewest signals.
+    /// -A signal moving to a table of another shard is moved to that shard with all its state. The application does not notice.
+    class ShardedDecoder
+    {
+    public:
+        ShardedDecoder(unsigned int shardCount, size_t queueCapacity,
+                       const SignalMetaCb& signalMetaCb, const DataAsRawCb& dataAsRawCb, const DataAsValueCb& dataAsValueCb,
+                       const DataAsTimestampedValuesCb& dataAsTimestampedValuesCb, LogCallback logCb);
+        /// Remaining packages are processed before the worker threads are stopped
+        ~ShardedDecoder();
+
+        ShardedDecoder(const ShardedDecoder&) = delete;
+        ShardedDecoder& operator=(const ShardedDecoder&) = delete;
+
+        size_t shardCount() const;
+
+        /// Processing happens asynchronously in the shard. Errors are logged there.
+        /// \return 0 on success, -1 if the meta information can not be assigned to any signal
+        int processMetaInformation(SignalNumber signalNumber, const MetaInformation& metaInformation);
+
+        /// \return number of bytes queued or -1 if signal is unknown.
+        ssize_t processMeasuredData(SignalNumber signalNumber, const unsigned char* data, size_t len);
+
+    private:
+        /// Orders the processing of a moving signal on two shards without blocking the calling thread.
+        /// The signal is handed over from the old shard to the new one.
+        class Fence
+        {
+        public:
+            /// \param signal Released by the old shard, nullptr if it did not know the signal
+            void pass(std::shared_ptr < SubscribedSignal > signal);
+            /// Blocks the calling shard until the other one passed the fence
+            /// \return The signal handed over
+            std::shared_ptr < SubscribedSignal > wait();
+
+        private:
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            bool m_passed = false;
+            std::shared_ptr < SubscribedSignal > m_signal;
+        };
+
+        struct Package
+        {
+            explicit Package(LogCallback logCb);
+
+            TransportType type;
+            SignalNumber signalNumber;
+            /// for meta information
+            MetaInformation metaInformation;
+            /// moving signals only: the old shard releases the signal and passes it here
+            std::shared_ptr < Fence > passedFence;
+            /// moving signals only: the new shard waits here and adopts the signal
+            std::shared_ptr < Fence > awaitedFence;
+            /// for measured data
+            std::vector < uint8_t > data;
+        };
+
+        class Shard
+        {
+        public:
+            Shard(size_t queueCapacity, const SignalMetaCb& signalMetaCb, const DataAsRawCb& dataAsRawCb, const DataAsValueCb& dataAsValueCb,
+                  const DataAsTimestampedValuesCb& dataAsTimestampedValuesCb, LogCallback logCb);
+            ~Shard();
+
+            /// \return A free slot of the queue. Waits if the queue is full, spinning briefly before blocking.
+            Package& producerSlot();
+            /// Make the filled slot available to the shard
+            void publish();
+
+        private:
+            void run();
+
+            SignalContainer m_signalContainer;
+            SpscQueue < Package > m_queue;
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            /// the producer waits here for a free slot
+            std::condition_variable m_slotCondition;
+            std::atomic < bool > m_sleeping;
+            std::atomic < bool > m_producerWaiting;
+            std::atomic < bool > m_stop;
+            std::thread m_thread;
+        };
+
+        /// A table and the shard processing it
+        struct TableAssignment
+        {
+            size_t shardIndex;
+            /// number of signals assigned to the table
+            size_t signalCount;
+        };
+
+        /// A signal assigned to a shard
+        struct SignalAssignment
+        {
+            std::string tableId;
+        };
+
+        /// \return shard the signal is assigned to or nullptr if signal is not assigned yet
+        Shard* assignedShard(SignalNumber signalNumber) const;
+        void setAssignedShard(SignalNumber signalNumber, Shard* shard);
+        void forward(Shard& shard, SignalNumber signalNumber, const MetaInformation& metaInformation);
+        /// Queues handing the signal over at the fence
+        void forwardFence(Shard& shard, SignalNumber signalNumber, std::shared_ptr < Fence > passedFence, std::shared_ptr < Fence > awaitedFence);
+        /// forwards meta information kept for a signal that just got assigned to a shard
+        void flushPending(Shard& shard, SignalNumber signalNumber);
+
+        /// Adds a signal to the table. A new table is assigned to the least loaded shard.
+        /// \return Index of the shard processing the table
+        size_t joinTable(const std::string& tableId);
+        /// Removes a signal from the table. The table is forgotten with its last signal.
+        void leaveTable(const std::string& tableId);
+        /// Moves the signal with its state to the shard of its new table. Packages queued for the old shard are processed before.
+        /// The new shard waits for this at a fence, the calling thread does not wait.
+        void moveSignal(SignalNumber signalNumber, SignalAssignment& signalAssignment, const std::string& tableId);
+
+        std::vector < std::unique_ptr < Shard > > m_shards;
+        /// number of signals processed by each shard, the shard index is the index
+        std::vector < size_t > m_shardSignalCounts;
+        /// signal number is the index, nullptr for signals not assigned to a shard
+        std::vector < Shard* > m_signalShards;
+        /// Table id is the key
+        std::unordered_map < std::string, TableAssignment > m_tables;
+        /// Signals assigned to a shard, signal number is the key
+        std::unordered_map < SignalNumber, SignalAssignment > m_signals;
+        /// Meta information of signals that are not yet assigned to a shard
+        std::unordered_map < SignalNumber, std::vector < MetaInformation > > m_pendingMetaInformation;
+        LogCallback logCallback;
+    };
+}
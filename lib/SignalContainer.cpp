@@ -8,12 +8,10 @@
 
 #include "streaming_protocol/SubscribedSignal.hpp"
 
+#include "BlockAccumulator.hpp"
+#include "ShardedDecoder.hpp"
+
 namespace daq::streaming_protocol {
-    /// default callback does nothing...
-    void nopSignalMetaCb(const SubscribedSignal&, const std::string&, const nlohmann::json&)
-    {
-    }
-    
     /// default callback does nothing...
     void nopDataCb(const SubscribedSignal&, uint64_t, const uint8_t*, size_t)
     {
@@ -22,21 +20,23 @@ namespace daq::streaming_protocol {
     
     
 SignalContainer::SignalContainer(LogCallback logCb)
-    : m_subscribedSignals()
-    , m_signalMetaCb(nopSignalMetaCb)
-    , m_dataAsRawCb(nopDataCb)
-    , m_dataAsValueCb(nopDataCb)
+    : m_container(logCb)
     , logCallback(logCb)
 {
+    CallbackHandler& handler = m_container.handler();
+    handler.dataAsRawCb = nopDataCb;
+    handler.dataAsValueCb = nopDataCb;
 }
 
+SignalContainer::~SignalContainer() = default;
+
 int SignalContainer::setSignalMetaCb(SignalMetaCb cb)
 {
     if (!cb) {
         STREAMING_PROTOCOL_LOG_E("not a valid callback!");
         return -1;
     }
-    m_signalMetaCb = cb;
+    m_container.handler().signalMetaCb = cb;
     return 0;
 }
 
@@ -46,7 +46,7 @@ int SignalContainer::setDataAsRawCb(DataAsRawCb cb)
         STREAMING_PROTOCOL_LOG_E("not a valid callback!");
         return -1;
     }
-    m_dataAsRawCb = cb;
+    m_container.handler().dataAsRawCb = cb;
     return 0;
 }
 
@@ -56,147 +56,132 @@ int SignalContainer::setDataAsValueCb(DataAsValueCb cb)
         std::cerr << "not a valid callback!";
         return -1;
     }
-    m_dataAsValueCb = cb;
+    m_container.handler().dataAsValueCb = cb;
     return 0;
 }
 
-int SignalContainer::processMetaInformation(SignalNumber signalNumber, const MetaInformation &metaInformation)
+int SignalContainer::setDataAsTimestampedValuesCb(DataAsTimestampedValuesCb cb)
 {
-    Signals::const_iterator signalIter;
-    std::string method = metaInformation.method();
-    const nlohmann::json& params = metaInformation.params();
-
-    if (method == META_METHOD_UNSUBSCRIBE) {
-        signalIter = m_subscribedSignals.find(signalNumber);
-        if (signalIter == m_subscribedSignals.end()) {
-            STREAMING_PROTOCOL_LOG_E("Got unsubscribe meta information for signal '{}' that was not subscribed before", signalNumber);
-            return -1;
-        }
-        std::string tableId = signalIter->second->tableId();
-        auto tableIter = m_tables.find(tableId);
-        if (tableIter != m_tables.end()) {
-            Table& table = tableIter->second;
-            if (signalIter->second->isTimeSignal()) {
-                table.timeSignalNumber = 0;
-            } else {
-                table.dataSignalNumbers.erase(signalNumber);
-            }
-            if ((table.timeSignalNumber == 0) && (table.dataSignalNumbers.empty())) {
-                // table is empty!
-                m_tables.erase(tableIter);
-            }
-        }
-    } else if (method == META_METHOD_SUBSCRIBE) {
-        // A new signal!
-        const auto signalIdIter = params.find(META_SIGNALID);
-        if (signalIdIter == params.end()) {
-            STREAMING_PROTOCOL_LOG_E("Invalid subscribe ack: No signal id!");
-            return -1;
-        }
-        auto subscribedSignal = std::make_unique < SubscribedSignal > (signalNumber, logCallback);
-        //STREAMING_PROTOCOL_LOG_I(":\n\tGot subscribed! (signal number: {})", signalNumber);
-        std::pair < Signals::iterator, bool > result = m_subscribedSignals.emplace(signalNumber, std::move(subscribedSignal));
-        if (result.second==false) {
-            STREAMING_PROTOCOL_LOG_E("Got duplicate subscribe ack for signal number {} with signal id {}!", signalNumber, signalIdIter->dump());
-            return -1;
-        }
-        signalIter = result.first;
-    } else {
-        signalIter = m_subscribedSignals.find(signalNumber);
-        if (signalIter == m_subscribedSignals.end()) {
-            STREAMING_PROTOCOL_LOG_E("Got meta information '{}' of signal {}, that was not subscribed before. Aborting!", method, signalNumber);
-            return -1;
-        }
+    if (!cb) {
+        STREAMING_PROTOCOL_LOG_E("not a valid callback!");
+        return -1;
     }
-    SubscribedSignal& signal = *signalIter->second;
-    int result = signal.processSignalMetaInformation(method, params);
-    if (result != 0) {
-        return result;
-    }
-
-    // This has to happen after meta information was processed!
-    if (method == META_METHOD_SIGNAL) {
-        // Perhaps we need to add this to the table members. If it already exists, nothing is changed.
-        auto signalNumberIter = m_subscribedSignals.find(signalNumber);
-        const auto& subscribedSignal = signalNumberIter->second;
-        std::string tableId = subscribedSignal->tableId();
-        if (subscribedSignal->isTimeSignal()) {
-            m_tables[tableId].timeSignalNumber = signalNumber;
-        } else {
-            m_tables[tableId].dataSignalNumbers.insert(signalNumber);
+    m_container.handler().dataAsTimestampedValuesCb = cb;
+    return 0;
+}
+
+int SignalContainer::enableBlocks(size_t blockCapacity, std::chrono::microseconds maxLatency, DataAsBlocksCb cb)
+{
+    if (m_blockAccumulator) {
+        STREAMING_PROTOCOL_LOG_E("Block mode is already enabled!");
+        return -1;
+    }
+    if (m_shardedDecoder) {
+        STREAMING_PROTOCOL_LOG_E("Block mode is not supported in sharded mode!");
+        return -1;
+    }
+    if (!cb) {
+        STREAMING_PROTOCOL_LOG_E("not a valid callback!");
+        return -1;
+    }
+    if (blockCapacity == 0) {
+        STREAMING_PROTOCOL_LOG_E("A block has to hold at least one value!");
+        return -1;
+    }
+    m_blockAccumulator = std::make_unique < BlockAccumulator > (blockCapacity, maxLatency, cb);
+    m_container.handler().blockAccumulator = m_blockAccumulator.get();
+    return 0;
+}
+
+void SignalContainer::CallbackHandler::dataAsTimestampedValues(const SubscribedSignal& subscribedSignal, const uint64_t* timeStamps, const uint8_t* data, size_t valueCount)
+{
+    if (blockAccumulator) {
+        // values of constant rule signals are delivered with their value index
+        size_t valueSize = subscribedSignal.dataValueSize();
+        if (subscribedSignal.ruleType() == RULETYPE_CONSTANT) {
+            valueSize += sizeof(uint64_t);
         }
+        blockAccumulator->add(subscribedSignal, timeStamps, data, valueCount, valueSize);
     }
+    if (dataAsTimestampedValuesCb) {
+        dataAsTimestampedValuesCb(subscribedSignal, timeStamps, data, valueCount);
+    }
+}
 
-    m_signalMetaCb(signal, method, params);
+void SignalContainer::pollBlocks()
+{
+    if (m_blockAccumulator) {
+        m_blockAccumulator->poll();
+    }
+}
+
+void SignalContainer::flushBlocks()
+{
+    if (m_blockAccumulator) {
+        m_blockAccumulator->flush();
+    }
+}
+
+int SignalContainer::startShards(unsigned int shardCount, size_t queueCapacity)
+{
+    if (m_shardedDecoder) {
+        STREAMING_PROTOCOL_LOG_E("Sharded mode is already enabled!");
+        return -1;
+    }
+    if (m_blockAccumulator) {
+        STREAMING_PROTOCOL_LOG_E("Sharded mode is not supported in block mode!");
+        return -1;
+    }
+    if (!m_container.empty()) {
+        STREAMING_PROTOCOL_LOG_E("Sharded mode has to be enabled before subscribing signals!");
+        return -1;
+    }
+    if (shardCount == 0) {
+        STREAMING_PROTOCOL_LOG_E("There has to be at least one shard!");
+        return -1;
+    }
+    const CallbackHandler& handler = m_container.handler();
+    m_shardedDecoder = std::make_unique < ShardedDecoder > (shardCount, queueCapacity, handler.signalMetaCb, handler.dataAsRawCb, handler.dataAsValueCb, handler.dataAsTimestampedValuesCb, logCallback);
+    return 0;
+}
+
+void SignalContainer::stopShards()
+{
+    m_shardedDecoder.reset();
+}
 
-    if (method == META_METHOD_UNSUBSCRIBE) {
-        m_subscribedSignals.erase(signalIter);
+size_t SignalContainer::shardCount() const
+{
+    if (m_shardedDecoder) {
+        return m_shardedDecoder->shardCount();
     }
     return 0;
 }
 
+int SignalContainer::processMetaInformation(SignalNumber signalNumber, const MetaInformation &metaInformation)
+{
+    if (m_shardedDecoder) {
+        return m_shardedDecoder->processMetaInformation(signalNumber, metaInformation);
+    }
+
+    if (m_blockAccumulator) {
+        // pending values are to be interpreted with the meta information they were received with
+        m_blockAccumulator->flush(signalNumber);
+    }
+
+    return m_container.processMetaInformation(signalNumber, metaInformation);
+}
+
 ssize_t SignalContainer::processMeasuredData(SignalNumber signalNumber, const unsigned char* data, size_t len)
 {
-    Signals::iterator signalIter = m_subscribedSignals.find(signalNumber);
-    if (signalIter == m_subscribedSignals.end()) {
-        STREAMING_PROTOCOL_LOG_W("Got data for signal '{}', that has not been yet reported as subscribed by server", signalNumber);
-        return -1;
+    if (m_shardedDecoder) {
+        return m_shardedDecoder->processMeasuredData(signalNumber, data, len);
     }
 
-    auto& signal = signalIter->second;
-    if(signal->isTimeSignal()) {
-        RuleType ruleType = signal->ruleType();
-        std::string tableId = signal->tableId();
-        if (ruleType == RULETYPE_EXPLICIT) {
-            // for explicit time rule, there is no value index
-            const auto tableIter = m_tables.find(tableId);
-            if (tableIter != m_tables.end()) {
-                uint64_t timeStamp;
-                memcpy(&timeStamp, data, sizeof(timeStamp));
-                const auto dataSignalNumbers = tableIter->second.dataSignalNumbers;
-                for(const auto signalNumberIter : dataSignalNumbers) {
-                    auto dataSignal = m_subscribedSignals[signalNumberIter];
-                    signal->setTime(timeStamp);
-                    STREAMING_PROTOCOL_LOG_D("{}:\n\tTime is: {}", dataSignal->signalId(), timeStamp);
-                }
-            }
-            signal->processMeasuredData(data, len, nullptr, m_dataAsRawCb, m_dataAsValueCb);
-        } else {
-            // for implicit time rule:
-            // 1st 64 bit are value index, followed by 64 bit timestamp
-            // get the related data signal and set its time
-            const auto tableIter = m_tables.find(tableId);
-            if (tableIter != m_tables.end()) {
-                const Table& table = tableIter->second;
-                auto *indexedTimeStamp = reinterpret_cast<const IndexedValue<uint64_t>*>(data);
-                const auto dataSignalNumbers = table.dataSignalNumbers;
-                for(const auto signalNumberIter : dataSignalNumbers) {
-                    auto& dataSignal = m_subscribedSignals[signalNumberIter];
-                    signal->setTime(indexedTimeStamp->value);
-                    signal->setTimeIndex(indexedTimeStamp->index);
-
-                    STREAMING_PROTOCOL_LOG_D("{}:\n\tStart time is: {}", dataSignal->signalId(), indexedTimeStamp->value);
-                }
-            }
-        }
-    } else {
-        std::string tableId = signal->tableId();
-        const auto& tableIter = m_tables.find(tableId);
-        if (tableIter != m_tables.end()) {
-            const Table& table = tableIter->second;
-            unsigned int timeSignalNumber = table.timeSignalNumber;
-            if (timeSignalNumber == 0) {
-                STREAMING_PROTOCOL_LOG_W("The time signal isn't yet known for value signal id '{}', number {}, table '{}'!",
-                                         signalIter->second->signalId(),
-                                         signalNumber,
-                                         tableId);
-                return -1;
-            }
-            auto timeSignal = m_subscribedSignals[timeSignalNumber];
-            signal->setTimeSignal(timeSignal);
-            return signal->processMeasuredData(data, len, timeSignal, m_dataAsRawCb, m_dataAsValueCb);
-        }
+    ssize_t result = m_container.processMeasuredData(signalNumber, data, len);
+    if (m_blockAccumulator) {
+        m_blockAccumulator->poll();
     }
-    return (ssize_t) len;
+    return result;
 }
 }
@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <unordered_set>
+
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/SignalHub.hpp"
+#include "streaming_protocol/StreamWriter.h"
+
+namespace daq::streaming_protocol {
+    SignalHub::SignalHub(LogCallback logCb)
+        : logCallback(logCb)
+        , m_routing(std::make_shared < const Routing > ())
+        , m_encodedCount(0)
+    {
+    }
+
+    std::string SignalHub::id() const
+    {
+        return "hub";
+    }
+
+    int SignalHub::writeMetaInformation(unsigned int signalNumber, const nlohmann::json& data)
+    {
+        std::vector < uint8_t > msgpack = nlohmann::json::to_msgpack(data);
+        // used by openDAQ streaming which both use little endian!
+        static const uint32_t littleMetaType = METAINFORMATION_MSGPACK;
+        boost::asio::const_buffer buffers[2];
+        buffers[0] = boost::asio::const_buffer(&littleMetaType, sizeof(littleMetaType));
+        buffers[1] = boost::asio::const_buffer(msgpack.data(), msgpack.size());
+        return write(TYPE_METAINFORMATION, signalNumber, buffers, 2);
+    }
+
+    int SignalHub::writeSignalData(unsigned int signalNumber, const void* pData, size_t length)
+    {
+        boost::asio::const_buffer buffer(pData, length);
+        return write(TYPE_SIGNALDATA, signalNumber, &buffer, 1);
+    }
+
+    int SignalHub::write(TransportType type, unsigned int signalNumber, const boost::asio::const_buffer* buffers, size_t bufferCount)
+    {
+        // keeps the sessions of the routing alive while writing to them
+        std::shared_ptr < const Routing > routing = this->routing();
+        const SendQueues* sendQueues = receivers(*routing, signalNumber);
+        // nothing is encoded for signals nobody subscribed
+        if (!sendQueues || sendQueues->empty()) {
+            return 0;
+        }
+
+        SendQueue::Packet packet = createPacket(type, signalNumber, buffers, bufferCount);
+        m_encodedCount.fetch_add(1, std::memory_order_relaxed);
+        for (const auto& sendQueue : *sendQueues) {
+            // A failing session does not affect the others, it is removed when it ends
+            sendQueue->push(type, signalNumber, packet);
+        }
+        return static_cast < int > (packet->size());
+    }
+
+    SendQueue::Packet SignalHub::createPacket(TransportType type, unsigned int signalNumber, const boost::asio::const_buffer* buffers, size_t bufferCount)
+    {
+        size_t size = 0;
+        for (size_t bufferIndex = 0; bufferIndex < bufferCount; ++bufferIndex) {
+            size += buffers[bufferIndex].size();
+        }
+        uint32_t transportHeaderBuffer[2];
+        size_t headerSize = StreamWriter::createTransportHeader(type, signalNumber, transportHeaderBuffer, size);
+
+        auto packet = std::make_shared < std::vector < uint8_t > > ();
+        packet->reserve(headerSize + size);
+        const uint8_t* header = reinterpret_cast < const uint8_t* > (transportHeaderBuffer);
+        packet->insert(packet->end(), header, header + headerSize);
+        for (size_t bufferIndex = 0; bufferIndex < bufferCount; ++bufferIndex) {
+            const uint8_t* data = static_cast < const uint8_t* > (buffers[bufferIndex].data());
+            packet->insert(packet->end(), data, data + buffers[bufferIndex].size());
+        }
+        return packet;
+    }
+
+    const SignalHub::SendQueues* SignalHub::Routing::subscribersOf(unsigned int signalNumber) const
+    {
+        if (signalNumber < subscribers.size()) {
+            return subscribers[signalNumber].get();
+        }
+        if ((signalNumber < s_indexedSignalCount) || sparseSubscribers.empty()) {
+            return nullptr;
+        }
+        const auto subscribersIter = sparseSubscribers.find(signalNumber);
+        if (subscribersIter == sparseSubscribers.end()) {
+            return nullptr;
+        }
+        return subscribersIter->second.get();
+    }
+
+    void SignalHub::Routing::setSubscribers(unsigned int signalNumber, std::shared_ptr < const SendQueues > sendQueues)
+    {
+        if (signalNumber >= s_indexedSignalCount) {
+            if (sendQueues->empty()) {
+                sparseSubscribers.erase(signalNumber);
+            } else {
+                sparseSubscribers[signalNumber] = std::move(sendQueues);
+            }
+            return;
+        }
+        if (signalNumber >= subscribers.size()) {
+            subscribers.resize(signalNumber + 1);
+        }
+        subscribers[signalNumber] = std::move(sendQueues);
+    }
+
+    const SignalHub::SendQueues* SignalHub::receivers(const Routing& routing, unsigned int signalNumber) const
+    {
+        if (m_targetThread.load(std::memory_order_acquire) == std::this_thread::get_id()) {
+            return m_target.get();
+        }
+        if (signalNumber == 0) {
+            return routing.sessions.get();
+        }
+        return routing.subscribersOf(signalNumber);
+    }
+
+    std::shared_ptr < const SignalHub::Routing > SignalHub::routing() const
+    {
+        return std::atomic_load(&m_routing);
+    }
+
+    void SignalHub::publish(std::shared_ptr < const Routing > routing)
+    {
+        std::atomic_store(&m_routing, std::move(routing));
+    }
+
+    bool SignalHub::contains(const SendQueues* sendQueues, const std::shared_ptr < SendQueue >& sendQueue)
+    {
+        if (!sendQueues) {
+            return false;
+        }
+        return std::find(sendQueues->begin(), sendQueues->end(), sendQueue) != sendQueues->end();
+    }
+
+    std::shared_ptr < const SignalHub::SendQueues > SignalHub::added(const SendQueues* sendQueues, const std::shared_ptr < SendQueue >& sendQueue)
+    {
+        auto result = std::make_shared < SendQueues > ();
+        if (sendQueues) {
+            *result = *sendQueues;
+        }
+        if (std::find(result->begin(), result->end(), sendQueue) == result->end()) {
+            result->push_back(sendQueue);
+        }
+        return result;
+    }
+
+    std::shared_ptr < const SignalHub::SendQueues > SignalHub::removed(const SendQueues* sendQueues, const std::shared_ptr < SendQueue >& sendQueue)
+    {
+        auto result = std::make_shared < SendQueues > ();
+        if (!sendQueues) {
+            return result;
+        }
+        for (const auto& entry : *sendQueues) {
+            if (entry != sendQueue) {
+                result->push_back(entry);
+            }
+        }
+        return result;
+    }
+
+    void SignalHub::addSession(std::shared_ptr < SendQueue > sendQueue)
+    {
+        std::lock_guard < std::mutex > lock(m_mutex);
+        auto routing = std::make_shared < Routing > (*this->routing());
+        routing->sessions = added(routing->sessions.get(), sendQueue);
+        publish(std::move(routing));
+    }
+
+    void SignalHub::removeSession(const std::shared_ptr < SendQueue >& sendQueue)
+    {
+        std::lock_guard < std::mutex > lock(m_mutex);
+        auto routing = std::make_shared < Routing > (*this->routing());
+        routing->sessions = removed(routing->sessions.get(), sendQueue);
+        for (auto& subscribers : routing->subscribers) {
+            if (subscribers && (std::find(subscribers->begin(), subscribers->end(), sendQueue) != subscribers->end())) {
+                subscribers = removed(subscribers.get(), sendQueue);
+            }
+        }
+        for (auto subscribersIter = routing->sparseSubscribers.begin(); subscribersIter != routing->sparseSubscribers.end();) {
+            const SendQueues& subscribers = *subscribersIter->second;
+            if (std::find(subscribers.begin(), subscribers.end(), sendQueue) == subscribers.end()) {
+                ++subscribersIter;
+                continue;
+            }
+            subscribersIter->second = removed(&subscribers, sendQueue);
+            if (subscribersIter->second->empty()) {
+                subscribersIter = routing->sparseSubscribers.erase(subscribersIter);
+            } else {
+                ++subscribersIter;
+            }
+        }
+        publish(std::move(routing));
+    }
+
+    void SignalHub::setTarget(const std::shared_ptr < SendQueue >& sendQueue)
+    {
+        if (sendQueue) {
+            m_target = std::make_shared < const SendQueues > (1, sendQueue);
+            m_targetThread.store(std::this_thread::get_id(), std::memory_order_release);
+        } else {
+            m_targetThread.store(std::thread::id(), std::memory_order_release);
+            m_target.reset();
+        }
+    }
+
+    bool SignalHub::isSubscribed(const std::shared_ptr < SendQueue >& sendQueue, unsigned int signalNumber) const
+    {
+        std::shared_ptr < const Routing > routing = this->routing();
+        return contains(routing->subscribersOf(signalNumber), sendQueue);
+    }
+
+    void SignalHub::subscribe(const std::shared_ptr < SendQueue >& sendQueue, BaseSignal& signal)
+    {
+        BaseSignal* signals[1] = { &signal };
+        subscribe(sendQueue, signals, 1);
+    }
+
+    void SignalHub::unsubscribe(const std::shared_ptr < SendQueue >& sendQueue, BaseSignal& signal)
+    {
+        BaseSignal* signals[1] = { &signal };
+        unsubscribe(sendQueue, signals, 1);
+    }
+
+    void SignalHub::subscribe(const std::shared_ptr < SendQueue >& sendQueue, const std::vector < BaseSignal* >& signals)
+    {
+        subscribe(sendQueue, signals.data(), signals.size());
+    }
+
+    void SignalHub::unsubscribe(const std::shared_ptr < SendQueue >& sendQueue, const std::vector < BaseSignal* >& signals)
+    {
+        unsubscribe(sendQueue, signals.data(), signals.size());
+    }
+
+    void SignalHub::subscribe(const std::shared_ptr < SendQueue >& sendQueue, BaseSignal* const* signals, size_t signalCount)
+    {
+        std::lock_guard < std::mutex > subscribeLock(m_subscribeMutex);
+        std::shared_ptr < const Routing > current = this->routing();
+        std::unordered_set < SignalNumber > subscribed;
+        setTarget(sendQueue);
+        for (size_t signalIndex = 0; signalIndex < signalCount; ++signalIndex) {
+            BaseSignal& signal = *signals[signalIndex];
+            SignalNumber signalNumber = signal.getNumber();
+            // the session counts once as subscriber of the signal
+            if (contains(current->subscribersOf(signalNumber), sendQueue) || !subscribed.insert(signalNumber).second) {
+                continue;
+            }
+            signal.subscribe();
+        }
+        setTarget(nullptr);
+        if (subscribed.empty()) {
+            return;
+        }
+
+        // data follows the signal descriptions
+        std::lock_guard < std::mutex > lock(m_mutex);
+        auto routing = std::make_shared < Routing > (*this->routing());
+        for (SignalNumber signalNumber : subscribed) {
+            routing->setSubscribers(signalNumber, added(routing->subscribersOf(signalNumber), sendQueue));
+        }
+        publish(std::move(routing));
+    }
+
+    void SignalHub::unsubscribe(const std::shared_ptr < SendQueue >& sendQueue, BaseSignal* const* signals, size_t signalCount)
+    {
+        std::lock_guard < std::mutex > subscribeLock(m_subscribeMutex);
+        std::shared_ptr < const Routing > current = this->routing();
+        std::unordered_set < SignalNumber > unsubscribed;
+        std::vector < BaseSignal* > acknowledged;
+        for (size_t signalIndex = 0; signalIndex < signalCount; ++signalIndex) {
+            SignalNumber signalNumber = signals[signalIndex]->getNumber();
+            if (contains(current->subscribersOf(signalNumber), sendQueue) && unsubscribed.insert(signalNumber).second) {
+                acknowledged.push_back(signals[signalIndex]);
+            }
+        }
+        if (acknowledged.empty()) {
+            return;
+        }
+        {
+            // no data after the unsubscribe acknowledges
+            std::lock_guard < std::mutex > lock(m_mutex);
+            auto routing = std::make_shared < Routing > (*this->routing());
+            for (SignalNumber signalNumber : unsubscribed) {
+                routing->setSubscribers(signalNumber, removed(routing->subscribersOf(signalNumber), sendQueue));
+            }
+            publish(std::move(routing));
+        }
+        setTarget(sendQueue);
+        for (BaseSignal* signal : acknowledged) {
+            signal->unsubscribe();
+        }
+        setTarget(nullptr);
+    }
+
+    size_t SignalHub::subscriberCount(unsigned int signalNumber) const
+    {
+        std::shared_ptr < const Routing > routing = this->routing();
+        const SendQueues* subscribers = routing->subscribersOf(signalNumber);
+        return subscribers ? subscribers->size() : 0;
+    }
+
+    uint64_t SignalHub::encodedCount() const
+    {
+        return m_encodedCount.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,168 @@
+#include <algorithm>
+
+#include "streaming_protocol/SignalIdPattern.hpp"
+
+namespace daq::streaming_protocol {
+    static const char Separator = '/';
+
+    static const char Escape = '\\';
+
+    /// \return true if the character at position is an escape character followed by a character to be taken literally
+    static bool isEscape(std::string_view signalId, size_t position)
+    {
+        if ((signalId[position] != Escape) || (position + 1 >= signalId.size())) {
+            return false;
+        }
+        char next = signalId[position + 1];
+        return (next == '*') || (next == '?') || (next == Escape);
+    }
+
+    bool SignalIdPattern::isPattern(std::string_view signalId)
+    {
+        for (size_t position = 0; position < signalId.size(); ++position) {
+            if (isEscape(signalId, position)) {
+                ++position;
+            } else if ((signalId[position] == '*') || (signalId[position] == '?')) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string SignalIdPattern::escape(std::string_view signalId)
+    {
+        std::string escaped;
+        escaped.reserve(signalId.size());
+        for (char character : signalId) {
+            if ((character == '*') || (character == '?') || (character == Escape)) {
+                escaped.push_back(Escape);
+            }
+            escaped.push_back(character);
+        }
+        return escaped;
+    }
+
+    std::string SignalIdPattern::unescape(std::string_view signalId)
+    {
+        std::string unescaped;
+        unescaped.reserve(signalId.size());
+        for (size_t position = 0; position < signalId.size(); ++position) {
+            if (isEscape(signalId, position)) {
+                ++position;
+            }
+            unescaped.push_back(signalId[position]);
+        }
+        return unescaped;
+    }
+
+    SignalIdPattern::SignalIdPattern(std::string_view pattern)
+        : m_prefixOnly(false)
+    {
+        // literal characters up to the next wildcard, escapes removed
+        std::string literal;
+        bool inPrefix = true;
+        size_t position = 0;
+        while (position < pattern.size()) {
+            char character = pattern[position];
+            if (isEscape(pattern, position)) {
+                literal.push_back(pattern[position + 1]);
+                position += 2;
+                continue;
+            }
+            if ((character != '*') && (character != '?')) {
+                literal.push_back(character);
+                ++position;
+                continue;
+            }
+
+            if (inPrefix) {
+                m_literalPrefix = literal;
+                inPrefix = false;
+            } else if (!literal.empty()) {
+                m_tokens.push_back({ TOKENTYPE_LITERAL, literal });
+            }
+            literal.clear();
+
+            if (character == '?') {
+                m_tokens.push_back({ TOKENTYPE_ANY_CHARACTER, std::string() });
+                ++position;
+            } else {
+                if ((position + 1 < pattern.size()) && (pattern[position + 1] == '*')) {
+                    m_tokens.push_back({ TOKENTYPE_ANY, std::string() });
+                    position += 2;
+                } else {
+                    m_tokens.push_back({ TOKENTYPE_SEGMENT, std::string() });
+                    ++position;
+                }
+                // consecutive wildcards are one wildcard
+                while ((position < pattern.size()) && (pattern[position] == '*')) {
+                    m_tokens.back().type = TOKENTYPE_ANY;
+                    ++position;
+                }
+            }
+        }
+        if (inPrefix) {
+            m_literalPrefix = literal;
+        } else if (!literal.empty()) {
+            m_tokens.push_back({ TOKENTYPE_LITERAL, literal });
+        }
+        m_prefixOnly = (m_tokens.size() == 1) && (m_tokens[0].type == TOKENTYPE_ANY);
+    }
+
+    bool SignalIdPattern::match(std::string_view signalId) const
+    {
+        if (signalId.compare(0, m_literalPrefix.size(), m_literalPrefix) != 0) {
+            return false;
+        }
+        return m_prefixOnly || matchFrom(0, signalId.substr(m_literalPrefix.size()));
+    }
+
+    bool SignalIdPattern::matchFrom(size_t tokenIndex, std::string_view rest) const
+    {
+        for (; tokenIndex < m_tokens.size(); ++tokenIndex) {
+            const Token& token = m_tokens[tokenIndex];
+            switch (token.type) {
+            case TOKENTYPE_LITERAL:
+                if (rest.compare(0, token.literal.size(), token.literal) != 0) {
+                    return false;
+                }
+                rest.remove_prefix(token.literal.size());
+                break;
+            case TOKENTYPE_ANY_CHARACTER:
+                if (rest.empty() || (rest[0] == Separator)) {
+                    return false;
+                }
+                rest.remove_prefix(1);
+                break;
+            case TOKENTYPE_SEGMENT:
+            case TOKENTYPE_ANY:
+            {
+                // the wildcard ends within the current segment or anywhere for '**'
+                size_t maxLength = rest.size();
+                if (token.type == TOKENTYPE_SEGMENT) {
+                    maxLength = std::min(rest.find(Separator), rest.size());
+                }
+                if (tokenIndex + 1 == m_tokens.size()) {
+                    return maxLength == rest.size();
+                }
+                const Token& next = m_tokens[tokenIndex + 1];
+                for (size_t length = 0; length <= maxLength; ++length) {
+                    if (next.type == TOKENTYPE_LITERAL) {
+                        // skip to where the following literal matches
+                        size_t found = rest.find(next.literal, length);
+                        if ((found == std::string_view::npos) || (found > maxLength)) {
+                            return false;
+                        }
+                        length = found;
+                    }
+                    if (matchFrom(tokenIndex + 1, rest.substr(length))) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            }
+        }
+        return rest.empty();
+    }
+}
@@ -8,26 +8,57 @@
 
 namespace daq::streaming_protocol {
 StreamMeta::StreamMeta(LogCallback logCb)
-    : logCallback(logCb)
+    : m_httpVersion(0)
+    , m_inBandControl(false)
+    , logCallback(logCb)
 {
 }
 
+/// \return false if the member exists but is no string. A missing member results in an empty value.
+static bool optionalString(const MsgpackView& object, const char* key, std::string& value)
+{
+    MsgpackView member = object.find(key);
+    if (!member.valid()) {
+        value.clear();
+        return true;
+    }
+    if (member.type() != MsgpackView::MSGPACKTYPE_STRING) {
+        return false;
+    }
+    value = member.asStringView();
+    return true;
+}
+
+/// \return false if the member is missing or no string
+static bool requiredString(const MsgpackView& object, const char* key, std::string& value)
+{
+    MsgpackView member = object.find(key);
+    if (member.type() != MsgpackView::MSGPACKTYPE_STRING) {
+        return false;
+    }
+    value = member.asStringView();
+    return true;
+}
+
 int StreamMeta::processMetaInformation(const MetaInformation& metaInformation, const std::string& sessionUrl)
 {
-    std::string method = metaInformation.method();
-    nlohmann::json params = metaInformation.params();
+    MethodType methodType = metaInformation.methodType();
+    // values are taken from the MessagePack content directly, no json document is built.
+    MsgpackView params = metaInformation.paramsView();
     try {
         // stream related meta information
-        if (method == META_METHOD_APIVERSION) {
+        switch (methodType) {
+        case METHODTYPE_APIVERSION:
+        {
             //{
             //  "method": "apiVersion",
             //  "params": {
             //    "version": "1.0.0"
             //  }
             //}
-            const auto iter = params.find(VERSION);
-            if (iter != params.end()) {
-                m_apiVersion = *iter;
+            MsgpackView version = params.find(VERSION);
+            if (version.type() == MsgpackView::MSGPACKTYPE_STRING) {
+                m_apiVersion = version.asStringView();
                 STREAMING_PROTOCOL_LOG_D("{}: {}:{}", sessionUrl, META_METHOD_APIVERSION, m_apiVersion);
 
 
@@ -54,35 +85,51 @@ int StreamMeta::processMetaInformation(const MetaInformation& metaInformation, c
                 STREAMING_PROTOCOL_LOG_E("{}: Missing version information", META_METHOD_APIVERSION);
                 return -1;
             }
-        } else if (method == META_METHOD_INIT) {
+            break;
+        }
+        case METHODTYPE_INIT:
+        {
             // This gives important information needed to control the daq stream.
-            m_streamId = params.value(META_STREAMID, "");
+            if (!optionalString(params, META_STREAMID, m_streamId)) {
+                STREAMING_PROTOCOL_LOG_E("{}: {} has to be a string", META_METHOD_INIT, META_STREAMID);
+                return -1;
+            }
             STREAMING_PROTOCOL_LOG_D("{}: this is {}", sessionUrl, m_streamId);
 
             {
-                const auto & supported_features = params.find("supported");
-                if (supported_features != params.end()) {
-                    for (auto& el : supported_features->object().items()) {
-                        STREAMING_PROTOCOL_LOG_D("{}: supported feature: {}", sessionUrl, el.key());
-                    }
+                MsgpackView supportedFeatures = params.find("supported");
+                for (auto iter = supportedFeatures.begin(); iter != supportedFeatures.end(); ++iter) {
+                    STREAMING_PROTOCOL_LOG_D("{}: supported feature: {}", sessionUrl, iter.key().asStringView());
                 }
             }
 
             {
-                const auto & iter = params.find("commandInterfaces");
-                if (iter!=params.end()) {
-                    for (const nlohmann::json& element: *iter) {
-                        STREAMING_PROTOCOL_LOG_D("{}: command interfaces: {}", sessionUrl, element.dump(2));
+                MsgpackView commandInterfaces = params.find("commandInterfaces");
+                if (commandInterfaces.valid()) {
+                    m_inBandControl = commandInterfaces.find(COMMANDINTERFACE_JSONRPC_INBAND).valid();
+                    for (MsgpackView element: commandInterfaces) {
+                        STREAMING_PROTOCOL_LOG_D("{}: command interfaces: {}", sessionUrl, element.toJson().dump(2));
                         static const char POST[] = "post";
-                        if (strncasecmp(element["httpMethod"].get<std::string>().c_str(), POST, sizeof(POST)) == 0) {
-                            m_httpControlPath = element["httpPath"];
-                            std::string httpVersionString = element["httpVersion"];
+                        std::string httpMethod;
+                        if ((element.type() != MsgpackView::MSGPACKTYPE_MAP) || (!optionalString(element, "httpMethod", httpMethod))) {
+                            STREAMING_PROTOCOL_LOG_E("{}: Invalid command interface", META_METHOD_INIT);
+                            return -1;
+                        }
+                        if (strncasecmp(httpMethod.c_str(), POST, sizeof(POST)) == 0) {
+                            std::string httpVersionString;
+                            std::string httpControlPort;
+                            if ((!requiredString(element, "httpPath", m_httpControlPath)) ||
+                                (!requiredString(element, "httpVersion", httpVersionString)) ||
+                                (!requiredString(element, "port", httpControlPort))) {
+                                STREAMING_PROTOCOL_LOG_E("{}: Invalid http command interface", META_METHOD_INIT);
+                                return -1;
+                            }
                             httpVersionString.erase(std::remove(httpVersionString.begin(), httpVersionString.end(), '.'), httpVersionString.end());
                             m_httpVersion = std::stoi(httpVersionString);
 
                             // Do not overwrite if control port is already set.
                             if (m_httpControlPort.empty()) {
-                                m_httpControlPort = element["port"];
+                                m_httpControlPort = httpControlPort;
                             }
                         }
                     }
@@ -91,20 +138,30 @@ int StreamMeta::processMetaInformation(const MetaInformation& metaInformation, c
                     STREAMING_PROTOCOL_LOG_D("http control port: {}", m_httpControlPort);
                 }
             }
-        } else if (method == META_METHOD_ALIVE) {
+            break;
+        }
+        case METHODTYPE_ALIVE:
+        {
             // check the fill level
-            const nlohmann::json::const_iterator& fillLevelIter = params.find(META_FILLLEVEL);
-            if (fillLevelIter != params.end()) {
-                unsigned int fillLevel = *fillLevelIter;
+            MsgpackView fillLevelNode = params.find(META_FILLLEVEL);
+            if (fillLevelNode.valid()) {
+                MsgpackView::Type fillLevelType = fillLevelNode.type();
+                if ((fillLevelType != MsgpackView::MSGPACKTYPE_UNSIGNED) && (fillLevelType != MsgpackView::MSGPACKTYPE_SIGNED) && (fillLevelType != MsgpackView::MSGPACKTYPE_FLOAT)) {
+                    STREAMING_PROTOCOL_LOG_E("{}: {} has to be a number", META_METHOD_ALIVE, META_FILLLEVEL);
+                    return -1;
+                }
+                unsigned int fillLevel = static_cast < unsigned int > (fillLevelNode.asDouble());
                 if (fillLevel >= 50) {
                     STREAMING_PROTOCOL_LOG_D("Fill level: {}", fillLevel);
                 }
             }
-        } else if (method == META_METHOD_AVAILABLE) {
-            // handled elsewhere...
-        } else if (method == META_METHOD_UNAVAILABLE) {
+            break;
+        }
+        case METHODTYPE_AVAILABLE:
+        case METHODTYPE_UNAVAILABLE:
             // handled elsewhere...
-        } else {
+            break;
+        default:
             // unknown stuff is ignored
             STREAMING_PROTOCOL_LOG_D("{}: Unhandled stream related meta information {}", sessionUrl, metaInformation.jsonContent().dump());
             return 0;
@@ -122,6 +179,11 @@ unsigned int StreamMeta::httpVersion() const
     return m_httpVersion;
 }
 
+bool StreamMeta::inBandControl() const
+{
+    return m_inBandControl;
+}
+
 const std::string &StreamMeta::httpControlPort() const
 {
     return m_httpControlPort;
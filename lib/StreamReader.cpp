@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cstring>
+
+#include "streaming_protocol/StreamReader.hpp"
+
+namespace daq::streaming_protocol {
+    static size_t roundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    SignalReader::SignalReader(const std::string& signalId, size_t capacity)
+        : m_signalId(signalId)
+        , m_timeStamps(roundUpToPowerOfTwo(capacity))
+        , m_mask(m_timeStamps.size() - 1)
+        , m_valueSize(0)
+        , m_droppedValueCount(0)
+        , m_writeIndex(0)
+        , m_readIndex(0)
+        , m_waiting(false)
+    {
+    }
+
+    bool SignalReader::write(const uint64_t* timeStamps, const uint8_t* data, size_t valueCount, size_t valueSize)
+    {
+        size_t currentValueSize = m_valueSize.load(std::memory_order_relaxed);
+        if (currentValueSize == 0) {
+            m_values.resize(capacity() * valueSize);
+            // published to the consumer together with the first values
+            m_valueSize.store(valueSize, std::memory_order_relaxed);
+        } else if (currentValueSize != valueSize) {
+            m_droppedValueCount.fetch_add(valueCount, std::memory_order_relaxed);
+            return false;
+        }
+
+        size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+        size_t freeCount = capacity() - (writeIndex - m_readIndex.load(std::memory_order_acquire));
+        size_t count = std::min(valueCount, freeCount);
+        if (count < valueCount) {
+            m_droppedValueCount.fetch_add(valueCount - count, std::memory_order_relaxed);
+        }
+
+        // in two parts if wrapping around
+        size_t position = writeIndex & m_mask;
+        size_t firstCount = std::min(count, capacity() - position);
+        memcpy(&m_timeStamps[position], timeStamps, firstCount * sizeof(uint64_t));
+        memcpy(&m_values[position * valueSize], data, firstCount * valueSize);
+        memcpy(m_timeStamps.data(), timeStamps + firstCount, (count - firstCount) * sizeof(uint64_t));
+        memcpy(m_values.data(), data + firstCount * valueSize, (count - firstCount) * valueSize);
+        m_writeIndex.store(writeIndex + count, std::memory_order_release);
+
+        // pairs with the fence in waitFor(): Either we see the consumer waiting or the consumer sees the values.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiting.load(std::memory_order_relaxed)) {
+            std::lock_guard < std::mutex > lock(m_mutex);
+            m_condition.notify_one();
+        }
+        return true;
+    }
+
+    size_t SignalReader::available() const
+    {
+        return m_writeIndex.load(std::memory_order_acquire) - m_readIndex.load(std::memory_order_acquire);
+    }
+
+    template < typename Condition >
+    bool SignalReader::waitFor(std::chrono::microseconds timeout, Condition condition)
+    {
+        if (condition()) {
+            return true;
+        }
+        if (timeout.count() <= 0) {
+            return false;
+        }
+        std::unique_lock < std::mutex > lock(m_mutex);
+        m_waiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool result = m_condition.wait_for(lock, timeout, condition);
+        m_waiting.store(false, std::memory_order_relaxed);
+        return result;
+    }
+
+    void SignalReader::copyOut(void* values, uint64_t* timeStamps, size_t count)
+    {
+        size_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+        size_t position = readIndex & m_mask;
+        size_t firstCount = std::min(count, capacity() - position);
+        if (timeStamps) {
+            memcpy(timeStamps, &m_timeStamps[position], firstCount * sizeof(uint64_t));
+            memcpy(timeStamps + firstCount, m_timeStamps.data(), (count - firstCount) * sizeof(uint64_t));
+        }
+        if (values && (count > 0)) {
+            size_t valueSize = m_valueSize.load(std::memory_order_relaxed);
+            uint8_t* pValues = static_cast < uint8_t* > (values);
+            memcpy(pValues, &m_values[position * valueSize], firstCount * valueSize);
+            memcpy(pValues + firstCount * valueSize, m_values.data(), (count - firstCount) * valueSize);
+        }
+        m_readIndex.store(readIndex + count, std::memory_order_release);
+    }
+
+    size_t SignalReader::read(void* values, uint64_t* timeStamps, size_t count, std::chrono::microseconds timeout)
+    {
+        waitFor(timeout, [this, count]() {
+            return available() >= count;
+        });
+        count = std::min(count, available());
+        copyOut(values, timeStamps, count);
+        return count;
+    }
+
+    size_t SignalReader::readUntil(uint64_t time, void* values, uint64_t* timeStamps, size_t maxCount, std::chrono::microseconds timeout)
+    {
+        size_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+        waitFor(timeout, [this, readIndex, time]() {
+            size_t availableCount = available();
+            return (availableCount > 0) && (m_timeStamps[(readIndex + availableCount - 1) & m_mask] >= time);
+        });
+
+        // time stamps ascend, find the first one at or after time
+        size_t low = 0;
+        size_t high = std::min(available(), maxCount);
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (m_timeStamps[(readIndex + middle) & m_mask] < time) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        copyOut(values, timeStamps, low);
+        return low;
+    }
+
+    StreamReader::StreamReader(LogCallback logCb)
+        : logCallback(logCb)
+    {
+    }
+
+    SignalReader& StreamReader::addSignal(const std::string& signalId, size_t capacity)
+    {
+        m_signalReaders.emplace_back(std::make_unique < SignalReader > (signalId, capacity));
+        // resolved again with the next values
+        m_routes.clear();
+        m_sparseRoutes.clear();
+        return *m_signalReaders.back();
+    }
+
+    StreamReader::Route& StreamReader::route(SignalNumber signalNumber)
+    {
+        if (signalNumber >= s_indexedRouteCount) {
+            return m_sparseRoutes[signalNumber];
+        }
+        if (signalNumber >= m_routes.size()) {
+            m_routes.resize(signalNumber + 1);
+        }
+        return m_routes[signalNumber];
+    }
+
+    void StreamReader::add(const SubscribedSignal& subscribedSignal, const uint64_t* timeStamps, const uint8_t* data, size_t valueCount)
+    {
+        Route& route = this->route(subscribedSignal.signalNumber());
+        if (route.signalId != subscribedSignal.signalId()) {
+            route.signalId = subscribedSignal.signalId();
+            route.reader = nullptr;
+            for (const auto& signalReader : m_signalReaders) {
+                if (signalReader->signalId() == route.signalId) {
+                    route.reader = signalReader.get();
+                    break;
+                }
+            }
+        }
+        if ((route.reader == nullptr) || (valueCount == 0)) {
+            return;
+        }
+
+        // values of constant rule signals are delivered with their value index
+        size_t valueSize = subscribedSignal.dataValueSize();
+        if (subscribedSignal.ruleType() == RULETYPE_CONSTANT) {
+            valueSize += sizeof(uint64_t);
+        }
+        if (!route.reader->write(timeStamps, data, valueCount, valueSize)) {
+            STREAMING_PROTOCOL_LOG_E("Value size of signal '{}' changed from {} to {}, values are dropped!", route.signalId, route.reader->valueSize(), valueSize);
+        }
+    }
+}
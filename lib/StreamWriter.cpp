@@ -13,6 +13,12 @@ StreamWriter::StreamWriter(std::shared_ptr<daq::stream::Stream> stream)
 {
 }
 
+StreamWriter::StreamWriter(std::shared_ptr<SendQueue> sendQueue)
+    : m_stream(sendQueue->stream())
+    , m_sendQueue(sendQueue)
+{
+}
+
 std::string StreamWriter::id() const
 {
     return m_stream->endPointUrl();
@@ -26,7 +32,7 @@ int StreamWriter::writeMetaInformation(unsigned int signalNumber, const nlohmann
 
 int StreamWriter::writeMsgPackMetaInformation(unsigned int signalNumber, const std::vector<uint8_t>& data)
 {
-    daq::stream::ConstBufferVector buffers(3);
+    boost::asio::const_buffer buffers[3];
 
     /// room for the mandatory header and the optional additional length
     uint32_t transportHeaderBuffer[2];
@@ -39,14 +45,17 @@ int StreamWriter::writeMsgPackMetaInformation(unsigned int signalNumber, const s
     buffers[1] = boost::asio::const_buffer(reinterpret_cast< const char*>(&littleMetaType), sizeof (littleMetaType));
     buffers[2] = boost::asio::const_buffer(&data[0], data.size());
 
+    if (m_sendQueue) {
+        return m_sendQueue->push(TYPE_METAINFORMATION, signalNumber, buffers, 3);
+    }
     boost::system::error_code ec;
     std::lock_guard guard(m_writeMtx);
-    return static_cast <int> (m_stream->write(buffers, ec));
+    return static_cast <int> (m_stream->write(daq::stream::ConstBufferVector(buffers, buffers + 3), ec));
 }
 
 int StreamWriter::writeSignalData(unsigned int signalNumber, const void *pData, size_t length)
 {
-    daq::stream::ConstBufferVector buffers(2);
+    boost::asio::const_buffer buffers[2];
 
     /// room for the mandatory header and the optional additional length
     uint32_t transportHeaderBuffer[2];
@@ -56,9 +65,12 @@ int StreamWriter::writeSignalData(unsigned int signalNumber, const void *pData,
     buffers[0] = boost::asio::const_buffer(&transportHeaderBuffer[0], headerSize);
     buffers[1] = boost::asio::const_buffer(pData, length);
 
+    if (m_sendQueue) {
+        return m_sendQueue->push(TYPE_SIGNALDATA, signalNumber, buffers, 2);
+    }
     boost::system::error_code ec;
     std::lock_guard guard(m_writeMtx);
-    return static_cast <int> (m_stream->write(buffers, ec));
+    return static_cast <int> (m_stream->write(daq::stream::ConstBufferVector(buffers, buffers + 2), ec));
 }
 
 size_t StreamWriter::createTransportHeader(TransportType type, unsigned int signalNumber, uint32_t (&transportHeaderBuffer)[2], size_t size)
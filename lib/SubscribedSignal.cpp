@@ -11,6 +11,7 @@
 #include "streaming_protocol/SubscribedSignal.hpp"
 
 #include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/TimeTicks.hpp"
 #include "streaming_protocol/Types.h"
 
 namespace daq::streaming_protocol {
@@ -33,75 +34,54 @@ SubscribedSignal::SubscribedSignal(unsigned int signalNumber, LogCallback logCb)
 {
 }
 
-ssize_t SubscribedSignal::processMeasuredData(const unsigned char* pData, size_t size, std::shared_ptr<SubscribedSignal> timeSignal, DataAsRawCb cbRaw, DataAsValueCb cbValues)
+/// Forwards to the callbacks given as std::function
+class FunctionDataHandler
 {
-    auto timeSignalRule = RULETYPE_EXPLICIT;
-    if (timeSignal)
-        timeSignalRule = timeSignal->m_ruleType;
+public:
+    FunctionDataHandler(const DataAsRawCb& cbRaw, const DataAsValueCb& cbValues, const DataAsTimestampedValuesCb& cbTimestampedValues)
+        : m_cbRaw(cbRaw)
+        , m_cbValues(cbValues)
+        , m_cbTimestampedValues(cbTimestampedValues)
+    {
+    }
 
-    switch (timeSignalRule) {
-    case RULETYPE_LINEAR:
+    void dataAsRaw(const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t byteCount)
     {
-        // Signals with a non-explicit rule will have a value index for each value
-        size_t bytesPerValue;
-        m_linearDelta = timeSignal->m_linearDelta;
-
-        if (m_ruleType == RULETYPE_EXPLICIT) {
-            // Since we deliver the time stamp of the first value,
-            // We increment timestamp after execution of the callback methods.
-            // short read is not allowed! We expect complete packages only!
-
-            uint64_t timeStamp = timeSignal->time() + ((m_linearValueIndex - timeSignal->timeIndex()) * m_linearDelta);
-            cbRaw(*this, timeStamp, pData, size);
-
-            bytesPerValue = m_dataValueSize;
-            size_t valueCount = size / bytesPerValue;
-            cbValues(*this, timeStamp, pData, valueCount);
-            m_linearValueIndex += valueCount;
-        }
-        else if (m_ruleType == RULETYPE_CONSTANT) {
-            // for implicit signals, we get also the value index
-            bytesPerValue = sizeof(uint64_t) + m_dataValueSize;
+        m_cbRaw(subscribedSignal, timeStamp, data, byteCount);
+    }
 
-            cbRaw(*this, timeSignal->time(), pData, size);
-            size_t valueCount = size / bytesPerValue;
-            cbValues(*this, timeSignal->time(), pData, valueCount);
-        }
-        else {
-            STREAMING_PROTOCOL_LOG_E("Linear data signal is not supported");
-        }
-        break;
+    void dataAsValue(const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t valueCount)
+    {
+        m_cbValues(subscribedSignal, timeStamp, data, valueCount);
     }
-    case RULETYPE_EXPLICIT:
+
+    bool wantsTimestampedValues() const
     {
-        // In openDAQ streaming protocol, time stamp and value are delivered separately as explicit values
-        // in the time signal and the data signal.
-        // The device will deliver the time stamp before the value => Time (m_time) is already set! 
-        if ((size % m_dataValueSize) != 0) {
-            STREAMING_PROTOCOL_LOG_E("Data is not an even multiple of expected data size");
-            return (ssize_t) size;
-        }
-        uint64_t time = timeSignal ? timeSignal->m_time : 0;
-        cbRaw(*this, time, pData, size);
-        cbValues(*this, time, pData, size / m_dataValueSize);
-        break;
+        return static_cast < bool > (m_cbTimestampedValues);
     }
-    case RULETYPE_CONSTANT:
-        STREAMING_PROTOCOL_LOG_E("Domain signal with constant rule is not supported  ({})", m_signalId);
-        return -1;
-    case RULETYPE_UNKNOWN:
-        STREAMING_PROTOCOL_LOG_E("No rule for signal ", m_signalId);
-        return -1;
+
+    void dataAsTimestampedValues(const SubscribedSignal& subscribedSignal, const uint64_t* timeStamps, const uint8_t* data, size_t valueCount)
+    {
+        m_cbTimestampedValues(subscribedSignal, timeStamps, data, valueCount);
     }
 
-    return (ssize_t) size;
-}
+private:
+    const DataAsRawCb& m_cbRaw;
+    const DataAsValueCb& m_cbValues;
+    const DataAsTimestampedValuesCb& m_cbTimestampedValues;
+};
 
+ssize_t SubscribedSignal::processMeasuredData(const unsigned char* pData, size_t size, const std::shared_ptr<SubscribedSignal>& timeSignal, const DataAsRawCb& cbRaw, const DataAsValueCb& cbValues,
+                                              const DataAsTimestampedValuesCb& cbTimestampedValues)
+{
+    FunctionDataHandler handler(cbRaw, cbValues, cbTimestampedValues);
+    return processMeasuredData(pData, size, timeSignal.get(), handler);
+}
 
-static size_t getDataTypeSize(const nlohmann::json& definitionNode)
+/// \return Number of elements of one-dimensional arrays of primitives, 1 if there are no dimensions, 0 if the dimensions are not supported
+static size_t getDimensionCount(const nlohmann::json& definitionNode)
 {
     std::size_t count = 1;
-    std::string name = definitionNode.value(META_NAME, "");
 
     // Check for one-dimensional arrays of primitives.
     if (definitionNode.count(META_DIMENSIONS) > 0)
@@ -125,59 +105,189 @@ static size_t getDataTypeSize(const nlohmann::json& definitionNode)
 
         count = linear.value(META_SIZE, 1);
     }
+    return count;
+}
+
+static size_t getDataTypeSize(const nlohmann::json& definitionNode)
+{
+    std::size_t count = getDimensionCount(definitionNode);
+    if (count == 0) {
+        return 0;
+    }
 
     auto dataTypeIter = definitionNode.find(META_DATATYPE);
     if (dataTypeIter != definitionNode.end()) {
-        nlohmann::json datatypeNode = *dataTypeIter;
-        std::string dataType = datatypeNode;
-        if (dataType == DATA_TYPE_UINT8) {
+        switch (dataTypeFromName(dataTypeIter->get_ref < const std::string& > ())) {
+        case DATATYPE_UINT8:
             return sizeof(uint8_t) * count;
-        } else if (dataType == DATA_TYPE_UINT16) {
+        case DATATYPE_UINT16:
             return sizeof(uint16_t) * count;
-        } else if (dataType == DATA_TYPE_UINT32) {
+        case DATATYPE_UINT32:
             return sizeof(uint32_t) * count;
-        } else if (dataType == DATA_TYPE_UINT64) {
+        case DATATYPE_UINT64:
             return sizeof(uint64_t) * count;
-        } else if (dataType == DATA_TYPE_INT8) {
+        case DATATYPE_INT8:
             return sizeof(int8_t) * count;
-        } else if (dataType == DATA_TYPE_INT16) {
+        case DATATYPE_INT16:
             return sizeof(int16_t) * count;
-        } else if (dataType == DATA_TYPE_INT32) {
+        case DATATYPE_INT32:
             return sizeof(int32_t) * count;
-        } else if (dataType == DATA_TYPE_INT64) {
+        case DATATYPE_INT64:
             return sizeof(int64_t) * count;
-        } else if (dataType == DATA_TYPE_REAL32) {
+        case DATATYPE_REAL32:
             return sizeof(float) * count;
-        } else if (dataType == DATA_TYPE_REAL64) {
+        case DATATYPE_REAL64:
             return sizeof(double) * count;
-        } else if (dataType == DATA_TYPE_COMPLEX32) {
+        case DATATYPE_COMPLEX32:
             return sizeof(Complex32Type) * count;
-        } else if (dataType == DATA_TYPE_COMPLEX64) {
+        case DATATYPE_COMPLEX64:
             return sizeof(Complex64Type) * count;
-        } else if (dataType == DATA_TYPE_BITFIELD) {
-            nlohmann::json subDatatypeNode = definitionNode[DATA_TYPE_BITFIELD];
+        case DATATYPE_BITFIELD:
+        {
+            const nlohmann::json& subDatatypeNode = definitionNode.at(DATA_TYPE_BITFIELD);
             return getDataTypeSize(subDatatypeNode) * count;
-        } else if (dataType == DATA_TYPE_ARRAY) {
-            nlohmann::json subDatatypeNode = definitionNode[DATA_TYPE_ARRAY];
-            size_t arrayCount = subDatatypeNode[META_COUNT];
+        }
+        case DATATYPE_ARRAY:
+        {
+            const nlohmann::json& subDatatypeNode = definitionNode.at(DATA_TYPE_ARRAY);
+            size_t arrayCount = subDatatypeNode.at(META_COUNT);
             return getDataTypeSize(subDatatypeNode) * count * arrayCount;
-        } else if (dataType == DATA_TYPE_STRUCT) {
+        }
+        case DATATYPE_STRUCT:
+        {
             size_t dataTypeSize = 0;
-            for (const auto& subDatatypeNodeIter: definitionNode[DATA_TYPE_STRUCT] ) {
-                const nlohmann::json& subDatatypeNode = subDatatypeNodeIter;
+            for (const nlohmann::json& subDatatypeNode: definitionNode.at(DATA_TYPE_STRUCT) ) {
                 dataTypeSize += getDataTypeSize(subDatatypeNode) * count;
             }
             return dataTypeSize;
-        } else {
+        }
+        default:
             return 0;
         }
     }
     return 0;
 }
 
+/// Lists the scalar elements a value consists of. Same structure as getDataTypeSize().
+/// \return false if the data type is not supported
+static bool getElementTypes(const nlohmann::json& definitionNode, std::vector < SampleType >& elementTypes)
+{
+    std::size_t count = getDimensionCount(definitionNode);
+    if (count == 0) {
+        return false;
+    }
+
+    auto dataTypeIter = definitionNode.find(META_DATATYPE);
+    if (dataTypeIter == definitionNode.end()) {
+        return false;
+    }
+
+    std::vector < SampleType > memberTypes;
+    switch (dataTypeFromName(dataTypeIter->get_ref < const std::string& > ())) {
+    case DATATYPE_UINT8:
+        memberTypes.push_back(SAMPLETYPE_U8);
+        break;
+    case DATATYPE_UINT16:
+        memberTypes.push_back(SAMPLETYPE_U16);
+        break;
+    case DATATYPE_UINT32:
+        memberTypes.push_back(SAMPLETYPE_U32);
+        break;
+    case DATATYPE_UINT64:
+        memberTypes.push_back(SAMPLETYPE_U64);
+        break;
+    case DATATYPE_INT8:
+        memberTypes.push_back(SAMPLETYPE_S8);
+        break;
+    case DATATYPE_INT16:
+        memberTypes.push_back(SAMPLETYPE_S16);
+        break;
+    case DATATYPE_INT32:
+        memberTypes.push_back(SAMPLETYPE_S32);
+        break;
+    case DATATYPE_INT64:
+        memberTypes.push_back(SAMPLETYPE_S64);
+        break;
+    case DATATYPE_REAL32:
+        memberTypes.push_back(SAMPLETYPE_REAL32);
+        break;
+    case DATATYPE_REAL64:
+        memberTypes.push_back(SAMPLETYPE_REAL64);
+        break;
+    case DATATYPE_COMPLEX32:
+        // real and imaginary part
+        memberTypes.assign(2, SAMPLETYPE_REAL32);
+        break;
+    case DATATYPE_COMPLEX64:
+        memberTypes.assign(2, SAMPLETYPE_REAL64);
+        break;
+    case DATATYPE_BITFIELD:
+        if (!getElementTypes(definitionNode.at(DATA_TYPE_BITFIELD), memberTypes)) {
+            return false;
+        }
+        break;
+    case DATATYPE_ARRAY:
+    {
+        const nlohmann::json& subDatatypeNode = definitionNode.at(DATA_TYPE_ARRAY);
+        size_t arrayCount = subDatatypeNode.at(META_COUNT);
+        std::vector < SampleType > arrayElementTypes;
+        if (!getElementTypes(subDatatypeNode, arrayElementTypes)) {
+            return false;
+        }
+        for (size_t arrayIndex = 0; arrayIndex < arrayCount; ++arrayIndex) {
+            memberTypes.insert(memberTypes.end(), arrayElementTypes.begin(), arrayElementTypes.end());
+        }
+        break;
+    }
+    case DATATYPE_STRUCT:
+        for (const nlohmann::json& subDatatypeNode: definitionNode.at(DATA_TYPE_STRUCT) ) {
+            if (!getElementTypes(subDatatypeNode, memberTypes)) {
+                return false;
+            }
+        }
+        break;
+    default:
+        return false;
+    }
+
+    for (size_t index = 0; index < count; ++index) {
+        elementTypes.insert(elementTypes.end(), memberTypes.begin(), memberTypes.end());
+    }
+    return true;
+}
+
 int SubscribedSignal::processSignalMetaInformation(const std::string& method, const nlohmann::json& params)
 {
-    if (method == META_METHOD_SUBSCRIBE) {
+    return processSignalMetaInformation(methodTypeFromName(method), params);
+}
+
+int SubscribedSignal::processSignalMetaInformation(MethodType method, const MsgpackView& params)
+{
+    if (method == METHODTYPE_SUBSCRIBE) {
+        // We allow a string or a number here.
+        const MsgpackView node = params.find(META_SIGNALID);
+        switch (node.type()) {
+        case MsgpackView::MSGPACKTYPE_STRING:
+            m_signalId = node.asStringView();
+            return 0;
+        case MsgpackView::MSGPACKTYPE_UNSIGNED:
+        case MsgpackView::MSGPACKTYPE_SIGNED:
+        case MsgpackView::MSGPACKTYPE_FLOAT:
+            m_signalId = node.toJson().dump();
+            return 0;
+        default:
+            // there needs to be the signal id!
+            return -1;
+        }
+    } else if (method == METHODTYPE_SIGNAL) {
+        return processSignalMetaInformation(method, params.valid() ? params.toJson() : nlohmann::json());
+    }
+    return 0;
+}
+
+int SubscribedSignal::processSignalMetaInformation(MethodType method, const nlohmann::json& params)
+{
+    if (method == METHODTYPE_SUBSCRIBE) {
         /// this is the first signal related meta information to arrive!
         auto iter = params.find(META_SIGNALID);
         if (iter == params.end()) {
@@ -193,7 +303,7 @@ int SubscribedSignal::processSignalMetaInformation(const std::string& method, co
         } else {
             return -1;
         }
-    } else if (method == META_METHOD_SIGNAL) {
+    } else if (method == METHODTYPE_SIGNAL) {
         auto tableIdIter = params.find(META_TABLEID);
         if (tableIdIter!=params.end()) {
             const nlohmann::json& node = tableIdIter.value();
@@ -253,8 +363,9 @@ int SubscribedSignal::processSignalMetaInformation(const std::string& method, co
 
                 auto ruleIter = definitionNode.find(META_RULE);
                 if (ruleIter != definitionNode.end()) {
-                    std::string rule = *ruleIter;
-                    if (rule == META_RULETYPE_LINEAR) {
+                    RuleType ruleType = ruleTypeFromName(ruleIter->get_ref < const std::string& > ());
+                    switch (ruleType) {
+                    case RULETYPE_LINEAR:
                         // always make sure that linear rule is valid.
                         // linear rule has to be delivered in a prior meta information at at the latest with this package.
                         if (m_linearDelta == 0) {
@@ -262,11 +373,12 @@ int SubscribedSignal::processSignalMetaInformation(const std::string& method, co
                             return -1;
                         }
                         m_ruleType = RULETYPE_LINEAR;
-                    } else if (rule == META_RULETYPE_EXPLICIT) {
-                        m_ruleType = RULETYPE_EXPLICIT;
-                    } else if (rule == META_RULETYPE_CONSTANT) {
-                        m_ruleType = RULETYPE_CONSTANT;
-                    } else {
+                        break;
+                    case RULETYPE_EXPLICIT:
+                    case RULETYPE_CONSTANT:
+                        m_ruleType = ruleType;
+                        break;
+                    default:
                         STREAMING_PROTOCOL_LOG_E("\tUnknown implicit rule\n");
                         return -1;
                     }
@@ -277,6 +389,14 @@ int SubscribedSignal::processSignalMetaInformation(const std::string& method, co
                 if (dataValueSize) {
                     m_dataValueSize = dataValueSize;
                 }
+                if (definitionNode.contains(META_DATATYPE)) {
+                    // data types not supported by the converter must not be converted with the layout of the previous data type
+                    std::vector < SampleType > elementTypes;
+                    if ((dataValueSize == 0) || (!getElementTypes(definitionNode, elementTypes))) {
+                        elementTypes.clear();
+                    }
+                    m_sampleConverter.setElementTypes(elementTypes);
+                }
 
                 nlohmann::json::const_iterator memberNameIter = definitionNode.find(META_NAME);
                 if (memberNameIter != definitionNode.end()) {
@@ -285,28 +405,40 @@ int SubscribedSignal::processSignalMetaInformation(const std::string& method, co
                 }
                 auto dataTypeIter = definitionNode.find(META_DATATYPE);
                 if (dataTypeIter != definitionNode.end()) {
-                    std::string dataType = *dataTypeIter;
-                    if (dataType == DATA_TYPE_UINT8) {
+                    const std::string& dataType = dataTypeIter->get_ref < const std::string& > ();
+                    switch (dataTypeFromName(dataType)) {
+                    case DATATYPE_UINT8:
                         m_dataValueType = SAMPLETYPE_U8;
-                    } else if (dataType == DATA_TYPE_UINT16) {
+                        break;
+                    case DATATYPE_UINT16:
                         m_dataValueType = SAMPLETYPE_U16;
-                    } else if (dataType == DATA_TYPE_UINT32) {
+                        break;
+                    case DATATYPE_UINT32:
                         m_dataValueType = SAMPLETYPE_U32;
-                    } else if (dataType == DATA_TYPE_UINT64) {
+                        break;
+                    case DATATYPE_UINT64:
                         m_dataValueType = SAMPLETYPE_U64;
-                    } else if (dataType == DATA_TYPE_INT8) {
+                        break;
+                    case DATATYPE_INT8:
                         m_dataValueType = SAMPLETYPE_S8;
-                    } else if (dataType == DATA_TYPE_INT16) {
+                        break;
+                    case DATATYPE_INT16:
                         m_dataValueType = SAMPLETYPE_S16;
-                    } else if (dataType == DATA_TYPE_INT32) {
+                        break;
+                    case DATATYPE_INT32:
                         m_dataValueType = SAMPLETYPE_S32;
-                    } else if (dataType == DATA_TYPE_INT64) {
+                        break;
+                    case DATATYPE_INT64:
                         m_dataValueType = SAMPLETYPE_S64;
-                    } else if (dataType == DATA_TYPE_REAL32) {
+                        break;
+                    case DATATYPE_REAL32:
                         m_dataValueType = SAMPLETYPE_REAL32;
-                    } else if (dataType == DATA_TYPE_REAL64) {
+                        break;
+                    case DATATYPE_REAL64:
                         m_dataValueType = SAMPLETYPE_REAL64;
-                    } else if (dataType == DATA_TYPE_BITFIELD) {
+                        break;
+                    case DATATYPE_BITFIELD:
+                    {
                         /// Find details in the "bitField" object. They have the following form:
                         /// \code
                         /// {
@@ -328,19 +460,23 @@ int SubscribedSignal::processSignalMetaInformation(const std::string& method, co
                         ///
                         m_datatypeDetails = definitionNode[DATA_TYPE_BITFIELD];
                         m_bitsInterpretationObject = m_datatypeDetails["bits"];
-                        std::string bitfieldDataType = m_datatypeDetails[META_DATATYPE];
-                        if (bitfieldDataType == DATA_TYPE_UINT32) {
+                        DataType bitfieldDataType = dataTypeFromName(m_datatypeDetails[META_DATATYPE].get_ref < const std::string& > ());
+                        if (bitfieldDataType == DATATYPE_UINT32) {
                             m_dataValueType = SAMPLETYPE_BITFIELD32;
-                        } else if (bitfieldDataType == DATA_TYPE_UINT64) {
+                        } else if (bitfieldDataType == DATATYPE_UINT64) {
                             m_dataValueType = SAMPLETYPE_BITFIELD64;
                         } else {
                             return -1;
                         }
-                    } else if (dataType == DATA_TYPE_COMPLEX32) {
+                        break;
+                    }
+                    case DATATYPE_COMPLEX32:
                         m_dataValueType = SAMPLETYPE_COMPLEX32;
-                    } else if (dataType == DATA_TYPE_COMPLEX64) {
+                        break;
+                    case DATATYPE_COMPLEX64:
                         m_dataValueType = SAMPLETYPE_COMPLEX64;
-                    } else if (dataType == DATA_TYPE_ARRAY) {
+                        break;
+                    case DATATYPE_ARRAY:
                         /// An array has a fixed number of elements of the specified member
                         /// Find details in the "array" object. They have the following form:
                         /// \code
@@ -352,7 +488,8 @@ int SubscribedSignal::processSignalMetaInformation(const std::string& method, co
                         /// \note only scalar array elements are supported here!
                         m_datatypeDetails = definitionNode[DATA_TYPE_ARRAY];
                         m_dataValueType = SAMPLETYPE_ARRAY;
-                    } else if (dataType == DATA_TYPE_DYNAMIC_ARRAY) {
+                        break;
+                    case DATATYPE_DYNAMIC_ARRAY:
                         /// An array with variable number of elements.
                         /// Data package always consists of a uint32 with the number of members followed by the explicit content of the members
                         /// \code
@@ -362,7 +499,7 @@ int SubscribedSignal::processSignalMetaInformation(const std::string& method, co
                         /// \endcode
                         STREAMING_PROTOCOL_LOG_E("{}: Data type 'dynamicArray' is not supported!", m_signalId);
                         return -1;
-                    } else if (dataType == DATA_TYPE_STRUCT) {
+                    case DATATYPE_STRUCT:
                         /// Struct constains an array of members
                         /// Find details in the "struct" object. They have the following form:
                         /// \code
@@ -380,7 +517,8 @@ int SubscribedSignal::processSignalMetaInformation(const std::string& method, co
                         /// \note only scalar elements are supported here!
                         m_datatypeDetails = definitionNode[DATA_TYPE_STRUCT];
                         m_dataValueType = SAMPLETYPE_STRUCT;
-                    } else {
+                        break;
+                    default:
                         STREAMING_PROTOCOL_LOG_E("{0}: Unknown datatype '{1}'", m_signalId, dataType);
                         return -1;
                     }
@@ -414,6 +552,11 @@ int SubscribedSignal::processSignalMetaInformation(const std::string& method, co
                 m_range.parse(definitionNode);
                 m_postScaling.parse(definitionNode);
 
+                // for implicit signals, each value follows after a value index
+                m_sampleConverter.setIndexed(m_ruleType != RULETYPE_EXPLICIT);
+                m_sampleConverter.setRange(m_range);
+                m_sampleConverter.setPostScaling(m_postScaling);
+
                 if (m_isTimeSignal) {
                     // separate check because time chapter may only be send initialy, later changes won't have this again!
                     if (m_ruleType == RULETYPE_LINEAR) {
@@ -452,42 +595,10 @@ int SubscribedSignal::processSignalMetaInformation(const std::string& method, co
 
 size_t SubscribedSignal::interpretValuesAsDouble(const unsigned char *pData, size_t count, double* doubleValueBuffer) const
 {
-    switch (m_dataValueType) {
-    case SAMPLETYPE_REAL32:
-        convert < float >(pData, count, doubleValueBuffer);
-        return count;
-    case SAMPLETYPE_REAL64:
-        convert < double >(pData, count, doubleValueBuffer);
-        return count;
-    case SAMPLETYPE_U8:
-        convert < uint8_t >(pData, count, doubleValueBuffer);
-        return count;
-    case SAMPLETYPE_U16:
-        convert < uint16_t >(pData, count, doubleValueBuffer);
-        return count;
-    case SAMPLETYPE_U32:
-    case SAMPLETYPE_BITFIELD32:
-        convert < uint32_t >(pData, count, doubleValueBuffer);
-        return count;
-    case SAMPLETYPE_U64:
-    case SAMPLETYPE_BITFIELD64:
-        convert < int64_t >(pData, count, doubleValueBuffer);
-        return count;
-    case SAMPLETYPE_S8:
-        convert < int8_t >(pData, count, doubleValueBuffer);
-        return count;
-    case SAMPLETYPE_S16:
-        convert < int16_t >(pData, count, doubleValueBuffer);
-        return count;
-    case SAMPLETYPE_S32:
-        convert < int32_t >(pData, count, doubleValueBuffer);
-        return count;
-    case SAMPLETYPE_S64:
-        convert < int64_t >(pData, count, doubleValueBuffer);
-        return count;
-    default:
+    if (m_sampleConverter.elementCount() != 1) {
         // All others are not supported
         return 0;
     }
+    return m_sampleConverter.convert(pData, count, doubleValueBuffer);
 }
 }
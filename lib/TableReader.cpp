@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define TABLEREADER_X86
+#include <immintrin.h>
+#endif
+
+#if defined(TABLEREADER_X86) && (defined(__GNUC__) || defined(__clang__))
+/// Allows using intrinsics of the given instruction set within a function without compiling the whole library for it
+#define TABLEREADER_TARGET(isa) __attribute__((target(isa)))
+#else
+#define TABLEREADER_TARGET(isa)
+#endif
+
+#include "streaming_protocol/SampleConverter.hpp"
+#include "streaming_protocol/TableReader.hpp"
+#include "streaming_protocol/TimeTicks.hpp"
+
+namespace daq::streaming_protocol {
+    /// Mark for signals that are no column
+    static const size_t NO_COLUMN = std::numeric_limits < size_t >::max();
+    /// Signal numbers from here on are not used as index. A single large signal number does not allocate a huge vector.
+    static const SignalNumber INDEXED_SIGNAL_COUNT = 4096;
+
+    /// Number of rows transposed at once. Keeps the touched part of the rows within the cache.
+    static const size_t ROW_BLOCK = 64;
+
+    /// Transposes the given range of columns and rows one value after the other
+    static void interleaveScalar(const double* const* columns, size_t columnCount, size_t columnBegin, size_t columnEnd, size_t rowBegin, size_t rowEnd, double* rows)
+    {
+        for (size_t row = rowBegin; row < rowEnd; ++row) {
+            for (size_t column = columnBegin; column < columnEnd; ++column) {
+                rows[row * columnCount + column] = columns[column][row];
+            }
+        }
+    }
+
+#ifdef TABLEREADER_X86
+    /// 2x2 blocks, SSE2 is part of x86-64
+    static void interleaveSse2(const double* const* columns, size_t columnCount, size_t rowCount, double* rows)
+    {
+        size_t columnEnd = columnCount & ~size_t(1);
+        for (size_t rowBegin = 0; rowBegin < rowCount; rowBegin += ROW_BLOCK) {
+            size_t rowEnd = std::min(rowBegin + ROW_BLOCK, rowCount);
+            size_t blockRowEnd = rowBegin + ((rowEnd - rowBegin) & ~size_t(1));
+            for (size_t column = 0; column < columnEnd; column += 2) {
+                for (size_t row = rowBegin; row < blockRowEnd; row += 2) {
+                    __m128d a = _mm_loadu_pd(columns[column] + row);
+                    __m128d b = _mm_loadu_pd(columns[column + 1] + row);
+                    _mm_storeu_pd(rows + row * columnCount + column, _mm_unpacklo_pd(a, b));
+                    _mm_storeu_pd(rows + (row + 1) * columnCount + column, _mm_unpackhi_pd(a, b));
+                }
+            }
+            interleaveScalar(columns, columnCount, 0, columnEnd, blockRowEnd, rowEnd, rows);
+            interleaveScalar(columns, columnCount, columnEnd, columnCount, rowBegin, rowEnd, rows);
+        }
+    }
+
+    /// 4x4 blocks
+    TABLEREADER_TARGET("avx") static void interleaveAvx(const double* const* columns, size_t columnCount, size_t rowCount, double* rows)
+    {
+        size_t columnEnd = columnCount & ~size_t(3);
+        for (size_t rowBegin = 0; rowBegin < rowCount; rowBegin += ROW_BLOCK) {
+            size_t rowEnd = std::min(rowBegin + ROW_BLOCK, rowCount);
+            size_t blockRowEnd = rowBegin + ((rowEnd - rowBegin) & ~size_t(3));
+            for (size_t column = 0; column < columnEnd; column += 4) {
+                for (size_t row = rowBegin; row < blockRowEnd; row += 4) {
+                    __m256d a = _mm256_loadu_pd(columns[column] + row);
+                    __m256d b = _mm256_loadu_pd(columns[column + 1] + row);
+                    __m256d c = _mm256_loadu_pd(columns[column + 2] + row);
+                    __m256d d = _mm256_loadu_pd(columns[column + 3] + row);
+                    // a0 b0 a2 b2, a1 b1 a3 b3, c0 d0 c2 d2, c1 d1 c3 d3
+                    __m256d ab02 = _mm256_unpacklo_pd(a, b);
+                    __m256d ab13 = _mm256_unpackhi_pd(a, b);
+                    __m256d cd02 = _mm256_unpacklo_pd(c, d);
+                    __m256d cd13 = _mm256_unpackhi_pd(c, d);
+                    double* pRow = rows + row * columnCount + column;
+                    _mm256_storeu_pd(pRow, _mm256_permute2f128_pd(ab02, cd02, 0x20));
+                    _mm256_storeu_pd(pRow + columnCount, _mm256_permute2f128_pd(ab13, cd13, 0x20));
+                    _mm256_storeu_pd(pRow + 2 * columnCount, _mm256_permute2f128_pd(ab02, cd02, 0x31));
+                    _mm256_storeu_pd(pRow + 3 * columnCount, _mm256_permute2f128_pd(ab13, cd13, 0x31));
+                }
+            }
+            interleaveScalar(columns, columnCount, 0, columnEnd, blockRowEnd, rowEnd, rows);
+            interleaveScalar(columns, columnCount, columnEnd, columnCount, rowBegin, rowEnd, rows);
+        }
+    }
+#endif
+
+    void TableReader::interleave(const double* const* columns, size_t columnCount, size_t rowCount, double* rows)
+    {
+        if (columnCount == 1) {
+            std::copy(columns[0], columns[0] + rowCount, rows);
+            return;
+        }
+#ifdef TABLEREADER_X86
+        // AVX is part of AVX2
+        static const bool avx = SampleConverter::supportedInstructionSet() >= SampleConverter::INSTRUCTIONSET_AVX2;
+        if (avx && (columnCount >= 4)) {
+            interleaveAvx(columns, columnCount, rowCount, rows);
+        } else {
+            interleaveSse2(columns, columnCount, rowCount, rows);
+        }
+#else
+        interleaveScalar(columns, columnCount, 0, columnCount, 0, rowCount, rows);
+#endif
+    }
+
+    TableReader::TableReader(const std::vector < std::string >& signalIds, size_t frameCapacity, size_t maxBufferedRows, TableFrameCb cb, LogCallback logCb)
+        : m_frameCapacity(std::max(frameCapacity, size_t(1)))
+        , m_maxBufferedRows(std::max(maxBufferedRows, m_frameCapacity))
+        , m_cb(cb)
+        , m_rowMajor(false)
+        , m_started(false)
+        , m_firstValueIndex(0)
+        , m_referenceTime(0)
+        , m_referenceValueIndex(0)
+        , m_timeDelta(0)
+        , m_droppedValueCount(0)
+        , logCallback(logCb)
+    {
+        for (const std::string& signalId : signalIds) {
+            Column column;
+            column.signalId = signalId;
+            column.values.reserve(m_maxBufferedRows + m_frameCapacity);
+            m_columns.push_back(std::move(column));
+        }
+        m_columnPointers.resize(m_columns.size());
+    }
+
+    void TableReader::setRowMajor(bool rowMajor)
+    {
+        m_rowMajor = rowMajor;
+    }
+
+    int TableReader::columnIndex(const SubscribedSignal& subscribedSignal)
+    {
+        size_t& signalColumn = this->signalColumn(subscribedSignal.signalNumber());
+        // signal numbers might get reused by other signals
+        if ((signalColumn == 0) ||
+            ((signalColumn != NO_COLUMN) && (m_columns[signalColumn - 1].signalId != subscribedSignal.signalId()))) {
+            signalColumn = NO_COLUMN;
+            for (size_t column = 0; column < m_columns.size(); ++column) {
+                if (m_columns[column].signalId == subscribedSignal.signalId()) {
+                    signalColumn = column + 1;
+                    break;
+                }
+            }
+        }
+        if (signalColumn == NO_COLUMN) {
+            return -1;
+        }
+        return static_cast < int > (signalColumn - 1);
+    }
+
+    size_t& TableReader::signalColumn(SignalNumber signalNumber)
+    {
+        if (signalNumber >= INDEXED_SIGNAL_COUNT) {
+            return m_sparseSignalColumns[signalNumber];
+        }
+        if (signalNumber >= m_signalColumns.size()) {
+            m_signalColumns.resize(signalNumber + 1, 0);
+        }
+        return m_signalColumns[signalNumber];
+    }
+
+    void TableReader::add(const SubscribedSignal& subscribedSignal, const uint64_t* timeStamps, const uint8_t* data, size_t valueCount)
+    {
+        int column = columnIndex(subscribedSignal);
+        if ((column < 0) || (valueCount == 0)) {
+            return;
+        }
+        uint64_t timeDelta = subscribedSignal.timeLinearDelta();
+        if ((timeDelta == 0) || (subscribedSignal.ruleType() != RULETYPE_EXPLICIT)) {
+            STREAMING_PROTOCOL_LOG_E("Signal '{}' is no synchronous signal with linear time!", subscribedSignal.signalId());
+            return;
+        }
+        m_conversionBuffer.resize(valueCount);
+        if (subscribedSignal.interpretValuesAsDouble(data, valueCount, m_conversionBuffer.data()) != valueCount) {
+            STREAMING_PROTOCOL_LOG_E("Data type of signal '{}' is not supported, scalars only!", subscribedSignal.signalId());
+            return;
+        }
+
+        // value index of the first value delivered
+        uint64_t valueIndex = subscribedSignal.timeIndex();
+        m_referenceTime = timeStamps[0];
+        m_referenceValueIndex = valueIndex;
+        m_timeDelta = timeDelta;
+        if (!m_started) {
+            m_started = true;
+            m_firstValueIndex = valueIndex;
+        }
+
+        const double* values = m_conversionBuffer.data();
+        if (valueIndex < m_firstValueIndex) {
+            // rows are delivered already
+            uint64_t lateCount = std::min(static_cast < uint64_t > (valueCount), m_firstValueIndex - valueIndex);
+            m_droppedValueCount += lateCount;
+            values += lateCount;
+            valueCount -= static_cast < size_t > (lateCount);
+            valueIndex += lateCount;
+            if (valueCount == 0) {
+                return;
+            }
+        }
+
+        if (valueIndex - m_firstValueIndex > m_maxBufferedRows) {
+            // discontinuity: Everything buffered is delivered, rows in between are skipped
+            flush();
+            m_firstValueIndex = valueIndex;
+        }
+
+        std::vector < double >& columnValues = m_columns[static_cast < size_t > (column)].values;
+        size_t offset = static_cast < size_t > (valueIndex - m_firstValueIndex);
+        if (columnValues.size() < offset + valueCount) {
+            // values missing in between are NaN
+            columnValues.resize(offset + valueCount, std::numeric_limits < double >::quiet_NaN());
+        }
+        std::copy(values, values + valueCount, columnValues.begin() + static_cast < std::ptrdiff_t > (offset));
+
+        size_t completeRows = columnValues.size();
+        size_t bufferedRows = 0;
+        for (const Column& tableColumn : m_columns) {
+            completeRows = std::min(completeRows, tableColumn.values.size());
+            bufferedRows = std::max(bufferedRows, tableColumn.values.size());
+        }
+        while (completeRows >= m_frameCapacity) {
+            deliver(m_frameCapacity);
+            completeRows -= m_frameCapacity;
+            bufferedRows -= m_frameCapacity;
+        }
+        while (bufferedRows > m_maxBufferedRows) {
+            // columns lagging behind do not hold us back any longer
+            size_t rowCount = std::min(m_frameCapacity, bufferedRows);
+            deliver(rowCount);
+            bufferedRows -= rowCount;
+        }
+    }
+
+    void TableReader::flush()
+    {
+        size_t bufferedRows = 0;
+        for (const Column& column : m_columns) {
+            bufferedRows = std::max(bufferedRows, column.values.size());
+        }
+        while (bufferedRows > 0) {
+            size_t rowCount = std::min(m_frameCapacity, bufferedRows);
+            deliver(rowCount);
+            bufferedRows -= rowCount;
+        }
+    }
+
+    void TableReader::deliver(size_t rowCount)
+    {
+        for (size_t column = 0; column < m_columns.size(); ++column) {
+            std::vector < double >& values = m_columns[column].values;
+            if (values.size() < rowCount) {
+                values.resize(rowCount, std::numeric_limits < double >::quiet_NaN());
+            }
+            m_columnPointers[column] = values.data();
+        }
+
+        m_timeStamps.resize(rowCount);
+        // wraps around correctly if the first row is before the reference
+        uint64_t firstTime = m_referenceTime + (m_firstValueIndex - m_referenceValueIndex) * m_timeDelta;
+        TimeTicks::linear(firstTime, m_timeDelta, rowCount, m_timeStamps.data());
+
+        TableFrame frame;
+        frame.firstValueIndex = m_firstValueIndex;
+        frame.rowCount = rowCount;
+        frame.timeStamps = m_timeStamps.data();
+        frame.columnCount = m_columns.size();
+        frame.columns = m_columnPointers.data();
+        frame.rows = nullptr;
+        if (m_rowMajor) {
+            m_rows.resize(rowCount * m_columns.size());
+            interleave(m_columnPointers.data(), m_columns.size(), rowCount, m_rows.data());
+            frame.rows = m_rows.data();
+        }
+        m_cb(frame);
+
+        for (Column& column : m_columns) {
+            column.values.erase(column.values.begin(), column.values.begin() + static_cast < std::ptrdiff_t > (rowCount));
+        }
+        m_firstValueIndex += rowCount;
+    }
+}
@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "streaming_protocol/SampleConverter.hpp"
+#include "streaming_protocol/TimeTicks.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+/// The loops below are compiled a 2nd time for AVX2 and selected at runtime
+#define TIMETICKS_AVX2
+#define TIMETICKS_INLINE inline __attribute__((always_inline))
+#else
+#define TIMETICKS_INLINE inline
+#endif
+
+namespace daq::streaming_protocol {
+    /// Loops are kept simple enough to be vectorized by the compiler
+
+    static TIMETICKS_INLINE void multiplyLoop(const uint64_t* values, size_t count, uint64_t factor, uint64_t* results)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            results[i] = values[i] * factor;
+        }
+    }
+
+    static TIMETICKS_INLINE void linearLoop(uint64_t start, uint64_t delta, size_t count, uint64_t* timeStamps)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            timeStamps[i] = start + i * delta;
+        }
+    }
+
+    static TIMETICKS_INLINE void indexedLoop(uint64_t start, uint64_t startIndex, uint64_t delta, const uint8_t* indexedValues, size_t stride, size_t count, uint64_t* timeStamps)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t valueIndex;
+            memcpy(&valueIndex, indexedValues + i * stride, sizeof(valueIndex));
+            timeStamps[i] = start + (valueIndex - startIndex) * delta;
+        }
+    }
+
+#ifdef TIMETICKS_AVX2
+    __attribute__((target("avx2"))) static void multiplyAvx2(const uint64_t* values, size_t count, uint64_t factor, uint64_t* results)
+    {
+        multiplyLoop(values, count, factor, results);
+    }
+
+    __attribute__((target("avx2"))) static void linearAvx2(uint64_t start, uint64_t delta, size_t count, uint64_t* timeStamps)
+    {
+        linearLoop(start, delta, count, timeStamps);
+    }
+
+    __attribute__((target("avx2"))) static void indexedAvx2(uint64_t start, uint64_t startIndex, uint64_t delta, const uint8_t* indexedValues, size_t stride, size_t count, uint64_t* timeStamps)
+    {
+        indexedLoop(start, startIndex, delta, indexedValues, stride, count, timeStamps);
+    }
+
+    static bool useAvx2()
+    {
+        static const bool avx2 = SampleConverter::supportedInstructionSet() >= SampleConverter::INSTRUCTIONSET_AVX2;
+        return avx2;
+    }
+#endif
+
+    static void multiply(const uint64_t* values, size_t count, uint64_t factor, uint64_t* results)
+    {
+#ifdef TIMETICKS_AVX2
+        if (useAvx2()) {
+            multiplyAvx2(values, count, factor, results);
+            return;
+        }
+#endif
+        multiplyLoop(values, count, factor, results);
+    }
+
+#if !defined(__SIZEOF_INT128__)
+    /// 128 bit product and restoring division for compilers without a 128 bit integer type
+    static uint64_t mulDivGeneric(uint64_t value, uint64_t multiplier, uint64_t divisor)
+    {
+        static const uint64_t LOWER = 0xffffffff;
+        uint64_t p00 = (value & LOWER) * (multiplier & LOWER);
+        uint64_t p01 = (value & LOWER) * (multiplier >> 32);
+        uint64_t p10 = (value >> 32) * (multiplier & LOWER);
+        uint64_t p11 = (value >> 32) * (multiplier >> 32);
+        uint64_t middle = (p00 >> 32) + (p01 & LOWER) + (p10 & LOWER);
+        uint64_t low = (middle << 32) | (p00 & LOWER);
+        uint64_t high = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+
+        uint64_t quotient = 0;
+        uint64_t remainder = 0;
+        for (int bit = 127; bit >= 0; --bit) {
+            bool carry = (remainder >> 63) != 0;
+            uint64_t nextBit = (bit >= 64) ? (high >> (bit - 64)) & 1 : (low >> bit) & 1;
+            remainder = (remainder << 1) | nextBit;
+            quotient <<= 1;
+            if (carry || (remainder >= divisor)) {
+                remainder -= divisor;
+                quotient |= 1;
+            }
+        }
+        return quotient;
+    }
+#endif
+
+    uint64_t TimeTicks::mulDiv(uint64_t value, uint64_t multiplier, uint64_t divisor)
+    {
+#if defined(__SIZEOF_INT128__)
+        __extension__ using Uint128 = unsigned __int128;
+        return static_cast < uint64_t > (static_cast < Uint128 > (value) * multiplier / divisor);
+#else
+        return mulDivGeneric(value, multiplier, divisor);
+#endif
+    }
+
+    /// \return value * multiplier / divisor, picks the cheapest exact way. 0 if divisor is 0.
+    static uint64_t scale(uint64_t value, uint64_t multiplier, uint64_t divisor)
+    {
+        if (divisor == 0) {
+            return 0;
+        } else if (multiplier % divisor == 0) {
+            return value * (multiplier / divisor);
+        } else if (divisor % multiplier == 0) {
+            return value / (divisor / multiplier);
+        } else if (divisor <= std::numeric_limits < uint64_t >::max() / multiplier) {
+            // remainder * multiplier can not overflow
+            return (value / divisor) * multiplier + (value % divisor) * multiplier / divisor;
+        }
+        return TimeTicks::mulDiv(value, multiplier, divisor);
+    }
+
+#if defined(__SIZEOF_INT128__)
+    /// Division by a divisor that is the same for many values.
+    /// The division is replaced by a multiplication with the reciprocal as described by Granlund and Montgomery in "Division by Invariant Integers using Multiplication".
+    /// Results are exact for all dividends.
+    class Divider
+    {
+    public:
+        /// \param divisor >= 2
+        explicit Divider(uint64_t divisor)
+        {
+            __extension__ using Uint128 = unsigned __int128;
+            // ceil(log2(divisor))
+            unsigned int log2 = 64 - static_cast < unsigned int > (__builtin_clzll(divisor - 1));
+            Uint128 power = static_cast < Uint128 > (1) << log2;
+            m_magic = static_cast < uint64_t > (((power - divisor) << 64) / divisor) + 1;
+            m_shift = log2 - 1;
+        }
+
+        uint64_t divide(uint64_t dividend) const
+        {
+            __extension__ using Uint128 = unsigned __int128;
+            uint64_t high = static_cast < uint64_t > ((static_cast < Uint128 > (dividend) * m_magic) >> 64);
+            return (high + ((dividend - high) >> 1)) >> m_shift;
+        }
+
+    private:
+        uint64_t m_magic;
+        unsigned int m_shift;
+    };
+#else
+    class Divider
+    {
+    public:
+        explicit Divider(uint64_t divisor)
+            : m_divisor(divisor)
+        {
+        }
+
+        uint64_t divide(uint64_t dividend) const
+        {
+            return dividend / m_divisor;
+        }
+
+    private:
+        uint64_t m_divisor;
+    };
+#endif
+
+    /// Batch version of scale()
+    static void scale(const uint64_t* values, size_t count, uint64_t multiplier, uint64_t divisor, uint64_t* results)
+    {
+        if (divisor == 0) {
+            std::fill(results, results + count, 0);
+        } else if (multiplier % divisor == 0) {
+            multiply(values, count, multiplier / divisor, results);
+        } else if (divisor % multiplier == 0) {
+            Divider divider(divisor / multiplier);
+            for (size_t i = 0; i < count; ++i) {
+                results[i] = divider.divide(values[i]);
+            }
+        } else if (divisor <= std::numeric_limits < uint64_t >::max() / multiplier) {
+            Divider divider(divisor);
+            for (size_t i = 0; i < count; ++i) {
+                uint64_t quotient = divider.divide(values[i]);
+                uint64_t remainder = values[i] - quotient * divisor;
+                results[i] = quotient * multiplier + divider.divide(remainder * multiplier);
+            }
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                results[i] = TimeTicks::mulDiv(values[i], multiplier, divisor);
+            }
+        }
+    }
+
+    using SystemClockPeriod = std::chrono::system_clock::period;
+
+    uint64_t TimeTicks::toNanoseconds(uint64_t timeTicks, uint64_t timeTicksPerSecond)
+    {
+        return scale(timeTicks, NANOSECONDS_PER_SECOND, timeTicksPerSecond);
+    }
+
+    uint64_t TimeTicks::fromNanoseconds(uint64_t nanoseconds, uint64_t timeTicksPerSecond)
+    {
+        return scale(nanoseconds, timeTicksPerSecond, NANOSECONDS_PER_SECOND);
+    }
+
+    std::chrono::system_clock::time_point TimeTicks::toSystemClock(uint64_t timeTicks, uint64_t timeTicksPerSecond)
+    {
+        uint64_t count = scale(timeTicks, SystemClockPeriod::den, timeTicksPerSecond * SystemClockPeriod::num);
+        return std::chrono::system_clock::time_point(std::chrono::system_clock::duration(static_cast < std::chrono::system_clock::rep > (count)));
+    }
+
+    uint64_t TimeTicks::fromSystemClock(const std::chrono::system_clock::time_point& time, uint64_t timeTicksPerSecond)
+    {
+        std::chrono::system_clock::rep count = time.time_since_epoch().count();
+        if (count < 0) {
+            return 0;
+        }
+        return scale(static_cast < uint64_t > (count), timeTicksPerSecond * SystemClockPeriod::num, SystemClockPeriod::den);
+    }
+
+    void TimeTicks::toNanoseconds(const uint64_t* timeTicks, size_t count, uint64_t timeTicksPerSecond, uint64_t* nanoseconds)
+    {
+        scale(timeTicks, count, NANOSECONDS_PER_SECOND, timeTicksPerSecond, nanoseconds);
+    }
+
+    void TimeTicks::toSystemClock(const uint64_t* timeTicks, size_t count, uint64_t timeTicksPerSecond, std::chrono::system_clock::time_point* times)
+    {
+        // converted in chunks that fit into the cache
+        static const size_t CHUNK_SIZE = 256;
+        uint64_t counts[CHUNK_SIZE];
+        while (count > 0) {
+            size_t chunkSize = std::min(count, CHUNK_SIZE);
+            scale(timeTicks, chunkSize, SystemClockPeriod::den, timeTicksPerSecond * SystemClockPeriod::num, counts);
+            for (size_t i = 0; i < chunkSize; ++i) {
+                times[i] = std::chrono::system_clock::time_point(std::chrono::system_clock::duration(static_cast < std::chrono::system_clock::rep > (counts[i])));
+            }
+            timeTicks += chunkSize;
+            times += chunkSize;
+            count -= chunkSize;
+        }
+    }
+
+    void TimeTicks::linear(uint64_t start, uint64_t delta, size_t count, uint64_t* timeStamps)
+    {
+#ifdef TIMETICKS_AVX2
+        if (useAvx2()) {
+            linearAvx2(start, delta, count, timeStamps);
+            return;
+        }
+#endif
+        linearLoop(start, delta, count, timeStamps);
+    }
+
+    void TimeTicks::linear(uint64_t start, uint64_t startIndex, uint64_t delta, const uint8_t* indexedValues, size_t stride, size_t count, uint64_t* timeStamps)
+    {
+#ifdef TIMETICKS_AVX2
+        if (useAvx2()) {
+            indexedAvx2(start, startIndex, delta, indexedValues, stride, count, timeStamps);
+            return;
+        }
+#endif
+        indexedLoop(start, startIndex, delta, indexedValues, stride, count, timeStamps);
+    }
+}
@@ -0,0 +1,321 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/post.hpp"
+#include "nlohmann/json.hpp"
+
+#include "stream/Stream.hpp"
+
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/jsonrpc_defines.hpp"
+#include "streaming_protocol/ProtocolHandler.hpp"
+#include "streaming_protocol/SignalContainer.hpp"
+#include "streaming_protocol/StreamWriter.h"
+
+#include "streaming_protocol/Logging.hpp"
+
+/// allocations are counted only while this is set
+static std::atomic < bool > s_countAllocations(false);
+static std::atomic < size_t > s_allocationCount(0);
+/// read requests are counted only while s_countAllocations is set
+static std::atomic < size_t > s_readCount(0);
+
+void* operator new(std::size_t size)
+{
+    if (s_countAllocations) {
+        ++s_allocationCount;
+    }
+    void* p = std::malloc(size ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace daq::streaming_protocol {
+    static LogCallback logCallback = daq::streaming_protocol::Logging::logCallback();
+
+    /// Everything written is recorded. Reading replays the recording in chunks of limited size.
+    /// The read completion is posted to the io context like a real network stream does.
+    class ReplayStream : public stream::Stream
+    {
+    public:
+        ReplayStream(boost::asio::io_context& ioc, size_t chunkSize)
+            : m_ioc(ioc)
+            , m_chunkSize(chunkSize)
+            , m_readPosition(0)
+        {
+        }
+
+        void asyncInit(CompletionCb completionCb) override
+        {
+            completionCb(boost::system::error_code());
+        }
+
+        boost::system::error_code init() override
+        {
+            return boost::system::error_code();
+        }
+
+        std::string endPointUrl() const override
+        {
+            return "";
+        }
+        std::string remoteHost() const override
+        {
+            return "";
+        }
+
+        void asyncReadAtLeast(std::size_t bytesToRead, ReadCompletionCb readAtLeastCb) override
+        {
+            if (s_countAllocations) {
+                ++s_readCount;
+            }
+            boost::system::error_code ec;
+            size_t bytesRead = readAtLeast(bytesToRead, ec);
+            boost::asio::post(m_ioc, [readAtLeastCb = std::move(readAtLeastCb), ec, bytesRead]() {
+                readAtLeastCb(ec, bytesRead);
+            });
+        }
+
+        size_t readAtLeast(std::size_t bytesToRead, boost::system::error_code &ec) override
+        {
+            size_t bytesLeft = m_recording.size() - m_readPosition;
+            if (bytesLeft < bytesToRead) {
+                ec = boost::asio::error::eof;
+                return 0;
+            }
+            size_t bytesRead = std::min(std::max(bytesToRead, m_chunkSize), bytesLeft);
+            auto buffer = m_buffer.prepare(bytesRead);
+            memcpy(buffer.data(), m_recording.data() + m_readPosition, bytesRead);
+            m_buffer.commit(bytesRead);
+            m_readPosition += bytesRead;
+            return bytesRead;
+        }
+
+        void asyncWrite(const boost::asio::const_buffer& data, Stream::WriteCompletionCb writeCompletionCb) override
+        {
+            boost::system::error_code ec;
+            writeCompletionCb(ec, write(data, ec));
+        }
+
+        void asyncWrite(const stream::ConstBufferVector& data, WriteCompletionCb writeCompletionCb) override
+        {
+            boost::system::error_code ec;
+            writeCompletionCb(ec, write(data, ec));
+        }
+
+        size_t write(const boost::asio::const_buffer& data, boost::system::error_code& ec) override
+        {
+            const uint8_t* pData = reinterpret_cast < const uint8_t* > (data.data());
+            m_recording.insert(m_recording.end(), pData, pData + data.size());
+            return data.size();
+        }
+
+        size_t write(const stream::ConstBufferVector& data, boost::system::error_code& ec) override
+        {
+            size_t sizeSum = 0;
+            for (const auto& dataIter : data) {
+                sizeSum += write(dataIter, ec);
+            }
+            return sizeSum;
+        }
+
+        void asyncClose(CompletionCb closeCb) override
+        {
+            closeCb(boost::system::error_code());
+        }
+
+        boost::system::error_code close() override
+        {
+            return boost::system::error_code();
+        }
+
+        /// The recording is moved to the stream to replay
+        std::vector < uint8_t > m_recording;
+    private:
+        boost::asio::io_context& m_ioc;
+        size_t m_chunkSize;
+        size_t m_readPosition;
+    };
+
+    /// Replays a recorded session and counts allocations and read requests while receiving data in the steady state.
+    /// \return Number of packages (data and time) received while counting
+    static size_t receiveRecording(ReceiveMode receiveMode)
+    {
+        static const unsigned int dataSignalNumber = 1;
+        static const unsigned int timeSignalNumber = 2;
+        static const uint64_t timeDelta = 10;
+        static const size_t warmUpPackageCount = 100;
+        static const size_t packageCount = 10000;
+        static const size_t valuesPerPackage = 50;
+        boost::asio::io_context ioContext;
+
+        nlohmann::json subscribeData;
+        subscribeData[daq::jsonrpc::METHOD] = META_METHOD_SUBSCRIBE;
+        subscribeData[daq::jsonrpc::PARAMS][META_SIGNALID] = "data";
+        nlohmann::json subscribeTime;
+        subscribeTime[daq::jsonrpc::METHOD] = META_METHOD_SUBSCRIBE;
+        subscribeTime[daq::jsonrpc::PARAMS][META_SIGNALID] = "time";
+
+        nlohmann::json dataSignal = R"(
+        {
+            "method" : "signal",
+            "params" : {
+                "definition" : {
+                    "dataType" : "real64"
+                },
+                "tableId" : "a table id that is too long for small string optimization"
+            }
+        }
+        )"_json;
+
+        nlohmann::json timeSignal = R"(
+        {
+            "method" : "signal",
+            "params" : {
+                "definition" : {
+                    "dataType" : "uint64",
+                    "rule" : "linear",
+                    "linear" : {
+                        "delta" : 10
+                    },
+                    "unit" : {
+                        "displayName": "s",
+                        "unitId": 5457219,
+                        "quantity": "time"
+                    },
+                    "resolution" : {
+                        "num" : 1,
+                        "denom" : 1000000
+                    }
+                },
+                "tableId" : "a table id that is too long for small string optimization"
+            }
+        }
+        )"_json;
+
+        // chunks do not match package borders. Some packages arrive in pieces
+        auto replayStream = std::make_unique < ReplayStream > (ioContext, 1000);
+        {
+            std::shared_ptr < stream::Stream > recordingStream(replayStream.get(), [](stream::Stream*){});
+            StreamWriter writer(recordingStream);
+            writer.writeMetaInformation(dataSignalNumber, subscribeData);
+            writer.writeMetaInformation(timeSignalNumber, subscribeTime);
+            writer.writeMetaInformation(dataSignalNumber, dataSignal);
+            writer.writeMetaInformation(timeSignalNumber, timeSignal);
+            double value = 0;
+            for (size_t packageIndex = 0; packageIndex < packageCount; ++packageIndex) {
+                if (packageIndex % 100 == 0) {
+                    // start time gets repeated from time to time
+                    IndexedValue < uint64_t > startTime;
+                    startTime.index = packageIndex * valuesPerPackage;
+                    startTime.value = startTime.index * timeDelta;
+                    writer.writeSignalData(timeSignalNumber, &startTime, sizeof(startTime));
+                }
+                std::vector < double > values;
+                for (size_t valueIndex = 0; valueIndex < valuesPerPackage; ++valueIndex) {
+                    values.push_back(value++);
+                }
+                writer.writeSignalData(dataSignalNumber, values.data(), values.size() * sizeof(double));
+            }
+        }
+
+        size_t packagesReceived = 0;
+        size_t errorCount = 0;
+        double expectedValue = 0;
+        auto dataAsValueCb = [&](const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t valueCount)
+        {
+            if (timeStamp != packagesReceived * valuesPerPackage * timeDelta) {
+                ++errorCount;
+            }
+            for (size_t valueIndex = 0; valueIndex < valueCount; ++valueIndex) {
+                double value;
+                memcpy(&value, data + valueIndex * sizeof(value), sizeof(value));
+                if (value != expectedValue++) {
+                    ++errorCount;
+                }
+            }
+            ++packagesReceived;
+            if (packagesReceived == warmUpPackageCount) {
+                s_countAllocations = true;
+            } else if (packagesReceived == packageCount) {
+                s_countAllocations = false;
+            }
+        };
+
+        auto streamMetaCb = [](ProtocolHandler& prtotocolHandler, const std::string& method, const nlohmann::json& params)
+        {
+        };
+
+        SignalContainer signalContainer(logCallback);
+        signalContainer.setDataAsValueCb(dataAsValueCb);
+        auto protocolHandler = std::make_shared<ProtocolHandler>(ioContext, signalContainer, streamMetaCb, logCallback);
+        protocolHandler->setReceiveMode(receiveMode);
+
+        boost::system::error_code sessionEc;
+        auto completionCb = [&](const boost::system::error_code& ec) {
+            sessionEc = ec;
+        };
+
+        s_allocationCount = 0;
+        s_readCount = 0;
+        protocolHandler->start(std::move(replayStream), completionCb);
+        ioContext.run();
+
+        EXPECT_EQ(sessionEc, boost::asio::error::eof);
+        EXPECT_EQ(packagesReceived, packageCount);
+        EXPECT_EQ(errorCount, 0);
+        // one time package per 100 data packages
+        return (packageCount - warmUpPackageCount) * 101 / 100;
+    }
+
+    TEST(AllocationTest, no_allocation_while_receiving_data_batched)
+    {
+        size_t countedPackageCount = receiveRecording(RECEIVEMODE_BATCHED);
+        // packages arrive in chunks holding several of them
+        ASSERT_GT(s_readCount, 0);
+        ASSERT_LT(s_readCount, countedPackageCount / 2);
+        ASSERT_EQ(s_allocationCount, 0);
+    }
+
+    TEST(AllocationTest, no_allocation_while_receiving_data_per_package)
+    {
+        receiveRecording(RECEIVEMODE_PER_PACKAGE);
+        ASSERT_GT(s_readCount, 0);
+        ASSERT_EQ(s_allocationCount, 0);
+    }
+}
@@ -0,0 +1,526 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/post.hpp"
+#include "nlohmann/json.hpp"
+
+#include "stream/Stream.hpp"
+
+#include "streaming_protocol/AwaitableConsumer.hpp"
+#include "streaming_protocol/ControlServer.hpp"
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/jsonrpc_defines.hpp"
+#include "streaming_protocol/StreamWriter.h"
+
+#include "streaming_protocol/Logging.hpp"
+
+/// allocations are counted only while this is set
+static std::atomic < bool > s_countAllocations(false);
+static std::atomic < size_t > s_allocationCount(0);
+
+void* operator new(std::size_t size)
+{
+    if (s_countAllocations) {
+        ++s_allocationCount;
+    }
+    void* p = std::malloc(size ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+
+namespace daq::streaming_protocol {
+    static LogCallback logCallback = daq::streaming_protocol::Logging::logCallback();
+
+    static const unsigned int dataSignalNumber = 1;
+    static const unsigned int timeSignalNumber = 2;
+    static const uint64_t timeDelta = 10;
+    static const size_t valuesPerPackage = 50;
+    static const uint16_t controlPort = 7448;
+
+    /// Everything written is read back in chunks of limited size. Reads wait for data to be written until the stream gets closed.
+    /// Read completions are posted to the io context like a real network stream does.
+    class LoopbackStream : public stream::Stream
+    {
+    public:
+        explicit LoopbackStream(boost::asio::io_context& ioc, size_t chunkSize = 64 * 1024)
+            : m_ioc(ioc)
+            , m_chunkSize(chunkSize)
+            , m_readPosition(0)
+            , m_bytesToRead(0)
+        {
+        }
+
+        void asyncInit(CompletionCb completionCb) override
+        {
+            completionCb(boost::system::error_code());
+        }
+
+        boost::system::error_code init() override
+        {
+            return boost::system::error_code();
+        }
+
+        std::string endPointUrl() const override
+        {
+            return "";
+        }
+
+        std::string remoteHost() const override
+        {
+            return "127.0.0.1";
+        }
+
+        void asyncReadAtLeast(std::size_t bytesToRead, ReadCompletionCb readAtLeastCb) override
+        {
+            m_bytesToRead = bytesToRead;
+            m_pendingRead = std::move(readAtLeastCb);
+            completeRead();
+        }
+
+        size_t readAtLeast(std::size_t bytesToRead, boost::system::error_code& ec) override
+        {
+            size_t bytesLeft = m_data.size() - m_readPosition;
+            if (bytesLeft < bytesToRead) {
+                ec = boost::asio::error::eof;
+                return 0;
+            }
+            size_t bytesRead = std::min(std::max(bytesToRead, m_chunkSize), bytesLeft);
+            auto buffer = m_buffer.prepare(bytesRead);
+            memcpy(buffer.data(), m_data.data() + m_readPosition, bytesRead);
+            m_buffer.commit(bytesRead);
+            m_readPosition += bytesRead;
+            return bytesRead;
+        }
+
+        void asyncWrite(const boost::asio::const_buffer& data, WriteCompletionCb writeCompletionCb) override
+        {
+            boost::system::error_code ec;
+            writeCompletionCb(ec, write(data, ec));
+        }
+
+        void asyncWrite(const stream::ConstBufferVector& data, WriteCompletionCb writeCompletionCb) override
+        {
+            boost::system::error_code ec;
+            writeCompletionCb(ec, write(data, ec));
+        }
+
+        size_t write(const boost::asio::const_buffer& data, boost::system::error_code&) override
+        {
+            const uint8_t* pData = reinterpret_cast < const uint8_t* > (data.data());
+            m_data.insert(m_data.end(), pData, pData + data.size());
+            completeRead();
+            return data.size();
+        }
+
+        size_t write(const stream::ConstBufferVector& data, boost::system::error_code& ec) override
+        {
+            size_t sizeSum = 0;
+            for (const auto& dataIter : data) {
+                sizeSum += write(dataIter, ec);
+            }
+            return sizeSum;
+        }
+
+        void asyncClose(CompletionCb closeCb) override
+        {
+            if (m_pendingRead) {
+                boost::asio::post(m_ioc, [readAtLeastCb = std::move(m_pendingRead)]() {
+                    readAtLeastCb(boost::asio::error::eof, 0);
+                });
+                m_pendingRead = ReadCompletionCb();
+            }
+            closeCb(boost::system::error_code());
+        }
+
+        boost::system::error_code close() override
+        {
+            return boost::system::error_code();
+        }
+
+    private:
+        /// Completes the pending read if enough data was written
+        void completeRead()
+        {
+            if (!m_pendingRead || (m_data.size() - m_readPosition < m_bytesToRead)) {
+                return;
+            }
+            boost::system::error_code ec;
+            size_t bytesRead = readAtLeast(m_bytesToRead, ec);
+            boost::asio::post(m_ioc, [readAtLeastCb = std::move(m_pendingRead), ec, bytesRead]() {
+                readAtLeastCb(ec, bytesRead);
+            });
+            m_pendingRead = ReadCompletionCb();
+        }
+
+        boost::asio::io_context& m_ioc;
+        size_t m_chunkSize;
+        std::vector < uint8_t > m_data;
+        size_t m_readPosition;
+        size_t m_bytesToRead;
+        ReadCompletionCb m_pendingRead;
+    };
+
+    static void writeInit(StreamWriter& writer)
+    {
+        nlohmann::json init;
+        init[daq::jsonrpc::METHOD] = META_METHOD_INIT;
+        init[daq::jsonrpc::PARAMS][META_STREAMID] = "stream";
+        init[daq::jsonrpc::PARAMS]["commandInterfaces"]["jsonrpc-http"]["httpMethod"] = "POST";
+        init[daq::jsonrpc::PARAMS]["commandInterfaces"]["jsonrpc-http"]["httpPath"] = "/";
+        init[daq::jsonrpc::PARAMS]["commandInterfaces"]["jsonrpc-http"]["httpVersion"] = "1.1";
+        init[daq::jsonrpc::PARAMS]["commandInterfaces"]["jsonrpc-http"]["port"] = std::to_string(controlPort);
+        writer.writeMetaInformation(0, init);
+    }
+
+    /// Subscribe acknowledges and meta information of a data signal with linear time signal
+    static void writeSignals(StreamWriter& writer)
+    {
+        nlohmann::json subscribeData;
+        subscribeData[daq::jsonrpc::METHOD] = META_METHOD_SUBSCRIBE;
+        subscribeData[daq::jsonrpc::PARAMS][META_SIGNALID] = "data";
+        nlohmann::json subscribeTime;
+        subscribeTime[daq::jsonrpc::METHOD] = META_METHOD_SUBSCRIBE;
+        subscribeTime[daq::jsonrpc::PARAMS][META_SIGNALID] = "time";
+
+        nlohmann::json dataSignal = R"(
+        {
+            "method" : "signal",
+            "params" : {
+                "definition" : {
+                    "dataType" : "real64"
+                },
+                "tableId" : "table"
+            }
+        }
+        )"_json;
+
+        nlohmann::json timeSignal = R"(
+        {
+            "method" : "signal",
+            "params" : {
+                "definition" : {
+                    "dataType" : "uint64",
+                    "rule" : "linear",
+                    "linear" : {
+                        "delta" : 10
+                    },
+                    "unit" : {
+                        "displayName": "s",
+                        "unitId": 5457219,
+                        "quantity": "time"
+                    },
+                    "resolution" : {
+                        "num" : 1,
+                        "denom" : 1000000
+                    }
+                },
+                "tableId" : "table"
+            }
+        }
+        )"_json;
+
+        writer.writeMetaInformation(dataSignalNumber, subscribeData);
+        writer.writeMetaInformation(timeSignalNumber, subscribeTime);
+        writer.writeMetaInformation(dataSignalNumber, dataSignal);
+        writer.writeMetaInformation(timeSignalNumber, timeSignal);
+    }
+
+    /// Start time followed by packageCount packages of consecutive values starting with 0
+    static void writeData(StreamWriter& writer, size_t packageCount)
+    {
+        IndexedValue < uint64_t > startTime;
+        startTime.index = 0;
+        startTime.value = 0;
+        writer.writeSignalData(timeSignalNumber, &startTime, sizeof(startTime));
+        double value = 0;
+        for (size_t packageIndex = 0; packageIndex < packageCount; ++packageIndex) {
+            std::vector < double > values;
+            for (size_t valueIndex = 0; valueIndex < valuesPerPackage; ++valueIndex) {
+                values.push_back(value++);
+            }
+            writer.writeSignalData(dataSignalNumber, values.data(), values.size() * sizeof(double));
+        }
+    }
+
+    /// Runs the coroutine until it is done. Exceptions are rethrown.
+    static void run(boost::asio::io_context& ioContext, boost::asio::awaitable < void > coroutine)
+    {
+        boost::asio::co_spawn(ioContext, std::move(coroutine), [](std::exception_ptr e) {
+            if (e) {
+                std::rethrow_exception(e);
+            }
+        });
+        ioContext.run();
+    }
+
+    TEST(AwaitableConsumerTest, next_packet_test)
+    {
+        static const size_t packageCount = 10;
+        boost::asio::io_context ioContext;
+        auto stream = std::make_unique < LoopbackStream > (ioContext);
+        {
+            std::shared_ptr < stream::Stream > writerStream(stream.get(), [](stream::Stream*){});
+            StreamWriter writer(writerStream);
+            writeSignals(writer);
+            writeData(writer, packageCount);
+        }
+
+        AwaitableConsumer consumer(ioContext, logCallback);
+        consumer.start(std::move(stream));
+
+        std::vector < std::string > methods;
+        size_t dataPackageCount = 0;
+        auto coroutine = [&]() -> boost::asio::awaitable < void >
+        {
+            // the meta information arrives in order
+            while (methods.size() < 4) {
+                const AwaitableConsumer::Packet* packet = co_await consumer.nextPacket();
+                EXPECT_NE(packet, nullptr);
+                EXPECT_EQ(packet->type, AwaitableConsumer::PACKETTYPE_SIGNAL_META);
+                methods.push_back(packet->signalId + "." + packet->method);
+            }
+
+            double expectedValue = 0;
+            while (dataPackageCount < packageCount) {
+                const AwaitableConsumer::Packet* packet = co_await consumer.nextPacket();
+                EXPECT_NE(packet, nullptr);
+                EXPECT_EQ(packet->type, AwaitableConsumer::PACKETTYPE_DATA);
+                EXPECT_EQ(packet->signalNumber, dataSignalNumber);
+                EXPECT_EQ(packet->signalId, "data");
+                EXPECT_EQ(packet->timeStamp, dataPackageCount * valuesPerPackage * timeDelta);
+                EXPECT_EQ(packet->valueCount, valuesPerPackage);
+                EXPECT_EQ(packet->valueSize, sizeof(double));
+                for (size_t valueIndex = 0; valueIndex < packet->valueCount; ++valueIndex) {
+                    double value;
+                    memcpy(&value, packet->data.data() + valueIndex * sizeof(value), sizeof(value));
+                    EXPECT_EQ(value, expectedValue++);
+                }
+                ++dataPackageCount;
+            }
+
+            consumer.stop();
+            EXPECT_EQ(co_await consumer.nextPacket(), nullptr);
+            EXPECT_TRUE(consumer.ended());
+        };
+        run(ioContext, coroutine());
+
+        std::vector < std::string > expectedMethods = { "data.subscribe", "time.subscribe", "data.signal", "time.signal" };
+        ASSERT_EQ(methods, expectedMethods);
+        ASSERT_EQ(dataPackageCount, packageCount);
+    }
+
+    TEST(AwaitableConsumerTest, read_test)
+    {
+        static const size_t packageCount = 10;
+        static const size_t readCount = 120;
+        boost::asio::io_context ioContext;
+        auto stream = std::make_unique < LoopbackStream > (ioContext);
+        std::shared_ptr < stream::Stream > writerStream(stream.get(), [](stream::Stream*){});
+        StreamWriter writer(writerStream);
+        writeSignals(writer);
+
+        AwaitableConsumer consumer(ioContext, logCallback);
+        consumer.setQueueData(false);
+        SignalReader& signalReader = consumer.addSignal("data", 1024);
+        consumer.start(std::move(stream));
+
+        size_t totalCount = 0;
+        auto coroutine = [&]() -> boost::asio::awaitable < void >
+        {
+            // the data is written while the reader waits
+            boost::asio::post(ioContext, [&]() {
+                writeData(writer, packageCount);
+            });
+
+            std::vector < double > values(readCount);
+            std::vector < uint64_t > timeStamps(readCount);
+            while (totalCount + readCount <= packageCount * valuesPerPackage) {
+                size_t count = co_await consumer.read(signalReader, values.data(), timeStamps.data(), readCount);
+                EXPECT_EQ(count, readCount);
+                for (size_t valueIndex = 0; valueIndex < count; ++valueIndex) {
+                    EXPECT_EQ(values[valueIndex], static_cast < double > (totalCount));
+                    EXPECT_EQ(timeStamps[valueIndex], totalCount * timeDelta);
+                    ++totalCount;
+                }
+            }
+
+            // less than requested once the session ended
+            consumer.stop();
+            size_t count = co_await consumer.read(signalReader, values.data(), timeStamps.data(), readCount);
+            EXPECT_EQ(count, packageCount * valuesPerPackage - totalCount);
+            totalCount += count;
+
+            // only meta information was queued
+            const AwaitableConsumer::Packet* packet;
+            while ((packet = co_await consumer.nextPacket()) != nullptr) {
+                EXPECT_EQ(packet->type, AwaitableConsumer::PACKETTYPE_SIGNAL_META);
+            }
+        };
+        run(ioContext, coroutine());
+
+        ASSERT_EQ(totalCount, packageCount * valuesPerPackage);
+        ASSERT_EQ(signalReader.droppedValueCount(), 0);
+    }
+
+    TEST(AwaitableConsumerTest, subscribe_test)
+    {
+        boost::asio::io_context ioContext;
+        auto stream = std::make_unique < LoopbackStream > (ioContext);
+        std::shared_ptr < stream::Stream > writerStream(stream.get(), [](stream::Stream*){});
+        StreamWriter writer(writerStream);
+        writeInit(writer);
+
+        AwaitableConsumer consumer(ioContext, logCallback);
+
+        // The producer acknowledges after receiving the request and responds the signals affected. Signal "unknown" is not known, the pattern matches no signal.
+        std::vector < std::string > receivedCommands;
+        ControlServer::ResolvingCommandCb commandCb = [&](const std::string&, const std::string& command, const SignalIds& signalIds, SignalIds& resolvedSignalIds, std::string&)
+        {
+            receivedCommands.push_back(command);
+            for (const std::string& signalId : signalIds) {
+                if ((signalId == "data") || (signalId == "time")) {
+                    resolvedSignalIds.push_back(signalId);
+                }
+            }
+            if (resolvedSignalIds.empty()) {
+                return 0;
+            } else if (command == META_METHOD_SUBSCRIBE) {
+                writeSignals(writer);
+            } else {
+                nlohmann::json unsubscribe;
+                unsubscribe[daq::jsonrpc::METHOD] = META_METHOD_UNSUBSCRIBE;
+                unsubscribe[daq::jsonrpc::PARAMS] = nlohmann::json::object();
+                writer.writeMetaInformation(dataSignalNumber, unsubscribe);
+            }
+            return 0;
+        };
+        ControlServer controlServer(ioContext, controlPort, commandCb, logCallback);
+        controlServer.start();
+        consumer.start(std::move(stream));
+
+        AwaitableConsumer::ControlResult subscribed;
+        AwaitableConsumer::ControlResult unsubscribed;
+        AwaitableConsumer::ControlResult patternSubscribed;
+        AwaitableConsumer::ControlResult unknownSubscribed;
+        AwaitableConsumer::ControlResult afterEnd;
+        afterEnd.succeeded = true;
+        auto coroutine = [&]() -> boost::asio::awaitable < void >
+        {
+            const AwaitableConsumer::Packet* packet = co_await consumer.nextPacket();
+            EXPECT_NE(packet, nullptr);
+            EXPECT_EQ(packet->type, AwaitableConsumer::PACKETTYPE_STREAM_META);
+            EXPECT_EQ(packet->method, META_METHOD_INIT);
+
+            SignalIds signalIds = { "data", "time" };
+            subscribed = co_await consumer.subscribe(signalIds);
+            signalIds = { "data" };
+            unsubscribed = co_await consumer.unsubscribe(signalIds);
+            // there is no acknowledge to wait for
+            signalIds = { "nothing/*" };
+            patternSubscribed = co_await consumer.subscribe(signalIds);
+            // reported instead of waiting for an acknowledge that never comes
+            signalIds = { "data", "unknown" };
+            unknownSubscribed = co_await consumer.subscribe(signalIds);
+
+            consumer.stop();
+            signalIds = { "data" };
+            afterEnd = co_await consumer.subscribe(signalIds);
+            controlServer.stop();
+        };
+        run(ioContext, coroutine());
+
+        ASSERT_TRUE(subscribed.succeeded);
+        ASSERT_TRUE(subscribed.unknownSignalIds.empty());
+        ASSERT_TRUE(unsubscribed.succeeded);
+        ASSERT_TRUE(patternSubscribed.succeeded);
+        ASSERT_TRUE(patternSubscribed.unknownSignalIds.empty());
+        ASSERT_TRUE(unknownSubscribed.succeeded);
+        ASSERT_EQ(unknownSubscribed.unknownSignalIds, SignalIds({ "unknown" }));
+        ASSERT_FALSE(afterEnd.succeeded);
+        std::vector < std::string > expectedCommands = { META_METHOD_SUBSCRIBE, META_METHOD_UNSUBSCRIBE, META_METHOD_SUBSCRIBE, META_METHOD_SUBSCRIBE };
+        ASSERT_EQ(receivedCommands, expectedCommands);
+    }
+
+    TEST(AwaitableConsumerTest, no_allocation_while_awaiting_data)
+    {
+        // the packet pool grows to the number of packages processed in one go and all packets are used once
+        static const size_t warmUpPackageCount = 1000;
+        static const size_t packageCount = 10000;
+        boost::asio::io_context ioContext;
+        auto stream = std::make_unique < LoopbackStream > (ioContext);
+        {
+            std::shared_ptr < stream::Stream > writerStream(stream.get(), [](stream::Stream*){});
+            StreamWriter writer(writerStream);
+            writeSignals(writer);
+            writeData(writer, packageCount);
+        }
+
+        AwaitableConsumer consumer(ioContext, logCallback);
+        consumer.protocolHandler().setReceiveMode(RECEIVEMODE_BATCHED);
+        consumer.start(std::move(stream));
+
+        size_t dataPackageCount = 0;
+        auto coroutine = [&]() -> boost::asio::awaitable < void >
+        {
+            const AwaitableConsumer::Packet* packet;
+            while ((packet = co_await consumer.nextPacket()) != nullptr) {
+                if (packet->type != AwaitableConsumer::PACKETTYPE_DATA) {
+                    continue;
+                }
+                ++dataPackageCount;
+                if (dataPackageCount == warmUpPackageCount) {
+                    s_countAllocations = true;
+                } else if (dataPackageCount == packageCount) {
+                    s_countAllocations = false;
+                    consumer.stop();
+                }
+            }
+        };
+        run(ioContext, coroutine());
+
+        ASSERT_EQ(dataPackageCount, packageCount);
+        ASSERT_EQ(s_allocationCount, 0);
+    }
+}
+
+#endif
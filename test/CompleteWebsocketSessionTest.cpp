@@ -26,6 +26,8 @@
 #include "streaming_protocol/ProducerSession.hpp"
 #include "streaming_protocol/ProtocolHandler.hpp"
 #include "streaming_protocol/SignalContainer.hpp"
+#include "streaming_protocol/StreamWriter.h"
+#include "streaming_protocol/SynchronousSignal.hpp"
 
 #include "streaming_protocol/Logging.hpp"
 
@@ -79,7 +81,10 @@ namespace daq::streaming_protocol {
         void acceptCb(std::shared_ptr < daq::stream::Stream > newStream)
         {
             std::cout << "accepted client (" << newStream->endPointUrl() << ")..." << std::endl;
-            auto producerSession = std::make_shared<ProducerSession>(newStream, nlohmann::json(), logCallback);
+            auto producerSession = std::make_shared<ProducerSession>(newStream, m_commandInterfaces, logCallback);
+            if (m_sessionCreatedCb) {
+                m_sessionCreatedCb(newStream, *producerSession);
+            }
             std::string sessionId = newStream->endPointUrl();
             // add sessions and start it
             m_sesions[sessionId] = producerSession;
@@ -91,6 +96,9 @@ namespace daq::streaming_protocol {
         std::thread m_workerThread;
         daq::stream::WebsocketServer m_server;
         std::map <std::string, std::shared_ptr<ProducerSession>> m_sesions;
+        nlohmann::json m_commandInterfaces;
+        /// Called for each session created before it is started
+        std::function < void(std::shared_ptr < daq::stream::Stream >, ProducerSession&) > m_sessionCreatedCb;
         LogCallback logCallback;
     };
 
@@ -177,4 +185,73 @@ namespace daq::streaming_protocol {
 
         clientIoContext.run();
     }
+
+    TEST_F(CompleteSession, test_in_band_subscribe_unsubscribe)
+    {
+        static const std::string tableId = "the table";
+        std::unique_ptr < StreamWriter > writer;
+        std::vector < std::shared_ptr < BaseSignal > > signals;
+        m_commandInterfaces[COMMANDINTERFACE_JSONRPC_INBAND] = nlohmann::json::object();
+        m_sessionCreatedCb = [&](std::shared_ptr < daq::stream::Stream > stream, ProducerSession& producerSession)
+        {
+            writer = std::make_unique < StreamWriter > (stream);
+            ProducerSession::Signals sessionSignals;
+            for (const std::string signalId : { "ai/0/raw", "ai/0/scaled", "ai/1/raw" }) {
+                auto signal = std::make_shared < SynchronousSignal < double > > (signalId, tableId, *writer, logCallback);
+                signals.push_back(signal);
+                sessionSignals[signalId] = signal;
+            }
+            producerSession.addSignals(sessionSignals);
+        };
+
+        boost::asio::io_context clientIoContext;
+        SignalContainer signalContainer(logCallback);
+        std::vector < std::string > subscribedSignalIds;
+        std::vector < std::string > unsubscribedSignalIds;
+        signalContainer.setSignalMetaCb([&](const SubscribedSignal& subscribedSignal, const std::string& method, const nlohmann::json&)
+        {
+            if (method == META_METHOD_SUBSCRIBE) {
+                subscribedSignalIds.push_back(subscribedSignal.signalId());
+            } else if (method == META_METHOD_UNSUBSCRIBE) {
+                unsubscribedSignalIds.push_back(subscribedSignal.signalId());
+            }
+        });
+
+        bool available = false;
+        std::vector < boost::system::error_code > results;
+        size_t subscribedCountOnCompletion = 0;
+        auto StreamMetaCb = [&](ProtocolHandler& protocolHandler, const std::string& method, const nlohmann::json&)
+        {
+            if (method != META_METHOD_AVAILABLE) {
+                return;
+            }
+            available = true;
+            protocolHandler.subscribe({ "ai/*/raw" }, [&](const boost::system::error_code& ec) {
+                results.push_back(ec);
+                // acknowledged before the response
+                subscribedCountOnCompletion = subscribedSignalIds.size();
+                protocolHandler.subscribe({ "ai/0/scaled", "unknown" }, [&](const boost::system::error_code& ec) {
+                    results.push_back(ec);
+                    protocolHandler.unsubscribe({ "**" }, [&](const boost::system::error_code& ec) {
+                        results.push_back(ec);
+                        protocolHandler.stop();
+                    });
+                });
+            });
+        };
+
+        auto clientStream = std::make_unique<stream::WebsocketClientStream>(clientIoContext, "localhost", std::to_string(ServerPort));
+        auto protocolHandler = std::make_shared<ProtocolHandler>(clientIoContext, signalContainer, StreamMetaCb, logCallback);
+        protocolHandler->start(std::move(clientStream));
+        clientIoContext.run();
+
+        ASSERT_TRUE(available);
+        ASSERT_EQ(results.size(), 3);
+        for (const auto& ec : results) {
+            EXPECT_FALSE(ec) << ec.message();
+        }
+        EXPECT_EQ(subscribedCountOnCompletion, 2);
+        EXPECT_EQ(subscribedSignalIds, std::vector < std::string > ({ "ai/0/raw", "ai/1/raw", "ai/0/scaled" }));
+        EXPECT_EQ(unsubscribedSignalIds, std::vector < std::string > ({ "ai/0/raw", "ai/0/scaled", "ai/1/raw" }));
+    }
 }
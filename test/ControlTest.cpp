@@ -17,7 +17,12 @@
 #include <gtest/gtest.h>
 
 #include "boost/asio/io_context.hpp"
+#include "boost/asio/ip/tcp.hpp"
+#include "boost/beast/core.hpp"
+#include "boost/beast/http.hpp"
+#include "nlohmann/json.hpp"
 
+#include "streaming_protocol/jsonrpc_defines.hpp"
 #include "streaming_protocol/Types.h"
 
 #include "streaming_protocol/Logging.hpp"
@@ -25,8 +30,11 @@
 #include "../lib/Controller.hpp"
 #include "streaming_protocol/ControlServer.hpp"
 
+#include <functional>
+#include <mutex>
 #include <thread>
 #include <future>
+#include <vector>
 
 namespace daq::streaming_protocol {
     static const std::string streamId = "theId";;
@@ -53,7 +61,7 @@ namespace daq::streaming_protocol {
 
         boost::system::error_code ec;
         unsigned int count = 0;
-        auto resultCb = [&](const boost::system::error_code& cbEc) {
+        auto resultCb = [&](const boost::system::error_code& cbEc, const nlohmann::json&) {
             ec = cbEc;
             ++count;
         };
@@ -94,7 +102,7 @@ namespace daq::streaming_protocol {
         boost::system::error_code ec;
         unsigned int count = 0;
         std::promise<void> clientPromise;
-        auto resultCb = [&](const boost::system::error_code& cbEc) {
+        auto resultCb = [&](const boost::system::error_code& cbEc, const nlohmann::json&) {
             ec = cbEc;
             ++count;
             clientPromise.set_value();
@@ -155,7 +163,7 @@ namespace daq::streaming_protocol {
         boost::system::error_code ec;
         unsigned int count = 0;
         std::promise<void> clientPromise;
-        auto resultCb = [&](const boost::system::error_code& cbEc) {
+        auto resultCb = [&](const boost::system::error_code& cbEc, const nlohmann::json&) {
             ec = cbEc;
             ++count;
             clientPromise.set_value();
@@ -177,4 +185,424 @@ namespace daq::streaming_protocol {
         workerThread.join();
     }
 
+
+    TEST(ControlServerClientTest, keep_alive)
+    {
+        boost::asio::io_context ioc;
+        Controller controller(ioc, streamId, address, std::to_string(port), target, httpVersion, logCallback);
+        std::vector < std::string > recvCommands;
+        ControlServer::CommandCb commandCb = [&](const std::string& /*_streamId*/, const std::string& _command, const SignalIds& /*_signalIds*/, std::string& /*_errorMessage*/)
+        {
+            recvCommands.push_back(_command);
+            return 0;
+        };
+        ControlServer server(ioc, port, commandCb, logCallback);
+        server.start();
+
+        // each request is sent after the one before completed
+        unsigned int count = 0;
+        Controller::ResultCb resultCb = [&](const boost::system::error_code& cbEc, const nlohmann::json&) {
+            EXPECT_FALSE(cbEc.failed());
+            if (++count < 3) {
+                controller.asyncSubscribe({ signalId }, resultCb);
+            } else {
+                ioc.stop();
+            }
+        };
+        controller.asyncSubscribe({ signalId }, resultCb);
+        ioc.run_for(timeout);
+
+        ASSERT_EQ(count, 3);
+        EXPECT_EQ(recvCommands.size(), 3);
+        EXPECT_EQ(controller.requestCount(), 3);
+        EXPECT_EQ(controller.connectCount(), 1);
+    }
+
+    TEST(ControlServerClientTest, http_1_0_connection_per_request)
+    {
+        boost::asio::io_context ioc;
+        Controller controller(ioc, streamId, address, std::to_string(port), target, 10, logCallback);
+        ControlServer::CommandCb commandCb = [&](const std::string& /*_streamId*/, const std::string& /*_command*/, const SignalIds& /*_signalIds*/, std::string& /*_errorMessage*/)
+        {
+            return 0;
+        };
+        ControlServer server(ioc, port, commandCb, logCallback);
+        server.start();
+
+        // the producer closes the connection after each response
+        unsigned int count = 0;
+        auto resultCb = [&](const boost::system::error_code& cbEc, const nlohmann::json&) {
+            EXPECT_FALSE(cbEc.failed());
+            if (++count == 2) {
+                ioc.stop();
+            }
+        };
+        controller.asyncSubscribe({ signalId }, resultCb);
+        controller.asyncUnsubscribe({ signalId }, resultCb);
+        ioc.run_for(timeout);
+
+        ASSERT_EQ(count, 2);
+        EXPECT_EQ(controller.requestCount(), 2);
+        EXPECT_EQ(controller.connectCount(), 2);
+    }
+
+    TEST(ControlServerClientTest, merged_requests)
+    {
+        boost::asio::io_context ioc;
+        Controller controller(ioc, streamId, address, std::to_string(port), target, httpVersion, logCallback);
+        std::vector < std::string > recvCommands;
+        std::vector < SignalIds > recvSignalIds;
+        ControlServer::CommandCb commandCb = [&](const std::string& /*_streamId*/, const std::string& _command, const SignalIds& _signalIds, std::string& /*_errorMessage*/)
+        {
+            recvCommands.push_back(_command);
+            recvSignalIds.push_back(_signalIds);
+            return 0;
+        };
+        ControlServer server(ioc, port, commandCb, logCallback);
+        server.start();
+
+        unsigned int count = 0;
+        auto resultCb = [&](const boost::system::error_code& cbEc, const nlohmann::json&) {
+            EXPECT_FALSE(cbEc.failed());
+            if (++count == 5) {
+                ioc.stop();
+            }
+        };
+        // consecutive calls to the same method are merged, duplicates are removed
+        controller.asyncSubscribe({ "a" }, resultCb);
+        controller.asyncSubscribe({ "b", "c" }, resultCb);
+        controller.asyncSubscribe({ "a" }, resultCb);
+        controller.asyncUnsubscribe({ "b" }, resultCb);
+        controller.asyncSubscribe({ "d" }, resultCb);
+        ioc.run_for(timeout);
+
+        ASSERT_EQ(count, 5);
+        EXPECT_EQ(controller.requestCount(), 3);
+        // pipelined over one connection
+        EXPECT_EQ(controller.connectCount(), 1);
+        ASSERT_EQ(recvCommands.size(), 3);
+        EXPECT_EQ(recvCommands[0], "subscribe");
+        EXPECT_EQ(recvSignalIds[0], SignalIds({ "a", "b", "c" }));
+        EXPECT_EQ(recvCommands[1], "unsubscribe");
+        EXPECT_EQ(recvSignalIds[1], SignalIds({ "b" }));
+        EXPECT_EQ(recvCommands[2], "subscribe");
+        EXPECT_EQ(recvSignalIds[2], SignalIds({ "d" }));
+    }
+
+    TEST(ControlServerClientTest, close)
+    {
+        boost::asio::io_context ioc;
+        Controller controller(ioc, streamId, address, std::to_string(port), target, httpVersion, logCallback);
+        ControlServer::CommandCb commandCb = [&](const std::string& /*_streamId*/, const std::string& /*_command*/, const SignalIds& /*_signalIds*/, std::string& /*_errorMessage*/)
+        {
+            return 0;
+        };
+        ControlServer server(ioc, port, commandCb, logCallback);
+        server.start();
+
+        boost::system::error_code ec;
+        unsigned int count = 0;
+        auto resultCb = [&](const boost::system::error_code& cbEc, const nlohmann::json&) {
+            ec = cbEc;
+            ++count;
+        };
+        controller.asyncSubscribe({ signalId }, resultCb);
+        // pending calls are aborted
+        ioc.poll();
+        controller.close();
+        EXPECT_EQ(count, 1);
+        EXPECT_EQ(ec, boost::asio::error::operation_aborted);
+    }
+
+    TEST(ControlServerClientTest, stop)
+    {
+        boost::asio::io_context ioc;
+        ControlServer::CommandCb commandCb = [&](const std::string& /*_streamId*/, const std::string& /*_command*/, const SignalIds& /*_signalIds*/, std::string& /*_errorMessage*/)
+        {
+            return 0;
+        };
+        ControlServer server(ioc, port, commandCb, logCallback);
+        server.start();
+        server.stop();
+        // the aborted accept is not started again, the io context runs out of work
+        ioc.run_for(timeout);
+        EXPECT_TRUE(ioc.stopped());
+    }
+
+    TEST(ControlClientTest, destroyed_with_queued_handlers)
+    {
+        boost::asio::io_context ioc;
+        unsigned int sendCount = 0;
+        std::vector < boost::system::error_code > results;
+        auto resultCb = [&](const boost::system::error_code& cbEc, const nlohmann::json&) {
+            results.push_back(cbEc);
+        };
+        {
+            Controller controller(ioc, [&](const char*, const SignalIds&, Controller::ResultCb) {
+                ++sendCount;
+            }, logCallback);
+            // merged, the merge timer completes right away
+            controller.asyncSubscribe({ signalId }, resultCb);
+            ioc.poll_one();
+            // not executed yet when the controller is gone
+            controller.asyncSubscribe({ signalId }, resultCb);
+        }
+        // the queued handlers do not touch the controller
+        ioc.run();
+        EXPECT_EQ(sendCount, 0);
+        ASSERT_EQ(results.size(), 2);
+        EXPECT_EQ(results[0], boost::asio::error::operation_aborted);
+        EXPECT_EQ(results[1], boost::asio::error::operation_aborted);
+    }
+
+    /// Posts the body synchronously and returns the response
+    static boost::beast::http::response < boost::beast::http::string_body > postSync(const std::string& body)
+    {
+        namespace http = boost::beast::http;
+        boost::asio::io_context ioc;
+        boost::asio::ip::tcp::socket socket(ioc);
+        socket.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), port));
+        http::request < http::string_body > request(http::verb::post, target, httpVersion);
+        request.set(http::field::host, address);
+        request.set(http::field::content_type, "application/json");
+        request.body() = body;
+        request.prepare_payload();
+        http::write(socket, request);
+        boost::beast::flat_buffer buffer;
+        http::response < http::string_body > response;
+        http::read(socket, buffer, response);
+        return response;
+    }
+
+    TEST(ControlServerClientTest, batch)
+    {
+        boost::asio::io_context ioc;
+        std::vector < std::string > recvCommands;
+        std::vector < SignalIds > recvSignalIds;
+        ControlServer::CommandCb commandCb = [&](const std::string& /*_streamId*/, const std::string& _command, const SignalIds& _signalIds, std::string& _errorMessage)
+        {
+            recvCommands.push_back(_command);
+            recvSignalIds.push_back(_signalIds);
+            if (_command == "unknown") {
+                _errorMessage = "unknown command";
+                return -1;
+            }
+            return 0;
+        };
+        ControlServer server(ioc, port, commandCb, logCallback);
+        server.start();
+        auto workerThread = std::thread([&]() { ioc.run(); });
+
+        nlohmann::json batch = nlohmann::json::array();
+        batch.push_back({ { "jsonrpc", "2.0" }, { "method", streamId + ".subscribe" }, { "params", { "a", "b" } }, { "id", 1 } });
+        batch.push_back({ { "jsonrpc", "2.0" }, { "method", streamId + ".unsubscribe" }, { "params", { "c" } }, { "id", 2 } });
+        batch.push_back({ { "jsonrpc", "2.0" }, { "method", streamId + ".unknown" }, { "params", { "d" } }, { "id", 3 } });
+        batch.push_back({ { "jsonrpc", "2.0" }, { "method", "no delimiter" }, { "params", { "e" } }, { "id", 4 } });
+        batch.push_back({ { "jsonrpc", "2.0" }, { "method", streamId + ".subscribe" }, { "params", { "f" } } });
+        auto response = postSync(batch.dump());
+
+        ioc.stop();
+        workerThread.join();
+
+        // all requests in one pass, each one answered
+        EXPECT_EQ(response.result(), boost::beast::http::status::ok);
+        ASSERT_EQ(recvCommands.size(), 3);
+        EXPECT_EQ(recvCommands[0], "subscribe");
+        EXPECT_EQ(recvSignalIds[0], SignalIds({ "a", "b" }));
+        EXPECT_EQ(recvCommands[1], "unsubscribe");
+        EXPECT_EQ(recvSignalIds[1], SignalIds({ "c" }));
+        EXPECT_EQ(recvCommands[2], "unknown");
+
+        nlohmann::json responses = nlohmann::json::parse(response.body());
+        ASSERT_TRUE(responses.is_array());
+        ASSERT_EQ(responses.size(), 5);
+        EXPECT_EQ(responses[0]["id"], 1);
+        EXPECT_EQ(responses[0]["result"], "Succeeded");
+        EXPECT_EQ(responses[1]["id"], 2);
+        EXPECT_EQ(responses[1]["result"], "Succeeded");
+        EXPECT_EQ(responses[2]["id"], 3);
+        EXPECT_EQ(responses[2]["error"]["code"], daq::jsonrpc::internalError);
+        EXPECT_EQ(responses[3]["id"], 4);
+        EXPECT_EQ(responses[3]["error"]["code"], daq::jsonrpc::methodNotFound);
+        EXPECT_TRUE(responses[4]["id"].is_null());
+        EXPECT_EQ(responses[4]["error"]["code"], daq::jsonrpc::invalidRequest);
+    }
+
+    TEST(ControlServerClientTest, resolved_signal_ids)
+    {
+        boost::asio::io_context ioc;
+        ControlServer::ResolvingCommandCb commandCb = [&](const std::string& /*_streamId*/, const std::string& /*_command*/, const SignalIds& _signalIds, SignalIds& _resolvedSignalIds, std::string& /*_errorMessage*/)
+        {
+            for (const auto& signalId : _signalIds) {
+                _resolvedSignalIds.push_back(signalId + "/0");
+                _resolvedSignalIds.push_back(signalId + "/1");
+            }
+            return 0;
+        };
+        ControlServer server(ioc, port, commandCb, logCallback);
+        server.start();
+        auto workerThread = std::thread([&]() { ioc.run(); });
+
+        auto response = postSync(R"({"jsonrpc":"2.0","method":"theId.subscribe","params":["a"],"id":7})");
+        nlohmann::json batch = nlohmann::json::array();
+        batch.push_back({ { "jsonrpc", "2.0" }, { "method", streamId + ".subscribe" }, { "params", { "b" } }, { "id", 8 } });
+        auto batchResponse = postSync(batch.dump());
+
+        ioc.stop();
+        workerThread.join();
+
+        ASSERT_EQ(response.result(), boost::beast::http::status::ok);
+        nlohmann::json result = nlohmann::json::parse(response.body());
+        EXPECT_EQ(result["id"], 7);
+        EXPECT_EQ(result["result"], nlohmann::json({ "a/0", "a/1" }));
+
+        ASSERT_EQ(batchResponse.result(), boost::beast::http::status::ok);
+        nlohmann::json responses = nlohmann::json::parse(batchResponse.body());
+        ASSERT_EQ(responses.size(), 1);
+        EXPECT_EQ(responses[0]["id"], 8);
+        EXPECT_EQ(responses[0]["result"], nlohmann::json({ "b/0", "b/1" }));
+    }
+
+    TEST(ControlServerClientTest, invalid_requests)
+    {
+        boost::asio::io_context ioc;
+        unsigned int count = 0;
+        ControlServer::CommandCb commandCb = [&](const std::string& /*_streamId*/, const std::string& /*_command*/, const SignalIds& /*_signalIds*/, std::string& /*_errorMessage*/)
+        {
+            ++count;
+            return 0;
+        };
+        ControlServer server(ioc, port, commandCb, logCallback);
+        server.start();
+        auto workerThread = std::thread([&]() { ioc.run(); });
+
+        EXPECT_EQ(postSync("no json").result(), boost::beast::http::status::bad_request);
+        EXPECT_EQ(postSync("[]").result(), boost::beast::http::status::bad_request);
+        EXPECT_EQ(postSync(R"({"jsonrpc":"2.0","method":"theId.subscribe","params":[1],"id":1})").result(), boost::beast::http::status::bad_request);
+
+        ioc.stop();
+        workerThread.join();
+        EXPECT_EQ(count, 0);
+    }
+
+    TEST(ControlServerClientTest, async_completion)
+    {
+        boost::asio::io_context ioc;
+        std::mutex mutex;
+        std::vector < std::pair < std::string, ControlServer::CompletionCb > > pending;
+        ControlServer::AsyncCommandCb commandCb = [&](const std::string& /*_streamId*/, const std::string& /*_command*/, const SignalIds& _signalIds, ControlServer::CompletionCb _completionCb)
+        {
+            std::lock_guard < std::mutex > lock(mutex);
+            pending.emplace_back(_signalIds.front(), _completionCb);
+        };
+        ControlServer server(ioc, port, commandCb, logCallback);
+        server.start();
+        auto workerThread = std::thread([&]() { ioc.run(); });
+
+        auto pendingCount = [&]() {
+            std::lock_guard < std::mutex > lock(mutex);
+            return pending.size();
+        };
+        auto waitForPending = [&](size_t count) {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            while ((pendingCount() < count) && (std::chrono::steady_clock::now() < deadline)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return pendingCount() == count;
+        };
+
+        // the first request does not block the io thread while it is pending
+        auto blocked = std::async(std::launch::async, [&]() {
+            return postSync(R"({"jsonrpc":"2.0","method":"theId.subscribe","params":["a"],"id":1})");
+        });
+        ASSERT_TRUE(waitForPending(1));
+        auto other = std::async(std::launch::async, [&]() {
+            return postSync(R"({"jsonrpc":"2.0","method":"theId.subscribe","params":["b"],"id":2})");
+        });
+        ASSERT_TRUE(waitForPending(2));
+
+        // completed from other threads in reverse order
+        std::thread([&]() { pending[1].second(0, { "b/0" }, ""); }).join();
+        ASSERT_EQ(other.wait_for(timeout), std::future_status::ready);
+        EXPECT_EQ(blocked.wait_for(std::chrono::milliseconds(10)), std::future_status::timeout);
+        std::thread([&]() { pending[0].second(-1, {}, "hardware failure"); }).join();
+        ASSERT_EQ(blocked.wait_for(timeout), std::future_status::ready);
+
+        auto otherResponse = other.get();
+        auto blockedResponse = blocked.get();
+        ioc.stop();
+        workerThread.join();
+
+        ASSERT_EQ(otherResponse.result(), boost::beast::http::status::ok);
+        nlohmann::json result = nlohmann::json::parse(otherResponse.body());
+        EXPECT_EQ(result["id"], 2);
+        EXPECT_EQ(result["result"], nlohmann::json({ "b/0" }));
+        EXPECT_EQ(blockedResponse.result(), boost::beast::http::status::bad_request);
+        EXPECT_NE(blockedResponse.body().find("hardware failure"), std::string::npos);
+    }
+
+    TEST(ControlServerClientTest, async_pipelined_requests)
+    {
+        namespace http = boost::beast::http;
+        static const size_t requestCount = 20;
+        boost::asio::io_context ioc;
+        std::mutex mutex;
+        std::vector < std::function < void() > > pending;
+        ControlServer::AsyncCommandCb commandCb = [&](const std::string& /*_streamId*/, const std::string& /*_command*/, const SignalIds& _signalIds, ControlServer::CompletionCb _completionCb)
+        {
+            std::lock_guard < std::mutex > lock(mutex);
+            pending.push_back([_signalIds, _completionCb]() { _completionCb(0, _signalIds, ""); });
+        };
+        ControlServer server(ioc, port, commandCb, logCallback);
+        server.start();
+        auto workerThread = std::thread([&]() { ioc.run(); });
+
+        // all requests at once over one connection, more than are read ahead
+        boost::asio::io_context clientIoc;
+        boost::asio::ip::tcp::socket socket(clientIoc);
+        socket.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), port));
+        for (size_t index = 0; index < requestCount; ++index) {
+            http::request < http::string_body > request(http::verb::post, target, httpVersion);
+            request.set(http::field::host, address);
+            request.set(http::field::content_type, "application/json");
+            nlohmann::json body = { { "jsonrpc", "2.0" }, { "method", streamId + ".subscribe" }, { "params", { std::to_string(index) } }, { "id", index } };
+            request.body() = body.dump();
+            request.prepare_payload();
+            http::write(socket, request);
+        }
+
+        // completed in reverse order, as many as are outstanding each time
+        std::vector < nlohmann::json > ids;
+        boost::beast::flat_buffer buffer;
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while ((ids.size() < requestCount) && (std::chrono::steady_clock::now() < deadline)) {
+            std::vector < std::function < void() > > completions;
+            {
+                std::lock_guard < std::mutex > lock(mutex);
+                completions.swap(pending);
+            }
+            if (completions.empty()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            for (auto iter = completions.rbegin(); iter != completions.rend(); ++iter) {
+                (*iter)();
+            }
+            for (size_t index = 0; index < completions.size(); ++index) {
+                http::response < http::string_body > response;
+                http::read(socket, buffer, response);
+                EXPECT_EQ(response.result(), http::status::ok);
+                ids.push_back(nlohmann::json::parse(response.body())["id"]);
+            }
+        }
+
+        ioc.stop();
+        workerThread.join();
+
+        // responded in the order of the requests
+        ASSERT_EQ(ids.size(), requestCount);
+        for (size_t index = 0; index < requestCount; ++index) {
+            EXPECT_EQ(ids[index], index);
+        }
+    }
 }
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "boost/asio/post.hpp"
+#include "boost/asio/thread_pool.hpp"
+#include "nlohmann/json.hpp"
+
+#include "streaming_protocol/DeliveryStage.hpp"
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/SubscribedSignal.hpp"
+
+namespace daq::streaming_protocol {
+    static LogCallback logCallback = daq::streaming_protocol::Logging::logCallback();
+
+    /// Data signal with int32 values and explicit rule
+    static std::unique_ptr < SubscribedSignal > createSignal(SignalNumber signalNumber)
+    {
+        auto signal = std::make_unique < SubscribedSignal > (signalNumber, logCallback);
+        nlohmann::json subscribe;
+        subscribe[META_SIGNALID] = "signal" + std::to_string(signalNumber);
+        signal->processSignalMetaInformation(META_METHOD_SUBSCRIBE, subscribe);
+        nlohmann::json signalMeta;
+        signalMeta[META_TABLEID] = "table";
+        signalMeta[META_DEFINITION][META_RULE] = META_RULETYPE_EXPLICIT;
+        signalMeta[META_DEFINITION][META_DATATYPE] = DATA_TYPE_INT32;
+        signal->processSignalMetaInformation(META_METHOD_SIGNAL, signalMeta);
+        return signal;
+    }
+
+    /// Publishes one value with time stamp value
+    static int publish(DeliveryStage& stage, const SubscribedSignal& signal, int32_t value)
+    {
+        uint64_t timeStamp = static_cast < uint64_t > (value);
+        return stage.publish(signal, &timeStamp, reinterpret_cast < const uint8_t* > (&value), 1);
+    }
+
+    static int32_t firstValue(const DeliveredData& data)
+    {
+        int32_t value;
+        memcpy(&value, data.data.data(), sizeof(value));
+        return value;
+    }
+
+    TEST(DeliveryStageTest, poll_test)
+    {
+        auto signal = createSignal(3);
+        std::vector < int32_t > values;
+        auto cb = [&values](const DeliveredData& data)
+        {
+            ASSERT_EQ(data.signalNumber, 3u);
+            ASSERT_EQ(data.signalId, "signal3");
+            ASSERT_EQ(data.sampleType, SAMPLETYPE_S32);
+            ASSERT_EQ(data.valueSize, sizeof(int32_t));
+            ASSERT_EQ(data.valueCount, 1u);
+            ASSERT_EQ(data.timeStamps[0], static_cast < uint64_t > (firstValue(data)));
+            values.push_back(firstValue(data));
+        };
+        DeliveryStage stage(2, 4, DeliveryStage::OVERFLOWPOLICY_BLOCK, cb, DeliveryStage::Executor(), logCallback);
+        for (int32_t value = 0; value < 3; ++value) {
+            ASSERT_EQ(publish(stage, *signal, value), 0);
+        }
+        // nothing is delivered in the thread of the reader
+        ASSERT_TRUE(values.empty());
+        DeliveryMetrics metrics = stage.metrics();
+        ASSERT_EQ(metrics.queueDepth, 3u);
+        ASSERT_EQ(metrics.publishedCount, 3u);
+
+        ASSERT_EQ(stage.poll(), 3u);
+        ASSERT_EQ(values, std::vector < int32_t > ({ 0, 1, 2 }));
+
+        // buffers are reused
+        for (int32_t value = 3; value < 7; ++value) {
+            ASSERT_EQ(publish(stage, *signal, value), 0);
+        }
+        ASSERT_EQ(stage.poll(), 4u);
+        metrics = stage.metrics();
+        ASSERT_EQ(metrics.queueDepth, 0u);
+        ASSERT_EQ(metrics.maxQueueDepth, 4u);
+        ASSERT_EQ(metrics.deliveredCount, 7u);
+        ASSERT_EQ(metrics.droppedCount, 0u);
+        ASSERT_EQ(metrics.blockedCount, 0u);
+        ASSERT_FALSE(metrics.closed);
+    }
+
+    TEST(DeliveryStageTest, drop_oldest_test)
+    {
+        auto signal = createSignal(1);
+        std::vector < int32_t > values;
+        auto cb = [&values](const DeliveredData& data)
+        {
+            values.push_back(firstValue(data));
+        };
+        DeliveryStage stage(1, 2, DeliveryStage::OVERFLOWPOLICY_DROP_OLDEST, cb, DeliveryStage::Executor(), logCallback);
+        for (int32_t value = 0; value < 5; ++value) {
+            ASSERT_EQ(publish(stage, *signal, value), 0);
+        }
+        ASSERT_EQ(stage.poll(), 2u);
+        ASSERT_EQ(values, std::vector < int32_t > ({ 3, 4 }));
+        ASSERT_EQ(stage.metrics().droppedCount, 3u);
+    }
+
+    TEST(DeliveryStageTest, close_test)
+    {
+        auto signal = createSignal(1);
+        std::vector < int32_t > values;
+        auto cb = [&values](const DeliveredData& data)
+        {
+            values.push_back(firstValue(data));
+        };
+        size_t closedCount = 0;
+        DeliveryStage stage(1, 2, DeliveryStage::OVERFLOWPOLICY_CLOSE, cb, DeliveryStage::Executor(), logCallback);
+        stage.setClosedCb([&closedCount]() {
+            ++closedCount;
+        });
+        ASSERT_EQ(publish(stage, *signal, 0), 0);
+        ASSERT_EQ(publish(stage, *signal, 1), 0);
+        ASSERT_EQ(publish(stage, *signal, 2), -1);
+        ASSERT_EQ(closedCount, 1u);
+        ASSERT_TRUE(stage.closed());
+
+        // packages published before are still delivered, packages published afterwards are dropped
+        ASSERT_EQ(stage.poll(), 2u);
+        ASSERT_EQ(publish(stage, *signal, 3), -1);
+        ASSERT_EQ(stage.poll(), 0u);
+        ASSERT_EQ(values, std::vector < int32_t > ({ 0, 1 }));
+        ASSERT_EQ(closedCount, 1u);
+        DeliveryMetrics metrics = stage.metrics();
+        ASSERT_EQ(metrics.droppedCount, 2u);
+        ASSERT_TRUE(metrics.closed);
+    }
+
+    TEST(DeliveryStageTest, executor_test)
+    {
+        static const size_t signalCount = 8;
+        static const int32_t valueCount = 20000;
+        std::vector < std::unique_ptr < SubscribedSignal > > signals;
+        for (size_t signalIndex = 0; signalIndex < signalCount; ++signalIndex) {
+            signals.push_back(createSignal(static_cast < SignalNumber > (signalIndex + 1)));
+        }
+
+        std::mutex mutex;
+        std::map < SignalNumber, std::vector < int32_t > > values;
+        bool outOfOrder = false;
+        auto cb = [&](const DeliveredData& data)
+        {
+            std::lock_guard < std::mutex > lock(mutex);
+            std::vector < int32_t >& signalValues = values[data.signalNumber];
+            if (!signalValues.empty() && (signalValues.back() >= firstValue(data))) {
+                outOfOrder = true;
+            }
+            signalValues.push_back(firstValue(data));
+        };
+
+        boost::asio::thread_pool pool(4);
+        auto executor = [&pool](std::function < void() > task)
+        {
+            boost::asio::post(pool, std::move(task));
+        };
+        {
+            DeliveryStage stage(4, 16, DeliveryStage::OVERFLOWPOLICY_BLOCK, cb, executor, logCallback);
+            for (int32_t value = 0; value < valueCount; ++value) {
+                ASSERT_EQ(publish(stage, *signals[static_cast < size_t > (value) % signalCount], value), 0);
+            }
+            while (stage.metrics().deliveredCount < static_cast < uint64_t > (valueCount)) {
+                std::this_thread::yield();
+            }
+            DeliveryMetrics metrics = stage.metrics();
+            ASSERT_EQ(metrics.queueDepth, 0u);
+            ASSERT_LE(metrics.maxQueueDepth, 4u * 16u);
+            ASSERT_EQ(metrics.droppedCount, 0u);
+        }
+        pool.join();
+
+        ASSERT_FALSE(outOfOrder);
+        ASSERT_EQ(values.size(), signalCount);
+        for (const auto& signalValues : values) {
+            ASSERT_EQ(signalValues.second.size(), valueCount / signalCount);
+        }
+    }
+    TEST(DeliveryStageTest, block_test)
+    {
+        static const int32_t valueCount = 50;
+        std::unique_ptr < SubscribedSignal > signal = createSignal(1);
+
+        std::vector < int32_t > values;
+        auto cb = [&](const DeliveredData& data)
+        {
+            // slower than the reader
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            values.push_back(firstValue(data));
+        };
+
+        boost::asio::thread_pool pool(1);
+        auto executor = [&pool](std::function < void() > task)
+        {
+            boost::asio::post(pool, std::move(task));
+        };
+        uint64_t blockedCount;
+        {
+            DeliveryStage stage(1, 2, DeliveryStage::OVERFLOWPOLICY_BLOCK, cb, executor, logCallback);
+            for (int32_t value = 0; value < valueCount; ++value) {
+                ASSERT_EQ(publish(stage, *signal, value), 0);
+            }
+            blockedCount = stage.metrics().blockedCount;
+            // the task handed to the executor delivers the remaining packages before the stage is gone
+        }
+        pool.join();
+
+        ASSERT_GT(blockedCount, 0u);
+        ASSERT_EQ(values.size(), static_cast < size_t > (valueCount));
+        for (int32_t value = 0; value < valueCount; ++value) {
+            ASSERT_EQ(values[static_cast < size_t > (value)], value);
+        }
+    }
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "nlohmann/json.hpp"
+
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/MetaInformation.hpp"
+#include "streaming_protocol/MsgpackView.hpp"
+
+#include "streaming_protocol/Logging.hpp"
+
+namespace daq::streaming_protocol {
+    static LogCallback logCallback = daq::streaming_protocol::Logging::logCallback();
+
+    TEST(MsgpackViewTest, scalar_test)
+    {
+        nlohmann::json doc = R"(
+        {
+            "positiveFixInt" : 5,
+            "uint8" : 200,
+            "uint16" : 60000,
+            "uint32" : 4000000000,
+            "uint64" : 18000000000000000000,
+            "negativeFixInt" : -5,
+            "int8" : -100,
+            "int16" : -30000,
+            "int32" : -2000000000,
+            "int64" : -9000000000000000000,
+            "double" : 1.5,
+            "true" : true,
+            "false" : false,
+            "nil" : null,
+            "string" : "hello"
+        }
+        )"_json;
+        std::vector < uint8_t > msgpack = nlohmann::json::to_msgpack(doc);
+        MsgpackView view(msgpack.data(), msgpack.size());
+        ASSERT_TRUE(view.valid());
+        ASSERT_EQ(view.size(), msgpack.size());
+        ASSERT_EQ(view.type(), MsgpackView::MSGPACKTYPE_MAP);
+        ASSERT_EQ(view.count(), doc.size());
+
+        ASSERT_EQ(view.find("positiveFixInt").asUnsigned(), 5);
+        ASSERT_EQ(view.find("uint8").asUnsigned(), 200);
+        ASSERT_EQ(view.find("uint16").asUnsigned(), 60000);
+        ASSERT_EQ(view.find("uint32").asUnsigned(), 4000000000);
+        ASSERT_EQ(view.find("uint64").asUnsigned(), 18000000000000000000u);
+        ASSERT_EQ(view.find("negativeFixInt").asSigned(), -5);
+        ASSERT_EQ(view.find("int8").asSigned(), -100);
+        ASSERT_EQ(view.find("int16").asSigned(), -30000);
+        ASSERT_EQ(view.find("int32").asSigned(), -2000000000);
+        ASSERT_EQ(view.find("int64").asSigned(), -9000000000000000000);
+        ASSERT_EQ(view.find("int64").asUnsigned(), 0);
+        ASSERT_EQ(view.find("uint8").asSigned(), 200);
+        ASSERT_EQ(view.find("double").asDouble(), 1.5);
+        ASSERT_EQ(view.find("int8").asDouble(), -100.0);
+        ASSERT_TRUE(view.find("true").asBool());
+        ASSERT_FALSE(view.find("false").asBool());
+        ASSERT_EQ(view.find("false").type(), MsgpackView::MSGPACKTYPE_BOOL);
+        ASSERT_EQ(view.find("nil").type(), MsgpackView::MSGPACKTYPE_NIL);
+        ASSERT_EQ(view.find("string").asStringView(), "hello");
+        ASSERT_EQ(view.find("string").asUnsigned(), 0);
+        ASSERT_TRUE(view.find("uint8").asStringView().empty());
+
+        ASSERT_FALSE(view.find("unknown").valid());
+        ASSERT_EQ(view.find("unknown").type(), MsgpackView::MSGPACKTYPE_INVALID);
+        // no map
+        ASSERT_FALSE(view.find("string").find("string").valid());
+
+        ASSERT_EQ(view.toJson(), doc);
+        ASSERT_EQ(view.find("int64").toJson(), doc["int64"]);
+    }
+
+    TEST(MsgpackViewTest, container_test)
+    {
+        nlohmann::json doc;
+        std::vector < std::string > signalIds;
+        for (size_t index = 0; index < 50000; ++index) {
+            signalIds.push_back("signal" + std::to_string(index));
+        }
+        doc[METHOD] = META_METHOD_AVAILABLE;
+        doc[PARAMS][META_SIGNALIDS] = signalIds;
+        doc[PARAMS]["empty"] = nlohmann::json::array();
+        doc[PARAMS]["nested"]["map"]["value"] = 42;
+        std::vector < uint8_t > msgpack = nlohmann::json::to_msgpack(doc);
+
+        MsgpackView view(msgpack.data(), msgpack.size());
+        ASSERT_TRUE(view.valid());
+        ASSERT_EQ(view.find(METHOD).asStringView(), META_METHOD_AVAILABLE);
+        MsgpackView params = view.find(PARAMS);
+        ASSERT_EQ(params.type(), MsgpackView::MSGPACKTYPE_MAP);
+
+        MsgpackView signalIdsView = params.find(META_SIGNALIDS);
+        ASSERT_EQ(signalIdsView.type(), MsgpackView::MSGPACKTYPE_ARRAY);
+        ASSERT_EQ(signalIdsView.count(), signalIds.size());
+        size_t index = 0;
+        for (MsgpackView signalId : signalIdsView) {
+            ASSERT_EQ(signalId.asStringView(), signalIds[index]);
+            ++index;
+        }
+        ASSERT_EQ(index, signalIds.size());
+
+        MsgpackView empty = params.find("empty");
+        ASSERT_EQ(empty.type(), MsgpackView::MSGPACKTYPE_ARRAY);
+        ASSERT_TRUE(empty.begin() == empty.end());
+
+        ASSERT_EQ(params.find("nested").find("map").find("value").asUnsigned(), 42);
+
+        std::vector < std::string > keys;
+        for (auto iter = params.begin(); iter != params.end(); ++iter) {
+            keys.emplace_back(iter.key().asStringView());
+        }
+        ASSERT_EQ(keys.size(), 3);
+
+        // scalars can not be iterated
+        MsgpackView method = view.find(METHOD);
+        ASSERT_TRUE(method.begin() == method.end());
+        ASSERT_FALSE(method.begin().key().valid());
+    }
+
+    TEST(MsgpackViewTest, invalid_test)
+    {
+        nlohmann::json doc;
+        doc["array"] = { 1, 2, 3 };
+        doc["string"] = "some text";
+        std::vector < uint8_t > msgpack = nlohmann::json::to_msgpack(doc);
+
+        // every truncation is detected
+        for (size_t size = 0; size < msgpack.size(); ++size) {
+            MsgpackView view(msgpack.data(), size);
+            ASSERT_FALSE(view.valid());
+            ASSERT_EQ(view.type(), MsgpackView::MSGPACKTYPE_INVALID);
+            ASSERT_FALSE(view.find("array").valid());
+            ASSERT_TRUE(view.begin() == view.end());
+            ASSERT_TRUE(view.toJson().is_null());
+        }
+
+        // trailing data is not part of the value
+        msgpack.push_back(0xc0);
+        MsgpackView view(msgpack.data(), msgpack.size());
+        ASSERT_TRUE(view.valid());
+        ASSERT_EQ(view.size(), msgpack.size() - 1);
+
+        // 0xc1 is never used
+        uint8_t neverUsed = 0xc1;
+        ASSERT_FALSE(MsgpackView(&neverUsed, sizeof(neverUsed)).valid());
+
+        // array announcing more elements than there are bytes
+        std::vector < uint8_t > hugeArray = { 0xdd, 0xff, 0xff, 0xff, 0xff, 0x01 };
+        ASSERT_FALSE(MsgpackView(hugeArray.data(), hugeArray.size()).valid());
+    }
+
+    TEST(MsgpackViewTest, meta_information_test)
+    {
+        nlohmann::json doc;
+        doc[METHOD] = META_METHOD_SUBSCRIBE;
+        doc[PARAMS][META_SIGNALID] = "theId";
+        std::vector < uint8_t > msgpack = nlohmann::json::to_msgpack(doc);
+        std::vector < uint8_t > package(sizeof(METAINFORMATION_MSGPACK) + msgpack.size());
+        memcpy(package.data(), &METAINFORMATION_MSGPACK, sizeof(METAINFORMATION_MSGPACK));
+        memcpy(package.data() + sizeof(METAINFORMATION_MSGPACK), msgpack.data(), msgpack.size());
+
+        MetaInformation metaInformation(logCallback);
+        ASSERT_EQ(metaInformation.interpret(package.data(), package.size()), 0);
+        ASSERT_EQ(metaInformation.type(), METAINFORMATION_MSGPACK);
+        ASSERT_EQ(metaInformation.method(), META_METHOD_SUBSCRIBE);
+        ASSERT_EQ(metaInformation.paramsView().find(META_SIGNALID).asStringView(), "theId");
+        ASSERT_EQ(metaInformation.params(), doc[PARAMS]);
+        ASSERT_EQ(metaInformation.jsonContent(), doc);
+
+        // a copy refers to its own data
+        MetaInformation copy(metaInformation);
+        package[package.size() - 1] = 'X';
+        ASSERT_EQ(metaInformation.interpret(package.data(), package.size()), 0);
+        ASSERT_EQ(copy.paramsView().find(META_SIGNALID).asStringView(), "theId");
+        ASSERT_EQ(metaInformation.paramsView().find(META_SIGNALID).asStringView(), "theIX");
+        ASSERT_EQ(metaInformation.jsonContent()[PARAMS][META_SIGNALID], "theIX");
+
+        // trailing garbage
+        package.push_back(0xc0);
+        ASSERT_EQ(metaInformation.interpret(package.data(), package.size()), -1);
+        ASSERT_FALSE(metaInformation.content().valid());
+        ASSERT_EQ(metaInformation.method(), "");
+        ASSERT_TRUE(metaInformation.params().is_null());
+
+        // keys that are no strings are rejected, also in nested maps: {"params": [{1: "x"}]}
+        std::vector < uint8_t > nestedKey = { 0x81, 0xa6, 'p', 'a', 'r', 'a', 'm', 's', 0x91, 0x81, 0x01, 0xa1, 'x' };
+        ASSERT_TRUE(MsgpackView(nestedKey.data(), nestedKey.size()).valid());
+        package.resize(sizeof(METAINFORMATION_MSGPACK));
+        package.insert(package.end(), nestedKey.begin(), nestedKey.end());
+        ASSERT_EQ(metaInformation.interpret(package.data(), package.size()), -1);
+        ASSERT_FALSE(metaInformation.content().valid());
+
+        // a string key in the same place is fine
+        package[package.size() - 3] = 0xa1;
+        package.insert(package.end() - 2, 'k');
+        ASSERT_EQ(metaInformation.interpret(package.data(), package.size()), 0);
+        ASSERT_EQ(metaInformation.params()[0]["k"], "x");
+    }
+}
@@ -35,6 +35,8 @@
 #include "streaming_protocol/LinearTimeSignal.hpp"
 #include "streaming_protocol/ProducerSession.hpp"
 #include "streaming_protocol/ProtocolHandler.hpp"
+#include "streaming_protocol/SendQueue.hpp"
+#include "streaming_protocol/SignalIdPattern.hpp"
 #include "streaming_protocol/StreamWriter.h"
 #include "streaming_protocol/SignalContainer.hpp"
 #include "streaming_protocol/SynchronousSignal.hpp"
@@ -194,6 +196,47 @@ TEST(ProducerSessionTest, start_stop)
     ASSERT_EQ(boost::system::error_code(), resultEc);
 }
 
+/// The test stream completes all writes right away, alive is written with a fill level of 0
+TEST(ProducerSessionTest, alive_with_send_queue)
+{
+    // MessagePack encoded key of the fill level, only alive has it
+    static const std::string alive = std::string("\xa9") + META_FILLLEVEL;
+
+    boost::asio::io_context ioc;
+    auto testStream = std::make_shared<TestStream>();
+    auto sendQueue = std::make_shared<SendQueue>(ioc, testStream, std::chrono::microseconds(0), SendQueue::DEFAULT_MAX_BATCH_SIZE,
+                                                 SendQueue::DEFAULT_CAPACITY, SendQueue::OVERFLOWPOLICY_DROP, logCallback);
+    auto producerSession = std::make_shared<ProducerSession>(sendQueue, nlohmann::json(), logCallback);
+    producerSession->setAliveInterval(std::chrono::milliseconds(10));
+    producerSession->start([](const boost::system::error_code&) {
+        FAIL();
+    });
+
+    auto countAlive = [&testStream]() {
+        std::string written(reinterpret_cast<const char*>(testStream->data()), testStream->size());
+        size_t count = 0;
+        for (size_t position = written.find(alive); position != std::string::npos; position = written.find(alive, position + 1)) {
+            // msgpack positive fixint
+            EXPECT_EQ(written[position + alive.size()], 0);
+            ++count;
+        }
+        return count;
+    };
+
+    // one alive per expiration of the timer, whatever the scheduling of the test
+    static const size_t aliveCount = 3;
+    auto start = std::chrono::steady_clock::now();
+    while ((countAlive() < aliveCount) && (std::chrono::steady_clock::now() - start < std::chrono::seconds(2))) {
+        ioc.run_one_for(std::chrono::milliseconds(100));
+    }
+    ASSERT_EQ(countAlive(), aliveCount);
+
+    // no more alive after stop, the io context runs out of work
+    producerSession->stop();
+    ioc.run();
+    EXPECT_EQ(countAlive(), aliveCount);
+}
+
 TEST(ProducerSessionTest, complete_session)
 {
     struct PackageInformation
@@ -537,4 +580,57 @@ TEST(ProducerSessionTest, session_signals)
     count = producerSession->removeSignals(allSignalIds);
     ASSERT_EQ(count, allSignalIds.size()-1);
 }
+
+TEST(ProducerSessionTest, signal_id_patterns)
+{
+    static const std::string fileName = "theFile";
+    static const std::string tableId = "the table Id";
+
+    boost::asio::io_context ioc;
+    auto fileStream = std::make_shared<stream::FileStream>(ioc, fileName, true);
+    auto producerSession = std::make_shared<ProducerSession>(fileStream, nlohmann::json(), logCallback);
+    StreamWriter writer(fileStream);
+
+    ProducerSession::Signals allSignals;
+    for (const std::string signalId : { "ai/0/raw", "ai/0/scaled", "ai/1/raw", "ai/1/scaled", "ai/10/raw", "ao/0/raw", "ai/*" }) {
+        allSignals[signalId] = std::make_shared<SynchronousSignal<double>>(signalId, tableId, writer, logCallback);
+    }
+    producerSession->addSignals(allSignals);
+
+    EXPECT_EQ(producerSession->resolveSignalIds({ "ai/*/raw" }), SignalIds({ "ai/0/raw", "ai/1/raw", "ai/10/raw" }));
+    EXPECT_EQ(producerSession->resolveSignalIds({ "ai/1**" }), SignalIds({ "ai/1/raw", "ai/1/scaled", "ai/10/raw" }));
+    EXPECT_EQ(producerSession->resolveSignalIds({ "a?/0/raw", "ai/1/scaled", "unknown", "x/*" }), SignalIds({ "ai/0/raw", "ao/0/raw", "ai/1/scaled" }));
+    // signal ids with wildcard characters are subscribed exactly if escaped
+    EXPECT_EQ(producerSession->resolveSignalIds({ SignalIdPattern::escape("ai/*") }), SignalIds({ "ai/*" }));
+
+    size_t count = producerSession->subscribeSignals({ "**/scaled" });
+    ASSERT_EQ(count, 2);
+    count = producerSession->unsubscribeSignals({ "ai/*/scaled" });
+    ASSERT_EQ(count, 2);
+}
+
+TEST(ProducerSessionTest, repeated_subscribe)
+{
+    static const std::string fileName = "theFile";
+    static const std::string tableId = "the table Id";
+    static const std::string signalId = "the Id";
+
+    boost::asio::io_context ioc;
+    auto fileStream = std::make_shared<stream::FileStream>(ioc, fileName, true);
+    auto producerSession = std::make_shared<ProducerSession>(fileStream, nlohmann::json(), logCallback);
+    StreamWriter writer(fileStream);
+
+    auto syncSignal = std::make_shared<SynchronousSignal<double>>(signalId, tableId, writer, logCallback);
+    producerSession->addSignal(syncSignal);
+
+    // the session counts once as subscriber
+    ASSERT_EQ(producerSession->subscribeSignals({ signalId }), 1);
+    ASSERT_EQ(producerSession->subscribeSignals({ signalId }), 1);
+    ASSERT_EQ(syncSignal->subscriberCount(), 1);
+
+    ASSERT_EQ(producerSession->unsubscribeSignals({ signalId }), 1);
+    ASSERT_FALSE(syncSignal->isSubscribed());
+    ASSERT_EQ(producerSession->unsubscribeSignals({ signalId }), 1);
+    ASSERT_EQ(syncSignal->subscriberCount(), 0);
+}
 }
@@ -19,6 +19,7 @@
 #include <gtest/gtest.h>
 
 #include "boost/asio/io_context.hpp"
+#include "boost/asio/post.hpp"
 #include "nlohmann/json.hpp"
 
 #include "stream/FileStream.hpp"
@@ -121,6 +122,102 @@ namespace daq::streaming_protocol {
     };
 
 
+    /// Read requests stay pending in the io context. They are never completed.
+    class PendingReadStream : public TestStream
+    {
+    public:
+        PendingReadStream(boost::asio::io_context& ioc)
+            : m_ioc(ioc)
+        {
+        }
+
+        void asyncReadAtLeast(std::size_t bytesToRead, ReadCompletionCb readAtLeastCb) override
+        {
+            boost::asio::post(m_ioc, [readAtLeastCb]() {
+            });
+        }
+    private:
+        boost::asio::io_context& m_ioc;
+    };
+
+    TEST(ProtocolHandlerTest, released_with_io_context)
+    {
+        SignalContainer signalContainer(logCallback);
+        std::weak_ptr < ProtocolHandler > weakProtocolHandler;
+        {
+            boost::asio::io_context ioContext;
+            auto streamMetaCb = [](ProtocolHandler& prtotocolHandler, const std::string& method, const nlohmann::json& params)
+            {
+            };
+            auto protocolHandler = std::make_shared<ProtocolHandler>(ioContext, signalContainer, streamMetaCb, logCallback);
+            weakProtocolHandler = protocolHandler;
+            protocolHandler->start(std::make_unique < PendingReadStream > (ioContext));
+            protocolHandler.reset();
+            // kept alive by the pending read
+            ASSERT_FALSE(weakProtocolHandler.expired());
+        }
+        // the io context got destroyed without completing the read
+        ASSERT_TRUE(weakProtocolHandler.expired());
+    }
+
+    /// Keeps the read request. It is completed by the test after the stream got closed.
+    class DelayedReadStream : public TestStream
+    {
+    public:
+        DelayedReadStream(ReadCompletionCb& pendingRead, bool& destroyed)
+            : m_pendingRead(pendingRead)
+            , m_destroyed(destroyed)
+        {
+        }
+
+        ~DelayedReadStream() override
+        {
+            m_destroyed = true;
+        }
+
+        void asyncReadAtLeast(std::size_t bytesToRead, ReadCompletionCb readAtLeastCb) override
+        {
+            m_pendingRead = readAtLeastCb;
+        }
+    private:
+        ReadCompletionCb& m_pendingRead;
+        bool& m_destroyed;
+    };
+
+    TEST(ProtocolHandlerTest, read_completed_after_close)
+    {
+        boost::asio::io_context ioContext;
+        SignalContainer signalContainer(logCallback);
+        stream::Stream::ReadCompletionCb pendingRead;
+        bool streamDestroyed = false;
+        bool closed = false;
+        std::weak_ptr < ProtocolHandler > weakProtocolHandler;
+        {
+            auto streamMetaCb = [](ProtocolHandler& prtotocolHandler, const std::string& method, const nlohmann::json& params)
+            {
+            };
+            auto protocolHandler = std::make_shared<ProtocolHandler>(ioContext, signalContainer, streamMetaCb, logCallback);
+            weakProtocolHandler = protocolHandler;
+            protocolHandler->start(std::make_unique < DelayedReadStream > (pendingRead, streamDestroyed), [&closed](const boost::system::error_code&) {
+                closed = true;
+            });
+            protocolHandler->stop();
+        }
+        ioContext.run();
+        ioContext.restart();
+        ASSERT_TRUE(closed);
+        ASSERT_TRUE(pendingRead);
+        // the read is still pending, the stream and the session are kept
+        ASSERT_FALSE(streamDestroyed);
+        ASSERT_FALSE(weakProtocolHandler.expired());
+
+        stream::Stream::ReadCompletionCb readCompletionCb = std::move(pendingRead);
+        readCompletionCb(boost::asio::error::operation_aborted, 0);
+        ioContext.run();
+        ASSERT_TRUE(streamDestroyed);
+        ASSERT_TRUE(weakProtocolHandler.expired());
+    }
+
     TEST(ProtocolHandlerTest, start_stop)
     {
         boost::asio::io_context ioContext;
@@ -306,4 +403,123 @@ namespace daq::streaming_protocol {
         ASSERT_EQ(methodSend, methodReceived);
         ASSERT_EQ(paramsSend, paramsReceived);
     }
+
+    TEST(ProtocolHandlerTest, batched_receive)
+    {
+        static const std::string streamFileName = "dumpFile";
+        static const unsigned int dataSignalNumber = 1;
+        static const unsigned int timeSignalNumber = 2;
+        static const size_t packageCount = 1000;
+        boost::asio::io_context ioContext;
+
+        nlohmann::json subscribeData;
+        subscribeData[daq::jsonrpc::METHOD] = META_METHOD_SUBSCRIBE;
+        subscribeData[daq::jsonrpc::PARAMS][META_SIGNALID] = "data";
+        nlohmann::json subscribeTime;
+        subscribeTime[daq::jsonrpc::METHOD] = META_METHOD_SUBSCRIBE;
+        subscribeTime[daq::jsonrpc::PARAMS][META_SIGNALID] = "time";
+
+        nlohmann::json dataSignal = R"(
+        {
+            "method" : "signal",
+            "params" : {
+                "definition" : {
+                    "dataType" : "int32"
+                },
+                "tableId" : "table"
+            }
+        }
+        )"_json;
+
+        nlohmann::json timeSignal = R"(
+        {
+            "method" : "signal",
+            "params" : {
+                "definition" : {
+                    "dataType" : "uint64",
+                    "rule" : "linear",
+                    "linear" : {
+                        "delta" : 1
+                    },
+                    "unit" : {
+                        "displayName": "s",
+                        "unitId": 5457219,
+                        "quantity": "time"
+                    },
+                    "resolution" : {
+                        "num" : 1,
+                        "denom" : 1
+                    }
+                },
+                "tableId" : "table"
+            }
+        }
+        )"_json;
+
+        {
+            auto fileStream = std::make_shared < daq::stream::FileStream > (ioContext, streamFileName, true);
+            fileStream->init();
+            StreamWriter writer(fileStream);
+            writer.writeMetaInformation(dataSignalNumber, subscribeData);
+            writer.writeMetaInformation(timeSignalNumber, subscribeTime);
+            writer.writeMetaInformation(dataSignalNumber, dataSignal);
+            writer.writeMetaInformation(timeSignalNumber, timeSignal);
+            IndexedValue < uint64_t > startTime;
+            startTime.index = 0;
+            startTime.value = 0;
+            writer.writeSignalData(timeSignalNumber, &startTime, sizeof(startTime));
+            // small packages with one value each and some big packages that require the additional length field
+            int32_t value = 0;
+            for (size_t packageIndex = 0; packageIndex < packageCount; ++packageIndex) {
+                size_t valueCount = (packageIndex % 100 == 0) ? 100 : 1;
+                std::vector < int32_t > values;
+                for (size_t valueIndex = 0; valueIndex < valueCount; ++valueIndex) {
+                    values.push_back(value++);
+                }
+                writer.writeSignalData(dataSignalNumber, values.data(), values.size() * sizeof(int32_t));
+            }
+        }
+
+        std::vector < int32_t > receivedValues;
+        std::vector < uint64_t > receivedTimeStamps;
+        size_t packagesReceived = 0;
+        auto dataAsValueCb = [&](const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t valueCount)
+        {
+            ASSERT_EQ(subscribedSignal.signalNumber(), dataSignalNumber);
+            const int32_t* values = reinterpret_cast < const int32_t* > (data);
+            receivedValues.insert(receivedValues.end(), values, values + valueCount);
+            receivedTimeStamps.push_back(timeStamp);
+            ++packagesReceived;
+        };
+
+        auto streamMetaCb = [](ProtocolHandler& prtotocolHandler, const std::string& method, const nlohmann::json& params)
+        {
+        };
+
+        SignalContainer signalContainer(logCallback);
+        signalContainer.setDataAsValueCb(dataAsValueCb);
+        auto protocolHandler = std::make_shared<ProtocolHandler>(ioContext, signalContainer, streamMetaCb, logCallback);
+        ASSERT_EQ(protocolHandler->receiveMode(), RECEIVEMODE_PER_PACKAGE);
+        protocolHandler->setReceiveMode(RECEIVEMODE_BATCHED);
+        ASSERT_EQ(protocolHandler->receiveMode(), RECEIVEMODE_BATCHED);
+        auto fileStream = std::make_unique < daq::stream::FileStream > (ioContext, streamFileName);
+
+        boost::system::error_code sessionEc;
+        auto completionCb = [&](const boost::system::error_code& ec) {
+            sessionEc = ec;
+        };
+
+        protocolHandler->start(std::move(fileStream), completionCb);
+        ioContext.run();
+
+        ASSERT_EQ(sessionEc, boost::asio::error::eof);
+        ASSERT_EQ(packagesReceived, packageCount);
+        for (size_t index = 0; index < receivedValues.size(); ++index) {
+            ASSERT_EQ(receivedValues[index], static_cast < int32_t > (index));
+        }
+        // linear time: the time stamp of the first value of each package is derived from the value index
+        ASSERT_EQ(receivedTimeStamps[0], 0);
+        ASSERT_EQ(receivedTimeStamps[1], 100);
+        ASSERT_EQ(receivedTimeStamps[2], 101);
+    }
 }
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "streaming_protocol/SampleConverter.hpp"
+#include "streaming_protocol/Types.h"
+
+namespace daq::streaming_protocol {
+    /// odd, to have remainders for all vector widths
+    static const size_t ValueCount = 37;
+
+    static const SampleConverter::InstructionSet InstructionSets[] = {
+        SampleConverter::INSTRUCTIONSET_SCALAR,
+        SampleConverter::INSTRUCTIONSET_SSE41,
+        SampleConverter::INSTRUCTIONSET_AVX2
+    };
+
+    /// Limits, zero and pseudo random values in between
+    template < typename Type >
+    static std::vector < Type > createValues()
+    {
+        std::vector < Type > values;
+        if constexpr (std::is_floating_point_v < Type >) {
+            // still within the range of float results
+            values = { static_cast < Type > (-1e30), static_cast < Type > (1e30), 0 };
+        } else {
+            values = { std::numeric_limits < Type >::lowest(), std::numeric_limits < Type >::max(), 0 };
+        }
+        uint64_t state = 0x9e3779b97f4a7c15;
+        while (values.size() < ValueCount) {
+            state = state * 6364136223846793005 + 1442695040888963407;
+            if constexpr (std::is_floating_point_v < Type >) {
+                values.push_back(static_cast < Type > (static_cast < int64_t > (state) / 1e12));
+            } else {
+                Type value;
+                memcpy(&value, &state, sizeof(value));
+                values.push_back(value);
+            }
+        }
+        return values;
+    }
+
+    template < typename Result >
+    static Result expectedResult(double value, const PostScaling& postScaling, const Range& range, unsigned int options)
+    {
+        if (options & SampleConverter::OPTION_POSTSCALING) {
+            value = value * postScaling.scale + postScaling.offset;
+        }
+        if (options & SampleConverter::OPTION_RANGE) {
+            value = (value > range.low) ? value : range.low;
+            value = (value < range.high) ? value : range.high;
+        }
+        return static_cast < Result > (value);
+    }
+
+    template < typename Type, typename Result >
+    static void checkConversion(SampleType sampleType)
+    {
+        std::vector < Type > values = createValues < Type > ();
+
+        // same values with value index in front
+        std::vector < uint8_t > indexedValues;
+        for (size_t valueIndex = 0; valueIndex < values.size(); ++valueIndex) {
+            IndexedValue < Type > indexedValue;
+            indexedValue.index = 1000 + valueIndex;
+            indexedValue.value = values[valueIndex];
+            const uint8_t* pIndexedValue = reinterpret_cast < const uint8_t* > (&indexedValue);
+            indexedValues.insert(indexedValues.end(), pIndexedValue, pIndexedValue + sizeof(indexedValue));
+        }
+
+        PostScaling postScaling;
+        postScaling.scale = -0.25;
+        postScaling.offset = 3.5;
+        Range range;
+        range.low = -1000;
+        range.high = 2000;
+
+        SampleConverter converter;
+        ASSERT_EQ(converter.setElementTypes({ sampleType }), 0);
+        ASSERT_EQ(converter.elementCount(), 1u);
+        ASSERT_EQ(converter.valueSize(), sizeof(Type));
+        converter.setPostScaling(postScaling);
+        converter.setRange(range);
+
+        for (SampleConverter::InstructionSet instructionSet : InstructionSets) {
+            converter.setInstructionSet(instructionSet);
+            for (unsigned int options = 0; options <= (SampleConverter::OPTION_POSTSCALING | SampleConverter::OPTION_RANGE); ++options) {
+                std::vector < Result > results(values.size());
+                std::vector < uint64_t > valueIndices(values.size());
+
+                converter.setIndexed(false);
+                ASSERT_EQ(converter.convert(reinterpret_cast < const uint8_t* > (values.data()), values.size(), results.data(), options), values.size());
+                for (size_t valueIndex = 0; valueIndex < values.size(); ++valueIndex) {
+                    Result expected = expectedResult < Result > (static_cast < double > (values[valueIndex]), postScaling, range, options);
+                    ASSERT_EQ(results[valueIndex], expected) << "instruction set " << instructionSet << ", options " << options << ", index " << valueIndex;
+                }
+
+                converter.setIndexed(true);
+                ASSERT_EQ(converter.valueSize(), sizeof(IndexedValue < Type >));
+                std::fill(results.begin(), results.end(), 0);
+                ASSERT_EQ(converter.convert(indexedValues.data(), values.size(), results.data(), options, valueIndices.data()), values.size());
+                for (size_t valueIndex = 0; valueIndex < values.size(); ++valueIndex) {
+                    Result expected = expectedResult < Result > (static_cast < double > (values[valueIndex]), postScaling, range, options);
+                    ASSERT_EQ(results[valueIndex], expected) << "instruction set " << instructionSet << ", options " << options << ", index " << valueIndex;
+                    ASSERT_EQ(valueIndices[valueIndex], 1000 + valueIndex);
+                }
+            }
+        }
+    }
+
+    template < typename Result >
+    static void checkAllSampleTypes()
+    {
+        checkConversion < uint8_t, Result > (SAMPLETYPE_U8);
+        checkConversion < int8_t, Result > (SAMPLETYPE_S8);
+        checkConversion < uint16_t, Result > (SAMPLETYPE_U16);
+        checkConversion < int16_t, Result > (SAMPLETYPE_S16);
+        checkConversion < uint32_t, Result > (SAMPLETYPE_U32);
+        checkConversion < int32_t, Result > (SAMPLETYPE_S32);
+        checkConversion < uint64_t, Result > (SAMPLETYPE_U64);
+        checkConversion < int64_t, Result > (SAMPLETYPE_S64);
+        checkConversion < float, Result > (SAMPLETYPE_REAL32);
+        checkConversion < double, Result > (SAMPLETYPE_REAL64);
+        checkConversion < uint32_t, Result > (SAMPLETYPE_BITFIELD32);
+        checkConversion < uint64_t, Result > (SAMPLETYPE_BITFIELD64);
+    }
+
+    TEST(SampleConverterTest, scalar_to_double_test)
+    {
+        checkAllSampleTypes < double > ();
+    }
+
+    TEST(SampleConverterTest, scalar_to_float_test)
+    {
+        checkAllSampleTypes < float > ();
+    }
+
+    TEST(SampleConverterTest, uint64_test)
+    {
+        // beyond the range of int64
+        std::vector < uint64_t > values(8, 0xfedcba9876543210);
+        std::vector < double > results(values.size());
+        SampleConverter converter;
+        ASSERT_EQ(converter.setElementTypes({ SAMPLETYPE_U64 }), 0);
+        for (SampleConverter::InstructionSet instructionSet : InstructionSets) {
+            converter.setInstructionSet(instructionSet);
+            converter.convert(reinterpret_cast < const uint8_t* > (values.data()), values.size(), results.data());
+            for (double result : results) {
+                ASSERT_EQ(result, 18364758544493064720.0);
+            }
+        }
+    }
+
+    TEST(SampleConverterTest, complex_test)
+    {
+        std::vector < Complex32Type > values = { { 1, -1 }, { 2, -2 }, { 3, -3 }, { 4, -4 }, { 5, -5 } };
+        SampleConverter converter;
+        ASSERT_EQ(converter.setElementTypes({ SAMPLETYPE_REAL32, SAMPLETYPE_REAL32 }), 0);
+        ASSERT_EQ(converter.elementCount(), 2u);
+        ASSERT_EQ(converter.valueSize(), sizeof(Complex32Type));
+
+        for (SampleConverter::InstructionSet instructionSet : InstructionSets) {
+            converter.setInstructionSet(instructionSet);
+            std::vector < double > results(2 * values.size());
+            ASSERT_EQ(converter.convert(reinterpret_cast < const uint8_t* > (values.data()), values.size(), results.data()), results.size());
+            for (size_t valueIndex = 0; valueIndex < values.size(); ++valueIndex) {
+                ASSERT_EQ(results[2 * valueIndex], values[valueIndex].real);
+                ASSERT_EQ(results[2 * valueIndex + 1], values[valueIndex].imag);
+            }
+        }
+    }
+
+#pragma pack(push, 1)
+    struct Member
+    {
+        int16_t status;
+        double amplitude;
+    };
+#pragma pack(pop)
+
+    TEST(SampleConverterTest, indexed_struct_test)
+    {
+        std::vector < IndexedValue < Member > > values;
+        for (uint64_t valueIndex = 0; valueIndex < 9; ++valueIndex) {
+            IndexedValue < Member > value;
+            value.index = valueIndex * 10;
+            value.value.status = static_cast < int16_t > (-100 * static_cast < int > (valueIndex));
+            value.value.amplitude = 0.5 * static_cast < double > (valueIndex);
+            values.push_back(value);
+        }
+
+        PostScaling postScaling;
+        postScaling.scale = 2;
+        postScaling.offset = 1;
+
+        SampleConverter converter;
+        ASSERT_EQ(converter.setElementTypes({ SAMPLETYPE_S16, SAMPLETYPE_REAL64 }), 0);
+        converter.setIndexed(true);
+        converter.setPostScaling(postScaling);
+        ASSERT_EQ(converter.valueSize(), sizeof(IndexedValue < Member >));
+
+        for (SampleConverter::InstructionSet instructionSet : InstructionSets) {
+            converter.setInstructionSet(instructionSet);
+            std::vector < float > results(2 * values.size());
+            std::vector < uint64_t > valueIndices(values.size());
+            ASSERT_EQ(converter.convert(reinterpret_cast < const uint8_t* > (values.data()), values.size(), results.data(), SampleConverter::OPTION_POSTSCALING, valueIndices.data()), results.size());
+            for (size_t valueIndex = 0; valueIndex < values.size(); ++valueIndex) {
+                ASSERT_EQ(valueIndices[valueIndex], values[valueIndex].index);
+                ASSERT_EQ(results[2 * valueIndex], 2 * values[valueIndex].value.status + 1);
+                ASSERT_EQ(results[2 * valueIndex + 1], static_cast < float > (2 * values[valueIndex].value.amplitude + 1));
+            }
+        }
+    }
+
+    TEST(SampleConverterTest, invalid_element_type_test)
+    {
+        SampleConverter converter;
+        uint8_t data[8] = {};
+        double result;
+        ASSERT_EQ(converter.elementCount(), 0u);
+        ASSERT_EQ(converter.convert(data, 1, &result), 0u);
+
+        ASSERT_EQ(converter.setElementTypes({ SAMPLETYPE_S32 }), 0);
+        ASSERT_EQ(converter.setElementTypes({ SAMPLETYPE_S32, SAMPLETYPE_STRUCT }), -1);
+        ASSERT_EQ(converter.setElementTypes({ SAMPLETYPE_COMPLEX64 }), -1);
+        // previous layout is kept
+        ASSERT_EQ(converter.elementCount(), 1u);
+        ASSERT_EQ(converter.valueSize(), sizeof(int32_t));
+    }
+
+    TEST(SampleConverterTest, instruction_set_test)
+    {
+        SampleConverter converter;
+        ASSERT_EQ(converter.instructionSet(), SampleConverter::supportedInstructionSet());
+        converter.setInstructionSet(SampleConverter::INSTRUCTIONSET_SCALAR);
+        ASSERT_EQ(converter.instructionSet(), SampleConverter::INSTRUCTIONSET_SCALAR);
+        converter.setInstructionSet(SampleConverter::INSTRUCTIONSET_AVX2);
+        ASSERT_EQ(converter.instructionSet(), SampleConverter::supportedInstructionSet());
+    }
+}
@@ -14,10 +14,16 @@
  * limitations under the License.
  */
 
+#include <chrono>
+#include <functional>
+#include <memory>
 #include <thread>
+#include <vector>
 #include <gtest/gtest.h>
 
+#include "boost/asio/executor_work_guard.hpp"
 #include "boost/asio/io_context.hpp"
+#include "boost/asio/ip/tcp.hpp"
 
 #include "stream/WebsocketClientStream.hpp"
 
@@ -114,4 +120,166 @@ namespace daq::streaming_protocol {
         ioc.run();
         ASSERT_EQ(result, boost::system::error_code());
     }
+
+    /// Waits until the condition is met or a timeout occurred
+    static bool waitFor(const std::function < bool() >& condition)
+    {
+        auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > timeout) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    TEST(ServerTest, threadPoolRoundRobin)
+    {
+        unsigned int listeningPort = 5001;
+        static const size_t threadCount = 2;
+        static const size_t clientCount = 4;
+        boost::asio::io_context acceptorIoc;
+        auto work = boost::asio::make_work_guard(acceptorIoc);
+        Server server(acceptorIoc, listeningPort, threadCount, Server::SESSIONDISTRIBUTION_ROUNDROBIN, logCallback);
+        ASSERT_EQ(server.threadCount(), threadCount);
+        ASSERT_EQ(server.start(), 0);
+        std::thread acceptorThread([&acceptorIoc]() { acceptorIoc.run(); });
+
+        boost::asio::io_context clientIoc;
+        std::vector < std::unique_ptr < stream::WebsocketClientStream > > clients;
+        for (size_t clientIndex = 0; clientIndex < clientCount; ++clientIndex) {
+            clients.emplace_back(std::make_unique < stream::WebsocketClientStream > (clientIoc, "localhost", std::to_string(listeningPort), "/"));
+            ASSERT_EQ(clients.back()->init(), boost::system::error_code());
+        }
+
+        EXPECT_TRUE(waitFor([&server]() { return server.sessionCount() == clientCount; }));
+        EXPECT_EQ(server.sessionCount(0), clientCount / threadCount);
+        EXPECT_EQ(server.sessionCount(1), clientCount / threadCount);
+
+        // the server notices the disconnect of a client
+        clients.back()->close();
+        EXPECT_TRUE(waitFor([&server]() { return server.sessionCount() == clientCount - 1; }));
+
+        server.stop();
+        EXPECT_EQ(server.sessionCount(), 0);
+        work.reset();
+        acceptorThread.join();
+    }
+
+    TEST(ServerTest, threadPoolAcceptedClient)
+    {
+        unsigned int listeningPort = 5005;
+        boost::asio::io_context acceptorIoc;
+        auto work = boost::asio::make_work_guard(acceptorIoc);
+        Server server(acceptorIoc, listeningPort, 1, Server::SESSIONDISTRIBUTION_ROUNDROBIN, logCallback);
+        ASSERT_EQ(server.start(), 0);
+        std::thread acceptorThread([&acceptorIoc]() { acceptorIoc.run(); });
+
+        boost::asio::io_context clientIoc;
+        stream::WebsocketClientStream client(clientIoc, "localhost", std::to_string(listeningPort), "/");
+        ASSERT_EQ(client.init(), boost::system::error_code());
+        EXPECT_TRUE(waitFor([&server]() { return server.sessionCount(0) == 1; }));
+
+        // the session processed on the thread of the pool closes the accepted socket
+        server.stop();
+        boost::system::error_code ec;
+        std::size_t bytesRead;
+        do {
+            bytesRead = client.readSome(ec);
+            client.consume(bytesRead);
+        } while (!ec);
+        EXPECT_EQ(ec, boost::beast::websocket::error::closed);
+        EXPECT_TRUE(waitFor([&server]() { return server.sessionCount() == 0; }));
+
+        work.reset();
+        acceptorThread.join();
+    }
+
+    TEST(ServerTest, threadPoolLeastLoaded)
+    {
+        unsigned int listeningPort = 5002;
+        boost::asio::io_context acceptorIoc;
+        auto work = boost::asio::make_work_guard(acceptorIoc);
+        Server server(acceptorIoc, listeningPort, 2, Server::SESSIONDISTRIBUTION_LEASTLOADED, logCallback);
+        ASSERT_EQ(server.start(), 0);
+        std::thread acceptorThread([&acceptorIoc]() { acceptorIoc.run(); });
+
+        boost::asio::io_context clientIoc;
+        stream::WebsocketClientStream first(clientIoc, "localhost", std::to_string(listeningPort), "/");
+        stream::WebsocketClientStream second(clientIoc, "localhost", std::to_string(listeningPort), "/");
+        stream::WebsocketClientStream third(clientIoc, "localhost", std::to_string(listeningPort), "/");
+        ASSERT_EQ(first.init(), boost::system::error_code());
+        EXPECT_TRUE(waitFor([&server]() { return server.sessionCount() == 1; }));
+        ASSERT_EQ(second.init(), boost::system::error_code());
+        EXPECT_TRUE(waitFor([&server]() { return server.sessionCount() == 2; }));
+
+        // the thread of the first client becomes the least loaded one and gets the third client
+        first.close();
+        EXPECT_TRUE(waitFor([&server]() { return server.sessionCount() == 1; }));
+        ASSERT_EQ(third.init(), boost::system::error_code());
+        EXPECT_TRUE(waitFor([&server]() { return server.sessionCount() == 2; }));
+        EXPECT_EQ(server.sessionCount(0), 1);
+        EXPECT_EQ(server.sessionCount(1), 1);
+
+        server.stop();
+        work.reset();
+        acceptorThread.join();
+    }
+    TEST(ServerTest, threadPoolPendingHandshake)
+    {
+        unsigned int listeningPort = 5003;
+        boost::asio::io_context acceptorIoc;
+        auto work = boost::asio::make_work_guard(acceptorIoc);
+        Server server(acceptorIoc, listeningPort, 2, Server::SESSIONDISTRIBUTION_LEASTLOADED, logCallback);
+        ASSERT_EQ(server.start(), 0);
+        std::thread acceptorThread([&acceptorIoc]() { acceptorIoc.run(); });
+
+        // clients that never do the websocket handshake
+        boost::asio::io_context clientIoc;
+        boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), listeningPort);
+        boost::asio::ip::tcp::socket first(clientIoc);
+        boost::asio::ip::tcp::socket second(clientIoc);
+        first.connect(endpoint);
+        second.connect(endpoint);
+
+        // the shard is loaded as soon as it is chosen
+        EXPECT_TRUE(waitFor([&server]() { return server.sessionCount() == 2; }));
+        EXPECT_EQ(server.sessionCount(0), 1);
+        EXPECT_EQ(server.sessionCount(1), 1);
+
+        // failed handshakes are not counted anymore
+        first.close();
+        second.close();
+        EXPECT_TRUE(waitFor([&server]() { return server.sessionCount() == 0; }));
+
+        server.stop();
+        work.reset();
+        acceptorThread.join();
+    }
+
+    TEST(ServerTest, threadPoolRestart)
+    {
+        unsigned int listeningPort = 5004;
+        boost::asio::io_context acceptorIoc;
+        auto work = boost::asio::make_work_guard(acceptorIoc);
+        Server server(acceptorIoc, listeningPort, 2, Server::SESSIONDISTRIBUTION_ROUNDROBIN, logCallback);
+        std::thread acceptorThread([&acceptorIoc]() { acceptorIoc.run(); });
+
+        boost::asio::io_context clientIoc;
+        for (unsigned int run = 0; run < 2; ++run) {
+            ASSERT_EQ(server.start(), 0);
+            stream::WebsocketClientStream client(clientIoc, "localhost", std::to_string(listeningPort), "/");
+            ASSERT_EQ(client.init(), boost::system::error_code());
+            EXPECT_TRUE(waitFor([&server]() { return server.sessionCount() == 1; }));
+            server.stop();
+            // a session might still finish its websocket handshake
+            EXPECT_TRUE(waitFor([&server]() { return server.sessionCount() == 0; }));
+            // let the threads of the pool run out of work
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+
+        work.reset();
+        acceptorThread.join();
+    }
 }
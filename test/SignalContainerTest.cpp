@@ -14,10 +14,16 @@
  * limitations under the License.
  */
 
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <gtest/gtest.h>
 
 #include "nlohmann/json.hpp"
 
+#include "../include/streaming_protocol/BasicSignalContainer.hpp"
 #include "../include/streaming_protocol/Defines.h"
 #include "../include/streaming_protocol/MetaInformation.hpp"
 #include "../include/streaming_protocol/SignalContainer.hpp"
@@ -849,4 +855,749 @@ namespace daq::streaming_protocol {
             ASSERT_EQ(result, 0);
         }
     }
+
+    TEST(SignalContainerTest, routing_test)
+    {
+        uint64_t timestamp = 222;
+        double measuredValue = 20;
+        ssize_t result;
+        SignalContainer signalContainer(logCallback);
+        std::vector < uint8_t > payload;
+        MetaInformation metaInformation(logCallback);
+
+        signalContainer.setDataAsRawCb(dataAsRawCb);
+
+        // signal numbers beyond the highest subscribed one are unknown
+        result = signalContainer.processMeasuredData(SIGNAL_NUMBER_MASK, reinterpret_cast< const uint8_t* >(&measuredValue), sizeof(measuredValue));
+        ASSERT_EQ(result, -1);
+
+        payload = nlohmann::json::to_msgpack(s_subscribeAckDataSignalDoc);
+        metaInformation = creataMetaInformation(payload);
+        signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation);
+        payload = nlohmann::json::to_msgpack(s_subscribeAckTimeSignalDoc);
+        metaInformation = creataMetaInformation(payload);
+        signalContainer.processMetaInformation(s_timeSignalNumber, metaInformation);
+        payload = nlohmann::json::to_msgpack(s_dataDoubleSignalMetaInformationDoc);
+        metaInformation = creataMetaInformation(payload);
+        signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation);
+        payload = nlohmann::json::to_msgpack(s_explicitOpenDAQTimeSignalMetaInformationDoc);
+        metaInformation = creataMetaInformation(payload);
+        signalContainer.processMetaInformation(s_timeSignalNumber, metaInformation);
+
+        result = signalContainer.processMeasuredData(s_timeSignalNumber, reinterpret_cast< const uint8_t* >(&timestamp), sizeof(timestamp));
+        ASSERT_EQ(result, sizeof(timestamp));
+        result = signalContainer.processMeasuredData(s_dataSignalNumber, reinterpret_cast< const uint8_t* >(&measuredValue), sizeof(measuredValue));
+        ASSERT_EQ(result, sizeof(measuredValue));
+        ASSERT_EQ(s_measuredTimeSignalNumber, s_timeSignalNumber);
+
+        // without time signal, data of the table can not be processed
+        payload = nlohmann::json::to_msgpack(s_unsubscribeAckDoc);
+        metaInformation = creataMetaInformation(payload);
+        result = signalContainer.processMetaInformation(s_timeSignalNumber, metaInformation);
+        ASSERT_EQ(result, 0);
+        result = signalContainer.processMeasuredData(s_timeSignalNumber, reinterpret_cast< const uint8_t* >(&timestamp), sizeof(timestamp));
+        ASSERT_EQ(result, -1);
+        result = signalContainer.processMeasuredData(s_dataSignalNumber, reinterpret_cast< const uint8_t* >(&measuredValue), sizeof(measuredValue));
+        ASSERT_EQ(result, -1);
+
+        // the time signal comes back with another signal number
+        static const unsigned int otherTimeSignalNumber = 1000;
+        payload = nlohmann::json::to_msgpack(s_subscribeAckTimeSignalDoc);
+        metaInformation = creataMetaInformation(payload);
+        signalContainer.processMetaInformation(otherTimeSignalNumber, metaInformation);
+        payload = nlohmann::json::to_msgpack(s_explicitOpenDAQTimeSignalMetaInformationDoc);
+        metaInformation = creataMetaInformation(payload);
+        signalContainer.processMetaInformation(otherTimeSignalNumber, metaInformation);
+
+        result = signalContainer.processMeasuredData(otherTimeSignalNumber, reinterpret_cast< const uint8_t* >(&timestamp), sizeof(timestamp));
+        ASSERT_EQ(result, sizeof(timestamp));
+        result = signalContainer.processMeasuredData(s_dataSignalNumber, reinterpret_cast< const uint8_t* >(&measuredValue), sizeof(measuredValue));
+        ASSERT_EQ(result, sizeof(measuredValue));
+        ASSERT_EQ(s_measuredTimeSignalNumber, otherTimeSignalNumber);
+        ASSERT_EQ(s_measuredRawDataTimestamp, timestamp);
+    }
+
+    TEST(SignalContainerTest, sparse_routing_test)
+    {
+        static const unsigned int dataSignalNumber = SIGNAL_NUMBER_MASK - 1;
+        static const unsigned int timeSignalNumber = SIGNAL_NUMBER_MASK;
+        static const unsigned int otherTimeSignalNumber = 5;
+        uint64_t timestamp = 222;
+        double measuredValue = 20;
+        ssize_t result;
+        SignalContainer signalContainer(logCallback);
+        std::vector < uint8_t > payload;
+        MetaInformation metaInformation(logCallback);
+
+        signalContainer.setDataAsRawCb(dataAsRawCb);
+
+        // large signal numbers are routed as well
+        payload = nlohmann::json::to_msgpack(s_subscribeAckDataSignalDoc);
+        metaInformation = creataMetaInformation(payload);
+        ASSERT_EQ(signalContainer.processMetaInformation(dataSignalNumber, metaInformation), 0);
+        payload = nlohmann::json::to_msgpack(s_subscribeAckTimeSignalDoc);
+        metaInformation = creataMetaInformation(payload);
+        ASSERT_EQ(signalContainer.processMetaInformation(timeSignalNumber, metaInformation), 0);
+        payload = nlohmann::json::to_msgpack(s_dataDoubleSignalMetaInformationDoc);
+        metaInformation = creataMetaInformation(payload);
+        ASSERT_EQ(signalContainer.processMetaInformation(dataSignalNumber, metaInformation), 0);
+        payload = nlohmann::json::to_msgpack(s_explicitOpenDAQTimeSignalMetaInformationDoc);
+        metaInformation = creataMetaInformation(payload);
+        ASSERT_EQ(signalContainer.processMetaInformation(timeSignalNumber, metaInformation), 0);
+
+        result = signalContainer.processMeasuredData(timeSignalNumber, reinterpret_cast< const uint8_t* >(&timestamp), sizeof(timestamp));
+        ASSERT_EQ(result, sizeof(timestamp));
+        result = signalContainer.processMeasuredData(dataSignalNumber, reinterpret_cast< const uint8_t* >(&measuredValue), sizeof(measuredValue));
+        ASSERT_EQ(result, sizeof(measuredValue));
+        ASSERT_EQ(s_measuredTimeSignalNumber, timeSignalNumber);
+        ASSERT_EQ(s_measuredRawDataTimestamp, timestamp);
+        result = signalContainer.processMeasuredData(SIGNAL_NUMBER_MASK - 2, reinterpret_cast< const uint8_t* >(&measuredValue), sizeof(measuredValue));
+        ASSERT_EQ(result, -1);
+
+        // the data signal moves to the table of another time signal
+        payload = nlohmann::json::to_msgpack(s_subscribeAckTimeSignalDoc);
+        metaInformation = creataMetaInformation(payload);
+        ASSERT_EQ(signalContainer.processMetaInformation(otherTimeSignalNumber, metaInformation), 0);
+        nlohmann::json otherTimeSignal = s_explicitOpenDAQTimeSignalMetaInformationDoc;
+        otherTimeSignal[PARAMS][META_TABLEID] = "otherTable";
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(otherTimeSignal));
+        ASSERT_EQ(signalContainer.processMetaInformation(otherTimeSignalNumber, metaInformation), 0);
+        nlohmann::json movedDataSignal = s_dataDoubleSignalMetaInformationDoc;
+        movedDataSignal[PARAMS][META_TABLEID] = "otherTable";
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(movedDataSignal));
+        ASSERT_EQ(signalContainer.processMetaInformation(dataSignalNumber, metaInformation), 0);
+
+        // the time signal of the old table has no data signal left, unsubscribing it does not affect the moved signal
+        payload = nlohmann::json::to_msgpack(s_unsubscribeAckDoc);
+        metaInformation = creataMetaInformation(payload);
+        ASSERT_EQ(signalContainer.processMetaInformation(timeSignalNumber, metaInformation), 0);
+        result = signalContainer.processMeasuredData(timeSignalNumber, reinterpret_cast< const uint8_t* >(&timestamp), sizeof(timestamp));
+        ASSERT_EQ(result, -1);
+
+        timestamp = 333;
+        result = signalContainer.processMeasuredData(otherTimeSignalNumber, reinterpret_cast< const uint8_t* >(&timestamp), sizeof(timestamp));
+        ASSERT_EQ(result, sizeof(timestamp));
+        result = signalContainer.processMeasuredData(dataSignalNumber, reinterpret_cast< const uint8_t* >(&measuredValue), sizeof(measuredValue));
+        ASSERT_EQ(result, sizeof(measuredValue));
+        ASSERT_EQ(s_measuredTimeSignalNumber, otherTimeSignalNumber);
+        ASSERT_EQ(s_measuredRawDataTimestamp, timestamp);
+    }
+
+    TEST(SignalContainerTest, sharded_measured_data_test)
+    {
+        static const size_t tableCount = 4;
+        static const size_t packageCount = 1000;
+        static const size_t valuesPerPackage = 10;
+
+        struct Received
+        {
+            std::vector < int32_t > values;
+            std::vector < uint64_t > timeStamps;
+            std::set < std::thread::id > threads;
+        };
+        std::mutex mutex;
+        std::map < SignalNumber, Received > received;
+        std::vector < std::string > subscribedSignalIds;
+
+        auto dataAsValueCb = [&](const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t valueCount)
+        {
+            std::lock_guard < std::mutex > lock(mutex);
+            Received& signalReceived = received[subscribedSignal.signalNumber()];
+            const int32_t* values = reinterpret_cast < const int32_t* > (data);
+            signalReceived.values.insert(signalReceived.values.end(), values, values + valueCount);
+            signalReceived.timeStamps.push_back(timeStamp);
+            signalReceived.threads.insert(std::this_thread::get_id());
+        };
+
+        auto signalMetaCb = [&](const SubscribedSignal& subscribedSignal, const std::string& method, const nlohmann::json& params)
+        {
+            std::lock_guard < std::mutex > lock(mutex);
+            if (method == META_METHOD_SUBSCRIBE) {
+                subscribedSignalIds.push_back(subscribedSignal.signalId());
+            }
+        };
+
+        SignalContainer signalContainer(logCallback);
+        ASSERT_EQ(signalContainer.shardCount(), 0);
+        signalContainer.setDataAsValueCb(dataAsValueCb);
+        signalContainer.setSignalMetaCb(signalMetaCb);
+        ASSERT_EQ(signalContainer.startShards(0), -1);
+        ASSERT_EQ(signalContainer.startShards(3), 0);
+        ASSERT_EQ(signalContainer.startShards(3), -1);
+        ASSERT_EQ(signalContainer.shardCount(), 3);
+
+        auto dataSignalNumber = [](size_t tableIndex) { return static_cast < SignalNumber > (2 * tableIndex + 1); };
+        auto timeSignalNumber = [](size_t tableIndex) { return static_cast < SignalNumber > (2 * tableIndex + 2); };
+
+        MetaInformation metaInformation(logCallback);
+        for (size_t tableIndex = 0; tableIndex < tableCount; ++tableIndex) {
+            std::string tableId = "table" + std::to_string(tableIndex);
+            nlohmann::json subscribeAck = s_subscribeAckDataSignalDoc;
+            subscribeAck[PARAMS][META_SIGNALID] = "data" + std::to_string(tableIndex);
+            metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(subscribeAck));
+            ASSERT_EQ(signalContainer.processMetaInformation(dataSignalNumber(tableIndex), metaInformation), 0);
+
+            subscribeAck[PARAMS][META_SIGNALID] = "time" + std::to_string(tableIndex);
+            metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(subscribeAck));
+            ASSERT_EQ(signalContainer.processMetaInformation(timeSignalNumber(tableIndex), metaInformation), 0);
+
+            // data for a signal that is not yet assigned to a table is rejected
+            int32_t value = 0;
+            ASSERT_EQ(signalContainer.processMeasuredData(dataSignalNumber(tableIndex), reinterpret_cast < const uint8_t* > (&value), sizeof(value)), -1);
+
+            nlohmann::json dataSignal = s_dataInt32SignalMetaInformationDoc;
+            dataSignal[PARAMS][META_TABLEID] = tableId;
+            metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(dataSignal));
+            ASSERT_EQ(signalContainer.processMetaInformation(dataSignalNumber(tableIndex), metaInformation), 0);
+
+            nlohmann::json timeSignal = s_linearOpenDAQTimeSignalMetaInformationDoc;
+            timeSignal[PARAMS][META_TABLEID] = tableId;
+            metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(timeSignal));
+            ASSERT_EQ(signalContainer.processMetaInformation(timeSignalNumber(tableIndex), metaInformation), 0);
+
+            IndexedValue < uint64_t > startTime;
+            startTime.index = 0;
+            startTime.value = 1000 * tableIndex;
+            ASSERT_EQ(signalContainer.processMeasuredData(timeSignalNumber(tableIndex), reinterpret_cast < const uint8_t* > (&startTime), sizeof(startTime)), sizeof(startTime));
+        }
+
+        // packages of all tables are interleaved
+        std::vector < int32_t > values(valuesPerPackage);
+        for (size_t packageIndex = 0; packageIndex < packageCount; ++packageIndex) {
+            for (size_t tableIndex = 0; tableIndex < tableCount; ++tableIndex) {
+                for (size_t valueIndex = 0; valueIndex < valuesPerPackage; ++valueIndex) {
+                    values[valueIndex] = static_cast < int32_t > (packageIndex * valuesPerPackage + valueIndex);
+                }
+                ssize_t result = signalContainer.processMeasuredData(dataSignalNumber(tableIndex), reinterpret_cast < const uint8_t* > (values.data()), values.size() * sizeof(int32_t));
+                ASSERT_EQ(result, values.size() * sizeof(int32_t));
+            }
+        }
+
+        // unsubscribe of the first table
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_unsubscribeAckDoc));
+        ASSERT_EQ(signalContainer.processMetaInformation(dataSignalNumber(0), metaInformation), 0);
+        ASSERT_EQ(signalContainer.processMeasuredData(dataSignalNumber(0), reinterpret_cast < const uint8_t* > (values.data()), sizeof(int32_t)), -1);
+
+        // processes everything queued
+        signalContainer.stopShards();
+        ASSERT_EQ(signalContainer.shardCount(), 0);
+
+        ASSERT_EQ(subscribedSignalIds.size(), 2 * tableCount);
+        ASSERT_EQ(received.size(), tableCount);
+        for (size_t tableIndex = 0; tableIndex < tableCount; ++tableIndex) {
+            const Received& signalReceived = received[dataSignalNumber(tableIndex)];
+            // each table is processed by one shard
+            ASSERT_EQ(signalReceived.threads.size(), 1);
+            ASSERT_NE(*signalReceived.threads.begin(), std::this_thread::get_id());
+            // order within the table is preserved
+            ASSERT_EQ(signalReceived.values.size(), packageCount * valuesPerPackage);
+            for (size_t valueIndex = 0; valueIndex < signalReceived.values.size(); ++valueIndex) {
+                ASSERT_EQ(signalReceived.values[valueIndex], static_cast < int32_t > (valueIndex));
+            }
+            ASSERT_EQ(signalReceived.timeStamps.size(), packageCount);
+            for (size_t packageIndex = 0; packageIndex < packageCount; ++packageIndex) {
+                ASSERT_EQ(signalReceived.timeStamps[packageIndex], 1000 * tableIndex + packageIndex * valuesPerPackage);
+            }
+        }
+    }
+
+    TEST(SignalContainerTest, sharded_table_assignment_test)
+    {
+        static const size_t tableCount = 3;
+        static const size_t valuesPerPackage = 10;
+
+        std::mutex mutex;
+        std::map < SignalNumber, std::vector < std::thread::id > > receivingThreads;
+        std::map < SignalNumber, std::vector < int32_t > > received;
+        std::vector < std::string > methods;
+
+        auto dataAsValueCb = [&](const SubscribedSignal& subscribedSignal, uint64_t, const uint8_t* data, size_t valueCount)
+        {
+            if ((subscribedSignal.signalNumber() == 2 * tableCount - 1) && (*reinterpret_cast < const int32_t* > (data) == 0)) {
+                // the old shard is still busy with the moving signal while the new one gets its packages
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+            std::lock_guard < std::mutex > lock(mutex);
+            const int32_t* values = reinterpret_cast < const int32_t* > (data);
+            std::vector < int32_t >& signalReceived = received[subscribedSignal.signalNumber()];
+            signalReceived.insert(signalReceived.end(), values, values + valueCount);
+            receivingThreads[subscribedSignal.signalNumber()].push_back(std::this_thread::get_id());
+        };
+
+        auto signalMetaCb = [&](const SubscribedSignal&, const std::string& method, const nlohmann::json&)
+        {
+            std::lock_guard < std::mutex > lock(mutex);
+            methods.push_back(method);
+        };
+
+        SignalContainer signalContainer(logCallback);
+        signalContainer.setDataAsValueCb(dataAsValueCb);
+        signalContainer.setSignalMetaCb(signalMetaCb);
+        // tiny queues make the producer wait for free slots
+        ASSERT_EQ(signalContainer.startShards(tableCount, 2), 0);
+
+        auto dataSignalNumber = [](size_t tableIndex) { return static_cast < SignalNumber > (2 * tableIndex + 1); };
+        auto timeSignalNumber = [](size_t tableIndex) { return static_cast < SignalNumber > (2 * tableIndex + 2); };
+
+        MetaInformation metaInformation(logCallback);
+        auto announceDataSignal = [&](SignalNumber signalNumber, const std::string& tableId)
+        {
+            nlohmann::json dataSignal = s_dataInt32SignalMetaInformationDoc;
+            dataSignal[PARAMS][META_TABLEID] = tableId;
+            metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(dataSignal));
+            return signalContainer.processMetaInformation(signalNumber, metaInformation);
+        };
+
+        for (size_t tableIndex = 0; tableIndex < tableCount; ++tableIndex) {
+            std::string tableId = "table" + std::to_string(tableIndex);
+            nlohmann::json subscribeAck = s_subscribeAckDataSignalDoc;
+            subscribeAck[PARAMS][META_SIGNALID] = "data" + std::to_string(tableIndex);
+            metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(subscribeAck));
+            ASSERT_EQ(signalContainer.processMetaInformation(dataSignalNumber(tableIndex), metaInformation), 0);
+            subscribeAck[PARAMS][META_SIGNALID] = "time" + std::to_string(tableIndex);
+            metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(subscribeAck));
+            ASSERT_EQ(signalContainer.processMetaInformation(timeSignalNumber(tableIndex), metaInformation), 0);
+
+            ASSERT_EQ(announceDataSignal(dataSignalNumber(tableIndex), tableId), 0);
+            nlohmann::json timeSignal = s_linearOpenDAQTimeSignalMetaInformationDoc;
+            timeSignal[PARAMS][META_TABLEID] = tableId;
+            metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(timeSignal));
+            ASSERT_EQ(signalContainer.processMetaInformation(timeSignalNumber(tableIndex), metaInformation), 0);
+        }
+
+        std::vector < int32_t > values(valuesPerPackage);
+        auto sendValues = [&](SignalNumber signalNumber, int32_t firstValue)
+        {
+            for (size_t valueIndex = 0; valueIndex < valuesPerPackage; ++valueIndex) {
+                values[valueIndex] = firstValue + static_cast < int32_t > (valueIndex);
+            }
+            return signalContainer.processMeasuredData(signalNumber, reinterpret_cast < const uint8_t* > (values.data()), values.size() * sizeof(int32_t));
+        };
+
+        for (size_t tableIndex = 0; tableIndex < tableCount; ++tableIndex) {
+            ASSERT_EQ(sendValues(dataSignalNumber(tableIndex), 0), values.size() * sizeof(int32_t));
+        }
+
+        // the last data signal moves to the table of the first one
+        ASSERT_EQ(announceDataSignal(dataSignalNumber(tableCount - 1), "table0"), 0);
+        ASSERT_EQ(sendValues(dataSignalNumber(tableCount - 1), valuesPerPackage), values.size() * sizeof(int32_t));
+        ASSERT_EQ(sendValues(dataSignalNumber(0), valuesPerPackage), values.size() * sizeof(int32_t));
+
+        signalContainer.stopShards();
+
+        // each table got a shard of its own
+        std::set < std::thread::id > tableThreads;
+        for (size_t tableIndex = 0; tableIndex < tableCount; ++tableIndex) {
+            tableThreads.insert(receivingThreads[dataSignalNumber(tableIndex)].front());
+        }
+        ASSERT_EQ(tableThreads.size(), tableCount);
+
+        // after the move, the signal is processed by the shard of its new table
+        const std::vector < std::thread::id >& movedThreads = receivingThreads[dataSignalNumber(tableCount - 1)];
+        ASSERT_EQ(movedThreads.size(), 2);
+        ASSERT_EQ(movedThreads.back(), receivingThreads[dataSignalNumber(0)].front());
+        const std::vector < int32_t >& movedValues = received[dataSignalNumber(tableCount - 1)];
+        ASSERT_EQ(movedValues.size(), 2 * valuesPerPackage);
+        for (size_t valueIndex = 0; valueIndex < movedValues.size(); ++valueIndex) {
+            ASSERT_EQ(movedValues[valueIndex], static_cast < int32_t > (valueIndex));
+        }
+
+        // moving between shards is not noticed by the application
+        ASSERT_EQ(std::count(methods.begin(), methods.end(), META_METHOD_SUBSCRIBE), 2 * tableCount);
+        ASSERT_EQ(std::count(methods.begin(), methods.end(), META_METHOD_UNSUBSCRIBE), 0);
+    }
+
+    TEST(SignalContainerTest, sharded_partial_table_change_test)
+    {
+        static const size_t tableCount = 2;
+        static const size_t valuesPerPackage = 10;
+
+        std::mutex mutex;
+        std::vector < int32_t > received;
+        std::vector < uint64_t > timeStamps;
+        std::vector < std::thread::id > receivingThreads;
+        std::map < SignalNumber, std::thread::id > tableThreads;
+        std::vector < std::string > methods;
+
+        auto dataAsValueCb = [&](const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t valueCount)
+        {
+            std::lock_guard < std::mutex > lock(mutex);
+            tableThreads.emplace(subscribedSignal.signalNumber(), std::this_thread::get_id());
+            if (subscribedSignal.signalNumber() != 3) {
+                return;
+            }
+            const int32_t* values = reinterpret_cast < const int32_t* > (data);
+            received.insert(received.end(), values, values + valueCount);
+            timeStamps.push_back(timeStamp);
+            receivingThreads.push_back(std::this_thread::get_id());
+        };
+
+        auto signalMetaCb = [&](const SubscribedSignal& subscribedSignal, const std::string& method, const nlohmann::json&)
+        {
+            std::lock_guard < std::mutex > lock(mutex);
+            if (subscribedSignal.signalNumber() == 3) {
+                methods.push_back(method);
+            }
+        };
+
+        SignalContainer signalContainer(logCallback);
+        signalContainer.setDataAsValueCb(dataAsValueCb);
+        signalContainer.setSignalMetaCb(signalMetaCb);
+        ASSERT_EQ(signalContainer.startShards(tableCount), 0);
+
+        auto dataSignalNumber = [](size_t tableIndex) { return static_cast < SignalNumber > (2 * tableIndex + 1); };
+        auto timeSignalNumber = [](size_t tableIndex) { return static_cast < SignalNumber > (2 * tableIndex + 2); };
+
+        MetaInformation metaInformation(logCallback);
+        for (size_t tableIndex = 0; tableIndex < tableCount; ++tableIndex) {
+            std::string tableId = "table" + std::to_string(tableIndex);
+            nlohmann::json subscribeAck = s_subscribeAckDataSignalDoc;
+            subscribeAck[PARAMS][META_SIGNALID] = "data" + std::to_string(tableIndex);
+            metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(subscribeAck));
+            ASSERT_EQ(signalContainer.processMetaInformation(dataSignalNumber(tableIndex), metaInformation), 0);
+            subscribeAck[PARAMS][META_SIGNALID] = "time" + std::to_string(tableIndex);
+            metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(subscribeAck));
+            ASSERT_EQ(signalContainer.processMetaInformation(timeSignalNumber(tableIndex), metaInformation), 0);
+
+            nlohmann::json dataSignal = s_dataInt32SignalMetaInformationDoc;
+            dataSignal[PARAMS][META_TABLEID] = tableId;
+            metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(dataSignal));
+            ASSERT_EQ(signalContainer.processMetaInformation(dataSignalNumber(tableIndex), metaInformation), 0);
+            nlohmann::json timeSignal = s_linearOpenDAQTimeSignalMetaInformationDoc;
+            timeSignal[PARAMS][META_TABLEID] = tableId;
+            metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(timeSignal));
+            ASSERT_EQ(signalContainer.processMetaInformation(timeSignalNumber(tableIndex), metaInformation), 0);
+
+            IndexedValue < uint64_t > startTime;
+            startTime.index = 0;
+            startTime.value = 1000 * tableIndex;
+            ASSERT_EQ(signalContainer.processMeasuredData(timeSignalNumber(tableIndex), reinterpret_cast < const uint8_t* > (&startTime), sizeof(startTime)), sizeof(startTime));
+        }
+
+        std::vector < int32_t > values(valuesPerPackage);
+        auto sendValues = [&](SignalNumber signalNumber, int32_t firstValue)
+        {
+            for (size_t valueIndex = 0; valueIndex < valuesPerPackage; ++valueIndex) {
+                values[valueIndex] = firstValue + static_cast < int32_t > (valueIndex);
+            }
+            return signalContainer.processMeasuredData(signalNumber, reinterpret_cast < const uint8_t* > (values.data()), values.size() * sizeof(int32_t));
+        };
+
+        ASSERT_EQ(sendValues(dataSignalNumber(0), 0), values.size() * sizeof(int32_t));
+        ASSERT_EQ(sendValues(dataSignalNumber(1), 0), values.size() * sizeof(int32_t));
+
+        // only the table changes. Definition, interpretation and value index of the signal stay as they are.
+        nlohmann::json tableChange;
+        tableChange[METHOD] = META_METHOD_SIGNAL;
+        tableChange[PARAMS][META_TABLEID] = "table0";
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(tableChange));
+        ASSERT_EQ(signalContainer.processMetaInformation(dataSignalNumber(1), metaInformation), 0);
+        ASSERT_EQ(sendValues(dataSignalNumber(1), valuesPerPackage), values.size() * sizeof(int32_t));
+
+        signalContainer.stopShards();
+
+        ASSERT_NE(tableThreads[dataSignalNumber(0)], tableThreads[dataSignalNumber(1)]);
+        ASSERT_EQ(receivingThreads.size(), 2);
+        ASSERT_EQ(receivingThreads.back(), tableThreads[dataSignalNumber(0)]);
+
+        ASSERT_EQ(received.size(), 2 * valuesPerPackage);
+        for (size_t valueIndex = 0; valueIndex < received.size(); ++valueIndex) {
+            ASSERT_EQ(received[valueIndex], static_cast < int32_t > (valueIndex));
+        }
+        // the value index continues, the time comes from the time signal of the new table
+        ASSERT_EQ(timeStamps.size(), 2);
+        ASSERT_EQ(timeStamps.front(), 1000);
+        ASSERT_EQ(timeStamps.back(), valuesPerPackage);
+
+        ASSERT_EQ(methods, std::vector < std::string > ({ META_METHOD_SUBSCRIBE, META_METHOD_SIGNAL, META_METHOD_SIGNAL }));
+    }
+
+    TEST(SignalContainerTest, block_measured_data_test)
+    {
+        static const size_t blockCapacity = 8;
+        static const size_t valuesPerPackage = 3;
+
+        struct Delivery
+        {
+            size_t blockCount;
+            std::vector < int32_t > values;
+            std::vector < uint64_t > timeStamps;
+        };
+        std::vector < Delivery > deliveries;
+        auto dataAsBlocksCb = [&](const SignalBlock* blocks, size_t blockCount)
+        {
+            Delivery delivery;
+            delivery.blockCount = blockCount;
+            for (size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex) {
+                const SignalBlock& block = blocks[blockIndex];
+                ASSERT_EQ(block.signal->signalNumber(), s_dataSignalNumber);
+                ASSERT_EQ(block.valueSize, sizeof(int32_t));
+                const int32_t* values = reinterpret_cast < const int32_t* > (block.data);
+                delivery.values.insert(delivery.values.end(), values, values + block.valueCount);
+                delivery.timeStamps.insert(delivery.timeStamps.end(), block.timeStamps, block.timeStamps + block.valueCount);
+            }
+            deliveries.push_back(delivery);
+        };
+
+        SignalContainer signalContainer(logCallback);
+        ASSERT_EQ(signalContainer.enableBlocks(blockCapacity, std::chrono::hours(1), DataAsBlocksCb()), -1);
+        ASSERT_EQ(signalContainer.enableBlocks(0, std::chrono::hours(1), dataAsBlocksCb), -1);
+        ASSERT_EQ(signalContainer.enableBlocks(blockCapacity, std::chrono::hours(1), dataAsBlocksCb), 0);
+        ASSERT_EQ(signalContainer.enableBlocks(blockCapacity, std::chrono::hours(1), dataAsBlocksCb), -1);
+        ASSERT_EQ(signalContainer.startShards(2), -1);
+
+        MetaInformation metaInformation(logCallback);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_subscribeAckDataSignalDoc));
+        signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_subscribeAckTimeSignalDoc));
+        signalContainer.processMetaInformation(s_timeSignalNumber, metaInformation);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_dataInt32SignalMetaInformationDoc));
+        signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_linearOpenDAQTimeSignalMetaInformationDoc));
+        signalContainer.processMetaInformation(s_timeSignalNumber, metaInformation);
+
+        IndexedValue < uint64_t > startTime;
+        startTime.index = 0;
+        startTime.value = 20;
+        ASSERT_EQ(signalContainer.processMeasuredData(s_timeSignalNumber, reinterpret_cast < const uint8_t* > (&startTime), sizeof(startTime)), sizeof(startTime));
+
+        std::vector < int32_t > values;
+        for (size_t packageIndex = 0; packageIndex < 10; ++packageIndex) {
+            std::vector < int32_t > package;
+            for (size_t valueIndex = 0; valueIndex < valuesPerPackage; ++valueIndex) {
+                package.push_back(static_cast < int32_t > (values.size()));
+                values.push_back(static_cast < int32_t > (values.size()));
+            }
+            ASSERT_EQ(signalContainer.processMeasuredData(s_dataSignalNumber, reinterpret_cast < const uint8_t* > (package.data()), package.size() * sizeof(int32_t)), package.size() * sizeof(int32_t));
+        }
+        // full blocks only, the deadline did not expire yet
+        ASSERT_EQ(deliveries.size(), 3u);
+        signalContainer.pollBlocks();
+        ASSERT_EQ(deliveries.size(), 3u);
+        signalContainer.flushBlocks();
+        ASSERT_EQ(deliveries.size(), 4u);
+        ASSERT_EQ(deliveries.back().values.size(), 10 * valuesPerPackage - 3 * blockCapacity);
+
+        std::vector < int32_t > deliveredValues;
+        std::vector < uint64_t > deliveredTimeStamps;
+        for (const Delivery& delivery : deliveries) {
+            ASSERT_EQ(delivery.blockCount, 1u);
+            deliveredValues.insert(deliveredValues.end(), delivery.values.begin(), delivery.values.end());
+            deliveredTimeStamps.insert(deliveredTimeStamps.end(), delivery.timeStamps.begin(), delivery.timeStamps.end());
+        }
+        ASSERT_EQ(deliveredValues, values);
+        for (size_t valueIndex = 0; valueIndex < deliveredTimeStamps.size(); ++valueIndex) {
+            ASSERT_EQ(deliveredTimeStamps[valueIndex], startTime.value + valueIndex);
+        }
+
+        // pending values are delivered before the signal is unsubscribed
+        deliveries.clear();
+        ASSERT_EQ(signalContainer.processMeasuredData(s_dataSignalNumber, reinterpret_cast < const uint8_t* > (values.data()), sizeof(int32_t)), sizeof(int32_t));
+        ASSERT_TRUE(deliveries.empty());
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_unsubscribeAckDoc));
+        ASSERT_EQ(signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation), 0);
+        ASSERT_EQ(deliveries.size(), 1u);
+        ASSERT_EQ(deliveries.back().values.size(), 1u);
+    }
+
+    /// The deadline does not expire by itself, pending values wait for the next package or pollBlocks()
+    TEST(SignalContainerTest, block_deadline_test)
+    {
+        static const std::chrono::milliseconds maxLatency(20);
+        size_t deliveredValueCount = 0;
+        auto dataAsBlocksCb = [&](const SignalBlock* blocks, size_t blockCount)
+        {
+            for (size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex) {
+                deliveredValueCount += blocks[blockIndex].valueCount;
+            }
+        };
+
+        SignalContainer signalContainer(logCallback);
+        ASSERT_EQ(signalContainer.enableBlocks(100, maxLatency, dataAsBlocksCb), 0);
+        MetaInformation metaInformation(logCallback);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_subscribeAckDataSignalDoc));
+        signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_subscribeAckTimeSignalDoc));
+        signalContainer.processMetaInformation(s_timeSignalNumber, metaInformation);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_dataInt32SignalMetaInformationDoc));
+        signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_linearOpenDAQTimeSignalMetaInformationDoc));
+        signalContainer.processMetaInformation(s_timeSignalNumber, metaInformation);
+        IndexedValue < uint64_t > startTime;
+        startTime.index = 0;
+        startTime.value = 20;
+        signalContainer.processMeasuredData(s_timeSignalNumber, reinterpret_cast < const uint8_t* > (&startTime), sizeof(startTime));
+
+        std::vector < int32_t > values = { 1, 2, 3 };
+        auto start = std::chrono::steady_clock::now();
+        signalContainer.processMeasuredData(s_dataSignalNumber, reinterpret_cast < const uint8_t* > (values.data()), values.size() * sizeof(int32_t));
+        bool beforeDeadline = std::chrono::steady_clock::now() - start < maxLatency;
+
+        // no package arrives, nothing is delivered until polled
+        std::this_thread::sleep_for(2 * maxLatency);
+        if (beforeDeadline) {
+            ASSERT_EQ(deliveredValueCount, 0u);
+        }
+        signalContainer.pollBlocks();
+        ASSERT_EQ(deliveredValueCount, values.size());
+    }
+
+    TEST(SignalContainerTest, block_latency_test)
+    {
+        size_t deliveredValueCount = 0;
+        auto dataAsBlocksCb = [&](const SignalBlock* blocks, size_t blockCount)
+        {
+            for (size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex) {
+                deliveredValueCount += blocks[blockIndex].valueCount;
+            }
+        };
+
+        SignalContainer signalContainer(logCallback);
+        // without latency, values are delivered with the package they arrived with
+        ASSERT_EQ(signalContainer.enableBlocks(1024, std::chrono::microseconds(0), dataAsBlocksCb), 0);
+
+        MetaInformation metaInformation(logCallback);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_subscribeAckDataSignalDoc));
+        signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_subscribeAckTimeSignalDoc));
+        signalContainer.processMetaInformation(s_timeSignalNumber, metaInformation);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_dataInt32SignalMetaInformationDoc));
+        signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_linearOpenDAQTimeSignalMetaInformationDoc));
+        signalContainer.processMetaInformation(s_timeSignalNumber, metaInformation);
+
+        IndexedValue < uint64_t > startTime;
+        startTime.index = 0;
+        startTime.value = 20;
+        signalContainer.processMeasuredData(s_timeSignalNumber, reinterpret_cast < const uint8_t* > (&startTime), sizeof(startTime));
+
+        int32_t values[] = { 1, 2 };
+        signalContainer.processMeasuredData(s_dataSignalNumber, reinterpret_cast < const uint8_t* > (values), sizeof(values));
+        ASSERT_EQ(deliveredValueCount, 2u);
+        signalContainer.processMeasuredData(s_dataSignalNumber, reinterpret_cast < const uint8_t* > (values), sizeof(values));
+        ASSERT_EQ(deliveredValueCount, 4u);
+    }
+
+    /// Collects what is delivered to the handler of a BasicSignalContainer
+    struct CollectingHandler : public NopSignalHandler
+    {
+        void signalMeta(SubscribedSignal&, const std::string& method, const nlohmann::json&)
+        {
+            methods.push_back(method);
+        }
+
+        bool wantsSignalMeta() const
+        {
+            return true;
+        }
+
+        void dataAsValue(const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t valueCount)
+        {
+            ASSERT_EQ(subscribedSignal.signalNumber(), s_dataSignalNumber);
+            firstTimeStamps.push_back(timeStamp);
+            const int32_t* pValues = reinterpret_cast < const int32_t* > (data);
+            values.insert(values.end(), pValues, pValues + valueCount);
+        }
+
+        bool wantsTimestampedValues() const
+        {
+            return true;
+        }
+
+        void dataAsTimestampedValues(const SubscribedSignal&, const uint64_t* pTimeStamps, const uint8_t*, size_t valueCount)
+        {
+            timeStamps.insert(timeStamps.end(), pTimeStamps, pTimeStamps + valueCount);
+        }
+
+        std::vector < std::string > methods;
+        std::vector < uint64_t > firstTimeStamps;
+        std::vector < int32_t > values;
+        std::vector < uint64_t > timeStamps;
+    };
+
+    TEST(SignalContainerTest, static_dispatch_test)
+    {
+        BasicSignalContainer < CollectingHandler > signalContainer(logCallback);
+        ASSERT_TRUE(signalContainer.empty());
+
+        MetaInformation metaInformation(logCallback);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_subscribeAckDataSignalDoc));
+        ASSERT_EQ(signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation), 0);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_subscribeAckTimeSignalDoc));
+        ASSERT_EQ(signalContainer.processMetaInformation(s_timeSignalNumber, metaInformation), 0);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_dataInt32SignalMetaInformationDoc));
+        ASSERT_EQ(signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation), 0);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_linearOpenDAQTimeSignalMetaInformationDoc));
+        ASSERT_EQ(signalContainer.processMetaInformation(s_timeSignalNumber, metaInformation), 0);
+        ASSERT_FALSE(signalContainer.empty());
+        ASSERT_EQ(signalContainer.handler().methods, std::vector < std::string > ({ META_METHOD_SUBSCRIBE, META_METHOD_SUBSCRIBE, META_METHOD_SIGNAL, META_METHOD_SIGNAL }));
+
+        std::vector < int32_t > values = { 1, 2, 3, 4, 5 };
+        // not subscribed
+        ASSERT_EQ(signalContainer.processMeasuredData(s_anotherDataSignalNumber, reinterpret_cast < const uint8_t* > (values.data()), sizeof(int32_t)), -1);
+
+        IndexedValue < uint64_t > startTime;
+        startTime.index = 0;
+        startTime.value = 20;
+        ASSERT_EQ(signalContainer.processMeasuredData(s_timeSignalNumber, reinterpret_cast < const uint8_t* > (&startTime), sizeof(startTime)), sizeof(startTime));
+        ASSERT_EQ(signalContainer.processMeasuredData(s_dataSignalNumber, reinterpret_cast < const uint8_t* > (values.data()), 2 * sizeof(int32_t)), 2 * sizeof(int32_t));
+        ASSERT_EQ(signalContainer.processMeasuredData(s_dataSignalNumber, reinterpret_cast < const uint8_t* > (values.data() + 2), 3 * sizeof(int32_t)), 3 * sizeof(int32_t));
+
+        const CollectingHandler& handler = signalContainer.handler();
+        ASSERT_EQ(handler.values, values);
+        ASSERT_EQ(handler.firstTimeStamps, std::vector < uint64_t > ({ 20, 22 }));
+        ASSERT_EQ(handler.timeStamps, std::vector < uint64_t > ({ 20, 21, 22, 23, 24 }));
+
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_unsubscribeAckDoc));
+        ASSERT_EQ(signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation), 0);
+        ASSERT_EQ(signalContainer.processMeasuredData(s_dataSignalNumber, reinterpret_cast < const uint8_t* > (values.data()), sizeof(int32_t)), -1);
+        ASSERT_EQ(handler.methods.back(), META_METHOD_UNSUBSCRIBE);
+    }
+    /// Does not want the signal related meta information, no json document is built for it
+    struct ValueHandler : public NopSignalHandler
+    {
+        void dataAsValue(const SubscribedSignal& subscribedSignal, uint64_t, const uint8_t* data, size_t valueCount)
+        {
+            signalId = subscribedSignal.signalId();
+            const int32_t* pValues = reinterpret_cast < const int32_t* > (data);
+            values.insert(values.end(), pValues, pValues + valueCount);
+        }
+
+        std::string signalId;
+        std::vector < int32_t > values;
+    };
+
+    TEST(SignalContainerTest, no_signal_meta_test)
+    {
+        BasicSignalContainer < ValueHandler > signalContainer(logCallback);
+
+        MetaInformation metaInformation(logCallback);
+        nlohmann::json subscribeAckDoc = s_subscribeAckDataSignalDoc;
+        // a numeric signal id is allowed as well
+        subscribeAckDoc[PARAMS][META_SIGNALID] = 42;
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(subscribeAckDoc));
+        ASSERT_EQ(signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation), 0);
+        // duplicate subscribe
+        ASSERT_EQ(signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation), -1);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_subscribeAckTimeSignalDoc));
+        ASSERT_EQ(signalContainer.processMetaInformation(s_timeSignalNumber, metaInformation), 0);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_dataInt32SignalMetaInformationDoc));
+        ASSERT_EQ(signalContainer.processMetaInformation(s_dataSignalNumber, metaInformation), 0);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(s_linearOpenDAQTimeSignalMetaInformationDoc));
+        ASSERT_EQ(signalContainer.processMetaInformation(s_timeSignalNumber, metaInformation), 0);
+
+        IndexedValue < uint64_t > startTime;
+        startTime.index = 0;
+        startTime.value = 20;
+        ASSERT_EQ(signalContainer.processMeasuredData(s_timeSignalNumber, reinterpret_cast < const uint8_t* > (&startTime), sizeof(startTime)), sizeof(startTime));
+        std::vector < int32_t > values = { 1, 2, 3 };
+        ASSERT_EQ(signalContainer.processMeasuredData(s_dataSignalNumber, reinterpret_cast < const uint8_t* > (values.data()), values.size() * sizeof(int32_t)), values.size() * sizeof(int32_t));
+        ASSERT_EQ(signalContainer.handler().values, values);
+        ASSERT_EQ(signalContainer.handler().signalId, "42");
+
+        // subscribe without signal id
+        subscribeAckDoc[PARAMS].erase(META_SIGNALID);
+        metaInformation = creataMetaInformation(nlohmann::json::to_msgpack(subscribeAckDoc));
+        ASSERT_EQ(signalContainer.processMetaInformation(s_anotherDataSignalNumber, metaInformation), -1);
+    }
 }
@@ -0,0 +1,390 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include <gtest/gtest.h>
+
+#include "nlohmann/json.hpp"
+
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/jsonrpc_defines.hpp"
+#include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/ProducerSession.hpp"
+#include "streaming_protocol/SendQueue.hpp"
+#include "streaming_protocol/SignalHub.hpp"
+#include "streaming_protocol/StreamWriter.h"
+#include "streaming_protocol/SynchronousSignal.hpp"
+
+namespace daq::streaming_protocol {
+    static LogCallback logCallback = Logging::logCallback();
+
+    /// Completes all writes right away. Records the bytes written and the location of the buffers.
+    /// Reads complete with the bytes passed to receive().
+    class HubTestStream : public stream::Stream
+    {
+    public:
+        void asyncInit(CompletionCb completionCb) override
+        {
+            completionCb(boost::system::error_code());
+        }
+
+        boost::system::error_code init() override
+        {
+            return boost::system::error_code();
+        }
+
+        std::string endPointUrl() const override
+        {
+            return "hub test";
+        }
+
+        std::string remoteHost() const override
+        {
+            return "";
+        }
+
+        void asyncReadAtLeast(std::size_t, ReadCompletionCb readCompletionCb) override
+        {
+            m_readCompletionCb = readCompletionCb;
+        }
+
+        size_t readAtLeast(std::size_t, boost::system::error_code&) override
+        {
+            return 0;
+        }
+
+        void asyncWrite(const boost::asio::const_buffer& data, WriteCompletionCb writeCompletionCb) override
+        {
+            asyncWrite(stream::ConstBufferVector(1, data), writeCompletionCb);
+        }
+
+        void asyncWrite(const stream::ConstBufferVector& data, WriteCompletionCb writeCompletionCb) override
+        {
+            boost::system::error_code ec;
+            size_t size = write(data, ec);
+            writeCompletionCb(ec, size);
+        }
+
+        size_t write(const boost::asio::const_buffer& data, boost::system::error_code& ec) override
+        {
+            return write(stream::ConstBufferVector(1, data), ec);
+        }
+
+        size_t write(const stream::ConstBufferVector& data, boost::system::error_code&) override
+        {
+            size_t size = 0;
+            for (const auto& buffer : data) {
+                written.append(static_cast < const char* > (buffer.data()), buffer.size());
+                bufferLocations.push_back(buffer.data());
+                size += buffer.size();
+            }
+            return size;
+        }
+
+        void asyncClose(CompletionCb closeCb) override
+        {
+            completeRead(boost::asio::error::operation_aborted, 0);
+            closeCb(boost::system::error_code());
+        }
+
+        boost::system::error_code close() override
+        {
+            return boost::system::error_code();
+        }
+
+        void receive(const std::string& data)
+        {
+            std::ostream os(&m_buffer);
+            os.write(data.data(), data.size());
+            completeRead(boost::system::error_code(), data.size());
+        }
+
+        std::string written;
+        std::vector < const void* > bufferLocations;
+
+    private:
+        void completeRead(const boost::system::error_code& ec, size_t size)
+        {
+            ReadCompletionCb readCompletionCb;
+            readCompletionCb.swap(m_readCompletionCb);
+            if (readCompletionCb) {
+                readCompletionCb(ec, size);
+            }
+        }
+
+        ReadCompletionCb m_readCompletionCb;
+    };
+
+    struct HubSession
+    {
+        HubSession(boost::asio::io_context& ioc)
+            : stream(std::make_shared < HubTestStream > ())
+            , sendQueue(std::make_shared < SendQueue > (ioc, stream, std::chrono::microseconds(0), SendQueue::DEFAULT_MAX_BATCH_SIZE,
+                                                        SendQueue::DEFAULT_CAPACITY, SendQueue::OVERFLOWPOLICY_DROP, logCallback))
+        {
+        }
+
+        std::shared_ptr < HubTestStream > stream;
+        std::shared_ptr < SendQueue > sendQueue;
+    };
+
+    TEST(SignalHubTest, encode_once)
+    {
+        boost::asio::io_context ioc;
+        SignalHub signalHub(logCallback);
+        HubSession sessions[3] = { HubSession(ioc), HubSession(ioc), HubSession(ioc) };
+        for (auto& session : sessions) {
+            signalHub.addSession(session.sendQueue);
+        }
+        SynchronousSignal < double > signal("the signal", "the table", signalHub, logCallback);
+        unsigned int signalNumber = signal.getNumber();
+
+        // nothing is encoded without subscriber
+        std::vector < double > values = { 1.0, 2.0, 3.0 };
+        EXPECT_EQ(signal.addData(values), 0);
+        EXPECT_EQ(signalHub.encodedCount(), 0);
+
+        // subscribe acknowledge and signal description go to the subscribing session only
+        signalHub.subscribe(sessions[0].sendQueue, signal);
+        signalHub.subscribe(sessions[1].sendQueue, signal);
+        EXPECT_EQ(signalHub.subscriberCount(signalNumber), 2);
+        ioc.poll();
+        ioc.restart();
+        EXPECT_FALSE(sessions[0].stream->written.empty());
+        EXPECT_EQ(sessions[0].stream->written, sessions[1].stream->written);
+        EXPECT_TRUE(sessions[2].stream->written.empty());
+        uint64_t encodedCount = signalHub.encodedCount();
+        for (auto& session : sessions) {
+            session.stream->written.clear();
+        }
+
+        // data is encoded once, each subscribed session gets the same bytes as written by a StreamWriter
+        EXPECT_GT(signal.addData(values), 0);
+        EXPECT_EQ(signalHub.encodedCount(), encodedCount + 1);
+        ioc.poll();
+        ioc.restart();
+        auto referenceStream = std::make_shared < HubTestStream > ();
+        StreamWriter referenceWriter(referenceStream);
+        referenceWriter.writeSignalData(signalNumber, values.data(), values.size() * sizeof(double));
+        EXPECT_EQ(sessions[0].stream->written, referenceStream->written);
+        EXPECT_EQ(sessions[1].stream->written, referenceStream->written);
+        EXPECT_TRUE(sessions[2].stream->written.empty());
+
+        // stream related meta information goes to all sessions
+        nlohmann::json metaInfo;
+        metaInfo[METHOD] = "bla";
+        signalHub.writeMetaInformation(0, metaInfo);
+        ioc.poll();
+        ioc.restart();
+        EXPECT_FALSE(sessions[2].stream->written.empty());
+
+        // no data after unsubscribing
+        signalHub.unsubscribe(sessions[0].sendQueue, signal);
+        ioc.poll();
+        ioc.restart();
+        for (auto& session : sessions) {
+            session.stream->written.clear();
+        }
+        signal.addData(values);
+        ioc.poll();
+        EXPECT_TRUE(sessions[0].stream->written.empty());
+        EXPECT_EQ(sessions[1].stream->written.size(), referenceStream->written.size());
+    }
+
+    TEST(SignalHubTest, bulk_subscribe)
+    {
+        boost::asio::io_context ioc;
+        SignalHub signalHub(logCallback);
+        HubSession sessions[2] = { HubSession(ioc), HubSession(ioc) };
+        SynchronousSignal < double > first("first", "the table", signalHub, logCallback);
+        SynchronousSignal < double > second("second", "the table", signalHub, logCallback);
+        SynchronousSignal < double > third("third", "the table", signalHub, logCallback);
+        for (auto& session : sessions) {
+            signalHub.addSession(session.sendQueue);
+        }
+
+        // signals given twice are acknowledged once, the same as subscribing them one by one
+        signalHub.subscribe(sessions[0].sendQueue, std::vector < BaseSignal* > ({ &first, &second, &first }));
+        signalHub.subscribe(sessions[1].sendQueue, first);
+        signalHub.subscribe(sessions[1].sendQueue, second);
+        ioc.poll();
+        ioc.restart();
+        EXPECT_FALSE(sessions[0].stream->written.empty());
+        EXPECT_EQ(sessions[0].stream->written, sessions[1].stream->written);
+        EXPECT_EQ(signalHub.subscriberCount(first.getNumber()), 2);
+        EXPECT_EQ(signalHub.subscriberCount(second.getNumber()), 2);
+        EXPECT_EQ(signalHub.subscriberCount(third.getNumber()), 0);
+        EXPECT_EQ(first.subscriberCount(), 2);
+
+        // signals not subscribed are skipped
+        for (auto& session : sessions) {
+            session.stream->written.clear();
+        }
+        signalHub.unsubscribe(sessions[0].sendQueue, std::vector < BaseSignal* > ({ &first, &second, &third }));
+        signalHub.unsubscribe(sessions[1].sendQueue, first);
+        signalHub.unsubscribe(sessions[1].sendQueue, second);
+        ioc.poll();
+        ioc.restart();
+        EXPECT_FALSE(sessions[0].stream->written.empty());
+        EXPECT_EQ(sessions[0].stream->written, sessions[1].stream->written);
+        EXPECT_EQ(signalHub.subscriberCount(first.getNumber()), 0);
+        EXPECT_EQ(signalHub.subscriberCount(second.getNumber()), 0);
+
+        // no data after unsubscribing
+        std::vector < double > values = { 1.0, 2.0, 3.0 };
+        EXPECT_EQ(first.addData(values), 0);
+        EXPECT_EQ(second.addData(values), 0);
+    }
+
+    TEST(SignalHubTest, packets_are_shared)
+    {
+        boost::asio::io_context ioc;
+        SignalHub signalHub(logCallback);
+        HubSession sessions[2] = { HubSession(ioc), HubSession(ioc) };
+        SynchronousSignal < double > signal("the signal", "the table", signalHub, logCallback);
+        for (auto& session : sessions) {
+            signalHub.addSession(session.sendQueue);
+            signalHub.subscribe(session.sendQueue, signal);
+        }
+        ioc.poll();
+        ioc.restart();
+        for (auto& session : sessions) {
+            session.stream->bufferLocations.clear();
+        }
+
+        // large packets are referenced by all sessions, not copied
+        std::vector < double > values(SendQueue::COPY_THRESHOLD);
+        signal.addData(values);
+        ioc.poll();
+        ASSERT_EQ(sessions[0].stream->bufferLocations.size(), 1);
+        ASSERT_EQ(sessions[1].stream->bufferLocations.size(), 1);
+        EXPECT_EQ(sessions[0].stream->bufferLocations[0], sessions[1].stream->bufferLocations[0]);
+    }
+
+    TEST(SignalHubTest, producer_sessions)
+    {
+        boost::asio::io_context ioc;
+        auto signalHub = std::make_shared < SignalHub > (logCallback);
+        auto signal = std::make_shared < SynchronousSignal < double > > ("the signal", "the table", *signalHub, logCallback);
+        HubSession hubSessions[2] = { HubSession(ioc), HubSession(ioc) };
+        std::vector < std::shared_ptr < ProducerSession > > producerSessions;
+        for (auto& hubSession : hubSessions) {
+            auto producerSession = std::make_shared < ProducerSession > (hubSession.sendQueue, nlohmann::json(), logCallback);
+            ASSERT_EQ(producerSession->setSignalHub(signalHub), 0);
+            producerSession->addSignal(signal);
+            EXPECT_EQ(producerSession->subscribeSignals({ "the signal" }), 1);
+            producerSessions.push_back(producerSession);
+        }
+        EXPECT_EQ(signalHub->subscriberCount(signal->getNumber()), 2);
+        EXPECT_EQ(signal->subscriberCount(), 2);
+        // subscribing twice does not count
+        EXPECT_EQ(producerSessions[1]->subscribeSignals({ "the signal" }), 1);
+        EXPECT_EQ(signal->subscriberCount(), 2);
+
+        // leaves the hub when stopped
+        producerSessions[0]->stop();
+        EXPECT_EQ(signalHub->subscriberCount(signal->getNumber()), 1);
+        EXPECT_EQ(signal->subscriberCount(), 1);
+        EXPECT_EQ(producerSessions[1]->unsubscribeSignals({ "the signal" }), 1);
+        EXPECT_EQ(signalHub->subscriberCount(signal->getNumber()), 0);
+        EXPECT_FALSE(signal->isSubscribed());
+        ioc.run();
+
+        // a hub requires a send queue
+        auto producerSession = std::make_shared < ProducerSession > (std::make_shared < HubTestStream > (), nlohmann::json(), logCallback);
+        EXPECT_EQ(producerSession->setSignalHub(signalHub), -1);
+    }
+
+    TEST(SignalHubTest, in_band_requests)
+    {
+        boost::asio::io_context ioc;
+        auto signalHub = std::make_shared < SignalHub > (logCallback);
+        auto signal = std::make_shared < SynchronousSignal < double > > ("the signal", "the table", *signalHub, logCallback);
+        HubSession hubSession(ioc);
+        nlohmann::json commandInterfaces;
+        commandInterfaces[COMMANDINTERFACE_JSONRPC_INBAND] = nlohmann::json::object();
+        auto producerSession = std::make_shared < ProducerSession > (hubSession.sendQueue, commandInterfaces, logCallback);
+        ASSERT_EQ(producerSession->setSignalHub(signalHub), 0);
+        producerSession->addSignal(signal);
+        producerSession->start([](const boost::system::error_code&) {
+        });
+
+        auto request = [&](const std::string& method) {
+            nlohmann::json request;
+            request[daq::jsonrpc::JSONRPC] = "2.0";
+            request[daq::jsonrpc::METHOD] = method;
+            request[daq::jsonrpc::PARAMS] = nlohmann::json::array({ "the signal" });
+            request[daq::jsonrpc::ID] = 1;
+            auto requestStream = std::make_shared < HubTestStream > ();
+            StreamWriter requestWriter(requestStream);
+            requestWriter.writeMetaInformation(0, request);
+            hubSession.stream->receive(requestStream->written);
+        };
+
+        // in-band requests subscribe via the hub, just like ProducerSession::subscribeSignals()
+        request(META_METHOD_SUBSCRIBE);
+        EXPECT_EQ(signalHub->subscriberCount(signal->getNumber()), 1);
+        EXPECT_EQ(signal->subscriberCount(), 1);
+        std::vector < double > values = { 1.0, 2.0, 3.0 };
+        EXPECT_GT(signal->addData(values), 0);
+
+        request(META_METHOD_UNSUBSCRIBE);
+        EXPECT_EQ(signalHub->subscriberCount(signal->getNumber()), 0);
+        EXPECT_FALSE(signal->isSubscribed());
+        EXPECT_EQ(signal->addData(values), 0);
+
+        producerSession->stop();
+        ioc.run();
+    }
+
+    TEST(SignalHubTest, large_signal_numbers)
+    {
+        boost::asio::io_context ioc;
+        SignalHub signalHub(logCallback);
+        HubSession sessions[2] = { HubSession(ioc), HubSession(ioc) };
+        for (auto& session : sessions) {
+            signalHub.addSession(session.sendQueue);
+        }
+        // signal numbers are counted up, signals are kept in a map from 4096 on
+        auto signal = std::make_unique < SynchronousSignal < double > > ("the signal", "the table", signalHub, logCallback);
+        while (signal->getNumber() < 4096) {
+            signal = std::make_unique < SynchronousSignal < double > > ("the signal", "the table", signalHub, logCallback);
+        }
+        unsigned int signalNumber = signal->getNumber();
+
+        signalHub.subscribe(sessions[0].sendQueue, *signal);
+        signalHub.subscribe(sessions[1].sendQueue, *signal);
+        EXPECT_EQ(signalHub.subscriberCount(signalNumber), 2);
+        EXPECT_TRUE(signalHub.isSubscribed(sessions[0].sendQueue, signalNumber));
+        EXPECT_EQ(signalHub.subscriberCount(signalNumber + 1), 0);
+        std::vector < double > values = { 1.0, 2.0, 3.0 };
+        EXPECT_GT(signal->addData(values), 0);
+
+        signalHub.removeSession(sessions[0].sendQueue);
+        EXPECT_EQ(signalHub.subscriberCount(signalNumber), 1);
+        EXPECT_FALSE(signalHub.isSubscribed(sessions[0].sendQueue, signalNumber));
+        signalHub.unsubscribe(sessions[1].sendQueue, *signal);
+        EXPECT_EQ(signalHub.subscriberCount(signalNumber), 0);
+        EXPECT_EQ(signal->addData(values), 0);
+        ioc.poll();
+    }
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "streaming_protocol/SignalIdPattern.hpp"
+
+/// allocations are counted only while this is set
+static std::atomic < bool > s_countAllocations(false);
+static std::atomic < size_t > s_allocationCount(0);
+
+void* operator new(std::size_t size)
+{
+    if (s_countAllocations) {
+        ++s_allocationCount;
+    }
+    void* p = std::malloc(size ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace daq::streaming_protocol {
+    TEST(SignalIdPatternTest, is_pattern)
+    {
+        EXPECT_FALSE(SignalIdPattern::isPattern("ai/0/raw"));
+        EXPECT_FALSE(SignalIdPattern::isPattern(""));
+        EXPECT_TRUE(SignalIdPattern::isPattern("ai/*/raw"));
+        EXPECT_TRUE(SignalIdPattern::isPattern("ai/?/raw"));
+        EXPECT_TRUE(SignalIdPattern::isPattern("**"));
+    }
+
+    TEST(SignalIdPatternTest, literal_prefix)
+    {
+        EXPECT_EQ(SignalIdPattern("ai/*/raw").literalPrefix(), "ai/");
+        EXPECT_EQ(SignalIdPattern("ai/1?").literalPrefix(), "ai/1");
+        EXPECT_EQ(SignalIdPattern("**/raw").literalPrefix(), "");
+        EXPECT_EQ(SignalIdPattern("ai/0/raw").literalPrefix(), "ai/0/raw");
+    }
+
+    TEST(SignalIdPatternTest, literal)
+    {
+        SignalIdPattern pattern("ai/0/raw");
+        EXPECT_TRUE(pattern.match("ai/0/raw"));
+        EXPECT_FALSE(pattern.match("ai/0/raw2"));
+        EXPECT_FALSE(pattern.match("ai/0/ra"));
+    }
+
+    TEST(SignalIdPatternTest, segment)
+    {
+        SignalIdPattern pattern("ai/*/raw");
+        EXPECT_TRUE(pattern.match("ai/0/raw"));
+        EXPECT_TRUE(pattern.match("ai/123/raw"));
+        EXPECT_TRUE(pattern.match("ai//raw"));
+        EXPECT_FALSE(pattern.match("ai/0/1/raw"));
+        EXPECT_FALSE(pattern.match("ai/0/scaled"));
+        EXPECT_FALSE(pattern.match("ao/0/raw"));
+
+        SignalIdPattern trailing("ai/*");
+        EXPECT_TRUE(trailing.match("ai/0"));
+        EXPECT_TRUE(trailing.match("ai/"));
+        EXPECT_FALSE(trailing.match("ai/0/raw"));
+
+        SignalIdPattern within("ai/in*put/raw");
+        EXPECT_TRUE(within.match("ai/input/raw"));
+        EXPECT_TRUE(within.match("ai/in_1_put/raw"));
+        EXPECT_FALSE(within.match("ai/in/put/raw"));
+    }
+
+    TEST(SignalIdPatternTest, any)
+    {
+        SignalIdPattern prefix("ai/**");
+        EXPECT_TRUE(prefix.match("ai/0/raw"));
+        EXPECT_TRUE(prefix.match("ai/"));
+        EXPECT_FALSE(prefix.match("ai"));
+
+        SignalIdPattern suffix("**/raw");
+        EXPECT_TRUE(suffix.match("ai/0/raw"));
+        EXPECT_TRUE(suffix.match("/raw"));
+        EXPECT_FALSE(suffix.match("ai/0/raw/x"));
+        EXPECT_FALSE(suffix.match("ai/0/scaled"));
+
+        SignalIdPattern middle("ai/**/raw");
+        EXPECT_TRUE(middle.match("ai/0/raw"));
+        EXPECT_TRUE(middle.match("ai/0/1/raw"));
+        EXPECT_TRUE(middle.match("ai/raw/raw"));
+        EXPECT_FALSE(middle.match("ai/raw"));
+
+        // consecutive wildcards are one
+        SignalIdPattern consecutive("ai/***");
+        EXPECT_TRUE(consecutive.match("ai/0/raw"));
+    }
+
+    TEST(SignalIdPatternTest, any_character)
+    {
+        SignalIdPattern pattern("ai/1?/raw");
+        EXPECT_TRUE(pattern.match("ai/10/raw"));
+        EXPECT_TRUE(pattern.match("ai/19/raw"));
+        EXPECT_FALSE(pattern.match("ai/1/raw"));
+        EXPECT_FALSE(pattern.match("ai/100/raw"));
+        EXPECT_FALSE(SignalIdPattern("ai?0").match("ai/0"));
+    }
+
+    TEST(SignalIdPatternTest, backtracking)
+    {
+        SignalIdPattern pattern("*a*b");
+        EXPECT_TRUE(pattern.match("aab"));
+        EXPECT_TRUE(pattern.match("xaybab"));
+        EXPECT_FALSE(pattern.match("xayba"));
+        EXPECT_TRUE(SignalIdPattern("**/x/*").match("a/x/b/x/c"));
+        EXPECT_FALSE(SignalIdPattern("**/x/*").match("a/x/b/c"));
+    }
+
+    TEST(SignalIdPatternTest, escape)
+    {
+        EXPECT_FALSE(SignalIdPattern::isPattern("ai/\\*"));
+        EXPECT_FALSE(SignalIdPattern::isPattern("ai/\\?/raw"));
+        EXPECT_TRUE(SignalIdPattern::isPattern("ai/\\\\*"));
+        EXPECT_FALSE(SignalIdPattern::isPattern("ai\\0"));
+
+        EXPECT_EQ(SignalIdPattern::escape("ai/*/r?w\\"), "ai/\\*/r\\?w\\\\");
+        EXPECT_EQ(SignalIdPattern::unescape(SignalIdPattern::escape("ai/*/r?w\\")), "ai/*/r?w\\");
+        // a backslash not followed by a character to be escaped is taken as it is
+        EXPECT_EQ(SignalIdPattern::unescape("ai\\0\\"), "ai\\0\\");
+
+        SignalIdPattern pattern("ai/\\*/*");
+        EXPECT_EQ(pattern.literalPrefix(), "ai/*/");
+        EXPECT_TRUE(pattern.match("ai/*/raw"));
+        EXPECT_FALSE(pattern.match("ai/0/raw"));
+
+        SignalIdPattern within("ai/*/r\\?w");
+        EXPECT_TRUE(within.match("ai/0/r?w"));
+        EXPECT_FALSE(within.match("ai/0/raw"));
+    }
+
+    TEST(SignalIdPatternTest, for_each_match)
+    {
+        std::map < std::string, int > signals;
+        int number = 0;
+        for (const std::string signalId : { "a", "ai/0/raw", "ai/0/scaled", "ai/1/raw", "ai/10/raw", "ai0", "ao/0/raw", "b" }) {
+            signals[signalId] = number++;
+        }
+
+        auto collect = [&signals](const std::string& pattern) {
+            std::vector < std::string > signalIds;
+            SignalIdPattern(pattern).forEachMatch(signals, [&signalIds](const std::pair < const std::string, int >& entry) {
+                signalIds.push_back(entry.first);
+            });
+            return signalIds;
+        };
+
+        EXPECT_EQ(collect("ai/*/raw"), std::vector < std::string > ({ "ai/0/raw", "ai/1/raw", "ai/10/raw" }));
+        EXPECT_EQ(collect("ai/**"), std::vector < std::string > ({ "ai/0/raw", "ai/0/scaled", "ai/1/raw", "ai/10/raw" }));
+        EXPECT_EQ(collect("**/raw"), std::vector < std::string > ({ "ai/0/raw", "ai/1/raw", "ai/10/raw", "ao/0/raw" }));
+        EXPECT_EQ(collect("?"), std::vector < std::string > ({ "a", "b" }));
+        EXPECT_TRUE(collect("c*").empty());
+    }
+
+    TEST(SignalIdPatternTest, no_allocation_while_matching)
+    {
+        std::map < std::string, size_t > signals;
+        for (size_t index = 0; index < 1000; ++index) {
+            signals["analog input/" + std::to_string(index) + "/raw"] = index;
+            signals["analog input/" + std::to_string(index) + "/scaled"] = index;
+        }
+        SignalIdPattern segmentPattern("analog input/*/raw");
+        SignalIdPattern anyPattern("**/scaled");
+        SignalIdPattern characterPattern("analog input/1?0/raw");
+
+        size_t count = 0;
+        s_allocationCount = 0;
+        s_countAllocations = true;
+        for (const auto& pattern : { &segmentPattern, &anyPattern, &characterPattern }) {
+            pattern->forEachMatch(signals, [&count](const std::pair < const std::string, size_t >&) {
+                ++count;
+            });
+        }
+        s_countAllocations = false;
+
+        EXPECT_EQ(count, 2010);
+        EXPECT_EQ(s_allocationCount, 0);
+    }
+}
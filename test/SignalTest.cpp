@@ -120,7 +120,8 @@ public:
     /// \param id 0: for stream related, >0: signal related
     int writeSignalData(unsigned int signalNumber, const void *pData, size_t length) override
     {
-        return 0;
+        ++signalDataCount;
+        return static_cast<int>(length);
     }
 
     std::string id() const override
@@ -129,6 +130,7 @@ public:
     }
 
     std::map <unsigned int, SignalMetaInformation> allSignalMetaInformation;
+    size_t signalDataCount = 0;
 };
 
 
@@ -470,6 +472,49 @@ TEST(SignalTest, sync_time_test)
     ASSERT_EQ(startTimeInTicks, timeSignal.getTimeStart());
 }
 
+TEST(SignalTest, subscription_gated_data)
+{
+    static const std::string tableId = "the table Id";
+
+    TestSubscribeWriter writer;
+    SynchronousSignal<double> syncSignal("the sync Id", tableId, writer, logCallback);
+    AsynchronousSignal<double> asyncSignal("the async Id", tableId, writer, logCallback);
+    LinearTimeSignal timeSignal("the time Id", tableId, s_timeTicksPerSecond, std::chrono::milliseconds(1), writer, logCallback);
+    std::vector<double> values = { 1.0, 2.0 };
+    AsynchronousSignal<double>::ValueTuples tuples = { { 1, 1.0 }, { 2, 2.0 } };
+
+    // nothing is written without subscriber, the value index advances nevertheless
+    ASSERT_FALSE(syncSignal.isSubscribed());
+    ASSERT_EQ(syncSignal.addData(values), 0);
+    ASSERT_EQ(asyncSignal.addData(tuples), 0);
+    timeSignal.setTimeStart(1000);
+    ASSERT_EQ(writer.signalDataCount, 0);
+    ASSERT_EQ(syncSignal.getValueIndex(), values.size());
+    ASSERT_EQ(timeSignal.getTimeStart(), 1000);
+
+    syncSignal.subscribe();
+    asyncSignal.subscribe();
+    timeSignal.subscribe();
+    ASSERT_TRUE(syncSignal.isSubscribed());
+    ASSERT_EQ(syncSignal.addData(values), values.size() * sizeof(double));
+    ASSERT_EQ(asyncSignal.addData(tuples), tuples.size() * sizeof(double));
+    timeSignal.setTimeStart(2000);
+    ASSERT_EQ(writer.signalDataCount, 4);
+
+    // each subscribe counts
+    syncSignal.subscribe();
+    ASSERT_EQ(syncSignal.subscriberCount(), 2);
+    syncSignal.unsubscribe();
+    ASSERT_TRUE(syncSignal.isSubscribed());
+    syncSignal.unsubscribe();
+    syncSignal.unsubscribe();
+    ASSERT_EQ(syncSignal.subscriberCount(), 0);
+    ASSERT_EQ(syncSignal.addData(values), 0);
+    asyncSignal.unsubscribe();
+    ASSERT_EQ(asyncSignal.addData(tuples), 0);
+    ASSERT_EQ(writer.signalDataCount, 4);
+}
+
 TEST(SignalTest, sync_outputrate_test)
 {
     static const std::string fileName = "theFile";
@@ -618,12 +663,8 @@ TEST(SignalTest, sync_ticks_to_time_test)
     timeRequested = std::chrono::hours(8760);
     checkTime(timeRequested, timeSignal);
 
-    // one thousand years
-    timeRequested = std::chrono::hours(8760*1000);
-    checkTime(timeRequested, timeSignal);
-
-    // two thousand years
-    timeRequested = std::chrono::hours(8760*2000);
+    // two hundred years, std::chrono::nanoseconds covers about 292 years only
+    timeRequested = std::chrono::hours(8760*200);
     checkTime(timeRequested, timeSignal);
 
 #ifdef TIME_GRANULARITY_NS
@@ -223,6 +223,30 @@ namespace daq::streaming_protocol {
             ASSERT_EQ(streamMeta.httpControlPort(), httpControlPort);
             ASSERT_EQ(streamMeta.httpControlPath(), httpControlPath);
         }
+
+        {
+            // command interface with wrong type is fatal!
+            nlohmann::json wrongTypeDoc = metaInformationDoc;
+            wrongTypeDoc[PARAMS]["commandInterfaces"]["jsonrpc-http"]["port"] = 8080;
+            std::vector < uint8_t > payload = nlohmann::json::to_msgpack(wrongTypeDoc);
+            MetaInformation metaInformation = creataMetaInformation(payload);
+
+            StreamMeta streamMeta(logCallback);
+            result = streamMeta.processMetaInformation(metaInformation, "testStream");
+            ASSERT_EQ(result, -1);
+        }
+
+        {
+            // stream id with wrong type is fatal!
+            nlohmann::json wrongTypeDoc = metaInformationDoc;
+            wrongTypeDoc[PARAMS][META_STREAMID] = 42;
+            std::vector < uint8_t > payload = nlohmann::json::to_msgpack(wrongTypeDoc);
+            MetaInformation metaInformation = creataMetaInformation(payload);
+
+            StreamMeta streamMeta(logCallback);
+            result = streamMeta.processMetaInformation(metaInformation, "testStream");
+            ASSERT_EQ(result, -1);
+        }
     }
 
     TEST(StreamMetaTest, alive_test)
@@ -255,5 +279,16 @@ namespace daq::streaming_protocol {
             result = streamMeta.processMetaInformation(metaInformation, "testStream");
             ASSERT_EQ(result, 0);
         }
+
+        {
+            // fill level with wrong type is fatal!
+            metaInformationDoc[PARAMS][META_FILLLEVEL] = "20";
+            std::vector < uint8_t > payload = nlohmann::json::to_msgpack(metaInformationDoc);
+            MetaInformation metaInformation = creataMetaInformation(payload);
+
+            StreamMeta streamMeta(logCallback);
+            result = streamMeta.processMetaInformation(metaInformation, "testStream");
+            ASSERT_EQ(result, -1);
+        }
     }
 }
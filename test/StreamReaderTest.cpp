@@ -0,0 +1,205 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "nlohmann/json.hpp"
+
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/StreamReader.hpp"
+#include "streaming_protocol/SubscribedSignal.hpp"
+
+namespace daq::streaming_protocol {
+    static LogCallback logCallback = daq::streaming_protocol::Logging::logCallback();
+
+    /// Data signal with explicit rule
+    static std::unique_ptr < SubscribedSignal > createSignal(SignalNumber signalNumber, const std::string& signalId, const std::string& dataType = DATA_TYPE_INT32)
+    {
+        auto signal = std::make_unique < SubscribedSignal > (signalNumber, logCallback);
+        nlohmann::json subscribe;
+        subscribe[META_SIGNALID] = signalId;
+        signal->processSignalMetaInformation(META_METHOD_SUBSCRIBE, subscribe);
+        nlohmann::json signalMeta;
+        signalMeta[META_TABLEID] = "table";
+        signalMeta[META_DEFINITION][META_RULE] = META_RULETYPE_EXPLICIT;
+        signalMeta[META_DEFINITION][META_DATATYPE] = dataType;
+        signal->processSignalMetaInformation(META_METHOD_SIGNAL, signalMeta);
+        return signal;
+    }
+
+    /// Adds count values, value and time stamp equal the value index
+    static void addValues(StreamReader& reader, const SubscribedSignal& signal, int32_t firstValue, size_t count)
+    {
+        std::vector < int32_t > values(count);
+        std::iota(values.begin(), values.end(), firstValue);
+        std::vector < uint64_t > timeStamps(values.begin(), values.end());
+        reader.add(signal, timeStamps.data(), reinterpret_cast < const uint8_t* > (values.data()), count);
+    }
+
+    TEST(StreamReaderTest, read_test)
+    {
+        auto signal = createSignal(1, "signal");
+        auto otherSignal = createSignal(2, "other");
+        StreamReader reader(logCallback);
+        SignalReader& signalReader = reader.addSignal("signal", 6);
+        ASSERT_EQ(signalReader.signalId(), "signal");
+        ASSERT_EQ(signalReader.capacity(), 8u);
+        ASSERT_EQ(signalReader.valueSize(), 0u);
+        ASSERT_EQ(signalReader.available(), 0u);
+
+        addValues(reader, *otherSignal, 0, 3);
+        ASSERT_EQ(signalReader.available(), 0u);
+
+        addValues(reader, *signal, 0, 6);
+        ASSERT_EQ(signalReader.valueSize(), sizeof(int32_t));
+        ASSERT_EQ(signalReader.available(), 6u);
+
+        std::vector < int32_t > values(8);
+        std::vector < uint64_t > timeStamps(8);
+        ASSERT_EQ(signalReader.read(values.data(), timeStamps.data(), 4), 4u);
+        ASSERT_EQ(values[0], 0);
+        ASSERT_EQ(values[3], 3);
+        ASSERT_EQ(timeStamps[3], 3u);
+
+        // wraps around
+        addValues(reader, *signal, 6, 5);
+        ASSERT_EQ(signalReader.available(), 7u);
+        // less than requested
+        ASSERT_EQ(signalReader.read(values.data(), timeStamps.data(), 8), 7u);
+        for (size_t valueIndex = 0; valueIndex < 7; ++valueIndex) {
+            ASSERT_EQ(values[valueIndex], static_cast < int32_t > (4 + valueIndex));
+            ASSERT_EQ(timeStamps[valueIndex], 4 + valueIndex);
+        }
+        ASSERT_EQ(signalReader.droppedValueCount(), 0u);
+
+        // values not fitting are dropped
+        addValues(reader, *signal, 11, 10);
+        ASSERT_EQ(signalReader.available(), 8u);
+        ASSERT_EQ(signalReader.droppedValueCount(), 2u);
+        // time stamps only
+        ASSERT_EQ(signalReader.read(nullptr, timeStamps.data(), 8), 8u);
+        ASSERT_EQ(timeStamps[0], 11u);
+        ASSERT_EQ(timeStamps[7], 18u);
+    }
+
+    TEST(StreamReaderTest, read_until_test)
+    {
+        auto signal = createSignal(1, "signal");
+        StreamReader reader(logCallback);
+        SignalReader& signalReader = reader.addSignal("signal", 16);
+        addValues(reader, *signal, 0, 10);
+
+        std::vector < int32_t > values(16);
+        std::vector < uint64_t > timeStamps(16);
+        ASSERT_EQ(signalReader.readUntil(4, values.data(), timeStamps.data(), 16), 4u);
+        ASSERT_EQ(values[3], 3);
+        // limited by maxCount
+        ASSERT_EQ(signalReader.readUntil(100, values.data(), timeStamps.data(), 2), 2u);
+        ASSERT_EQ(values[0], 4);
+        ASSERT_EQ(signalReader.readUntil(3, values.data(), timeStamps.data(), 16), 0u);
+        // wraps around
+        addValues(reader, *signal, 10, 10);
+        ASSERT_EQ(signalReader.readUntil(17, values.data(), timeStamps.data(), 16), 11u);
+        ASSERT_EQ(values[0], 6);
+        ASSERT_EQ(values[10], 16);
+        ASSERT_EQ(signalReader.available(), 3u);
+    }
+
+    TEST(StreamReaderTest, large_signal_number_test)
+    {
+        // routed through a map, the signal number is not used as index
+        auto signal = createSignal(SIGNAL_NUMBER_MASK, "signal");
+        auto otherSignal = createSignal(SIGNAL_NUMBER_MASK - 1, "other");
+        StreamReader reader(logCallback);
+        SignalReader& signalReader = reader.addSignal("signal", 16);
+        addValues(reader, *otherSignal, 0, 3);
+        addValues(reader, *signal, 0, 4);
+        ASSERT_EQ(signalReader.available(), 4u);
+
+        std::vector < int32_t > values(4);
+        std::vector < uint64_t > timeStamps(4);
+        ASSERT_EQ(signalReader.read(values.data(), timeStamps.data(), 4), 4u);
+        ASSERT_EQ(values[3], 3);
+    }
+
+    TEST(StreamReaderTest, value_size_test)
+    {
+        auto signal = createSignal(1, "signal");
+        StreamReader reader(logCallback);
+        SignalReader& signalReader = reader.addSignal("signal", 16);
+        addValues(reader, *signal, 0, 4);
+
+        // the signal number gets reused by a signal with another data type
+        auto doubleSignal = createSignal(1, "signal", DATA_TYPE_REAL64);
+        std::vector < double > values(3);
+        std::vector < uint64_t > timeStamps(3);
+        reader.add(*doubleSignal, timeStamps.data(), reinterpret_cast < const uint8_t* > (values.data()), values.size());
+        ASSERT_EQ(signalReader.available(), 4u);
+        ASSERT_EQ(signalReader.droppedValueCount(), 3u);
+    }
+
+    TEST(StreamReaderTest, blocking_test)
+    {
+        auto signal = createSignal(1, "signal");
+        StreamReader reader(logCallback);
+        SignalReader& signalReader = reader.addSignal("signal", 1024);
+
+        static const size_t packageCount = 100;
+        static const size_t valuesPerPackage = 10;
+        std::thread producer([&]() {
+            for (size_t packageIndex = 0; packageIndex < packageCount; ++packageIndex) {
+                addValues(reader, *signal, static_cast < int32_t > (packageIndex * valuesPerPackage), valuesPerPackage);
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        });
+
+        std::vector < int32_t > values(packageCount * valuesPerPackage);
+        size_t readCount = 0;
+        // in chunks not matching the packages
+        while (readCount < values.size()) {
+            size_t count = std::min < size_t > (37, values.size() - readCount);
+            ASSERT_EQ(signalReader.read(&values[readCount], nullptr, count, std::chrono::seconds(10)), count);
+            readCount += count;
+        }
+        producer.join();
+        for (size_t valueIndex = 0; valueIndex < values.size(); ++valueIndex) {
+            ASSERT_EQ(values[valueIndex], static_cast < int32_t > (valueIndex));
+        }
+
+        // times out
+        auto start = std::chrono::steady_clock::now();
+        ASSERT_EQ(signalReader.read(values.data(), nullptr, 1, std::chrono::milliseconds(10)), 0u);
+        ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(10));
+
+        // waits for a value at or after the time
+        std::vector < uint64_t > timeStamps(values.size());
+        std::thread lateProducer([&]() {
+            addValues(reader, *signal, 1000, 5);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            addValues(reader, *signal, 1005, 5);
+        });
+        ASSERT_EQ(signalReader.readUntil(1007, values.data(), timeStamps.data(), values.size(), std::chrono::seconds(10)), 7u);
+        ASSERT_EQ(timeStamps[6], 1006u);
+        lateProducer.join();
+    }
+}
@@ -14,6 +14,13 @@
  * limitations under the License.
  */
 
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/asio/executor_work_guard.hpp>
 #include <boost/asio/io_context.hpp>
 
 #include <gtest/gtest.h>
@@ -21,8 +28,14 @@
 #include "nlohmann/json.hpp"
 
 #include "stream/FileStream.hpp"
+#include "streaming_protocol/AsynchronousSignal.hpp"
 #include "streaming_protocol/StreamWriter.h"
 #include "streaming_protocol/Defines.h"
+#include "streaming_protocol/ExplicitTimeSignal.hpp"
+#include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/ProtocolHandler.hpp"
+#include "streaming_protocol/SendQueue.hpp"
+#include "streaming_protocol/SignalContainer.hpp"
 
 namespace daq::streaming_protocol {
 
@@ -151,4 +164,435 @@ namespace daq::streaming_protocol {
             fileStream.consume(headerInfo.length); // consume payload
         }
     }
+    /// Records all writes. Asynchronous writes are completed by calling completeWrite().
+    class RecordingStream : public stream::Stream
+    {
+    public:
+        void asyncInit(CompletionCb completionCb) override
+        {
+            completionCb(boost::system::error_code());
+        }
+
+        boost::system::error_code init() override
+        {
+            return boost::system::error_code();
+        }
+
+        std::string endPointUrl() const override
+        {
+            return "recording";
+        }
+
+        std::string remoteHost() const override
+        {
+            return "";
+        }
+
+        void asyncReadAtLeast(std::size_t, ReadCompletionCb) override
+        {
+        }
+
+        size_t readAtLeast(std::size_t, boost::system::error_code&) override
+        {
+            return 0;
+        }
+
+        void asyncWrite(const boost::asio::const_buffer& data, WriteCompletionCb writeCompletionCb) override
+        {
+            asyncWrite(stream::ConstBufferVector(1, data), writeCompletionCb);
+        }
+
+        void asyncWrite(const stream::ConstBufferVector& data, WriteCompletionCb writeCompletionCb) override
+        {
+            boost::system::error_code ec;
+            m_writeSize = write(data, ec);
+            m_writeCompletionCb = writeCompletionCb;
+        }
+
+        size_t write(const boost::asio::const_buffer& data, boost::system::error_code& ec) override
+        {
+            return write(stream::ConstBufferVector(1, data), ec);
+        }
+
+        size_t write(const stream::ConstBufferVector& data, boost::system::error_code&) override
+        {
+            std::string written;
+            for (const auto& buffer : data) {
+                written.append(static_cast < const char* > (buffer.data()), buffer.size());
+            }
+            writes.push_back(written);
+            return written.size();
+        }
+
+        void asyncClose(CompletionCb closeCb) override
+        {
+            closed = true;
+            closeCb(boost::system::error_code());
+        }
+
+        boost::system::error_code close() override
+        {
+            return boost::system::error_code();
+        }
+
+        bool writePending() const
+        {
+            return static_cast < bool > (m_writeCompletionCb);
+        }
+
+        void completeWrite(const boost::system::error_code& ec = boost::system::error_code())
+        {
+            WriteCompletionCb writeCompletionCb;
+            writeCompletionCb.swap(m_writeCompletionCb);
+            writeCompletionCb(ec, ec ? 0 : m_writeSize);
+        }
+
+        std::vector < std::string > writes;
+        bool closed = false;
+
+    private:
+        WriteCompletionCb m_writeCompletionCb;
+        size_t m_writeSize = 0;
+    };
+
+    static void writePackets(StreamWriter& streamWriter, unsigned int firstValue, unsigned int count)
+    {
+        for (unsigned int value = firstValue; value < firstValue + count; ++value) {
+            streamWriter.writeSignalData(7, &value, sizeof(value));
+        }
+    }
+
+    TEST(StreamWriterTest, queued_packets_are_coalesced)
+    {
+        boost::asio::io_context ioc;
+        auto recordingStream = std::make_shared < RecordingStream >();
+        auto sendQueue = std::make_shared < SendQueue >(ioc, recordingStream, std::chrono::microseconds(0), SendQueue::DEFAULT_MAX_BATCH_SIZE, SendQueue::DEFAULT_CAPACITY, SendQueue::OVERFLOWPOLICY_DISCONNECT, Logging::logCallback());
+        StreamWriter streamWriter(sendQueue);
+        ASSERT_EQ(streamWriter.id(), "recording");
+
+        nlohmann::json metaInfo;
+        metaInfo["bla"] = 12;
+        streamWriter.writeMetaInformation(0, metaInfo);
+        writePackets(streamWriter, 0, 3);
+        // written in the io context thread
+        EXPECT_TRUE(recordingStream->writes.empty());
+        ioc.poll();
+        ASSERT_EQ(recordingStream->writes.size(), 1);
+        ASSERT_TRUE(recordingStream->writePending());
+
+        // queued while the write is in progress
+        writePackets(streamWriter, 3, 5);
+        ioc.poll();
+        EXPECT_EQ(recordingStream->writes.size(), 1);
+        recordingStream->completeWrite();
+        ASSERT_EQ(recordingStream->writes.size(), 2);
+        recordingStream->completeWrite();
+
+        SendQueueMetrics metrics = sendQueue->metrics();
+        EXPECT_EQ(metrics.packetCount, 9);
+        EXPECT_EQ(metrics.writeCount, 2);
+        EXPECT_EQ(metrics.queuedBytes, 0);
+        EXPECT_FALSE(metrics.failed);
+
+        // same bytes as written synchronously
+        auto syncStream = std::make_shared < RecordingStream >();
+        StreamWriter syncWriter(syncStream);
+        syncWriter.writeMetaInformation(0, metaInfo);
+        writePackets(syncWriter, 0, 8);
+        std::string syncWritten;
+        for (const auto& written : syncStream->writes) {
+            syncWritten += written;
+        }
+        EXPECT_EQ(syncStream->writes.size(), 9);
+        EXPECT_EQ(recordingStream->writes[0] + recordingStream->writes[1], syncWritten);
+        EXPECT_EQ(metrics.writtenBytes, syncWritten.size());
+    }
+
+    TEST(StreamWriterTest, queued_flush_policy)
+    {
+        static const std::chrono::milliseconds maxLatency(20);
+        static const size_t packetSize = sizeof(uint32_t) + sizeof(unsigned int);
+        boost::asio::io_context ioc;
+        // would stop when running out of work
+        auto work = boost::asio::make_work_guard(ioc);
+        auto recordingStream = std::make_shared < RecordingStream >();
+        auto sendQueue = std::make_shared < SendQueue >(ioc, recordingStream, maxLatency, 4 * packetSize, SendQueue::DEFAULT_CAPACITY, SendQueue::OVERFLOWPOLICY_DISCONNECT, Logging::logCallback());
+        StreamWriter streamWriter(sendQueue);
+
+        // held back for maxLatency
+        auto start = std::chrono::steady_clock::now();
+        writePackets(streamWriter, 0, 1);
+        ioc.poll();
+        EXPECT_TRUE(recordingStream->writes.empty());
+        while (recordingStream->writes.empty() && (std::chrono::steady_clock::now() - start < std::chrono::seconds(2))) {
+            ioc.run_one_for(std::chrono::milliseconds(100));
+        }
+        ASSERT_EQ(recordingStream->writes.size(), 1);
+        EXPECT_GE(std::chrono::steady_clock::now() - start, maxLatency);
+        recordingStream->completeWrite();
+
+        // written right away once the batch size is reached
+        writePackets(streamWriter, 1, 4);
+        ioc.poll();
+        ASSERT_EQ(recordingStream->writes.size(), 2);
+        EXPECT_EQ(recordingStream->writes[1].size(), 4 * packetSize);
+        recordingStream->completeWrite();
+
+        // or when flushed
+        writePackets(streamWriter, 5, 1);
+        sendQueue->flush();
+        ioc.poll();
+        ASSERT_EQ(recordingStream->writes.size(), 3);
+        recordingStream->completeWrite();
+        EXPECT_EQ(sendQueue->metrics().writeCount, 3);
+    }
+
+    TEST(StreamWriterTest, queued_write_failure)
+    {
+        boost::asio::io_context ioc;
+        auto recordingStream = std::make_shared < RecordingStream >();
+        auto sendQueue = std::make_shared < SendQueue >(ioc, recordingStream, std::chrono::microseconds(0), SendQueue::DEFAULT_MAX_BATCH_SIZE, SendQueue::DEFAULT_CAPACITY, SendQueue::OVERFLOWPOLICY_DISCONNECT, Logging::logCallback());
+        StreamWriter streamWriter(sendQueue);
+
+        writePackets(streamWriter, 0, 1);
+        ioc.poll();
+        writePackets(streamWriter, 1, 1);
+        recordingStream->completeWrite(boost::asio::error::broken_pipe);
+
+        // queued packets are discarded
+        unsigned int value = 2;
+        EXPECT_EQ(streamWriter.writeSignalData(7, &value, sizeof(value)), -1);
+        ioc.poll();
+        EXPECT_EQ(recordingStream->writes.size(), 1);
+        SendQueueMetrics metrics = sendQueue->metrics();
+        EXPECT_TRUE(metrics.failed);
+        EXPECT_EQ(metrics.queuedBytes, 0);
+    }
+
+    /// \return The values of the signal data packets written by writePackets()
+    static std::vector < unsigned int > writtenValues(const std::string& written)
+    {
+        static const size_t packetSize = sizeof(uint32_t) + sizeof(unsigned int);
+        std::vector < unsigned int > values;
+        for (size_t position = 0; position + packetSize <= written.size(); position += packetSize) {
+            unsigned int value;
+            memcpy(&value, written.data() + position + sizeof(uint32_t), sizeof(value));
+            values.push_back(value);
+        }
+        return values;
+    }
+
+    TEST(StreamWriterTest, queued_overflow_drop)
+    {
+        static const size_t packetSize = sizeof(uint32_t) + sizeof(unsigned int);
+        boost::asio::io_context ioc;
+        auto recordingStream = std::make_shared < RecordingStream >();
+        auto sendQueue = std::make_shared < SendQueue >(ioc, recordingStream, std::chrono::microseconds(0), SendQueue::DEFAULT_MAX_BATCH_SIZE, 10 * packetSize, SendQueue::OVERFLOWPOLICY_DROP, Logging::logCallback());
+        StreamWriter streamWriter(sendQueue);
+        sendQueue->setDroppable(7, true);
+
+        // the client does not complete the 1st write, its packet is accounted until then
+        writePackets(streamWriter, 0, 1);
+        ioc.poll();
+        ASSERT_TRUE(recordingStream->writePending());
+        writePackets(streamWriter, 1, 20);
+        SendQueueMetrics metrics = sendQueue->metrics();
+        EXPECT_EQ(metrics.bufferedBytes, 10 * packetSize);
+        EXPECT_EQ(metrics.fillLevel, 100);
+        EXPECT_EQ(metrics.droppedCount, 11);
+        EXPECT_EQ(metrics.droppedBytes, 11 * packetSize);
+        EXPECT_EQ(sendQueue->droppedCount(7), 11);
+        EXPECT_EQ(sendQueue->droppedCount(8), 0);
+
+        // whole packets are dropped, later ones are queued again once there is room
+        unsigned int value = 21;
+        EXPECT_EQ(streamWriter.writeSignalData(7, &value, sizeof(value)), 0);
+        recordingStream->completeWrite();
+        ASSERT_EQ(recordingStream->writes.size(), 2);
+        EXPECT_EQ(writtenValues(recordingStream->writes[1]), std::vector < unsigned int >({ 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+        EXPECT_EQ(sendQueue->fillLevel(), 90);
+        recordingStream->completeWrite();
+        EXPECT_EQ(sendQueue->fillLevel(), 0);
+        EXPECT_EQ(streamWriter.writeSignalData(7, &value, sizeof(value)), packetSize);
+
+        // meta information is never dropped
+        writePackets(streamWriter, 22, 9);
+        nlohmann::json metaInfo;
+        metaInfo["bla"] = 12;
+        EXPECT_GT(streamWriter.writeMetaInformation(0, metaInfo), 0);
+        EXPECT_FALSE(sendQueue->metrics().failed);
+    }
+
+    TEST(StreamWriterTest, queued_overflow_decimate)
+    {
+        static const size_t packetSize = sizeof(uint32_t) + sizeof(unsigned int);
+        boost::asio::io_context ioc;
+        auto recordingStream = std::make_shared < RecordingStream >();
+        auto sendQueue = std::make_shared < SendQueue >(ioc, recordingStream, std::chrono::microseconds(0), SendQueue::DEFAULT_MAX_BATCH_SIZE, 16 * packetSize, SendQueue::OVERFLOWPOLICY_DECIMATE, Logging::logCallback());
+        StreamWriter streamWriter(sendQueue);
+        sendQueue->setDroppable(7, true);
+
+        writePackets(streamWriter, 0, 1);
+        ioc.poll();
+        ASSERT_TRUE(recordingStream->writePending());
+        // every packet below 50%, every 2nd below 75%, every 4th above, none when full
+        writePackets(streamWriter, 1, 30);
+        EXPECT_EQ(sendQueue->droppedCount(7), 15);
+        EXPECT_EQ(sendQueue->fillLevel(), 100);
+        recordingStream->completeWrite();
+        ASSERT_EQ(recordingStream->writes.size(), 2);
+        EXPECT_EQ(writtenValues(recordingStream->writes[1]), std::vector < unsigned int >({ 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 14, 16, 20, 24, 28 }));
+    }
+
+    TEST(StreamWriterTest, queued_overflow_drop_large_signal_number)
+    {
+        static const size_t packetSize = sizeof(uint32_t) + sizeof(unsigned int);
+        static const unsigned int signalNumber = SIGNAL_NUMBER_MASK;
+        boost::asio::io_context ioc;
+        auto recordingStream = std::make_shared < RecordingStream >();
+        auto sendQueue = std::make_shared < SendQueue >(ioc, recordingStream, std::chrono::microseconds(0), SendQueue::DEFAULT_MAX_BATCH_SIZE, 2 * packetSize, SendQueue::OVERFLOWPOLICY_DROP, Logging::logCallback());
+        StreamWriter streamWriter(sendQueue);
+        // the state of signal numbers from 4096 on is kept in a map
+        sendQueue->setDroppable(signalNumber, true);
+
+        for (unsigned int value = 0; value < 4; ++value) {
+            streamWriter.writeSignalData(signalNumber, &value, sizeof(value));
+            ioc.poll();
+        }
+        EXPECT_EQ(sendQueue->droppedCount(signalNumber), 2);
+        EXPECT_EQ(sendQueue->droppedCount(signalNumber - 1), 0);
+        EXPECT_FALSE(sendQueue->metrics().failed);
+    }
+
+    TEST(StreamWriterTest, queued_overflow_drop_not_droppable)
+    {
+        static const size_t packetSize = sizeof(uint32_t) + sizeof(unsigned int);
+        boost::asio::io_context ioc;
+        auto work = boost::asio::make_work_guard(ioc);
+        auto recordingStream = std::make_shared < RecordingStream >();
+        auto sendQueue = std::make_shared < SendQueue >(ioc, recordingStream, std::chrono::microseconds(0), SendQueue::DEFAULT_MAX_BATCH_SIZE, 4 * packetSize, SendQueue::OVERFLOWPOLICY_DROP, Logging::logCallback());
+        StreamWriter streamWriter(sendQueue);
+
+        writePackets(streamWriter, 0, 1);
+        ioc.poll();
+        ASSERT_TRUE(recordingStream->writePending());
+        // data of signals not droppable is never dropped, it may exceed the capacity by another capacity
+        for (unsigned int value = 1; value < 8; ++value) {
+            EXPECT_EQ(streamWriter.writeSignalData(7, &value, sizeof(value)), packetSize);
+        }
+        EXPECT_EQ(sendQueue->droppedCount(7), 0);
+        EXPECT_FALSE(sendQueue->metrics().failed);
+        unsigned int value = 8;
+        EXPECT_EQ(streamWriter.writeSignalData(7, &value, sizeof(value)), -1);
+        EXPECT_TRUE(sendQueue->metrics().failed);
+        recordingStream->completeWrite(boost::asio::error::operation_aborted);
+    }
+
+    /// Time stamps of an explicit time signal are not dropped, each value received keeps the time stamp it was written with
+    TEST(StreamWriterTest, queued_overflow_drop_time_stamps)
+    {
+        static const std::string fileName = "theFile";
+        static const std::string tableId = "the table Id";
+        static const size_t packetSize = sizeof(uint32_t) + sizeof(uint64_t);
+        boost::asio::io_context ioc;
+        auto work = boost::asio::make_work_guard(ioc);
+        auto recordingStream = std::make_shared < RecordingStream >();
+        auto sendQueue = std::make_shared < SendQueue >(ioc, recordingStream, std::chrono::microseconds(0), SendQueue::DEFAULT_MAX_BATCH_SIZE, 64 * packetSize, SendQueue::OVERFLOWPOLICY_DROP, Logging::logCallback());
+        StreamWriter streamWriter(sendQueue);
+
+        ExplicitTimeSignal timeSignal("the time Id", tableId, 1000000000, streamWriter, Logging::logCallback());
+        AsynchronousSignal < uint64_t > asyncSignal("the Id", tableId, streamWriter, Logging::logCallback());
+        sendQueue->setDroppable(timeSignal.getNumber(), timeSignal.isDroppable());
+        sendQueue->setDroppable(asyncSignal.getNumber(), asyncSignal.isDroppable());
+        auto completeWrites = [&]() {
+            for (ioc.poll(); recordingStream->writePending(); ioc.poll()) {
+                recordingStream->completeWrite();
+            }
+        };
+        timeSignal.subscribe();
+        asyncSignal.subscribe();
+        completeWrites();
+
+        // the value equals its time stamp
+        auto writeValues = [&](uint64_t first, uint64_t count) {
+            for (uint64_t time = first; time < first + count; ++time) {
+                streamWriter.writeSignalData(timeSignal.getNumber(), &time, sizeof(time));
+                AsynchronousSignal < uint64_t >::ValueTuples tuples(1);
+                tuples[0].timeStamp = time;
+                tuples[0].value = time;
+                asyncSignal.addData(tuples);
+            }
+        };
+
+        // the client does not complete the 1st write, values are dropped once the capacity is reached
+        writeValues(0, 1);
+        ioc.poll();
+        ASSERT_TRUE(recordingStream->writePending());
+        writeValues(1, 60);
+        EXPECT_GT(sendQueue->droppedCount(asyncSignal.getNumber()), 0);
+        EXPECT_EQ(sendQueue->droppedCount(timeSignal.getNumber()), 0);
+        completeWrites();
+        writeValues(61, 5);
+        completeWrites();
+        EXPECT_FALSE(sendQueue->metrics().failed);
+
+        {
+            std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+            for (const auto& written : recordingStream->writes) {
+                file << written;
+            }
+        }
+
+        std::vector < uint64_t > receivedValues;
+        auto dataAsValueCb = [&](const SubscribedSignal& subscribedSignal, uint64_t timeStamp, const uint8_t* data, size_t valueCount)
+        {
+            if (subscribedSignal.isTimeSignal()) {
+                return;
+            }
+            ASSERT_EQ(subscribedSignal.signalNumber(), asyncSignal.getNumber());
+            ASSERT_EQ(valueCount, 1);
+            uint64_t value;
+            memcpy(&value, data, sizeof(value));
+            EXPECT_EQ(timeStamp, value);
+            receivedValues.push_back(value);
+        };
+        auto streamMetaCb = [](ProtocolHandler&, const std::string&, const nlohmann::json&)
+        {
+        };
+
+        boost::asio::io_context consumerIoc;
+        SignalContainer signalContainer(Logging::logCallback());
+        signalContainer.setDataAsValueCb(dataAsValueCb);
+        auto protocolHandler = std::make_shared < ProtocolHandler >(consumerIoc, signalContainer, streamMetaCb, Logging::logCallback());
+        protocolHandler->start(std::make_unique < daq::stream::FileStream >(consumerIoc, fileName));
+        consumerIoc.run();
+
+        EXPECT_EQ(receivedValues.size(), 66 - sendQueue->droppedCount(asyncSignal.getNumber()));
+        // values written after the drops are received as well
+        ASSERT_FALSE(receivedValues.empty());
+        EXPECT_EQ(receivedValues.back(), 65);
+    }
+
+    TEST(StreamWriterTest, queued_overflow_disconnect)
+    {
+        static const size_t packetSize = sizeof(uint32_t) + sizeof(unsigned int);
+        boost::asio::io_context ioc;
+        auto work = boost::asio::make_work_guard(ioc);
+        auto recordingStream = std::make_shared < RecordingStream >();
+        auto sendQueue = std::make_shared < SendQueue >(ioc, recordingStream, std::chrono::microseconds(0), SendQueue::DEFAULT_MAX_BATCH_SIZE, 4 * packetSize, SendQueue::OVERFLOWPOLICY_DISCONNECT, Logging::logCallback());
+        StreamWriter streamWriter(sendQueue);
+
+        writePackets(streamWriter, 0, 4);
+        ioc.poll();
+        ASSERT_TRUE(recordingStream->writePending());
+        unsigned int value = 4;
+        EXPECT_EQ(streamWriter.writeSignalData(7, &value, sizeof(value)), -1);
+        EXPECT_TRUE(sendQueue->metrics().failed);
+        // the session ends as on any other failure of the stream
+        ioc.poll();
+        EXPECT_TRUE(recordingStream->closed);
+        recordingStream->completeWrite(boost::asio::error::operation_aborted);
+        EXPECT_EQ(streamWriter.writeSignalData(7, &value, sizeof(value)), -1);
+        EXPECT_EQ(recordingStream->writes.size(), 1);
+    }
 }
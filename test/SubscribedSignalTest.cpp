@@ -795,4 +795,141 @@ namespace daq::streaming_protocol {
 			ASSERT_EQ(postScaling, postScalingResult);
 		}
 	}
+
+    TEST(SubscribedSignalTest, sample_converter_test)
+    {
+        SignalNumber signalNumber = 9;
+        int result;
+
+        SubscribedSignal dataSignal(signalNumber, logCallback);
+
+        PostScaling postScaling;
+        postScaling.offset = 1;
+        postScaling.scale = 10;
+        Range range;
+        range.low = -100;
+        range.high = 100;
+
+        nlohmann::json metaDataSignal;
+        metaDataSignal[META_DEFINITION][META_RULE] = META_RULETYPE_CONSTANT;
+        metaDataSignal[META_DEFINITION][META_DATATYPE] = DATA_TYPE_STRUCT;
+        nlohmann::json arrayMember;
+        arrayMember[META_NAME] = "counts";
+        arrayMember[META_DATATYPE] = DATA_TYPE_ARRAY;
+        arrayMember[DATA_TYPE_ARRAY][META_DATATYPE] = DATA_TYPE_INT16;
+        arrayMember[DATA_TYPE_ARRAY][META_COUNT] = 2;
+        nlohmann::json complexMember;
+        complexMember[META_NAME] = "spectrum";
+        complexMember[META_DATATYPE] = DATA_TYPE_COMPLEX32;
+        metaDataSignal[META_DEFINITION][DATA_TYPE_STRUCT] = nlohmann::json::array({ arrayMember, complexMember });
+        range.compose(metaDataSignal[META_DEFINITION]);
+        postScaling.compose(metaDataSignal[META_DEFINITION]);
+        result = dataSignal.processSignalMetaInformation(META_METHOD_SIGNAL, metaDataSignal);
+        ASSERT_EQ(result, 0);
+
+        const SampleConverter& converter = dataSignal.sampleConverter();
+        ASSERT_EQ(converter.elementCount(), 4u);
+        // the value index comes in front of each value
+        ASSERT_EQ(converter.valueSize(), sizeof(uint64_t) + dataSignal.dataValueSize());
+
+#pragma pack(push, 1)
+        struct Value
+        {
+            uint64_t index;
+            int16_t counts[2];
+            Complex32Type spectrum;
+        };
+#pragma pack(pop)
+        Value values[] = {
+            { 0, { 1, -1 }, { 2.5, -2.5 } },
+            { 5, { 20, -20 }, { 0.5, 1.5 } }
+        };
+
+        double results[8];
+        uint64_t valueIndices[2];
+        unsigned int options = SampleConverter::OPTION_POSTSCALING | SampleConverter::OPTION_RANGE;
+        ASSERT_EQ(converter.convert(reinterpret_cast < const uint8_t* > (values), 2, results, options, valueIndices), 8u);
+        ASSERT_EQ(valueIndices[0], 0u);
+        ASSERT_EQ(valueIndices[1], 5u);
+        double expected[] = { 11, -9, 26, -24, 100, -100, 6, 16 };
+        for (size_t resultIndex = 0; resultIndex < 8; ++resultIndex) {
+            ASSERT_EQ(results[resultIndex], expected[resultIndex]);
+        }
+
+        // only values with one element are supported here
+        ASSERT_EQ(dataSignal.interpretValuesAsDouble(reinterpret_cast < const uint8_t* > (values), 2, results), 0u);
+
+        // a data type the converter does not support clears the previous layout, even if the signal is refused
+        nlohmann::json dynamicArraySignal;
+        dynamicArraySignal[META_DEFINITION][META_RULE] = META_RULETYPE_EXPLICIT;
+        dynamicArraySignal[META_DEFINITION][META_DATATYPE] = DATA_TYPE_DYNAMIC_ARRAY;
+        dynamicArraySignal[META_DEFINITION][DATA_TYPE_DYNAMIC_ARRAY][META_DATATYPE] = DATA_TYPE_INT32;
+        result = dataSignal.processSignalMetaInformation(META_METHOD_SIGNAL, dynamicArraySignal);
+        ASSERT_EQ(result, -1);
+        ASSERT_EQ(converter.elementCount(), 0u);
+        ASSERT_EQ(converter.convert(reinterpret_cast < const uint8_t* > (values), 2, results), 0u);
+    }
+
+    TEST(SubscribedSignalTest, timestamped_values_test)
+    {
+        SignalNumber signalNumber = 9;
+        uint64_t startTime = 1000;
+        uint64_t signalDelayIndex = 10;
+
+        auto dataAsRawCb = [](const SubscribedSignal&, uint64_t, const uint8_t*, size_t) {};
+        auto dataAsValueCb = [](const SubscribedSignal&, uint64_t, const uint8_t*, size_t) {};
+        std::vector < uint64_t > deliveredTimeStamps;
+        auto dataAsTimestampedValuesCb = [&](const SubscribedSignal&, const uint64_t* timeStamps, const uint8_t*, size_t valueCount)
+        {
+            deliveredTimeStamps.assign(timeStamps, timeStamps + valueCount);
+        };
+
+        {
+            // explicit rule: values follow each other
+            auto timeSignal = std::make_shared<SubscribedSignal>(signalNumber+1, logCallback);
+            SubscribedSignal dataSignal(signalNumber, logCallback);
+            prepareSignals(dataSignal, timeSignal, startTime);
+
+            nlohmann::json metaDataSignal;
+            metaDataSignal[META_VALUEINDEX] = signalDelayIndex;
+            metaDataSignal[META_DEFINITION][META_RULE] = META_RULETYPE_EXPLICIT;
+            metaDataSignal[META_DEFINITION][META_DATATYPE] = DATA_TYPE_UINT16;
+            ASSERT_EQ(dataSignal.processSignalMetaInformation(META_METHOD_SIGNAL, metaDataSignal), 0);
+
+            uint16_t data[] = { 1, 2, 3 };
+            dataSignal.processMeasuredData(reinterpret_cast < unsigned char* > (data), sizeof(data), timeSignal, dataAsRawCb, dataAsValueCb, dataAsTimestampedValuesCb);
+            ASSERT_EQ(deliveredTimeStamps, std::vector < uint64_t > ({ 1010, 1011, 1012 }));
+            dataSignal.processMeasuredData(reinterpret_cast < unsigned char* > (data), sizeof(data), timeSignal, dataAsRawCb, dataAsValueCb, dataAsTimestampedValuesCb);
+            ASSERT_EQ(deliveredTimeStamps, std::vector < uint64_t > ({ 1013, 1014, 1015 }));
+        }
+
+        {
+            // constant rule: each value has its value index
+#pragma pack(push, 1)
+            struct Uint32WithValueIndex
+            {
+                uint64_t valueIndex;
+                uint32_t value;
+            };
+#pragma pack(pop)
+
+            auto timeSignal = std::make_shared<SubscribedSignal>(signalNumber+1, logCallback);
+            SubscribedSignal dataSignal(signalNumber, logCallback);
+            prepareSignals(dataSignal, timeSignal, startTime);
+            timeSignal->setTimeIndex(2);
+
+            nlohmann::json metaDataSignal;
+            metaDataSignal[META_DEFINITION][META_RULE] = META_RULETYPE_CONSTANT;
+            metaDataSignal[META_DEFINITION][META_DATATYPE] = DATA_TYPE_UINT32;
+            ASSERT_EQ(dataSignal.processSignalMetaInformation(META_METHOD_SIGNAL, metaDataSignal), 0);
+
+            Uint32WithValueIndex data[] = {
+                { 2, 5},
+                { 5, 6},
+                { 9, 7}
+            };
+            dataSignal.processMeasuredData(reinterpret_cast < unsigned char* > (data), sizeof(data), timeSignal, dataAsRawCb, dataAsValueCb, dataAsTimestampedValuesCb);
+            ASSERT_EQ(deliveredTimeStamps, std::vector < uint64_t > ({ 1000, 1003, 1007 }));
+        }
+    }
 }
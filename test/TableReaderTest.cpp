@@ -0,0 +1,278 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "nlohmann/json.hpp"
+
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/Logging.hpp"
+#include "streaming_protocol/SubscribedSignal.hpp"
+#include "streaming_protocol/TableReader.hpp"
+
+namespace daq::streaming_protocol {
+    static LogCallback logCallback = daq::streaming_protocol::Logging::logCallback();
+
+    static const uint64_t StartTime = 1000;
+    static const uint64_t TimeDelta = 10;
+
+    /// A table with a linear time signal and int32 data signals
+    class TestTable
+    {
+    public:
+        /// \param firstSignalNumber Signal number of the 1st data signal, the others follow
+        explicit TestTable(size_t dataSignalCount, unsigned int firstSignalNumber = 1)
+            : m_timeSignal(std::make_shared < SubscribedSignal > (0, logCallback))
+        {
+            nlohmann::json subscribe;
+            subscribe[META_SIGNALID] = "time";
+            m_timeSignal->processSignalMetaInformation(META_METHOD_SUBSCRIBE, subscribe);
+            nlohmann::json timeSignal;
+            timeSignal[META_TABLEID] = "table";
+            timeSignal[META_DEFINITION][META_RULE] = META_RULETYPE_LINEAR;
+            timeSignal[META_DEFINITION][META_RULETYPE_LINEAR][META_DELTA] = TimeDelta;
+            timeSignal[META_DEFINITION][META_DATATYPE] = DATA_TYPE_UINT64;
+            m_timeSignal->processSignalMetaInformation(META_METHOD_SIGNAL, timeSignal);
+            m_timeSignal->setTime(StartTime);
+
+            for (size_t signalIndex = 0; signalIndex < dataSignalCount; ++signalIndex) {
+                auto dataSignal = std::make_unique < SubscribedSignal > (static_cast < unsigned int > (firstSignalNumber + signalIndex), logCallback);
+                subscribe[META_SIGNALID] = signalId(signalIndex);
+                dataSignal->processSignalMetaInformation(META_METHOD_SUBSCRIBE, subscribe);
+                nlohmann::json metaDataSignal;
+                metaDataSignal[META_TABLEID] = "table";
+                metaDataSignal[META_DEFINITION][META_RULE] = META_RULETYPE_EXPLICIT;
+                metaDataSignal[META_DEFINITION][META_DATATYPE] = DATA_TYPE_INT32;
+                dataSignal->processSignalMetaInformation(META_METHOD_SIGNAL, metaDataSignal);
+                dataSignal->setTimeSignal(m_timeSignal);
+                m_dataSignals.push_back(std::move(dataSignal));
+            }
+        }
+
+        static std::string signalId(size_t signalIndex)
+        {
+            return "data" + std::to_string(signalIndex);
+        }
+
+        /// value of a data signal at a value index
+        static int32_t value(size_t signalIndex, uint64_t valueIndex)
+        {
+            return static_cast < int32_t > (1000 * signalIndex + valueIndex);
+        }
+
+        /// Sends the next valueCount values of a data signal to the reader
+        void send(size_t signalIndex, size_t valueCount, TableReader& reader)
+        {
+            SubscribedSignal& dataSignal = *m_dataSignals[signalIndex];
+            std::vector < int32_t > values;
+            for (size_t valueIndex = 0; valueIndex < valueCount; ++valueIndex) {
+                values.push_back(value(signalIndex, dataSignal.timeIndex() + valueIndex));
+            }
+            auto nop = [](const SubscribedSignal&, uint64_t, const uint8_t*, size_t) {};
+            auto add = [&reader](const SubscribedSignal& subscribedSignal, const uint64_t* timeStamps, const uint8_t* data, size_t count)
+            {
+                reader.add(subscribedSignal, timeStamps, data, count);
+            };
+            dataSignal.processMeasuredData(reinterpret_cast < const unsigned char* > (values.data()), values.size() * sizeof(int32_t), m_timeSignal, nop, nop, add);
+        }
+
+        /// Skips values of a data signal
+        void skip(size_t signalIndex, size_t valueCount)
+        {
+            SubscribedSignal& dataSignal = *m_dataSignals[signalIndex];
+            dataSignal.setTimeIndex(dataSignal.timeIndex() + valueCount);
+        }
+
+    private:
+        std::shared_ptr < SubscribedSignal > m_timeSignal;
+        std::vector < std::unique_ptr < SubscribedSignal > > m_dataSignals;
+    };
+
+    /// Collects all rows delivered
+    struct Rows
+    {
+        std::vector < uint64_t > valueIndices;
+        std::vector < uint64_t > timeStamps;
+        /// per column
+        std::vector < std::vector < double > > columns;
+        std::vector < size_t > frameSizes;
+
+        TableFrameCb frameCb()
+        {
+            return [this](const TableFrame& frame)
+            {
+                columns.resize(frame.columnCount);
+                frameSizes.push_back(frame.rowCount);
+                for (size_t row = 0; row < frame.rowCount; ++row) {
+                    valueIndices.push_back(frame.firstValueIndex + row);
+                    timeStamps.push_back(frame.timeStamps[row]);
+                    for (size_t column = 0; column < frame.columnCount; ++column) {
+                        columns[column].push_back(frame.columns[column][row]);
+                        if (frame.rows) {
+                            ASSERT_EQ(frame.rows[row * frame.columnCount + column], frame.columns[column][row]);
+                        }
+                    }
+                }
+            };
+        }
+    };
+
+    TEST(TableReaderTest, aligned_test)
+    {
+        static const size_t signalCount = 3;
+        TestTable table(signalCount);
+        Rows rows;
+        TableReader reader({ TestTable::signalId(0), TestTable::signalId(1), TestTable::signalId(2) }, 4, 100, rows.frameCb(), logCallback);
+        reader.setRowMajor(true);
+        ASSERT_EQ(reader.columnCount(), signalCount);
+
+        // packages of different sizes
+        table.send(0, 3, reader);
+        table.send(1, 5, reader);
+        table.send(2, 2, reader);
+        ASSERT_TRUE(rows.frameSizes.empty());
+        table.send(2, 7, reader);
+        table.send(0, 6, reader);
+        table.send(1, 4, reader);
+        ASSERT_EQ(rows.frameSizes, std::vector < size_t > ({ 4, 4 }));
+        reader.flush();
+        ASSERT_EQ(rows.frameSizes, std::vector < size_t > ({ 4, 4, 1 }));
+
+        ASSERT_EQ(rows.valueIndices.size(), 9u);
+        for (size_t row = 0; row < rows.valueIndices.size(); ++row) {
+            ASSERT_EQ(rows.valueIndices[row], row);
+            ASSERT_EQ(rows.timeStamps[row], StartTime + row * TimeDelta);
+            for (size_t column = 0; column < signalCount; ++column) {
+                ASSERT_EQ(rows.columns[column][row], TestTable::value(column, row));
+            }
+        }
+        ASSERT_EQ(reader.droppedValueCount(), 0u);
+    }
+
+    TEST(TableReaderTest, straggler_test)
+    {
+        TestTable table(2);
+        Rows rows;
+        TableReader reader({ TestTable::signalId(0), TestTable::signalId(1) }, 4, 8, rows.frameCb(), logCallback);
+
+        // the 2nd signal lags behind
+        table.send(0, 8, reader);
+        ASSERT_TRUE(rows.frameSizes.empty());
+        // more than can be buffered
+        table.send(0, 4, reader);
+        ASSERT_EQ(rows.frameSizes, std::vector < size_t > ({ 4 }));
+        for (size_t row = 0; row < 4; ++row) {
+            ASSERT_EQ(rows.columns[0][row], TestTable::value(0, row));
+            ASSERT_TRUE(std::isnan(rows.columns[1][row]));
+        }
+
+        // values of delivered rows are dropped, the others are aligned
+        table.send(1, 6, reader);
+        ASSERT_EQ(reader.droppedValueCount(), 4u);
+        reader.flush();
+        ASSERT_EQ(rows.valueIndices.size(), 12u);
+        for (size_t row = 4; row < 12; ++row) {
+            ASSERT_EQ(rows.valueIndices[row], row);
+            ASSERT_EQ(rows.columns[0][row], TestTable::value(0, row));
+            if (row < 6) {
+                ASSERT_EQ(rows.columns[1][row], TestTable::value(1, row));
+            } else {
+                ASSERT_TRUE(std::isnan(rows.columns[1][row]));
+            }
+        }
+    }
+
+    TEST(TableReaderTest, gap_test)
+    {
+        TestTable table(2);
+        Rows rows;
+        TableReader reader({ TestTable::signalId(0), TestTable::signalId(1) }, 4, 8, rows.frameCb(), logCallback);
+
+        // gap within the buffer is NaN
+        table.send(0, 4, reader);
+        table.send(1, 1, reader);
+        table.skip(1, 2);
+        table.send(1, 1, reader);
+        ASSERT_EQ(rows.frameSizes, std::vector < size_t > ({ 4 }));
+        ASSERT_EQ(rows.columns[1][0], TestTable::value(1, 0));
+        ASSERT_TRUE(std::isnan(rows.columns[1][1]));
+        ASSERT_TRUE(std::isnan(rows.columns[1][2]));
+        ASSERT_EQ(rows.columns[1][3], TestTable::value(1, 3));
+
+        // gap larger than the buffer: rows in between are skipped
+        table.send(0, 2, reader);
+        table.skip(0, 100);
+        table.skip(1, 102);
+        table.send(0, 4, reader);
+        table.send(1, 4, reader);
+        ASSERT_EQ(rows.frameSizes, std::vector < size_t > ({ 4, 2, 4 }));
+        ASSERT_EQ(rows.valueIndices[6], 106u);
+        ASSERT_EQ(rows.timeStamps[6], StartTime + 106 * TimeDelta);
+        ASSERT_EQ(rows.columns[0][6], TestTable::value(0, 106));
+        ASSERT_EQ(rows.columns[1][6], TestTable::value(1, 106));
+    }
+
+    TEST(TableReaderTest, unknown_signal_test)
+    {
+        TestTable table(2);
+        Rows rows;
+        TableReader reader({ TestTable::signalId(1) }, 2, 2, rows.frameCb(), logCallback);
+        table.send(0, 4, reader);
+        ASSERT_TRUE(rows.frameSizes.empty());
+        table.send(1, 4, reader);
+        ASSERT_EQ(rows.frameSizes, std::vector < size_t > ({ 2, 2 }));
+    }
+
+    TEST(TableReaderTest, large_signal_number_test)
+    {
+        // columns of large signal numbers are resolved through a map
+        TestTable table(2, SIGNAL_NUMBER_MASK - 1);
+        Rows rows;
+        TableReader reader({ TestTable::signalId(1) }, 2, 2, rows.frameCb(), logCallback);
+        table.send(0, 4, reader);
+        ASSERT_TRUE(rows.frameSizes.empty());
+        table.send(1, 4, reader);
+        ASSERT_EQ(rows.frameSizes, std::vector < size_t > ({ 2, 2 }));
+        ASSERT_EQ(rows.columns[0][3], TestTable::value(1, 3));
+    }
+
+    TEST(TableReaderTest, interleave_test)
+    {
+        for (size_t columnCount = 1; columnCount <= 9; ++columnCount) {
+            for (size_t rowCount = 0; rowCount <= 133; rowCount += 7) {
+                std::vector < std::vector < double > > columns(columnCount);
+                std::vector < const double* > columnPointers;
+                for (size_t column = 0; column < columnCount; ++column) {
+                    for (size_t row = 0; row < rowCount; ++row) {
+                        columns[column].push_back(static_cast < double > (1000 * column + row));
+                    }
+                    columnPointers.push_back(columns[column].data());
+                }
+                std::vector < double > rows(columnCount * rowCount, -1);
+                TableReader::interleave(columnPointers.data(), columnCount, rowCount, rows.data());
+                for (size_t row = 0; row < rowCount; ++row) {
+                    for (size_t column = 0; column < columnCount; ++column) {
+                        ASSERT_EQ(rows[row * columnCount + column], columns[column][row]) << columnCount << " columns, " << rowCount << " rows";
+                    }
+                }
+            }
+        }
+    }
+}
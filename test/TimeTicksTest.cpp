@@ -0,0 +1,149 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "streaming_protocol/TimeTicks.hpp"
+
+namespace daq::streaming_protocol {
+    /// 1GHz, 1MHz, NTP and some resolutions that divide neither into nor by 1GHz
+    static const uint64_t TimeTicksPerSeconds[] = { 1000000000, 1000000, uint64_t(1) << 32, 48000, 3, 1000000007, 40000000000 };
+
+    /// odd, to have remainders for all vector widths
+    static const size_t ValueCount = 37;
+
+    TEST(TimeTicksTest, mul_div_test)
+    {
+        ASSERT_EQ(TimeTicks::mulDiv(0, 7, 3), 0u);
+        ASSERT_EQ(TimeTicks::mulDiv(10, 7, 3), 23u);
+        // intermediate product beyond 64 bit
+        ASSERT_EQ(TimeTicks::mulDiv(0xffffffffffffffff, 1000000000, 1000000000), 0xffffffffffffffff);
+        ASSERT_EQ(TimeTicks::mulDiv(0x8000000000000000, 6, 4), 0xc000000000000000);
+    }
+
+    TEST(TimeTicksTest, nanoseconds_test)
+    {
+        for (uint64_t timeTicksPerSecond : TimeTicksPerSeconds) {
+            // one second
+            ASSERT_EQ(TimeTicks::toNanoseconds(timeTicksPerSecond, timeTicksPerSecond), TimeTicks::NANOSECONDS_PER_SECOND);
+            ASSERT_EQ(TimeTicks::fromNanoseconds(TimeTicks::NANOSECONDS_PER_SECOND, timeTicksPerSecond), timeTicksPerSecond);
+            // ten years and a tick
+            uint64_t timeTicks = timeTicksPerSecond * 3600 * 8760 * 10 + 1;
+            uint64_t nanoseconds = TimeTicks::toNanoseconds(timeTicks, timeTicksPerSecond);
+            ASSERT_EQ(nanoseconds, TimeTicks::mulDiv(timeTicks, TimeTicks::NANOSECONDS_PER_SECOND, timeTicksPerSecond)) << timeTicksPerSecond;
+            ASSERT_EQ(TimeTicks::fromNanoseconds(nanoseconds, timeTicksPerSecond), TimeTicks::mulDiv(nanoseconds, timeTicksPerSecond, TimeTicks::NANOSECONDS_PER_SECOND)) << timeTicksPerSecond;
+        }
+
+        // rounded towards zero
+        ASSERT_EQ(TimeTicks::toNanoseconds(2, 3), 666666666u);
+        ASSERT_EQ(TimeTicks::fromNanoseconds(999, 1000000), 0u);
+    }
+
+    TEST(TimeTicksTest, nanoseconds_batch_test)
+    {
+        for (uint64_t timeTicksPerSecond : TimeTicksPerSeconds) {
+            std::vector < uint64_t > timeTicks(ValueCount);
+            for (size_t index = 0; index < ValueCount; ++index) {
+                timeTicks[index] = index * 0x123456789abc + index;
+            }
+            // largest dividend
+            timeTicks.back() = 0xffffffffffffffff;
+            std::vector < uint64_t > nanoseconds(ValueCount);
+            TimeTicks::toNanoseconds(timeTicks.data(), timeTicks.size(), timeTicksPerSecond, nanoseconds.data());
+            for (size_t index = 0; index < ValueCount; ++index) {
+                ASSERT_EQ(nanoseconds[index], TimeTicks::toNanoseconds(timeTicks[index], timeTicksPerSecond)) << timeTicksPerSecond;
+            }
+
+            // in place
+            TimeTicks::toNanoseconds(timeTicks.data(), timeTicks.size(), timeTicksPerSecond, timeTicks.data());
+            ASSERT_EQ(timeTicks, nanoseconds);
+        }
+    }
+
+    TEST(TimeTicksTest, system_clock_test)
+    {
+        for (uint64_t timeTicksPerSecond : TimeTicksPerSeconds) {
+            std::chrono::system_clock::time_point time = TimeTicks::toSystemClock(timeTicksPerSecond * 86400, timeTicksPerSecond);
+            ASSERT_EQ(time, std::chrono::system_clock::time_point(std::chrono::hours(24)));
+            ASSERT_EQ(TimeTicks::fromSystemClock(time, timeTicksPerSecond), timeTicksPerSecond * 86400);
+
+            std::vector < uint64_t > timeTicks(ValueCount);
+            for (size_t index = 0; index < ValueCount; ++index) {
+                timeTicks[index] = index * 0x123456789abc;
+            }
+            std::vector < std::chrono::system_clock::time_point > times(ValueCount);
+            TimeTicks::toSystemClock(timeTicks.data(), timeTicks.size(), timeTicksPerSecond, times.data());
+            for (size_t index = 0; index < ValueCount; ++index) {
+                ASSERT_EQ(times[index], TimeTicks::toSystemClock(timeTicks[index], timeTicksPerSecond));
+            }
+        }
+
+        // before the epoch
+        ASSERT_EQ(TimeTicks::fromSystemClock(std::chrono::system_clock::time_point(-std::chrono::hours(1)), 1000), 0u);
+    }
+
+    TEST(TimeTicksTest, unknown_time_base_test)
+    {
+        // no division by zero
+        ASSERT_EQ(TimeTicks::toNanoseconds(1000, 0), 0u);
+        ASSERT_EQ(TimeTicks::fromNanoseconds(1000, 0), 0u);
+        ASSERT_EQ(TimeTicks::toSystemClock(1000, 0), std::chrono::system_clock::time_point());
+        ASSERT_EQ(TimeTicks::fromSystemClock(std::chrono::system_clock::time_point(std::chrono::hours(1)), 0), 0u);
+
+        std::vector < uint64_t > timeTicks(ValueCount, 1000);
+        std::vector < uint64_t > nanoseconds(ValueCount, 1);
+        TimeTicks::toNanoseconds(timeTicks.data(), timeTicks.size(), 0, nanoseconds.data());
+        ASSERT_EQ(nanoseconds, std::vector < uint64_t > (ValueCount, 0));
+        std::vector < std::chrono::system_clock::time_point > times(ValueCount, std::chrono::system_clock::time_point(std::chrono::hours(1)));
+        TimeTicks::toSystemClock(timeTicks.data(), timeTicks.size(), 0, times.data());
+        ASSERT_EQ(times, std::vector < std::chrono::system_clock::time_point > (ValueCount));
+    }
+
+    TEST(TimeTicksTest, linear_test)
+    {
+        std::vector < uint64_t > timeStamps(ValueCount);
+        TimeTicks::linear(1000, 3, timeStamps.size(), timeStamps.data());
+        for (size_t index = 0; index < ValueCount; ++index) {
+            ASSERT_EQ(timeStamps[index], 1000 + index * 3);
+        }
+    }
+
+    TEST(TimeTicksTest, linear_indexed_test)
+    {
+#pragma pack(push, 1)
+        struct Int16WithValueIndex
+        {
+            uint64_t valueIndex;
+            int16_t value;
+        };
+#pragma pack(pop)
+
+        std::vector < Int16WithValueIndex > values(ValueCount);
+        for (size_t index = 0; index < ValueCount; ++index) {
+            values[index].valueIndex = 100 + index * index;
+            values[index].value = 0;
+        }
+
+        std::vector < uint64_t > timeStamps(ValueCount);
+        TimeTicks::linear(1000, 100, 3, reinterpret_cast < const uint8_t* > (values.data()), sizeof(Int16WithValueIndex), values.size(), timeStamps.data());
+        for (size_t index = 0; index < ValueCount; ++index) {
+            ASSERT_EQ(timeStamps[index], 1000 + index * index * 3);
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2022-2025 openDAQ d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "streaming_protocol/Defines.h"
+#include "streaming_protocol/Vocabulary.hpp"
+
+namespace daq::streaming_protocol {
+    // lookup works at compile time
+    static_assert(methodTypeFromName(META_METHOD_SIGNAL) == METHODTYPE_SIGNAL, "");
+    static_assert(dataTypeFromName(DATA_TYPE_REAL64) == DATATYPE_REAL64, "");
+    static_assert(ruleTypeFromName(META_RULETYPE_LINEAR) == RULETYPE_LINEAR, "");
+
+    TEST(VocabularyTest, method_type_test)
+    {
+        ASSERT_EQ(methodTypeFromName(META_METHOD_APIVERSION), METHODTYPE_APIVERSION);
+        ASSERT_EQ(methodTypeFromName(META_METHOD_INIT), METHODTYPE_INIT);
+        ASSERT_EQ(methodTypeFromName(META_METHOD_AVAILABLE), METHODTYPE_AVAILABLE);
+        ASSERT_EQ(methodTypeFromName(META_METHOD_UNAVAILABLE), METHODTYPE_UNAVAILABLE);
+        ASSERT_EQ(methodTypeFromName(META_METHOD_ALIVE), METHODTYPE_ALIVE);
+        ASSERT_EQ(methodTypeFromName(META_METHOD_SUBSCRIBE), METHODTYPE_SUBSCRIBE);
+        ASSERT_EQ(methodTypeFromName(META_METHOD_UNSUBSCRIBE), METHODTYPE_UNSUBSCRIBE);
+        ASSERT_EQ(methodTypeFromName(META_METHOD_SIGNAL), METHODTYPE_SIGNAL);
+
+        ASSERT_EQ(methodTypeFromName(""), METHODTYPE_UNKNOWN);
+        ASSERT_EQ(methodTypeFromName("signals"), METHODTYPE_UNKNOWN);
+        ASSERT_EQ(methodTypeFromName("Signal"), METHODTYPE_UNKNOWN);
+        ASSERT_EQ(methodTypeFromName(std::string(META_METHOD_SIGNAL) + '\0'), METHODTYPE_UNKNOWN);
+    }
+
+    TEST(VocabularyTest, data_type_test)
+    {
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_INT8), DATATYPE_INT8);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_UINT8), DATATYPE_UINT8);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_INT16), DATATYPE_INT16);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_UINT16), DATATYPE_UINT16);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_INT32), DATATYPE_INT32);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_UINT32), DATATYPE_UINT32);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_INT64), DATATYPE_INT64);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_UINT64), DATATYPE_UINT64);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_REAL32), DATATYPE_REAL32);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_REAL64), DATATYPE_REAL64);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_COMPLEX32), DATATYPE_COMPLEX32);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_COMPLEX64), DATATYPE_COMPLEX64);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_ARRAY), DATATYPE_ARRAY);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_DYNAMIC_ARRAY), DATATYPE_DYNAMIC_ARRAY);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_STRUCT), DATATYPE_STRUCT);
+        ASSERT_EQ(dataTypeFromName(DATA_TYPE_BITFIELD), DATATYPE_BITFIELD);
+
+        ASSERT_EQ(dataTypeFromName("real128"), DATATYPE_UNKNOWN);
+        ASSERT_EQ(dataTypeFromName("int"), DATATYPE_UNKNOWN);
+    }
+
+    TEST(VocabularyTest, rule_type_test)
+    {
+        ASSERT_EQ(ruleTypeFromName(META_RULETYPE_EXPLICIT), RULETYPE_EXPLICIT);
+        ASSERT_EQ(ruleTypeFromName(META_RULETYPE_LINEAR), RULETYPE_LINEAR);
+        ASSERT_EQ(ruleTypeFromName(META_RULETYPE_CONSTANT), RULETYPE_CONSTANT);
+        ASSERT_EQ(ruleTypeFromName("quadratic"), RULETYPE_UNKNOWN);
+    }
+}